@@ -11,6 +11,7 @@
 
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
+#include <zephyr/timing/timing.h>
 #include <math.h>
 #include "parameter_mem.h"
 #include "datalog_mem.h"
@@ -21,25 +22,37 @@
 #include "epc_mem.h"
 #include "cloud.h"
 #include "test.h"
+#include "window.h"
+#include "fastmath.h"
 
-#define PI                3.141593
-#define EARTH_GRAVITY     9.80665 //  m/s^2
+#define PI                3.141593f
+#define EARTH_GRAVITY     9.80665f //  m/s^2
 #define NF                10 //samples for moving average filter (0.25secs)
 
 #define MOP_RESET_STATE     0
 #define NEW_CHIPPED_MOP     1
 #define NEW_UNCHIPPED_MOP   2
 
+/* Execution time statistic of algorithm_execute_process (cpu cycles) */
+typedef struct
+{
+    uint32_t calls;
+    uint64_t total_cycles;
+    uint64_t min_cycles;
+    uint64_t max_cycles;
+    int64_t start_uptime; // ms, uptime at the last reset
+} ALGO_BENCHMARK;
+
 #define IDLE_STATE          0
 #define MOVING_STATE        1
 #define MOPPING_STATE       2
 
 extern void init_algorithms(void);
 extern void algo_reset_variables(void);
-extern void algo_fAddArrayElement(float *array, float sample, uint16_t array_length);
-extern float algo_fmean(float *array, uint16_t array_length);
-extern float algo_fsum(float *array, uint16_t array_length);
 extern void algorithm_execute_process(void);
+extern void algo_benchmark_Reset(void);
+extern void algo_benchmark_Execute(void);
+extern void algo_benchmark_Get(ALGO_BENCHMARK *snapshot);
 extern void update_average_usage_numbers(void);
 extern float standard_deviation(float *array, int length);
 
@@ -20,6 +20,7 @@
 #include "algorithms.h"
 #include "epc_mem.h"
 #include "event_mem.h"
+#include "provisioning.h"
 
 extern UsageUpdate myUsageUpdate;
 extern DeviceStatus myDeviceStatus;
@@ -27,7 +28,8 @@ extern uint32_t coap_last_transmission_timer;
 extern time_t timestamp_last_cloud_transmission;
 
 extern void cloud_SendUsageUpdateObject(void);
-extern uint32_t protobuf_EncodeUsageUpdateObject(uint8_t **buf);
+extern uint32_t protobuf_PrepareUsageUpdateObject(void);
+extern uint32_t protobuf_EncodeUsageUpdateObject(ProtobufCBuffer *buffer);
 extern void cloud_DecodeUsageUpdateProtobuf(uint8_t *message, uint16_t len);
 extern void cloud_DecodeHubUpdateProtobuf(uint8_t *message, uint16_t len);
 extern void cloud_DecodeDataUpdateProtobuf(uint8_t *message, uint16_t len);
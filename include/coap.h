@@ -34,10 +34,31 @@
 #include "rtc.h"
 #include "aws_fota.h"
 
-#define MAX_COAP_MSG_LEN 1024
 #define BLOCK_WISE_TRANSFER_SIZE_GET 2048
-#define COAP_BLOCK_SIZE COAP_BLOCK_128
+#define COAP_BLOCK_SIZE COAP_BLOCK_1024                    // Largest Block1 size, the server may negotiate it down
+#define COAP_BLOCK_SIZE_BYTES (1 << (COAP_BLOCK_SIZE + 4)) // Same as coap_block_size_to_bytes(COAP_BLOCK_SIZE)
+#define MAX_COAP_MSG_LEN (COAP_BLOCK_SIZE_BYTES + 64)      // One block plus header, token and options
+#define COAP_TOKEN_LENGTH 4
+#define COAP_EMPTY_MESSAGE_LENGTH 4
+
+/* Transmission parameters of RFC 7252, chapter 4.8 */
+#define COAP_ACK_TIMEOUT 2000                              // ms
+#define COAP_ACK_RANDOM_FACTOR 1500                        // Per mille, the first timeout is between ACK_TIMEOUT and 1.5 * ACK_TIMEOUT
+#define COAP_MAX_RETRANSMIT 4
+#define COAP_NSTART 1                                      // Blocks in flight. Raise only if the server accepts Block1 out of order
+#define COAP_SEPARATE_RESPONSE_TIMEOUT 30                  // s, wait time for a separate response after an empty ACK
 #define PSK_TAG 2
+#define COAP_SERVER_HOSTNAME "coap.bosch-iot-hub.com"
+#define COAP_DNS_CACHE_TTL 3600         // s, the resolved server address is used this long before it is resolved again
+#define COAP_SOCKET_IDLE_MARGIN 60      // s, added to the longest sync interval, a socket idle for longer (missed syncs) is connected again
+
+/* Payload of a CoAP request which is read block by block, so the complete payload never has to be in RAM */
+typedef struct coap_payload_source
+{
+  uint32_t length;
+  void (*read)(const struct coap_payload_source *source, uint32_t offset, uint8_t *data, uint16_t len);
+  const void *context; // Passed unchanged to the read function
+} COAP_PAYLOAD_SOURCE;
 
 extern uint16_t next_token;
 extern int16_t err;
@@ -46,7 +67,10 @@ extern time_t time_since_last_cloud_transmission;
 extern time_t timestamp_last_cloud_transmission;
 
 extern int16_t send_coap_request(uint8_t method, uint8_t *message, uint16_t len);
+extern int16_t send_coap_request_from_source(uint8_t method, const COAP_PAYLOAD_SOURCE *source);
 extern int16_t start_coap_client(void);
+extern void coap_disconnect(void);
+extern void coap_invalidate_connection(void);
 extern void convert_ASCII_text_in_hexadecimal_string(char *destination, char *source);
 extern int16_t process_large_coap_reply(void);
 extern void wait(void);
@@ -42,6 +42,8 @@
 #include "event_mem.h"
 #include "hard_reset.h"
 #include "system_mem.h"
+#include "provisioning.h"
+#include "datalog_export.h"
 
 extern bool trace_acc_switch;
 extern bool trace_flash;
@@ -0,0 +1,114 @@
+/**
+ * @file datalog_codec.h
+ * @author Thomas Keilbach | keiltronic GmbH
+ * @date 17 Oct 2026
+ * @brief This file contains the compact frame format of the data log. It does not depend on Zephyr, so the decoder can also be
+ * compiled on a PC to convert an exported log.
+ * @version 2.0.0
+ */
+
+#ifndef DATALOG_CODEC_H
+#define DATALOG_CODEC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "epc.h"
+
+#define DATALOG_FRAME_LENGTH 128UL // In bytes - must be a value of power of 2  (2^n)
+
+/* Dataframe to store in external log. Frame length of 2^n (256 byte in this case) is mandatory
+ * to avoid memory leaks in the external flash memory.
+ */
+typedef union
+{
+    uint8_t logging_frame[DATALOG_FRAME_LENGTH];
+
+    struct __attribute__((packed))
+    {
+        uint32_t FrameNumber;        /* 4 byte */
+        uint32_t unixtime;           /* 4 byte */
+        uint16_t millisec;           /* 2 byte */
+        EPC_BINARY rfid_epc;         /* 20 bytes */
+        uint8_t rfid_reserved;       /* 1 byte */
+        uint8_t rfid_record_type;    /* 1 byte */
+        int16_t raw_sens_value[9];   /* 18 bytes */
+        float floor_handle_angle;    /* 4 byte */
+        float frame_handle_angle;    /* 4 byte */
+        float Mopping_speed;         /* 4 byte */
+        float Coverage_per_Mop;      /* 4 byte */
+        uint16_t Mop_cycles;         /* 2 bytes */
+        uint8_t Mopping_pattern;     /* 1 byte */
+        uint8_t Motion_state;        /* 1 byte */
+        uint16_t Total_Steps;        /* 2 bytes */
+        uint16_t Battery_voltage;    /* 2 bytes */
+        uint16_t ChargeCycle;        /* 2 byte */
+        uint16_t Input_status;       /* 2 bytes */
+        uint16_t Output_status;      /* 2 bytes */
+        uint8_t Error_status;        /* 1 byte */
+    };
+} LOGFRAME;
+
+/* Format version 2 (version 1 were the plain 128 byte LOGFRAMEs).
+ *
+ * Each 4kB sector starts with a DATALOG_SECTOR_HEADER and holds a keyframe followed by delta frames, up to the first erased
+ * byte. A record is:
+ *
+ *   type (1) | field mask (varint) | fields of the mask in the order of the bits
+ *
+ * A field which is not in the mask has the value of the previous frame, except the rfid which is zero then. The keyframe is
+ * encoded against a frame with all values zero, so the sector can be decoded without any other sector. Frame numbers are not
+ * stored, the frames of a sector are numbered from FirstFrameNumber on.
+ *
+ * Integers are stored as difference to the previous frame (zigzag varint), status words as varint of the changed bits (xor) and
+ * floats as 4 bytes if they changed. The epc is stored once per sector (length + trimmed bytes), later frames refer to it with
+ * its index in the sector.
+ */
+#define DATALOG_FORMAT_VERSION 2
+#define DATALOG_RECORD_KEYFRAME 0x4B    // 'K'
+#define DATALOG_RECORD_DELTA 0x44       // 'D'
+#define DATALOG_RECORD_ERASED 0xFF      // End of the frames of a sector
+#define DATALOG_RECORD_MAX_LENGTH 128   // Byte, upper limit of one encoded frame (worst case is 100 byte)
+#define DATALOG_EPC_DICTIONARY_SIZE 16  // Epcs per sector which are referenced by index
+
+/* Bits of the field mask */
+#define DATALOG_FIELD_TIME (1U << 0)           // unixtime and millisec as milli seconds
+#define DATALOG_FIELD_IMU (1U << 1)            // All raw sensor values
+#define DATALOG_FIELD_FLOOR_ANGLE (1U << 2)
+#define DATALOG_FIELD_FRAME_ANGLE (1U << 3)
+#define DATALOG_FIELD_SPEED (1U << 4)
+#define DATALOG_FIELD_COVERAGE (1U << 5)
+#define DATALOG_FIELD_RFID (1U << 6)           // Epc index and record type
+#define DATALOG_FIELD_MOP_CYCLES (1U << 7)
+#define DATALOG_FIELD_MOP_STATE (1U << 8)      // Mopping pattern and motion state
+#define DATALOG_FIELD_STEPS (1U << 9)
+#define DATALOG_FIELD_BATTERY (1U << 10)       // Battery voltage and charge cycles
+#define DATALOG_FIELD_INPUTS (1U << 11)
+#define DATALOG_FIELD_OUTPUTS (1U << 12)
+#define DATALOG_FIELD_ERRORS (1U << 13)
+#define DATALOG_FIELD_ALL ((1U << 14) - 1)
+
+/* First bytes of each sector of the data log */
+typedef struct __attribute__((packed))
+{
+    uint32_t FirstFrameNumber; // Number of the keyframe, erased (0xFFFFFFFF) if the sector was not written
+    uint32_t SectorNumber;     // Counts on when the ring buffer wraps, the sector is stored at SectorNumber % DATALOG_SECTOR_COUNT
+    uint8_t Version;           // DATALOG_FORMAT_VERSION
+    uint8_t Reserved[3];
+} DATALOG_SECTOR_HEADER;
+
+/* State of the encoder or decoder within one sector */
+typedef struct
+{
+    LOGFRAME previous;                             // Last encoded or decoded frame
+    EPC_BINARY epc[DATALOG_EPC_DICTIONARY_SIZE];   // Epcs of the sector
+    uint8_t epc_count;
+    uint32_t frame_number;                         // Number of the next frame
+    bool keyframe;                                 // The next frame is the first one of the sector
+} DATALOG_CODEC;
+
+extern void datalog_ResetCodec(DATALOG_CODEC *codec, uint32_t first_frame_number);
+extern uint16_t datalog_EncodeFrame(DATALOG_CODEC *codec, const LOGFRAME *frame, uint8_t *buffer);
+extern int16_t datalog_DecodeFrame(DATALOG_CODEC *codec, const uint8_t *buffer, uint16_t length, LOGFRAME *frame);
+
+#endif
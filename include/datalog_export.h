@@ -0,0 +1,66 @@
+/**
+ * @file datalog_export.h
+ * @author Thomas Keilbach | keiltronic GmbH
+ * @date 17 Oct 2026
+ * @brief This file contains the binary export of the data log over the shell uart
+ * @version 2.0.0
+ */
+
+#ifndef DATALOG_EXPORT_H
+#define DATALOG_EXPORT_H
+
+#include <zephyr/kernel.h>
+#include <stdlib.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/byteorder.h>
+#include "datalog_mem.h"
+
+/* The export sends the sectors of the data log as they are stored in the flash (compact frames, see datalog_codec.h), the
+ * host decodes them. Data logging continues while the log is exported.
+ *
+ * Frame layout (all values little endian), the same as the binary provisioning:
+ *
+ *   0xA5 0x5A | type (1) | sequence (2) | payload length (2) | payload | CRC32 (4)
+ *
+ * The CRC32 (IEEE) covers type, sequence, payload length and payload. Bytes in front of the sync bytes are ignored (shell
+ * output). The sequence number counts the frames of an export starting with 0 at the INFO frame.
+ *
+ * Device to host:
+ *   INFO   (0x11): format version (1), first sector (4), end sector (4), oldest frame (4), next frame (4). The sectors from
+ *                  first sector up to end sector (excluded) are sent, sectors which were not written are left out. The newest
+ *                  sector is not sent while frames are still logged into it, end sector is this sector then.
+ *   DATA   (0x12): sector number (4), offset in the sector (2), data. The erased end of a sector is not sent.
+ *   SECTOR (0x13): sector number (4), length (2). The sector was sent completely and was not overwritten meanwhile, only
+ *                  sectors with this frame are valid.
+ *   END    (0x14): next sector (4). Sector to resume with to get the newest sector and the frames which were logged during
+ *                  the export.
+ *
+ * There is no acknowledge, the log is sent at the speed of the uart. When a frame is missing or its CRC is wrong, the host
+ * starts the export again with the sector it did not receive completely (datalog export <sector>).
+ *
+ * The shell is bypassed during the export (no echo, prompt or commands). Only "datalog export <sector>" lines, to start again,
+ * and "datalog export" or Ctrl-C, to stop, are accepted until the END frame.
+ */
+#define DATALOG_EXPORT_SYNC_1 0xA5
+#define DATALOG_EXPORT_SYNC_2 0x5A
+#define DATALOG_EXPORT_HEADER_LENGTH 5       // type, sequence, payload length
+#define DATALOG_EXPORT_BLOCK_SIZE 1024       // Byte, data of one DATA frame (read from flash at once)
+#define DATALOG_EXPORT_DATA_HEADER_LENGTH 6  // sector number, offset
+#define DATALOG_EXPORT_MAX_PAYLOAD (DATALOG_EXPORT_DATA_HEADER_LENGTH + DATALOG_EXPORT_BLOCK_SIZE)
+
+#define DATALOG_EXPORT_FRAME_INFO 0x11
+#define DATALOG_EXPORT_FRAME_DATA 0x12
+#define DATALOG_EXPORT_FRAME_SECTOR 0x13
+#define DATALOG_EXPORT_FRAME_END 0x14
+
+#define DATALOG_EXPORT_COMMAND "datalog export" // Command of the receiver, accepted while the shell is bypassed
+#define DATALOG_EXPORT_CTRL_C 0x03
+
+extern bool datalog_ExportActive;
+
+extern void datalog_ExportStart(const struct shell *shell, uint32_t sector);
+extern void datalog_ExportStop(void);
+extern void datalog_Export(void);
+
+#endif
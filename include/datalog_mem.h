@@ -17,41 +17,20 @@
 #include "rfid.h"
 #include "rtc.h"
 #include "algorithms.h"
+#include "epc.h"
+#include "datalog_codec.h"
 
 #define DATALOG_MEM 0x0000000UL      // Start address of memory region
 #define DATALOG_MEM_LENGTH 0x7FFFFFUL // for 3-byte addressing it is 0xFFFFFFUL, in 4-byte addressing 0x1FFFFFFUL   // Lengts of memory region (multiples of 64kB sector size)
-#define DATALOG_FRAME_LENGTH 128UL   // In bytes - must be a value of power of 2  (2^n)
+#define DATALOG_WRITE_BUFFER_COUNT 8 // Number of frames which can be queued for the flash service thread
 
-/* Dataframe to store in external log. Frame length of 2^n (256 byte in this case) is mandatory
- * to avoid memory leaks in the external flash memory.
+/* The log is a ring buffer of 4kB sectors with compact frames (see datalog_codec.h). The sector number and the frame number
+ * count on when the log wraps, sector n is stored at n % DATALOG_SECTOR_COUNT. When a sector is started, the following sector
+ * is erased, so there is always an erased sector in front of the newest frame. At boot the newest sector is found with a binary
+ * search over the sector headers.
  */
-typedef union
-{
-    uint8_t logging_frame[DATALOG_FRAME_LENGTH];
-
-    struct __attribute__((packed))
-    {
-        uint32_t FrameNumber;        /* 4 byte */
-        uint32_t unixtime;           /* 4 byte */
-        uint16_t millisec;           /* 2 byte */
-        uint8_t rfid_record_hex[21]; /* 21 bytes */
-        uint8_t rfid_record_type;    /* 1 byte */
-        int16_t raw_sens_value[9];   /* 18 bytes */
-        float floor_handle_angle;    /* 4 byte */
-        float frame_handle_angle;    /* 4 byte */
-        float Mopping_speed;         /* 4 byte */
-        float Coverage_per_Mop;      /* 4 byte */
-        uint16_t Mop_cycles;         /* 2 bytes */
-        uint8_t Mopping_pattern;     /* 1 byte */
-        uint8_t Motion_state;        /* 1 byte */
-        uint16_t Total_Steps;        /* 2 bytes */
-        uint16_t Battery_voltage;    /* 2 bytes */
-        uint16_t ChargeCycle;        /* 2 byte */
-        uint16_t Input_status;       /* 2 bytes */
-        uint16_t Output_status;      /* 2 bytes */
-        uint8_t Error_status;        /* 1 byte */
-    };
-} LOGFRAME;
+#define DATALOG_SECTOR_COUNT ((DATALOG_MEM_LENGTH + 1) / FLASH_SUBSUBSECTOR_SIZE)  // Erase sectors of the ring buffer
+#define DATALOG_FRAME_ERASED 0xFFFFFFFFUL                                          // FirstFrameNumber of an erased sector
 
 extern LOGFRAME DataFrame;
 
@@ -59,11 +38,16 @@ extern void datalog_StoreFrame(void);
 extern void datalog_GetData(void);
 extern void datalog_CleardatalogAll(void);
 extern uint32_t datalog_GetLastFrameNumber(const uint8_t cs_pin);
+extern bool datalog_ReadSectorHeader(const uint8_t cs_pin, uint32_t sector, DATALOG_SECTOR_HEADER *header);
+extern void datalog_ResetPosition(void);
+extern void datalog_GetSectorRange(uint32_t *oldest_sector, uint32_t *next_sector, uint32_t *head_length);
 
 extern uint8_t datalog_EnableFlag;
 extern uint8_t datalog_MemoryFull;
 extern uint8_t datalog_EraseActive;
 extern uint8_t setaddress_flag;
 extern uint8_t datalog_ReadOutisActive;
+extern uint32_t datalog_OldestFrameNumber;
+extern uint32_t flash_logaddress_write;
 
 #endif
@@ -0,0 +1,149 @@
+/**
+ * @file epc.h
+ * @author Thomas Keilbach | keiltronic GmbH
+ * @date 17 Oct 2026
+ * @brief This file contains the binary epc type which is used in the whole tag pipeline and its helper functions
+ * @version 2.0.0
+ */
+
+#ifndef EPC_H
+#define EPC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* The trimmed epc from the RFID reader (up to 128 bit) is right aligned in 20 bytes, the leading bytes are zero. This is the
+ * same layout the rfid records in the external flash are stored with.
+ */
+#define EPC_BINARY_LENGTH 20                             // Byte
+#define EPC_HEX_STRING_LENGTH ((2 * EPC_BINARY_LENGTH) + 1) // Hex digits including termination
+
+typedef struct
+{
+  uint8_t bytes[EPC_BINARY_LENGTH];
+} EPC_BINARY;
+
+static inline void EPC_Clear(EPC_BINARY *epc)
+{
+  memset(epc->bytes, 0, EPC_BINARY_LENGTH);
+}
+
+static inline bool EPC_IsZero(const EPC_BINARY *epc)
+{
+  uint8_t i = 0;
+  uint8_t sum = 0;
+
+  for (i = 0; i < EPC_BINARY_LENGTH; i++)
+  {
+    sum |= epc->bytes[i];
+  }
+
+  return (sum == 0);
+}
+
+static inline int EPC_Compare(const EPC_BINARY *a, const EPC_BINARY *b)
+{
+  return memcmp(a->bytes, b->bytes, EPC_BINARY_LENGTH);
+}
+
+static inline bool EPC_Equal(const EPC_BINARY *a, const EPC_BINARY *b)
+{
+  return (memcmp(a->bytes, b->bytes, EPC_BINARY_LENGTH) == 0);
+}
+
+/* 32-bit FNV-1a hash of the epc */
+static inline uint32_t EPC_Hash(const EPC_BINARY *epc)
+{
+  uint32_t hash = 2166136261UL;
+  uint8_t i = 0;
+
+  for (i = 0; i < EPC_BINARY_LENGTH; i++)
+  {
+    hash ^= epc->bytes[i];
+    hash *= 16777619UL;
+  }
+
+  return hash;
+}
+
+/* Returns the value of one hex digit or -1 if the character is no hex digit */
+static inline int8_t EPC_HexDigitValue(char c)
+{
+  if ((c >= '0') && (c <= '9'))
+  {
+    return c - '0';
+  }
+  if ((c >= 'A') && (c <= 'F'))
+  {
+    return c - 'A' + 10;
+  }
+  if ((c >= 'a') && (c <= 'f'))
+  {
+    return c - 'a' + 10;
+  }
+  return -1;
+}
+
+/*!
+ * @brief This function converts a hex string (e.g. 3000E280689400004003A1F5) to a binary epc. The string is right aligned,
+ * missing leading digits are zero. Used at the boundaries where epcs arrive as text (RFID reader, shell).
+ * @param string: Pointer to the hex digits, no termination needed
+ * @param length: Number of hex digits
+ * @param epc: Pointer to the resulting epc
+ * @return bool: false if the string is too long or contains a character which is no hex digit
+ */
+static inline bool EPC_FromHexString(const char *string, uint16_t length, EPC_BINARY *epc)
+{
+  uint16_t i = 0;
+  uint16_t nibble = 0;
+  int8_t value = 0;
+
+  EPC_Clear(epc);
+
+  if (length > (2 * EPC_BINARY_LENGTH))
+  {
+    return false;
+  }
+
+  /* Nibble position of the first digit, counted from the most significant nibble */
+  nibble = (2 * EPC_BINARY_LENGTH) - length;
+
+  for (i = 0; i < length; i++, nibble++)
+  {
+    value = EPC_HexDigitValue(string[i]);
+
+    if (value < 0)
+    {
+      EPC_Clear(epc);
+      return false;
+    }
+
+    epc->bytes[nibble / 2] |= (nibble % 2) ? value : (value << 4);
+  }
+
+  return true;
+}
+
+/*!
+ * @brief This function converts a binary epc to a terminated hex string. Used only to print epcs on the shell.
+ * @param epc: Pointer to the epc
+ * @param string: Pointer to a buffer of at least EPC_HEX_STRING_LENGTH characters
+ * @return char*: The string buffer, so the function can be used as printf argument
+ */
+static inline char *EPC_ToHexString(const EPC_BINARY *epc, char *string)
+{
+  static const char hex[] = "0123456789ABCDEF";
+  uint8_t i = 0;
+
+  for (i = 0; i < EPC_BINARY_LENGTH; i++)
+  {
+    string[(2 * i)] = hex[epc->bytes[i] >> 4];
+    string[(2 * i) + 1] = hex[epc->bytes[i] & 0x0F];
+  }
+  string[2 * EPC_BINARY_LENGTH] = 0;
+
+  return string;
+}
+
+#endif
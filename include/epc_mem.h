@@ -16,11 +16,16 @@
 #include "algorithms.h"
 #include "cloud.h"
 #include "system_mem.h"
+#include "epc.h"
+#include <zephyr/sys/crc.h>
 
 /* RFID record database settings */
 #define RFID_RECORD_REGION 0x20000UL        // Start address of memory region
 #define RFID_RECORD_REGION_LENGTH 0x2FFFFUL // Up to 5000  -> Total: 32 byte * 5000 = 160.000 byte
 #define RFID_RECORD_BYTE_LENGTH 32          // In byte, must be a value of power of 2  (2^n)
+#define RFID_RECORD_MAX_COUNT 5000         // Maximum number of rfid records, the region has room for 6144
+#define EPC_INDEX_MAX_RECORDS RFID_RECORD_MAX_COUNT // Records which fit into the RAM index
+#define EPC_INDEX_BUILD_BLOCK_RECORDS 32    // Records which are read at once while building the RAM index
 
 /* ROOM record database settings */
 #define ROOM_RECORD_REGION 0x50000UL        // Start address of memory region
@@ -33,12 +38,20 @@
 #define MOP_RECORD_BYTE_LENGTH 8           // In byte, must be a value of power of 2  (2^n)
 #define ADVANCED_MOP_RECORD_BYTE_LENGTH 16 // In byte, must be a value of power of 2  (2^n)
 
+/* Database banks. The rfid, room and mop regions above are bank 0, bank 1 is a shadow copy behind them. A DataUpdate is written
+ * into the inactive bank and activated by writing its header with the next generation number. The valid header with the highest
+ * generation selects the active bank at boot, without any header bank 0 is used (databases written by shell commands). */
+#define EPC_DATABASE_BANK_COUNT 2
+#define EPC_DATABASE_BANK_OFFSET 0x60000UL     // Distance of the bank 1 regions to the bank 0 regions
+#define EPC_DATABASE_HEADER_REGION 0xE0000UL   // One 4kB sector per bank with the bank header
+#define EPC_DATABASE_MAGIC 0x42445045UL        // "EPDB"
+#define EPC_DATABASE_UUID_LENGTH 16
+
 /* EPC string settings */
 #define EPC_RING_BUFFER_SIZE 64
 #define EPC_LENGTH_MIN 32
 #define EPC_LENGTH_MAX 41
 #define EPC_STRING_LENGTH 41
-#define EPC_TOTAL_HEX_LENGTH 20
 #define EPC_LAST_SEEN_COUNT 20
 #define ROOM_TO_MOP_MAP_BYTE_LENGTH 42
 #define LAST_SEEN_AUTO_RESET_TIME 60000 // millisec
@@ -53,12 +66,6 @@
 
 #define MAX_MOP_PER_SHIFT 60
 
-/* EPC raw data which comes from RFID reader module over UART*/
-typedef union
-{
-  char string[EPC_STRING_LENGTH];
-} EPC_TAG;
-
 /* Return structure for binary search result */
 typedef struct
 {
@@ -67,6 +74,55 @@ typedef struct
   uint8_t found;
 } EPC_BINARY_SERACH_RESULT;
 
+/* Entry of the RAM index of the rfid record database */
+typedef struct __attribute__((packed))
+{
+  uint32_t hash;         // Hash of the binary epc
+  uint16_t record_index; // Index of the record in the rfid record database
+} EPC_INDEX_ENTRY;
+
+/* Tables of the epc database, in the order of their regions */
+typedef enum
+{
+  EPC_TABLE_RFID = 0,
+  EPC_TABLE_ROOM,
+  EPC_TABLE_MOP,
+  EPC_TABLE_COUNT
+} EPC_TABLE;
+
+/* Header of a database bank, written after all tables of the bank were written and verified */
+typedef struct __attribute__((packed))
+{
+  uint32_t magic;
+  uint32_t generation;
+  uint16_t record_count[EPC_TABLE_COUNT]; // Rfid records are stored sorted by epc, room and mop records at the index of their id
+  uint8_t uuid_length;
+  uint8_t uuid[EPC_DATABASE_UUID_LENGTH]; // uuid of the DataUpdate which created the bank
+  uint8_t reserved;
+  uint32_t crc;                           // CRC32 of the header without this field
+} EPC_DATABASE_HEADER;
+
+/* Location of a table in bank 0 */
+typedef struct
+{
+  uint32_t region;
+  uint32_t region_length;
+  uint16_t record_length;
+  const char *name;
+} EPC_TABLE_DESCRIPTOR;
+
+/* New content of the databases. Records have the flash layout, a table without records is taken over from the active bank. */
+typedef struct
+{
+  struct
+  {
+    uint8_t *records;
+    uint32_t length;  // Bytes
+  } table[EPC_TABLE_COUNT];
+  const uint8_t *uuid;
+  uint32_t uuid_length;
+} EPC_DATABASE_UPDATE;
+
 /* RFID objects for cloud */
 typedef union
 {
@@ -74,7 +130,8 @@ typedef union
 
   struct __attribute__((packed))
   {
-    uint8_t epc[EPC_TOTAL_HEX_LENGTH + 1];
+    EPC_BINARY epc;
+    uint8_t reserved; // Keeps the layout of the records in flash
     uint8_t type;
     uint16_t id;
   };
@@ -133,26 +190,26 @@ typedef union
     uint16_t mop_linked_room_id;
     uint16_t current_mop_id;
     uint16_t previous_mop_id;
-    uint8_t current_mop_epc[EPC_TOTAL_HEX_LENGTH];
+    EPC_BINARY current_mop_epc;
     time_t timestamp;
   };
 } ROOM_TO_MOP_MAP;
 
-/* EPC raw data which comes from RFID reader module over UART*/
+/* Last seen tag which came from RFID reader module over UART */
 typedef union
 {
-  uint8_t epc_frame[EPC_STRING_LENGTH + sizeof(int64_t) + sizeof(uint32_t)]; // Total size is EPC frame length + 8 byte for timestamp + 4 byte for counts
+  uint8_t epc_frame[EPC_BINARY_LENGTH + sizeof(int64_t) + sizeof(uint32_t)]; // Total size is binary epc length + 8 byte for timestamp + 4 byte for counts
 
   struct __attribute__((packed))
   {
-    EPC_TAG record;
+    EPC_BINARY epc;
     int64_t timestamp;
     uint32_t counts;
   };
 } LAST_SEEN_TAG;
 
 extern LAST_SEEN_TAG EPC_last_seen_records[EPC_LAST_SEEN_COUNT];
-extern EPC_TAG epc_ring_buffer[EPC_RING_BUFFER_SIZE];
+extern EPC_BINARY epc_ring_buffer[EPC_RING_BUFFER_SIZE];
 extern ROOM_RECORD current_room_record;
 extern MOP_RECORD current_mop_record;
 extern ADVANCED_MOP_RECORD new_advanced_mop_record;
@@ -163,10 +220,10 @@ extern uint8_t room_detected;
 extern ROOM_RECORD current_room_record;
 extern MOP_RECORD current_mop_record;
 extern ADVANCED_MOP_RECORD last_seen_mop_records_array[MAX_MOP_PER_SHIFT];
-extern char Currentmop_RFID[EPC_TOTAL_HEX_LENGTH];
-extern char Newmop_RFID[EPC_TOTAL_HEX_LENGTH];
+extern EPC_BINARY Currentmop_RFID;
+extern EPC_BINARY Newmop_RFID;
 
-extern char current_mop_epc[EPC_TOTAL_HEX_LENGTH];
+extern const EPC_TABLE_DESCRIPTOR EPC_database_tables[EPC_TABLE_COUNT];
 extern uint8_t epc_next_tag;
 extern uint32_t epc_head_position;
 extern uint32_t epc_tail_position;
@@ -178,24 +235,25 @@ extern uint16_t EPC_last_room_record_index;
 extern uint16_t EPC_last_mop_record_index;
 extern uint32_t last_seen_array_auto_clear_timer;
 extern uint8_t mop_installed;
-extern char current_mob_string_reading[EPC_TOTAL_HEX_LENGTH + 1];
+extern EPC_BINARY current_mop_epc_reading;
 extern uint8_t last_seen_mop_count;
 extern uint32_t last_seen_mop_auto_clear_timer;
 extern uint32_t last_seen_mop_id;
 
 extern void epc_process_tags(void);
+extern void epc_signal_new_tags(void);
+extern bool epc_tags_pending(void);
+extern struct k_sem epc_new_tags_sem;
 extern void epc_mem_init(void);
 extern void EPC_Sort_last_seen(void);
-extern void EPC_Update_last_seen(char *epc_new_rfid_record);
+extern void EPC_Update_last_seen(const EPC_BINARY *epc);
 extern void EPC_Clear_last_seen(void);
-extern void EPC_AddItemToFlash(uint8_t cs_pin, EPC_TAG *tag);
-extern void EPC_DeleteListAtFlash(uint8_t cs_pin);
-extern EPC_TAG EPC_ReadItemAtFlash(uint8_t cs_pin, uint16_t epc_index);
-extern uint16_t EPC_GetLastEPCIndexAtFlash(uint8_t cs_pin);
 extern EPC_BINARY_SERACH_RESULT EPC_BinarySearch(uint8_t cs_pin, char *epc_value_to_find, uint16_t epc_list_length);
-extern void SerializeCharToHex(char *source, uint8_t *dest, uint16_t len);
-extern void PrintDeserializeHexToChar(uint8_t *source, uint16_t len);
-extern const char *DeserializeHexToChar(uint8_t *source, uint16_t len);
+extern void EPC_Index_Build(uint8_t cs_pin, uint16_t record_count);
+extern void EPC_Index_Add(RFID_RECORD *record, uint16_t record_index);
+extern void EPC_Index_Clear(void);
+extern EPC_BINARY_SERACH_RESULT EPC_Index_Lookup(uint8_t cs_pin, const EPC_BINARY *epc, RFID_RECORD *record);
+extern void EPC_PrintHexString(const EPC_BINARY *epc);
 extern void EPC_Memory_Delete_All_Records(const uint8_t cs_pin, const uint32_t memory, const uint32_t len);
 extern void EPC_Memory_Write_RFID_Record(uint8_t cs_pin, RFID_RECORD *record, uint32_t index);
 extern void EPC_Memory_Write_Room_Record(uint8_t cs_pin, ROOM_RECORD *record, uint32_t index);
@@ -205,7 +263,17 @@ extern void EPC_Memory_Read_RFID_Record_fast(uint8_t cs_pin, RFID_RECORD *record
 extern void EPC_Memory_Read_Room_Record(uint8_t cs_pin, ROOM_RECORD *record, uint32_t index);
 extern void EPC_Memory_Read_Mop_Record(uint8_t cs_pin, MOP_RECORD *record, uint32_t index);
 extern uint16_t EPC_Memory_GetLastIndex(uint8_t cs_pin, uint32_t memory, uint32_t len, uint16_t frame_len);
-extern uint8_t update_last_seen_room_id_array(uint8_t *room_wall_epc, uint8_t type, uint32_t id, uint16_t length);
+extern void EPC_Database_Init(uint8_t cs_pin);
+extern void EPC_Database_BeginUpdate(uint8_t cs_pin);
+extern uint32_t EPC_Database_GetActiveAddress(EPC_TABLE table);
+extern uint32_t EPC_Database_GetTargetAddress(EPC_TABLE table);
+extern int EPC_Database_CompareRfidRecord(const void *a, const void *b);
+extern int EPC_Database_CompareId(const void *a, const void *b);
+extern int16_t EPC_Database_FinishTable(uint8_t cs_pin, EPC_TABLE table, int32_t count, uint32_t crc);
+extern int16_t EPC_Database_CommitUpdate(uint8_t cs_pin, const uint8_t *uuid, uint32_t uuid_length);
+extern int16_t EPC_Database_ApplyUpdate(uint8_t cs_pin, EPC_DATABASE_UPDATE *update);
+extern const EPC_DATABASE_HEADER *EPC_Database_GetHeader(uint8_t *bank);
+extern uint8_t update_last_seen_room_id_array(const EPC_BINARY *room_wall_epc, uint8_t type, uint32_t id, uint16_t length);
 extern void clear_last_seen_room_id_array(uint16_t length);
 extern void PrintLastSeenLocationRecords(void);
 extern void reset_room_to_mop_mapping(void);
@@ -220,7 +288,7 @@ extern uint8_t Mop_CheckIDInLastSeenArray(ADVANCED_MOP_RECORD current_mop);
 extern uint8_t room_to_mop_linkage(void);
 extern void list_last_seen_location_record_array(void);
 extern void clear_last_seen_location_record_array(void);
-extern uint16_t check_or_add_location_record_in_array(uint8_t *location_epc, uint8_t epc_len);
-extern void epc_extract_tags_from_buffer(void);
+extern uint16_t check_or_add_location_record_in_array(const EPC_BINARY *location_epc);
+extern void epc_store_tag(const char *epc_hex, uint8_t length, int16_t rssi);
 extern void bubblesort(LAST_SEEN_TAG array[], uint16_t length);
 #endif
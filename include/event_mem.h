@@ -9,6 +9,7 @@
 #ifndef EVENT_MEM_H
 #define EVENT_MEM_H
 
+#include <zephyr/sys/crc.h>
 #include "protobuf-c.h"
 #include "flash.h"
 #include "cloud.h"
@@ -18,18 +19,57 @@
 #define EVENT_MEM_LENGTH 0x7FFFFFUL // for 3-byte addressing it is 0xFFFFFFUL, in 4-byte addressing 0x1FFFFFFUL   // Lengts of memory region (multiples of 64kB sector size)
 #define EVENT_MAX_OUTSOURCED_MESSAGES 500
 
+/* The event memory is a log structured journal. Each packed event array is one record which starts at a sector boundary with
+ * this header, followed by the protobuf payload. The journal wraps around at the end of the event memory.
+ */
+#define EVENT_JOURNAL_SECTOR_SIZE FLASH_SUBSUBSECTOR_SIZE
+#define EVENT_JOURNAL_SIZE (EVENT_MEM_LENGTH + 1)   // Byte
+#define EVENT_JOURNAL_MAGIC 0x4A564545UL            // "EEVJ"
+#define EVENT_JOURNAL_ACK_PENDING 0xFFFFFFFFUL      // Erased state, record was not confirmed by the cloud yet
+#define EVENT_JOURNAL_ACK_DONE 0x00000000UL         // Record was sent to the cloud
+#define EVENT_JOURNAL_CRC_CHUNK_SIZE 256            // Byte, read buffer for the CRC check at boot
+
+typedef struct __attribute__((packed))
+{
+    uint32_t magic;
+    uint32_t sequence; // Increases with every record, used to restore the order at boot
+    uint32_t length;   // Length of the payload
+    uint32_t crc;      // CRC32 (IEEE) of the payload
+    uint32_t ack;      // EVENT_JOURNAL_ACK_PENDING or EVENT_JOURNAL_ACK_DONE
+} EVENT_JOURNAL_HEADER;
+
 typedef struct __attribute__((packed))
 {
-    uint32_t start_address;
-    uint32_t length;
+    uint32_t start_address; // Offset of the journal record in the event memory
+    uint32_t length;        // Length of the payload
+    uint32_t sequence;
 } EVENT_LIST_OF_OUTSOURCED_MESSAGES;
 
+typedef struct
+{
+    uint32_t spilled_segments;   // Packed event arrays written to the external flash
+    uint32_t spilled_events;     // Events in these segments
+    uint32_t sent_segments;      // Segments sent to the cloud and removed from the list
+    uint32_t recovered_segments; // Unsent journal records found at boot
+    uint32_t lost_list_full;     // Events lost because the list of outsourced messages was full
+    uint32_t lost_flash_full;    // Events lost because the event memory was full
+    uint32_t lost_pack_error;    // Events lost because the event array could not be packed
+    uint32_t lost_corrupt;       // Journal records with a wrong CRC found at boot
+    uint32_t lost_spill_pending; // Events lost because the full event array was not spilled yet
+} EVENT_QUEUE_STATISTICS;
+
+struct coap_payload_source; // Defined in coap.h, which includes this header indirectly
+
 extern void Event_ClearCompleteFlash(void);
-extern void Event_StorePackedUsageObjectToFlash(void);
-extern uint8_t Event_ReadFromFlash(uint32_t address, uint32_t length, uint8_t **buf);
+extern void Event_AcknowledgeOutsourcedMessages(uint32_t count);
+extern void Event_JournalRecover(void);
+extern bool Event_StorePackedUsageObjectToFlash(void);
+extern void Event_GetPayloadSource(const EVENT_LIST_OF_OUTSOURCED_MESSAGES *message, struct coap_payload_source *source);
 extern uint8_t event_clearing_in_progress;
 
 extern EVENT_LIST_OF_OUTSOURCED_MESSAGES Event_ListOfOutsourcedMessages[EVENT_MAX_OUTSOURCED_MESSAGES];
 extern uint32_t Event_NumberOfOutsourcedMessages;
+extern uint32_t Event_flash_write_head;
+extern EVENT_QUEUE_STATISTICS Event_QueueStatistics;
 
 #endif
\ No newline at end of file
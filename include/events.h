@@ -18,17 +18,93 @@
 #include "notification.h"
 #include "cloud.h"
 #include "epc_mem.h"
+#include "epc.h"
 #include "event_mem.h"
 
 #define EVENT_MAX_ITEMS_IN_ARRAY 100
+#define EVENT_POOL_SIZE (EVENT_MAX_ITEMS_IN_ARRAY + 1) // One spare block for the event which is created while the array is full
+
+/* Common first fields of all Event0xXX messages */
+typedef struct
+{
+  ProtobufCMessage base;
+  uint32_t event_id;
+  int64_t event_timestamp;
+} EVENT_PAYLOAD_HEADER;
+
+/* One pool block holds the GenericEvent and its payload, so every event needs exactly one allocation */
+typedef struct
+{
+  GenericEvent generic;
+  uint64_t filter_key; // Compared by Event_filter() for events with EVENT_POLICY_UNIQUE, not uploaded
+  union
+  {
+    EVENT_PAYLOAD_HEADER header;
+    Event0x01 event0x01;
+    Event0x02 event0x02;
+    Event0x04 event0x04;
+    Event0x05 event0x05;
+    Event0x06 event0x06;
+    Event0x07 event0x07;
+    Event0x09 event0x09;
+    Event0x0B event0x0b;
+    Event0x0C event0x0c;
+    Event0x0D event0x0d;
+    Event0x0F event0x0f;
+    Event0x10 event0x10;
+    Event0x11 event0x11;
+    Event0x12 event0x12;
+    Event0x13 event0x13;
+    Event0x17 event0x17;
+    Event0x18 event0x18;
+    Event0x19 event0x19;
+    Event0x1A event0x1a;
+    Event0x1B event0x1b;
+    Event0x1C event0x1c;
+    Event0xFF event0xff;
+  } payload;
+} EVENT_OBJECT;
+
+#define EVENT_FILTER_KEY(room_id, mop_id) (((uint64_t)(room_id) << 32) | (mop_id))
+
+#define EVENT_POLICY_NONE 0
+#define EVENT_POLICY_NOTIFY BIT(0) // Event triggers the user notification from the ActionMatrix
+#define EVENT_POLICY_UNIQUE BIT(1) // Event is discarded if the same event with the same filter key is already in the event array
+
+/* Registry entry of one event type */
+typedef struct
+{
+  uint8_t id;                                                           // Event id, also index in the ActionMatrix
+  GenericEvent__OneOfGenericEventCase generic_case;                     // Oneof case in the GenericEvent
+  const ProtobufCMessageDescriptor *message;                            // Payload layout, used to init and to encode the payload
+  const char *name;                                                     // Description for the shell
+  uint8_t policy;                                                       // EVENT_POLICY_xxx
+  void (*details)(const EVENT_OBJECT *object, char *text, size_t size); // Optional, appends payload fields to the verbose output
+} EVENT_DESCRIPTOR;
+
+typedef struct
+{
+  uint32_t allocations;        // Successful allocations since boot
+  uint32_t allocation_failures; // Events which got lost because the pool was empty
+  uint32_t max_used;            // High water mark of blocks in use
+} EVENT_POOL_STATISTICS;
 
 extern EventArray__EventArrayEntry my_event_array_entries[EVENT_MAX_ITEMS_IN_ARRAY];
 extern EventArray myEventArray;
 extern ProtobufCBinaryData binary_data;
-extern uint8_t current_location_epc_string[20];
+extern uint8_t current_location_epc_string[EPC_BINARY_LENGTH];
 extern uint32_t Event_ItemsInArray;
 extern bool event_simulation_in_progress;
 extern uint16_t event1statistics_interval_timer;
+extern EVENT_POOL_STATISTICS Event_PoolStatistics;
+extern struct k_mutex event_mutex; // Guards the event array and the list of outsourced messages (event_mem.c), can be nested in one thread
+
+/* Event pool functions */
+extern EVENT_OBJECT *Event_Alloc(void);
+extern void Event_Free(GenericEvent *event);
+extern uint32_t Event_PoolUsed(void);
+
+extern const EVENT_DESCRIPTOR *Event_GetDescriptor(uint8_t id);
 
 /* Event array function*/
 extern void Event_ClearArray(void);
@@ -0,0 +1,111 @@
+/**
+ * @file fastmath.h
+ * @author Thomas Keilbach | keiltronic GmbH
+ * @date 17 Oct 2026
+ * @brief This file contains single precision math functions for the motion algorithm. The FPU of the Cortex-M33 only
+ * supports single precision, every double operation is emulated in software.
+ * @version 1.0.0
+ */
+
+#ifndef FASTMATH_H
+#define FASTMATH_H
+
+#include <stdint.h>
+#include <math.h>
+
+#define FMATH_PI 3.14159265f
+#define FMATH_HALF_PI 1.57079633f
+#define FMATH_RAD_TO_DEG (180.0f / FMATH_PI)
+
+static inline float fmath_Square(float x)
+{
+  return x * x;
+}
+
+static inline float fmath_Norm2(float x, float y)
+{
+  return sqrtf((x * x) + (y * y));
+}
+
+static inline float fmath_Norm3(float x, float y, float z)
+{
+  return sqrtf((x * x) + (y * y) + (z * z));
+}
+
+/*!
+ * @brief Dot product of two float vectors. The loop has no dependencies between the iterations except the sum, so the
+ * compiler can unroll it and keep everything in FPU registers.
+ */
+static inline float fmath_Dot(const float *a, const float *b, uint16_t length)
+{
+  float sum = 0.0f;
+  uint16_t i = 0;
+
+  for (i = 0; i < length; i++)
+  {
+    sum += a[i] * b[i];
+  }
+
+  return sum;
+}
+
+/*!
+ * @brief Euclidean norm of a float vector
+ */
+static inline float fmath_Norm(const float *a, uint16_t length)
+{
+  return sqrtf(fmath_Dot(a, a, length));
+}
+
+/*!
+ * @brief Fast single precision atan2. The argument is reduced to [0, 1] and atan is approximated with the polynomial
+ * from Abramowitz and Stegun 4.4.49, the absolute error is below 2e-5 rad (0.001 degree) over the whole range.
+ * @param y: y coordinate
+ * @param x: x coordinate
+ * @return float: Angle in rad (-PI to PI), 0 for x = y = 0
+ */
+static inline float fmath_Atan2(float y, float x)
+{
+  float abs_x = fabsf(x);
+  float abs_y = fabsf(y);
+  float z = 0.0f;
+  float z2 = 0.0f;
+  float angle = 0.0f;
+
+  if ((abs_x == 0.0f) && (abs_y == 0.0f))
+  {
+    return 0.0f;
+  }
+
+  /* atan(y/x) = PI/2 - atan(x/y), so only ratios up to 1 are needed */
+  if (abs_x >= abs_y)
+  {
+    z = abs_y / abs_x;
+  }
+  else
+  {
+    z = abs_x / abs_y;
+  }
+
+  z2 = z * z;
+  angle = z * (0.9998660f + z2 * (-0.3302995f + z2 * (0.1801410f + z2 * (-0.0851330f + z2 * 0.0208351f))));
+
+  if (abs_y > abs_x)
+  {
+    angle = FMATH_HALF_PI - angle;
+  }
+
+  if (x < 0.0f)
+  {
+    angle = FMATH_PI - angle;
+  }
+
+  if (y < 0.0f)
+  {
+    angle = -angle;
+  }
+
+  return angle;
+}
+
+#endif
@@ -27,7 +27,13 @@
 #define DUMMY_BYTE                0x00
 
 #define SAMPLE_LENGTH             32
-#define SPI_MAX_BLOCK_LENGTH      1 // byte
+#define FLASH_PAGE_SIZE           256UL // Byte, a page program must not cross this boundary
+#define FLASH_3BYTE_ADDRESS_LIMIT 0x1000000UL // Byte, 16MB are reachable with 3 address bytes
+#define FLASH_READ_CMD_MAX_FREQUENCY 50000000UL // Hz, above this clock the FAST READ command has to be used
+#define FLASH_FAST_READ_DUMMY_CYCLES 8 // Default dummy cycles of FAST READ in extended SPI mode
+#define FLASH_MAX_DUMMY_BYTES     2
+#define FLASH_BUSY_POLL_INTERVAL_US 50 // Pause between two status register reads while the flash is busy
+#define FLASH_REQUEST_QUEUE_SIZE  16 // Number of requests per priority which can be queued for the flash service thread
 
 /* Register definition */
 #define FLASH_RDID                0x9E
@@ -94,9 +100,75 @@
 #define FLASH_BP3_BIT_MASK        0x07
 #define FLASH_SRWD_BIT_MASK       0x08
 #define FLASH_JEDEC               0x9F
+#define FLASH_PP4BYTE             0x12   // 4-byte address page program
+#define FLASH_SSE_4KB_4BYTE       0x21   // 4-byte address 4kB sub sector erase
+#define FLASH_SSE_32KB_4BYTE      0x5C   // 4-byte address 32kB sub sector erase
+#define FLASH_SE_64KB_4BYTE       0xDC   // 4-byte address 64kB sector erase
+
+/* Identification of a known flash part (JEDEC id) */
+typedef struct
+{
+  uint8_t manufacturer_id;
+  uint8_t memory_type;
+  uint8_t capacity_id;
+  uint32_t size; // Byte
+  const char *name;
+} FLASH_PART;
+
+/* Op codes and address width which are used to access one flash part */
+typedef struct
+{
+  const FLASH_PART *part; // NULL if the part is unknown
+  uint8_t address_bytes;
+  uint8_t read_cmd;
+  uint8_t read_dummy_bytes;
+  uint8_t program_cmd;
+  uint8_t erase_4kb_cmd;
+  uint8_t erase_32kb_cmd;
+  uint8_t erase_64kb_cmd;
+} FLASH_COMMAND_SET;
+
+/* Operations which can be queued for the flash service thread */
+typedef enum
+{
+  FLASH_REQUEST_READ,
+  FLASH_REQUEST_WRITE,
+  FLASH_REQUEST_ERASE_4KB,
+  FLASH_REQUEST_ERASE_32KB,
+  FLASH_REQUEST_ERASE_64KB,
+  FLASH_REQUEST_SYNC, // No operation, completes after all previously queued requests of the same priority
+} FLASH_REQUEST_TYPE;
+
+typedef enum
+{
+  FLASH_PRIORITY_HIGH,
+  FLASH_PRIORITY_NORMAL,
+} FLASH_REQUEST_PRIORITY;
+
+typedef struct flash_request FLASH_REQUEST;
+
+/* Called in the context of the flash service thread after the request was executed */
+typedef void (*flash_request_callback_t)(const FLASH_REQUEST *request, int result);
+
+struct flash_request
+{
+  FLASH_REQUEST_TYPE type;
+  uint8_t cs_pin;
+  uint32_t addr;
+  uint8_t *data; // Must stay valid until the request was completed
+  uint32_t len;
+  flash_request_callback_t callback; // Optional
+  void *user_data;                   // Optional, passed unchanged to the callback
+  struct k_sem *done;                // Optional, given after the request was completed
+  int *result;                       // Optional, receives the result before done is given
+};
 
 extern void flash_init(void);
-extern uint8_t flash_access(const struct device *spi, struct spi_config *spi_cfg, uint8_t cmd, uint32_t addr, uint8_t *data,uint32_t len);
+extern void flash_cs(uint8_t cs_pin, uint8_t state);
+extern uint8_t flash_DetectDevice(uint8_t cs_pin);
+extern void flash_ReadJedecId(uint8_t cs_pin, uint8_t *id);
+extern FLASH_COMMAND_SET *flash_GetCommandSet(uint8_t cs_pin);
+extern uint8_t flash_access(const struct device *spi, struct spi_config *spi_cfg, const FLASH_COMMAND_SET *command_set, uint8_t cmd, uint32_t addr, uint8_t *data,uint32_t len);
 extern uint8_t flash_access_register(const struct device *spi, struct spi_config *spi_cfg, uint8_t reg, uint8_t *data,uint32_t len);
 extern void flash_write(uint8_t cs_pin, uint32_t addr, uint8_t *data,uint32_t len);
 extern void flash_read(uint8_t cs_pin, uint32_t addr, uint8_t *data,uint32_t len);
@@ -107,6 +179,8 @@ extern uint8_t flash_TestAndClearBlock(const uint8_t cs_pin, const uint32_t addr
 extern uint8_t acces_write_reg(const uint8_t cs_pin, const struct device *spi, struct spi_config *spi_cfg, uint8_t reg, uint32_t addr);
 extern void flash_WriteRegister(uint8_t cs_pin, uint8_t reg, uint8_t data);
 extern void flash_WaitWhileBusy(uint8_t cs_pin);
+extern void flash_LockBusWhenReady(uint8_t cs_pin);
+extern void flash_UnlockBus(void);
 extern void flash_WriteEnable(uint8_t cs_pin);
 extern void flash_EraseAll(const uint8_t cs_pin);
 extern void flash_EraseSector_4kB(const uint8_t cs_pin, const uint32_t addr);
@@ -115,10 +189,16 @@ extern void flash_EraseSector_64kB(const uint8_t cs_pin, const uint32_t addr) ;
 extern void flash_ClearBlock_4kB(const uint8_t cs_pin, const uint32_t memory, const uint32_t length);
 extern void flash_ClearBlock_64kB(const uint8_t cs_pin, const uint32_t memory, const uint32_t length);
 extern void flash_ClearMemAll(uint8_t cs_pin, uint32_t memory, uint32_t length);
-extern uint32_t flash_GetLastFrameNumber(const uint8_t cs_pin, const uint32_t sub_sector_size, const uint32_t start_address, const uint32_t memory_length, const uint32_t frame_length);
 extern void flash_MemoryViewer(uint8_t cs_pin, uint32_t start_address, uint32_t length);
 extern uint8_t flash_CommunicationTest(uint8_t cs_pin);
 extern uint8_t flash_ValidateDataInMemory(uint8_t cs_pin, uint32_t offset, uint32_t addr, uint16_t accumulation_length, uint8_t clear_value);
+extern int flash_SubmitRequest(const FLASH_REQUEST *request, FLASH_REQUEST_PRIORITY priority);
+extern int flash_SubmitRequestAndWait(FLASH_REQUEST *request, FLASH_REQUEST_PRIORITY priority);
+extern void flash_WaitForPendingRequests(void);
+extern uint32_t flash_PendingRequests(FLASH_REQUEST_PRIORITY priority);
+extern void flash_ProcessRequests(void);
+
+extern uint32_t flash_request_queue_overflows;
 
 extern struct gpio_dt_spec chip_select_1;
 extern struct gpio_dt_spec chip_select_2;
@@ -23,7 +23,27 @@
 #include "led.h"
 #include "stepdetection.h"
 
-#define GRAVITY_EARTH 9.81
+#define GRAVITY_EARTH 9.81f
+
+/* The BMI160 fifo is read in header mode, a frame contains a one byte header followed by the aux (8 byte), gyro (6 byte)
+ * and accel (6 byte) data which were sampled at this moment. Accel and gyro run at 100Hz, the magnetometer at 50Hz.
+ */
+#define IMU_FIFO_BUFFER_SIZE 512        // Byte, size of one burst read (half of the 1024 byte sensor fifo)
+#define IMU_FIFO_WATERMARK 200          // Byte, fill level which triggers the watermark interrupt on INT2 (multiple of 4)
+#define IMU_FIFO_MAX_FRAMES (IMU_FIFO_BUFFER_SIZE / (1 + BMI160_FIFO_GA_LENGTH))
+#define IMU_FIFO_TIMEOUT_MS 500         // ms, the fifo is read at latest after this time if no watermark interrupt arrived
+#define IMU_SAMPLE_QUEUE_SIZE 64        // Samples
+#define IMU_SAMPLE_PERIOD_TICKS 256     // Sensor time ticks (39.0625us) between two samples at 100Hz output data rate
+#define IMU_SENSORTIME_MASK 0x00FFFFFF  // The sensor time is a 24 bit counter
+#define IMU_MS_TO_SENSORTIME(ms) (((uint32_t)(ms) * 128) / 5) // 1ms = 25.6 sensor time ticks
+
+typedef struct
+{
+  uint32_t sensortime; // Sensor time of the sample (24 bit, 39.0625us resolution)
+  struct bmi160_sensor_data accel;
+  struct bmi160_sensor_data gyro;
+  struct bmm150_mag_data mag; // Compensated magnetometer data, holds the last value for frames without aux data
+} IMU_SAMPLE;
 
 extern struct bmi160_dev bmi160;
 extern struct bmm150_dev bmm150;
@@ -38,8 +58,14 @@ extern volatile uint8_t step_interrupt_triggered;
 extern volatile uint8_t motion_detected;
 extern volatile uint32_t motion_reset_counter;
 
+extern struct k_sem imu_fifo_sem;
+extern struct k_msgq imu_sample_queue;
+extern uint32_t imu_fifo_skipped_frames;
+extern uint32_t imu_sample_queue_overflows;
+
 extern void imu_init(void);
 extern void imu_fetch_data(void);
+extern bool imu_get_next_interval(void);
 extern void trace_imu(void);
 extern void trace_imu_reduced(void);
 extern void motion_detection(void);
@@ -0,0 +1,75 @@
+/**
+ * @file provisioning.h
+ * @author Thomas Keilbach | keiltronic GmbH
+ * @date 17 Oct 2026
+ * @brief This file contains the binary protocol to load the rfid, room and mop databases over the shell uart
+ * @version 2.0.0
+ */
+
+#ifndef PROVISIONING_H
+#define PROVISIONING_H
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/crc.h>
+#include "epc_mem.h"
+
+/* Frame layout (all values little endian):
+ *
+ *   0xA5 0x5A | type (1) | sequence (2) | payload length (2) | payload | CRC32 (4)
+ *
+ * The CRC32 (IEEE) covers type, sequence, payload length and payload. Bytes in front of the sync bytes are ignored, so shell
+ * output which is printed while the provisioning mode is active does not disturb the host.
+ *
+ * Host to device, the sequence number counts the frames of the session starting with 0:
+ *   START  (0x01): table (1), record count (4). Starts a table, the host waits for its ACK (the staging area is erased).
+ *   DATA   (0x02): whole records of the current table in flash layout, any order.
+ *   END    (0x03): CRC32 of the records of all DATA frames of the table (4). The host waits for its ACK (the table is sorted,
+ *                  validated and written into the inactive bank).
+ *   COMMIT (0x04): optional uuid. Activates all tables of the session together, tables which were not sent are kept.
+ *   ABORT  (0x05): Leaves the provisioning mode, the active databases are unchanged.
+ *
+ * Device to host:
+ *   ACK    (0x81): next expected sequence (2), status (1). Cumulative, the host may send PROVISION_WINDOW frames ahead.
+ *   NAK    (0x82): next expected sequence (2), status (1). With PROVISION_ERROR_CRC or _SEQUENCE the host sends again starting
+ *                  with the expected frame (go-back-N). Any other status tells why a frame was rejected, the device
+ *                  leaves the provisioning mode and the session has to be started again.
+ *
+ * Without any response the host sends again starting with the oldest frame which is not acknowledged.
+ *
+ * The device leaves the provisioning mode after COMMIT, ABORT or PROVISION_TIMEOUT without a frame.
+ */
+#define PROVISION_SYNC_1 0xA5
+#define PROVISION_SYNC_2 0x5A
+#define PROVISION_HEADER_LENGTH 5       // type, sequence, payload length
+#define PROVISION_MAX_PAYLOAD 512       // Byte, multiple of all record lengths
+#define PROVISION_WINDOW 4              // Frames the host may send without ACK
+#define PROVISION_TIMEOUT 30            // s
+#define PROVISION_BATCH_SIZE 4096       // Byte, records are sorted in RAM in batches of this size
+#define PROVISION_STAGING_REGION 0x100000UL                                             // Sorted batches of the current table (cs2)
+#define PROVISION_STAGING_REGION_LENGTH (RFID_RECORD_REGION_LENGTH + 1)                 // Largest table
+#define PROVISION_MAX_RUNS (PROVISION_STAGING_REGION_LENGTH / PROVISION_BATCH_SIZE)     // Sorted batches which are merged
+
+#define PROVISION_FRAME_START 0x01
+#define PROVISION_FRAME_DATA 0x02
+#define PROVISION_FRAME_END 0x03
+#define PROVISION_FRAME_COMMIT 0x04
+#define PROVISION_FRAME_ABORT 0x05
+#define PROVISION_FRAME_ACK 0x81
+#define PROVISION_FRAME_NAK 0x82
+
+/* Status of ACK and NAK */
+#define PROVISION_OK 0x00
+#define PROVISION_ERROR_CRC 0x01          // Frame CRC wrong
+#define PROVISION_ERROR_SEQUENCE 0x02     // Frame missing, send again from the expected sequence
+#define PROVISION_ERROR_FRAME 0x03        // Unknown type or invalid payload length
+#define PROVISION_ERROR_STATE 0x04        // Frame not allowed now (e.g. DATA without START)
+#define PROVISION_ERROR_SIZE 0x05         // Too many records for the table
+#define PROVISION_ERROR_TABLE_CRC 0x06    // CRC of END does not match or record count wrong
+#define PROVISION_ERROR_DUPLICATE 0x07    // Same epc or id twice in a table
+#define PROVISION_ERROR_FLASH 0x08        // Verifying the written table failed
+
+extern void Provision_Start(const struct shell *shell);
+extern bool Provision_IsActive(void);
+
+#endif
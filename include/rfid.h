@@ -15,6 +15,62 @@
 #include "uart.h"
 #include "epc_mem.h"
 
+#define RFID_LINE_BUFFER_SIZE       64   // Longest response line (command character, PC, epc, CRC, RSSI)
+#define RFID_RX_CHUNK_SIZE          64   // Byte taken from the uart rx ring per read
+#define RFID_REQUEST_TABLE_SIZE     4    // Commands which can wait for a response at the same time
+#define RFID_RESPONSE_TIMEOUT_MS    100  // Time the module has to answer a command
+#define RFID_CONFIG_TIMEOUT_MS      300  // Time the module has to answer while configuring (covers the start up after power on)
+#define RFID_CONFIG_RETRIES         3
+#define RFID_RSSI_NONE              INT16_MIN
+
+typedef enum
+{
+  RFID_RESPONSE_TAG,     // Tag read ('U' or 'Q' line with epc)
+  RFID_RESPONSE_TAG_END, // End of an inventory round or no tag in range
+  RFID_RESPONSE_VALUE,   // Setting ('N' line)
+  RFID_RESPONSE_VERSION, // Firmware version ('V' line)
+  RFID_RESPONSE_OTHER
+} RFID_RESPONSE_TYPE;
+
+/* Parsed response line. The pointers point into the parser line buffer and are only valid while the line is dispatched */
+typedef struct
+{
+  RFID_RESPONSE_TYPE type;
+  char command;            // First character of the line
+  const char *payload;     // Characters after the command character
+  uint8_t payload_length;
+  const char *epc;         // Trimmed epc hex digits (tag responses only)
+  uint8_t epc_length;
+  int16_t rssi;            // RFID_RSSI_NONE if the module did not send it
+  int32_t value;           // Hex value of the first field, -1 if there is none
+} RFID_RESPONSE;
+
+typedef struct
+{
+  bool pending;
+  uint32_t sequence;       // Order the commands were sent in
+  char response_command;   // First character of the expected response line
+  int64_t deadline;        // Uptime in ms
+  struct k_sem *done;      // Given when the response arrived, NULL if nobody waits
+  int32_t *value;
+  char *response;          // Copy of the response line, can be NULL
+  uint8_t response_size;
+  int *result;
+} RFID_REQUEST;
+
+typedef enum
+{
+  RFID_PARSER_WAIT_LINE, // Wait for the <LF> which starts a line
+  RFID_PARSER_LINE       // Collect the line until <CR>
+} RFID_PARSER_STATE;
+
+typedef struct
+{
+  RFID_PARSER_STATE state;
+  char line[RFID_LINE_BUFFER_SIZE];
+  uint8_t length;
+} RFID_PARSER;
+
 extern struct gpio_dt_spec booster_enable_pin;
 extern struct gpio_dt_spec rfid_trigger_pin;
 
@@ -95,7 +151,13 @@ extern struct gpio_dt_spec rfid_trigger_pin;
 #define VN                          8
 
 /* Functions */
-extern void config_RFID(void);extern void RFID_TriggerSingleScan(void);
+extern void config_RFID(void);
+extern void RFID_TriggerSingleScan(void);
+extern int rfid_SendCommand(const char *command);
+extern int rfid_Request(const char *command, char response_command, uint32_t timeout_ms, bool wait, int32_t *value);
+extern int rfid_RequestText(const char *command, char response_command, uint32_t timeout_ms, char *response, uint8_t response_size);
+extern void rfid_ParseResponse(const uint8_t *data, uint16_t length);
+extern void rfid_ProcessReceivedData(void);
 extern void rfid_trigger_multi_read(void);
 extern void rfid_init(void);
 extern void RFID_TurnOff(void);
@@ -116,5 +178,8 @@ extern  uint8_t RFID_IsOn;
 extern  uint8_t RFID_ScanEnable;
 extern  uint16_t RFID_SwitchOffDelayTimer;
 extern  uint8_t RFID_TriggeredRead;
+extern  uint32_t rfid_request_timeouts;
+extern  uint32_t rfid_unsolicited_responses;
+extern  uint32_t rfid_parser_overlong_lines;
 
 #endif
\ No newline at end of file
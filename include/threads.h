@@ -23,7 +23,7 @@
 #include "pwm.h"
 #include "coap.h"
 #include "usb.h"
-#include "datalog_mem.h"
+#include "datalog_export.h"
 #include "aws_fota.h"
 #include "cloud.h"
 #include "test.h"
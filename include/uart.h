@@ -19,23 +19,31 @@
 #include "rfid.h"
 #include "test.h"
 
-#define UART1_BUFFERSIZE             1024
+#define UART1_RX_RING_SIZE           1024 // Byte, must be a power of two
+#define UART1_RX_RING_MASK           (UART1_RX_RING_SIZE - 1)
+#define UART1_RX_DMA_BUFFER_SIZE     128  // Byte, one of the two rx buffers the UARTE fills by DMA
+#define UART1_RX_TIMEOUT_US          1000 // Idle time after which the received bytes are reported (about 4 characters at 38400 baud)
+#define UART1_TX_MESSAGE_SIZE        32   // Byte, longest command for the RFID module
+#define UART1_TX_QUEUE_SIZE          8    // Number of commands which can wait for transmission
 #define EPC_CUT_OFF_START            4 // 4 byte PC
 #define EPC_CUT_OFF_END              4 // CRC 4 byte
 
 extern void uart1_init(void);
+extern int uart1_Transmit(const uint8_t *data, uint16_t length);
 
 //extern struct device *uart1;
-extern volatile char uart1_InputBuffer[UART1_BUFFERSIZE];
-extern volatile char uart1_RFIDResponse[UART1_BUFFERSIZE];
 extern volatile uint8_t uart1_TransmissionReady;
-extern volatile uint16_t uart1_TransmissionLength;
-extern volatile uint16_t uart1_RFIDResponseTransmissionLength;
-extern volatile uint8_t uart1_RFIDResponseFinished;
 extern volatile uint8_t uart1_NewDataReceived;
 extern volatile uint8_t EPC_tag_buffer_rollover;
 extern volatile uint8_t EPC_extended_tag_buffer_rollover;
 extern volatile uint32_t tag_interrupt_counter;
+extern volatile uint32_t uart1_rx_ring_overflows;
+extern volatile uint32_t uart1_rx_errors;
+extern struct k_sem uart1_rx_sem;
+
+extern uint16_t uart1_RxRingRead(uint8_t *data, uint16_t length);
+extern uint16_t uart1_RxRingAvailable(void);
+extern void uart1_RxRingFlush(void);
 
 extern void uart1_cb(const struct device *rfid_module, struct uart_event *evt, void *user_data);
 extern struct device *uart1;
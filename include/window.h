@@ -0,0 +1,54 @@
+/**
+ * @file window.h
+ * @author Thomas Keilbach | keiltronic GmbH
+ * @date 17 Oct 2026
+ * @brief This file contains the sliding window type which is used by the algorithm to keep the history of a signal
+ * @version 1.0.0
+ */
+
+#ifndef WINDOW_H
+#define WINDOW_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#define WINDOW_MAX_LENGTH 32 // Samples
+
+/* Monotonic deque of (value, sequence) pairs, used to track the minimum or maximum of the window */
+typedef struct
+{
+  float value[WINDOW_MAX_LENGTH];
+  uint32_t sequence[WINDOW_MAX_LENGTH];
+  uint16_t first;
+  uint16_t count;
+} WINDOW_DEQUE;
+
+/* Circular buffer of the last samples of a signal. The running sum and sum of squares are updated with every new sample,
+ * so mean, variance and (if enabled) minimum and maximum cost O(1) per sample independent of the window length.
+ */
+typedef struct
+{
+  float samples[WINDOW_MAX_LENGTH];
+  float sum;
+  float sum_squares;
+  uint32_t sequence; // Number of samples added since init
+  uint16_t length;   // Window length in samples
+  uint16_t head;     // Index where the next sample is written
+  bool track_extrema;
+  WINDOW_DEQUE min;
+  WINDOW_DEQUE max;
+} WINDOW;
+
+extern void window_Init(WINDOW *window, uint16_t length, float initial_value, bool track_extrema);
+extern void window_Add(WINDOW *window, float sample);
+extern float window_Get(const WINDOW *window, uint16_t age);
+extern float window_Sum(const WINDOW *window);
+extern float window_Mean(const WINDOW *window);
+extern float window_Variance(const WINDOW *window);
+extern float window_StandardDeviation(const WINDOW *window);
+extern float window_Min(const WINDOW *window);
+extern float window_Max(const WINDOW *window);
+
+#endif
@@ -0,0 +1,480 @@
+/**
+ * @file datalog_codec.c
+ * @author Thomas Keilbach | keiltronic GmbH
+ * @date 17 Oct 2026
+ * @brief This file contains the encoder and decoder of the compact data log frames (format see datalog_codec.h)
+ * @version 2.0.0
+ */
+
+/*!
+ * @defgroup Memory
+ * @brief This file contains the encoder and decoder of the compact data log frames (format see datalog_codec.h)
+ * @{*/
+
+#include "datalog_codec.h"
+
+#define DATALOG_RAW_VALUE_COUNT 9
+
+static uint8_t datalog_PutVarint(uint8_t *buffer, uint64_t value)
+{
+  uint8_t length = 0;
+
+  do
+  {
+    buffer[length] = value & 0x7F;
+    value >>= 7;
+
+    if (value != 0)
+    {
+      buffer[length] |= 0x80;
+    }
+    length++;
+  } while (value != 0);
+
+  return length;
+}
+
+static bool datalog_GetVarint(const uint8_t *buffer, uint16_t length, uint16_t *position, uint64_t *value)
+{
+  uint8_t shift = 0;
+
+  *value = 0;
+
+  while ((*position < length) && (shift < 64))
+  {
+    *value |= (uint64_t)(buffer[*position] & 0x7F) << shift;
+    shift += 7;
+
+    if ((buffer[(*position)++] & 0x80) == 0)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static uint64_t datalog_ZigZag(int64_t value)
+{
+  return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t datalog_UnZigZag(uint64_t value)
+{
+  return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static uint64_t datalog_Milliseconds(const LOGFRAME *frame)
+{
+  return ((uint64_t)frame->unixtime * 1000) + frame->millisec;
+}
+
+static bool datalog_FloatChanged(float a, float b)
+{
+  return (memcmp(&a, &b, sizeof(float)) != 0);
+}
+
+/*!
+ * @brief This function prepares the encoder or decoder for a new sector, the next frame is a keyframe
+ * @param codec: Pointer to the state
+ * @param first_frame_number: Number of the first frame of the sector (FirstFrameNumber of the sector header)
+ */
+void datalog_ResetCodec(DATALOG_CODEC *codec, uint32_t first_frame_number)
+{
+  memset(codec, 0, sizeof(DATALOG_CODEC));
+  codec->frame_number = first_frame_number;
+  codec->keyframe = true;
+}
+
+/*!
+ * @brief This function encodes a frame as difference to the previous frame of the sector
+ * @param codec: Pointer to the encoder state
+ * @param frame: Frame to encode, the frame number is not stored
+ * @param buffer: Pointer to at least DATALOG_RECORD_MAX_LENGTH bytes
+ * @return uint16_t: Length of the encoded frame
+ */
+uint16_t datalog_EncodeFrame(DATALOG_CODEC *codec, const LOGFRAME *frame, uint8_t *buffer)
+{
+  const LOGFRAME *previous = &codec->previous;
+  uint16_t position = 0;
+  uint16_t mask = 0;
+  uint8_t epc_index = 0;
+  uint8_t epc_start = 0;
+  uint8_t i = 0;
+
+  /* Collect the fields which changed */
+  if (datalog_Milliseconds(frame) != datalog_Milliseconds(previous))
+  {
+    mask |= DATALOG_FIELD_TIME;
+  }
+  if (memcmp(frame->raw_sens_value, previous->raw_sens_value, sizeof(frame->raw_sens_value)) != 0)
+  {
+    mask |= DATALOG_FIELD_IMU;
+  }
+  if (datalog_FloatChanged(frame->floor_handle_angle, previous->floor_handle_angle) == true)
+  {
+    mask |= DATALOG_FIELD_FLOOR_ANGLE;
+  }
+  if (datalog_FloatChanged(frame->frame_handle_angle, previous->frame_handle_angle) == true)
+  {
+    mask |= DATALOG_FIELD_FRAME_ANGLE;
+  }
+  if (datalog_FloatChanged(frame->Mopping_speed, previous->Mopping_speed) == true)
+  {
+    mask |= DATALOG_FIELD_SPEED;
+  }
+  if (datalog_FloatChanged(frame->Coverage_per_Mop, previous->Coverage_per_Mop) == true)
+  {
+    mask |= DATALOG_FIELD_COVERAGE;
+  }
+  if ((EPC_IsZero(&frame->rfid_epc) == false) || (frame->rfid_record_type != 0))
+  {
+    mask |= DATALOG_FIELD_RFID;
+  }
+  if (frame->Mop_cycles != previous->Mop_cycles)
+  {
+    mask |= DATALOG_FIELD_MOP_CYCLES;
+  }
+  if ((frame->Mopping_pattern != previous->Mopping_pattern) || (frame->Motion_state != previous->Motion_state))
+  {
+    mask |= DATALOG_FIELD_MOP_STATE;
+  }
+  if (frame->Total_Steps != previous->Total_Steps)
+  {
+    mask |= DATALOG_FIELD_STEPS;
+  }
+  if ((frame->Battery_voltage != previous->Battery_voltage) || (frame->ChargeCycle != previous->ChargeCycle))
+  {
+    mask |= DATALOG_FIELD_BATTERY;
+  }
+  if (frame->Input_status != previous->Input_status)
+  {
+    mask |= DATALOG_FIELD_INPUTS;
+  }
+  if (frame->Output_status != previous->Output_status)
+  {
+    mask |= DATALOG_FIELD_OUTPUTS;
+  }
+  if (frame->Error_status != previous->Error_status)
+  {
+    mask |= DATALOG_FIELD_ERRORS;
+  }
+
+  buffer[position++] = (codec->keyframe == true) ? DATALOG_RECORD_KEYFRAME : DATALOG_RECORD_DELTA;
+  position += datalog_PutVarint(&buffer[position], mask);
+
+  if (mask & DATALOG_FIELD_TIME)
+  {
+    position += datalog_PutVarint(&buffer[position], datalog_ZigZag((int64_t)(datalog_Milliseconds(frame) - datalog_Milliseconds(previous))));
+  }
+
+  if (mask & DATALOG_FIELD_IMU)
+  {
+    for (i = 0; i < DATALOG_RAW_VALUE_COUNT; i++)
+    {
+      position += datalog_PutVarint(&buffer[position], datalog_ZigZag((int32_t)frame->raw_sens_value[i] - previous->raw_sens_value[i]));
+    }
+  }
+
+  if (mask & DATALOG_FIELD_FLOOR_ANGLE)
+  {
+    memcpy(&buffer[position], &frame->floor_handle_angle, sizeof(float));
+    position += sizeof(float);
+  }
+  if (mask & DATALOG_FIELD_FRAME_ANGLE)
+  {
+    memcpy(&buffer[position], &frame->frame_handle_angle, sizeof(float));
+    position += sizeof(float);
+  }
+  if (mask & DATALOG_FIELD_SPEED)
+  {
+    memcpy(&buffer[position], &frame->Mopping_speed, sizeof(float));
+    position += sizeof(float);
+  }
+  if (mask & DATALOG_FIELD_COVERAGE)
+  {
+    memcpy(&buffer[position], &frame->Coverage_per_Mop, sizeof(float));
+    position += sizeof(float);
+  }
+
+  if (mask & DATALOG_FIELD_RFID)
+  {
+    /* Index of the epc in the sector, a new epc follows the index (which is the number of epcs so far) */
+    for (epc_index = 0; epc_index < codec->epc_count; epc_index++)
+    {
+      if (EPC_Equal(&codec->epc[epc_index], &frame->rfid_epc) == true)
+      {
+        break;
+      }
+    }
+
+    position += datalog_PutVarint(&buffer[position], epc_index);
+
+    if (epc_index == codec->epc_count)
+    {
+      for (epc_start = 0; (epc_start < EPC_BINARY_LENGTH) && (frame->rfid_epc.bytes[epc_start] == 0); epc_start++)
+      {
+      }
+
+      buffer[position++] = EPC_BINARY_LENGTH - epc_start;
+      memcpy(&buffer[position], &frame->rfid_epc.bytes[epc_start], EPC_BINARY_LENGTH - epc_start);
+      position += EPC_BINARY_LENGTH - epc_start;
+
+      if (codec->epc_count < DATALOG_EPC_DICTIONARY_SIZE)
+      {
+        codec->epc[codec->epc_count++] = frame->rfid_epc;
+      }
+    }
+
+    buffer[position++] = frame->rfid_record_type;
+  }
+
+  if (mask & DATALOG_FIELD_MOP_CYCLES)
+  {
+    position += datalog_PutVarint(&buffer[position], datalog_ZigZag((int32_t)frame->Mop_cycles - previous->Mop_cycles));
+  }
+  if (mask & DATALOG_FIELD_MOP_STATE)
+  {
+    buffer[position++] = frame->Mopping_pattern;
+    buffer[position++] = frame->Motion_state;
+  }
+  if (mask & DATALOG_FIELD_STEPS)
+  {
+    position += datalog_PutVarint(&buffer[position], datalog_ZigZag((int32_t)frame->Total_Steps - previous->Total_Steps));
+  }
+  if (mask & DATALOG_FIELD_BATTERY)
+  {
+    position += datalog_PutVarint(&buffer[position], datalog_ZigZag((int32_t)frame->Battery_voltage - previous->Battery_voltage));
+    position += datalog_PutVarint(&buffer[position], datalog_ZigZag((int32_t)frame->ChargeCycle - previous->ChargeCycle));
+  }
+  if (mask & DATALOG_FIELD_INPUTS)
+  {
+    position += datalog_PutVarint(&buffer[position], frame->Input_status ^ previous->Input_status);
+  }
+  if (mask & DATALOG_FIELD_OUTPUTS)
+  {
+    position += datalog_PutVarint(&buffer[position], frame->Output_status ^ previous->Output_status);
+  }
+  if (mask & DATALOG_FIELD_ERRORS)
+  {
+    buffer[position++] = frame->Error_status ^ previous->Error_status;
+  }
+
+  codec->previous = *frame;
+  codec->frame_number++;
+  codec->keyframe = false;
+
+  return position;
+}
+
+/*!
+ * @brief This function decodes the next frame of a sector
+ * @param codec: Pointer to the decoder state
+ * @param buffer: Pointer to the bytes of the sector at the position of the frame
+ * @param length: Number of valid bytes in the buffer
+ * @param frame: Pointer to the decoded frame
+ * @return int16_t: Number of bytes of the frame, 0 at the end of the sector, -1 if the frame is invalid
+ */
+int16_t datalog_DecodeFrame(DATALOG_CODEC *codec, const uint8_t *buffer, uint16_t length, LOGFRAME *frame)
+{
+  uint16_t position = 0;
+  uint64_t value = 0;
+  uint64_t mask = 0;
+  uint64_t epc_index = 0;
+  uint8_t epc_length = 0;
+  uint8_t i = 0;
+
+  if ((length == 0) || (buffer[0] == DATALOG_RECORD_ERASED))
+  {
+    return 0;
+  }
+
+  if (buffer[position++] != ((codec->keyframe == true) ? DATALOG_RECORD_KEYFRAME : DATALOG_RECORD_DELTA))
+  {
+    return -1;
+  }
+
+  if ((datalog_GetVarint(buffer, length, &position, &mask) == false) || ((mask & ~DATALOG_FIELD_ALL) != 0))
+  {
+    return -1;
+  }
+
+  /* Fields which are not stored did not change, except the rfid */
+  *frame = codec->previous;
+  EPC_Clear(&frame->rfid_epc);
+  frame->rfid_reserved = 0;
+  frame->rfid_record_type = 0;
+
+  if (mask & DATALOG_FIELD_TIME)
+  {
+    if (datalog_GetVarint(buffer, length, &position, &value) == false)
+    {
+      return -1;
+    }
+    value = datalog_Milliseconds(&codec->previous) + datalog_UnZigZag(value);
+    frame->unixtime = value / 1000;
+    frame->millisec = value % 1000;
+  }
+
+  if (mask & DATALOG_FIELD_IMU)
+  {
+    for (i = 0; i < DATALOG_RAW_VALUE_COUNT; i++)
+    {
+      if (datalog_GetVarint(buffer, length, &position, &value) == false)
+      {
+        return -1;
+      }
+      frame->raw_sens_value[i] = codec->previous.raw_sens_value[i] + datalog_UnZigZag(value);
+    }
+  }
+
+  if (mask & DATALOG_FIELD_FLOOR_ANGLE)
+  {
+    if ((position + sizeof(float)) > length)
+    {
+      return -1;
+    }
+    memcpy(&frame->floor_handle_angle, &buffer[position], sizeof(float));
+    position += sizeof(float);
+  }
+  if (mask & DATALOG_FIELD_FRAME_ANGLE)
+  {
+    if ((position + sizeof(float)) > length)
+    {
+      return -1;
+    }
+    memcpy(&frame->frame_handle_angle, &buffer[position], sizeof(float));
+    position += sizeof(float);
+  }
+  if (mask & DATALOG_FIELD_SPEED)
+  {
+    if ((position + sizeof(float)) > length)
+    {
+      return -1;
+    }
+    memcpy(&frame->Mopping_speed, &buffer[position], sizeof(float));
+    position += sizeof(float);
+  }
+  if (mask & DATALOG_FIELD_COVERAGE)
+  {
+    if ((position + sizeof(float)) > length)
+    {
+      return -1;
+    }
+    memcpy(&frame->Coverage_per_Mop, &buffer[position], sizeof(float));
+    position += sizeof(float);
+  }
+
+  if (mask & DATALOG_FIELD_RFID)
+  {
+    if ((datalog_GetVarint(buffer, length, &position, &epc_index) == false) || (epc_index > codec->epc_count))
+    {
+      return -1;
+    }
+
+    if (epc_index < codec->epc_count)
+    {
+      frame->rfid_epc = codec->epc[epc_index];
+    }
+    else
+    {
+      if (position >= length)
+      {
+        return -1;
+      }
+
+      epc_length = buffer[position++];
+
+      if ((epc_length > EPC_BINARY_LENGTH) || ((position + epc_length) > length))
+      {
+        return -1;
+      }
+
+      memcpy(&frame->rfid_epc.bytes[EPC_BINARY_LENGTH - epc_length], &buffer[position], epc_length);
+      position += epc_length;
+
+      if (codec->epc_count < DATALOG_EPC_DICTIONARY_SIZE)
+      {
+        codec->epc[codec->epc_count++] = frame->rfid_epc;
+      }
+    }
+
+    if (position >= length)
+    {
+      return -1;
+    }
+    frame->rfid_record_type = buffer[position++];
+  }
+
+  if (mask & DATALOG_FIELD_MOP_CYCLES)
+  {
+    if (datalog_GetVarint(buffer, length, &position, &value) == false)
+    {
+      return -1;
+    }
+    frame->Mop_cycles = codec->previous.Mop_cycles + datalog_UnZigZag(value);
+  }
+  if (mask & DATALOG_FIELD_MOP_STATE)
+  {
+    if ((position + 2) > length)
+    {
+      return -1;
+    }
+    frame->Mopping_pattern = buffer[position++];
+    frame->Motion_state = buffer[position++];
+  }
+  if (mask & DATALOG_FIELD_STEPS)
+  {
+    if (datalog_GetVarint(buffer, length, &position, &value) == false)
+    {
+      return -1;
+    }
+    frame->Total_Steps = codec->previous.Total_Steps + datalog_UnZigZag(value);
+  }
+  if (mask & DATALOG_FIELD_BATTERY)
+  {
+    if (datalog_GetVarint(buffer, length, &position, &value) == false)
+    {
+      return -1;
+    }
+    frame->Battery_voltage = codec->previous.Battery_voltage + datalog_UnZigZag(value);
+
+    if (datalog_GetVarint(buffer, length, &position, &value) == false)
+    {
+      return -1;
+    }
+    frame->ChargeCycle = codec->previous.ChargeCycle + datalog_UnZigZag(value);
+  }
+  if (mask & DATALOG_FIELD_INPUTS)
+  {
+    if (datalog_GetVarint(buffer, length, &position, &value) == false)
+    {
+      return -1;
+    }
+    frame->Input_status = codec->previous.Input_status ^ value;
+  }
+  if (mask & DATALOG_FIELD_OUTPUTS)
+  {
+    if (datalog_GetVarint(buffer, length, &position, &value) == false)
+    {
+      return -1;
+    }
+    frame->Output_status = codec->previous.Output_status ^ value;
+  }
+  if (mask & DATALOG_FIELD_ERRORS)
+  {
+    if (position >= length)
+    {
+      return -1;
+    }
+    frame->Error_status = codec->previous.Error_status ^ buffer[position++];
+  }
+
+  frame->FrameNumber = codec->frame_number++;
+  codec->previous = *frame;
+  codec->keyframe = false;
+
+  return position;
+}
+
+/**@}*/
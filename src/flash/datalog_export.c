@@ -0,0 +1,285 @@
+/**
+ * @file datalog_export.c
+ * @author Thomas Keilbach | keiltronic GmbH
+ * @date 17 Oct 2026
+ * @brief This file contains the binary export of the data log over the shell uart (protocol see datalog_export.h)
+ * @version 2.0.0
+ */
+
+/*!
+ * @defgroup Memory
+ * @brief This file contains the binary export of the data log over the shell uart (protocol see datalog_export.h)
+ * @{*/
+#include "datalog_export.h"
+
+bool datalog_ExportActive = false;
+
+static const struct shell *datalog_export_shell = NULL;
+static uint32_t datalog_export_sector = 0UL;
+static bool datalog_export_restart = false;
+static uint16_t datalog_export_sequence = 0;
+static char datalog_export_line[32]; // Command line of the receiver while the shell is bypassed
+static uint8_t datalog_export_line_length = 0;
+
+/* The export runs in the datalog readout thread with a small stack */
+static uint8_t datalog_export_frame[2 + DATALOG_EXPORT_HEADER_LENGTH + DATALOG_EXPORT_MAX_PAYLOAD + sizeof(uint32_t)];
+
+/**
+ * @brief This function writes raw bytes to the shell uart. The shell is bypassed, so it does not echo or print a prompt, and
+ * the write mutex of the shell keeps the output of other threads out of the frame.
+ */
+static void datalog_ExportWrite(const uint8_t *data, size_t length)
+{
+  size_t written = 0;
+
+  k_mutex_lock(&datalog_export_shell->ctx->wr_mtx, K_FOREVER);
+
+  while (length > 0)
+  {
+    if (datalog_export_shell->iface->api->write(datalog_export_shell->iface, data, length, &written) != 0)
+    {
+      break;
+    }
+
+    data += written;
+    length -= written;
+
+    if (written == 0)
+    {
+      k_msleep(1);
+    }
+  }
+
+  k_mutex_unlock(&datalog_export_shell->ctx->wr_mtx);
+}
+
+/**
+ * @brief This function sends a frame, the payload has to be in datalog_export_frame already
+ *
+ * @param type: Frame type
+ * @param length: Payload length
+ */
+static void datalog_ExportSendFrame(uint8_t type, uint16_t length)
+{
+  uint32_t crc = 0UL;
+
+  datalog_export_frame[0] = DATALOG_EXPORT_SYNC_1;
+  datalog_export_frame[1] = DATALOG_EXPORT_SYNC_2;
+  datalog_export_frame[2] = type;
+  datalog_export_frame[3] = datalog_export_sequence & 0xFF;
+  datalog_export_frame[4] = datalog_export_sequence >> 8;
+  datalog_export_frame[5] = length & 0xFF;
+  datalog_export_frame[6] = length >> 8;
+
+  crc = crc32_ieee(&datalog_export_frame[2], DATALOG_EXPORT_HEADER_LENGTH + length);
+  memcpy(&datalog_export_frame[2 + DATALOG_EXPORT_HEADER_LENGTH + length], &crc, sizeof(crc));
+
+  datalog_ExportWrite(datalog_export_frame, 2 + DATALOG_EXPORT_HEADER_LENGTH + length + sizeof(crc));
+  datalog_export_sequence++;
+}
+
+static uint8_t *datalog_ExportPayload(void)
+{
+  return &datalog_export_frame[2 + DATALOG_EXPORT_HEADER_LENGTH];
+}
+
+/* Returns true if all bytes of a block are erased, the frames of a sector end there */
+static bool datalog_ExportBlockIsErased(const uint8_t *data, uint16_t length)
+{
+  uint16_t i = 0;
+
+  for (i = 0; i < length; i++)
+  {
+    if (data[i] != 0xFF)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Bypass of the shell while the export is active. Only the commands of the receiver are handled: "datalog export <sector>"
+ * starts the export again, "datalog export" without sector and Ctrl-C stop it. Everything else is dropped.
+ */
+static void datalog_ExportReceive(const struct shell *shell, uint8_t *data, size_t length)
+{
+  const char *argument = NULL;
+  size_t i = 0;
+
+  for (i = 0; i < length; i++)
+  {
+    if (data[i] == DATALOG_EXPORT_CTRL_C)
+    {
+      datalog_ExportStop();
+      return;
+    }
+
+    if ((data[i] != '\r') && (data[i] != '\n'))
+    {
+      if (datalog_export_line_length < (sizeof(datalog_export_line) - 1))
+      {
+        datalog_export_line[datalog_export_line_length++] = data[i];
+      }
+      continue;
+    }
+
+    datalog_export_line[datalog_export_line_length] = '\0';
+    datalog_export_line_length = 0;
+
+    if (strncmp(datalog_export_line, DATALOG_EXPORT_COMMAND, strlen(DATALOG_EXPORT_COMMAND)) != 0)
+    {
+      continue;
+    }
+
+    argument = &datalog_export_line[strlen(DATALOG_EXPORT_COMMAND)];
+    while (*argument == ' ')
+    {
+      argument++;
+    }
+
+    if (*argument == '\0')
+    {
+      datalog_ExportStop();
+      return;
+    }
+
+    datalog_ExportStart(shell, strtoul(argument, NULL, 10));
+  }
+}
+
+/**
+ * @brief This function starts the export, or starts it again with another sector while it is active. The shell is bypassed
+ * until the export ends, so no shell output gets between the frames.
+ *
+ * @param shell: Shell of the uart to send the frames with
+ * @param sector: First sector number to send, older sectors which were overwritten are skipped
+ */
+void datalog_ExportStart(const struct shell *shell, uint32_t sector)
+{
+  datalog_export_shell = shell;
+  datalog_export_sector = sector;
+
+  if (datalog_ExportActive == true)
+  {
+    datalog_export_restart = true;
+  }
+  else
+  {
+    datalog_export_line_length = 0;
+    shell_set_bypass(shell, datalog_ExportReceive);
+  }
+
+  datalog_ExportActive = true;
+}
+
+/**
+ * @brief This function stops the export after the current frame, the shell takes over the uart again
+ */
+void datalog_ExportStop(void)
+{
+  datalog_ExportActive = false;
+
+  if (datalog_export_shell != NULL)
+  {
+    shell_set_bypass(datalog_export_shell, NULL);
+  }
+}
+
+/**
+ * @brief This function sends the sectors of the data log. It is called from the datalog readout thread while the export is
+ * active.
+ */
+void datalog_Export(void)
+{
+  DATALOG_SECTOR_HEADER header;
+  DATALOG_SECTOR_HEADER check;
+  uint32_t oldest_sector = 0UL;
+  uint32_t next_sector = 0UL;
+  uint32_t head_length = 0UL;
+  uint32_t end_sector = 0UL;
+  uint32_t sector = 0UL;
+  uint32_t offset = 0UL;
+  uint16_t block_length = 0;
+  uint8_t *payload = datalog_ExportPayload();
+
+  datalog_export_restart = false;
+  datalog_export_sequence = 0;
+
+  /* The range is taken first, so waiting for the queued frames makes sure the sectors before the newest one are complete */
+  datalog_GetSectorRange(&oldest_sector, &next_sector, &head_length);
+  flash_WaitForPendingRequests();
+
+  /* The newest sector is still written while it is not full. It is not sent, the export is resumed with it */
+  end_sector = next_sector;
+  if ((next_sector > 0) && (head_length < FLASH_SUBSUBSECTOR_SIZE))
+  {
+    end_sector = next_sector - 1;
+  }
+
+  sector = MAX(datalog_export_sector, oldest_sector);
+
+  payload[0] = DATALOG_FORMAT_VERSION;
+  sys_put_le32(sector, &payload[1]);
+  sys_put_le32(end_sector, &payload[5]);
+  sys_put_le32(datalog_OldestFrameNumber, &payload[9]);
+  sys_put_le32(System.datalogFrameNumber, &payload[13]);
+  datalog_ExportSendFrame(DATALOG_EXPORT_FRAME_INFO, 17);
+
+  while ((datalog_ExportActive == true) && (datalog_export_restart == false) && (sector < end_sector))
+  {
+    wdt_reset();
+
+    /* Sectors which were overwritten meanwhile or not written (reset during the sector start) are left out */
+    if ((datalog_ReadSectorHeader(GPIO_PIN_FLASH_CS1, sector, &header) == false) || (header.SectorNumber != sector))
+    {
+      sector++;
+      continue;
+    }
+
+    for (offset = 0UL; (offset < FLASH_SUBSUBSECTOR_SIZE) && (datalog_ExportActive == true) && (datalog_export_restart == false); offset += block_length)
+    {
+      block_length = MIN(DATALOG_EXPORT_BLOCK_SIZE, FLASH_SUBSUBSECTOR_SIZE - offset);
+
+      flash_read(GPIO_PIN_FLASH_CS1, DATALOG_MEM + ((sector % DATALOG_SECTOR_COUNT) * FLASH_SUBSUBSECTOR_SIZE) + offset, &payload[DATALOG_EXPORT_DATA_HEADER_LENGTH], block_length);
+
+      if (datalog_ExportBlockIsErased(&payload[DATALOG_EXPORT_DATA_HEADER_LENGTH], block_length) == true)
+      {
+        break;
+      }
+
+      sys_put_le32(sector, &payload[0]);
+      sys_put_le16(offset, &payload[4]);
+      datalog_ExportSendFrame(DATALOG_EXPORT_FRAME_DATA, DATALOG_EXPORT_DATA_HEADER_LENGTH + block_length);
+    }
+
+    if ((datalog_ExportActive == false) || (datalog_export_restart == true))
+    {
+      break;
+    }
+
+    /* The oldest sector is erased ahead when the log is full, so the sector is only valid if it is still the same */
+    if ((datalog_ReadSectorHeader(GPIO_PIN_FLASH_CS1, sector, &check) == true) && (memcmp(&check, &header, sizeof(header)) == 0))
+    {
+      sys_put_le32(sector, &payload[0]);
+      sys_put_le16(offset, &payload[4]);
+      datalog_ExportSendFrame(DATALOG_EXPORT_FRAME_SECTOR, DATALOG_EXPORT_DATA_HEADER_LENGTH);
+    }
+
+    sector++;
+  }
+
+  /* The export stays active and starts again with the requested sector */
+  if (datalog_export_restart == true)
+  {
+    return;
+  }
+
+  sys_put_le32(sector, &payload[0]);
+  datalog_ExportSendFrame(DATALOG_EXPORT_FRAME_END, sizeof(uint32_t));
+
+  datalog_ExportStop();
+}
+
+/**@}*/
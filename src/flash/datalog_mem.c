@@ -21,6 +21,263 @@ uint8_t datalog_EraseActive = false;
 uint8_t setaddress_flag = false;
 uint8_t datalog_ReadOutisActive = false;
 uint32_t flash_logaddress_write = 0UL;
+uint32_t datalog_OldestFrameNumber = 0UL; // Oldest frame which is still stored in the ring buffer
+
+static DATALOG_CODEC datalog_codec;                               // Encoder of the sector which is written
+static uint32_t datalog_next_sector = 0UL;                        // Sector number of the sector which is started next
+static uint32_t datalog_oldest_sector = 0UL;                      // Sector number of the oldest sector
+static uint32_t datalog_sector_offset = FLASH_SUBSUBSECTOR_SIZE;  // Write position in the newest sector, no sector started yet
+static uint8_t datalog_record[sizeof(DATALOG_SECTOR_HEADER) + DATALOG_RECORD_MAX_LENGTH];
+
+/* Decoder of the readout */
+static DATALOG_CODEC datalog_read_codec;
+static LOGFRAME datalog_read_frame;
+static uint8_t datalog_read_buffer[DATALOG_RECORD_MAX_LENGTH];
+
+/* Copies of the frames which are queued for the flash service thread. The buffers are used round robin and requests of the
+ * same priority are executed in order, so the next buffer is always the oldest one when the semaphore can be taken.
+ */
+static uint8_t datalog_write_buffer[DATALOG_WRITE_BUFFER_COUNT][sizeof(DATALOG_SECTOR_HEADER) + DATALOG_RECORD_MAX_LENGTH];
+static uint8_t datalog_write_buffer_index = 0;
+K_SEM_DEFINE(datalog_write_buffer_sem, DATALOG_WRITE_BUFFER_COUNT, DATALOG_WRITE_BUFFER_COUNT);
+
+static void datalog_WriteDoneCallback(const FLASH_REQUEST *request, int result)
+{
+  ARG_UNUSED(request);
+  ARG_UNUSED(result);
+
+  k_sem_give(&datalog_write_buffer_sem);
+}
+
+/* Queues an encoded frame for writing. If all buffers are in use, the frame is written directly to not lose it. */
+static void datalog_QueueRecord(uint32_t addr, uint8_t *data, uint32_t length)
+{
+  FLASH_REQUEST request = {
+      .type = FLASH_REQUEST_WRITE,
+      .cs_pin = GPIO_PIN_FLASH_CS1,
+      .addr = addr,
+      .len = length,
+      .callback = datalog_WriteDoneCallback,
+  };
+
+  if (k_sem_take(&datalog_write_buffer_sem, K_NO_WAIT) == 0)
+  {
+    request.data = &datalog_write_buffer[datalog_write_buffer_index][0];
+    memcpy(request.data, data, length);
+
+    if (flash_SubmitRequest(&request, FLASH_PRIORITY_NORMAL) == 0)
+    {
+      datalog_write_buffer_index = (datalog_write_buffer_index + 1) % DATALOG_WRITE_BUFFER_COUNT;
+      return;
+    }
+
+    k_sem_give(&datalog_write_buffer_sem);
+  }
+
+  flash_WaitForPendingRequests();
+  flash_write(GPIO_PIN_FLASH_CS1, addr, data, length);
+}
+
+/* Returns true if the first word of a sector is erased, a written sector always starts with its header */
+static bool datalog_SectorIsErased(const uint8_t cs_pin, uint32_t sector)
+{
+  uint32_t data = 0UL;
+
+  flash_read(cs_pin, DATALOG_MEM + ((sector % DATALOG_SECTOR_COUNT) * FLASH_SUBSUBSECTOR_SIZE), (uint8_t *)&data, sizeof(data));
+
+  return (data == DATALOG_FRAME_ERASED);
+}
+
+/*!
+ * @brief This function reads the header of a sector of the ring buffer
+ * @param cs_pin: GPIO number of the cs pin
+ * @param sector: Sector number, the sector is read at sector % DATALOG_SECTOR_COUNT
+ * @param header: Pointer to the header
+ * @return bool: false if the sector is erased or does not contain a sector of this format
+ */
+bool datalog_ReadSectorHeader(const uint8_t cs_pin, uint32_t sector, DATALOG_SECTOR_HEADER *header)
+{
+  flash_read(cs_pin, DATALOG_MEM + ((sector % DATALOG_SECTOR_COUNT) * FLASH_SUBSUBSECTOR_SIZE), (uint8_t *)header, sizeof(DATALOG_SECTOR_HEADER));
+
+  return ((header->FirstFrameNumber != DATALOG_FRAME_ERASED) && (header->Version == DATALOG_FORMAT_VERSION) &&
+          ((header->SectorNumber % DATALOG_SECTOR_COUNT) == (sector % DATALOG_SECTOR_COUNT)));
+}
+
+/* Decodes the next frame of a sector into datalog_read_frame, returns false at the end of the frames */
+static bool datalog_ReadNextFrame(const uint8_t cs_pin, uint32_t sector, uint32_t *offset)
+{
+  uint32_t length = MIN(sizeof(datalog_read_buffer), FLASH_SUBSUBSECTOR_SIZE - *offset);
+  int16_t consumed = 0;
+
+  if (length == 0)
+  {
+    return false;
+  }
+
+  flash_read(cs_pin, DATALOG_MEM + ((sector % DATALOG_SECTOR_COUNT) * FLASH_SUBSUBSECTOR_SIZE) + *offset, datalog_read_buffer, length);
+  consumed = datalog_DecodeFrame(&datalog_read_codec, datalog_read_buffer, length, &datalog_read_frame);
+
+  if (consumed <= 0)
+  {
+    return false;
+  }
+
+  *offset += consumed;
+  return true;
+}
+
+/* The next sector is erased ahead, so the log holds the DATALOG_SECTOR_COUNT - 1 sectors in front of it. If the oldest sector is not valid (e.g. a log of the previous format) the oldest frame number is kept.
+ */
+static void datalog_UpdateOldestFrame(const uint8_t cs_pin)
+{
+  DATALOG_SECTOR_HEADER header;
+
+  if ((datalog_next_sector + 1) > DATALOG_SECTOR_COUNT)
+  {
+    datalog_oldest_sector = datalog_next_sector + 1 - DATALOG_SECTOR_COUNT;
+  }
+  else
+  {
+    datalog_oldest_sector = 0UL;
+  }
+
+  if ((datalog_ReadSectorHeader(cs_pin, datalog_oldest_sector, &header) == true) && (header.SectorNumber == datalog_oldest_sector))
+  {
+    datalog_OldestFrameNumber = header.FirstFrameNumber;
+  }
+}
+
+/* Starts the next sector: erases the sector after it, puts the sector header into datalog_record and resets the encoder */
+static void datalog_StartSector(void)
+{
+  DATALOG_SECTOR_HEADER header;
+
+  /* The erase is queued in front of the write, so the datalog thread does not wait for the erase cycle */
+  FLASH_REQUEST erase_request = {
+      .type = FLASH_REQUEST_ERASE_4KB,
+      .cs_pin = GPIO_PIN_FLASH_CS1,
+      .addr = DATALOG_MEM + (((datalog_next_sector + 1) % DATALOG_SECTOR_COUNT) * FLASH_SUBSUBSECTOR_SIZE),
+  };
+
+  if (flash_SubmitRequest(&erase_request, FLASH_PRIORITY_NORMAL) != 0)
+  {
+    flash_WaitForPendingRequests();
+    flash_EraseSector_4kB(GPIO_PIN_FLASH_CS1, erase_request.addr);
+  }
+
+  memset(&header, 0xFF, sizeof(header));
+  header.FirstFrameNumber = System.datalogFrameNumber;
+  header.SectorNumber = datalog_next_sector;
+  header.Version = DATALOG_FORMAT_VERSION;
+  memcpy(datalog_record, &header, sizeof(header));
+
+  datalog_ResetCodec(&datalog_codec, System.datalogFrameNumber);
+  datalog_sector_offset = 0UL;
+  datalog_next_sector++;
+
+  datalog_UpdateOldestFrame(GPIO_PIN_FLASH_CS1);
+}
+
+/* Sector 0 up to the newest sector are written in the same pass through the ring buffer, the next sector is erased and the
+ * following sectors are from the previous pass or were never written. This allows a binary search over the sector headers, then
+ * the frames of the newest sector are counted. Logging continues in the next sector.
+ */
+static uint32_t datalog_SearchNextFrame(const uint8_t cs_pin)
+{
+  DATALOG_SECTOR_HEADER reference;
+  DATALOG_SECTOR_HEADER header;
+  uint32_t head_sector = 0UL;
+  uint32_t offset = 0UL;
+  uint32_t low = 0UL;
+  uint32_t high = 0UL;
+  uint32_t middle = 0UL;
+
+  datalog_ResetPosition();
+
+  if (datalog_ReadSectorHeader(cs_pin, 0, &reference) == false)
+  {
+    /* Sector 0 is only erased ahead while the last sector is written, otherwise the log is empty */
+    head_sector = DATALOG_SECTOR_COUNT - 1;
+
+    if (datalog_ReadSectorHeader(cs_pin, head_sector, &reference) == false)
+    {
+      if (datalog_SectorIsErased(cs_pin, 0) == false)
+      {
+        flash_EraseSector_4kB(cs_pin, DATALOG_MEM);
+      }
+      return 0UL;
+    }
+  }
+  else
+  {
+    low = 0UL;
+    high = DATALOG_SECTOR_COUNT - 1;
+
+    while (low < high)
+    {
+      middle = (low + high + 1) / 2;
+
+      if ((datalog_ReadSectorHeader(cs_pin, middle, &header) == true) && ((header.SectorNumber / DATALOG_SECTOR_COUNT) == (reference.SectorNumber / DATALOG_SECTOR_COUNT)))
+      {
+        low = middle;
+      }
+      else
+      {
+        high = middle - 1;
+      }
+    }
+
+    head_sector = low;
+  }
+
+  datalog_ReadSectorHeader(cs_pin, head_sector, &header);
+
+  /* Count the frames of the newest sector */
+  datalog_ResetCodec(&datalog_read_codec, header.FirstFrameNumber);
+  offset = sizeof(DATALOG_SECTOR_HEADER);
+  while (datalog_ReadNextFrame(cs_pin, head_sector, &offset) == true)
+  {
+  }
+
+  datalog_next_sector = header.SectorNumber + 1;
+  datalog_UpdateOldestFrame(cs_pin);
+
+  /* A log which was written before the ring buffer existed has no erased sector in front of the newest frame */
+  if (datalog_SectorIsErased(cs_pin, datalog_next_sector) == false)
+  {
+    flash_EraseSector_4kB(cs_pin, DATALOG_MEM + ((datalog_next_sector % DATALOG_SECTOR_COUNT) * FLASH_SUBSUBSECTOR_SIZE));
+  }
+
+  return datalog_read_codec.frame_number;
+}
+
+/*!
+ * @brief This function searches the newest frame in the ring buffer and sets the oldest frame number. The boot time does not
+ * depend on the fill level of the log.
+ * @param cs_pin: GPIO number of the cs pin
+ * @return uint32_t: Number of the next frame to write
+ */
+uint32_t datalog_GetLastFrameNumber(const uint8_t cs_pin)
+{
+  uint32_t frame_number = 0UL;
+
+  /* Disable data logging while SPI hardware is used for read out flash memory */
+  datalog_EnableFlag = false;
+
+  frame_number = datalog_SearchNextFrame(cs_pin);
+
+  /* Enable data logging again if it is activated */
+  if (Parameter.datalogEnable == true && datalog_MemoryFull == false)
+  {
+    datalog_EnableFlag = true;
+  }
+  else
+  {
+    datalog_EnableFlag = false;
+  }
+
+  return frame_number;
+}
 
 /*!
  * @brief This functions writes a complete data frame (structe) in the external flash.
@@ -29,6 +286,8 @@ uint32_t flash_logaddress_write = 0UL;
  */
 void datalog_StoreFrame(void)
 {
+  uint16_t length = 0;
+
   if (datalog_ReadOutisActive == false && datalog_MemoryFull == false)
   {
     /* Frame number */
@@ -70,77 +329,66 @@ void datalog_StoreFrame(void)
     DataFrame.Output_status = System.StatusOutputs;
     DataFrame.Error_status = System.StatusErrors;
 
-    /* Calculate address in flash */
-    flash_logaddress_write = System.datalogFrameNumber * DATALOG_FRAME_LENGTH;
+    /* Encode the frame as difference to the previous one, a frame which does not fit into the sector starts the next sector
+     * with a keyframe
+     */
+    length = datalog_EncodeFrame(&datalog_codec, &DataFrame, datalog_record);
 
-    /* Write data to flash */
-    if (flash_logaddress_write < DATALOG_MEM_LENGTH)
+    if ((datalog_sector_offset + length) > FLASH_SUBSUBSECTOR_SIZE)
     {
-      /* Erase sector if the address points to the first element of the sector */
-     // if (!(DATALOG_MEM + flash_logaddress_write) % FLASH_SECTOR_SIZE)
-     if (!(DATALOG_MEM + flash_logaddress_write) % FLASH_SUBSUBSECTOR_SIZE) 
-      {
-        flash_EraseSector_64kB(GPIO_PIN_FLASH_CS1, DATALOG_MEM + flash_logaddress_write);
-      }
+      datalog_StartSector();
+      length = sizeof(DATALOG_SECTOR_HEADER) + datalog_EncodeFrame(&datalog_codec, &DataFrame, &datalog_record[sizeof(DATALOG_SECTOR_HEADER)]);
+    }
 
-      /* Write new data into flash memory */
-      flash_write(GPIO_PIN_FLASH_CS1, DATALOG_MEM + flash_logaddress_write, &DataFrame.logging_frame[0], DATALOG_FRAME_LENGTH);
-      System.datalogFrameNumber++;
+    /* Calculate address in flash, the sector number counts on when the ring buffer wraps */
+    flash_logaddress_write = (((datalog_next_sector - 1) % DATALOG_SECTOR_COUNT) * FLASH_SUBSUBSECTOR_SIZE) + datalog_sector_offset;
 
-      /* If verbose mode is active, print current frame to console after it was written to flash */
-      if (Parameter.datalog_sniffFrame)
-      {
-        /* Print line number and unix time in millisec resolution */
-        rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "%d;%d%d;", DataFrame.FrameNumber, DataFrame.unixtime, DataFrame.millisec);
-
-        /* Print latest found EPC tag in HEX representation */
-        PrintDeserializeHexToChar(&DataFrame.rfid_record_hex[0], 20);
-
-        /* Print IMU and mopping data */
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "%d;%d;%d;%d;%d;%d;%d;%d;%d;%d;%d;%d;%d;%d;%d;%d;%d;",
-                      DataFrame.raw_sens_value[0],
-                      DataFrame.raw_sens_value[1],
-                      DataFrame.raw_sens_value[2],
-                      DataFrame.raw_sens_value[3],
-                      DataFrame.raw_sens_value[4],
-                      DataFrame.raw_sens_value[5],
-                      DataFrame.raw_sens_value[6],
-                      DataFrame.raw_sens_value[7],
-                      DataFrame.raw_sens_value[8]);
-
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "%f;%f;",
-                      DataFrame.floor_handle_angle,
-                      DataFrame.frame_handle_angle);
-
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "%f;%f;%d;%d;%d;%d;%d;%d;",
-                      DataFrame.Mopping_speed,
-                      DataFrame.Coverage_per_Mop,
-                      DataFrame.Mop_cycles,
-                      DataFrame.Mopping_pattern,
-                      DataFrame.Motion_state,
-                      DataFrame.Total_Steps,
-                      DataFrame.Battery_voltage,
-                      DataFrame.ChargeCycle);
-
-        /* Print device status */
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "%d;%d;%d\n",
-                      DataFrame.Input_status,
-                      DataFrame.Output_status,
-                      DataFrame.Error_status);
-      }
-    }
-    else
-    {
-      /* If verbose mode is active */
-      datalog_EnableFlag = false;
-      datalog_MemoryFull = true;
+    /* Write new data into flash memory (executed by the flash service thread) */
+    datalog_QueueRecord(DATALOG_MEM + flash_logaddress_write, datalog_record, length);
+    datalog_sector_offset += length;
+    System.datalogFrameNumber++;
 
-      if (Parameter.datalog_sniffFrame || Parameter.debug)
-      {
-        rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Flash memory full.");
-      }
+    /* If verbose mode is active, print current frame to console after it was written to flash */
+    if (Parameter.datalog_sniffFrame)
+    {
+      /* Print line number and unix time in millisec resolution */
+      rtc_print_debug_timestamp();
+      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "%d;%d%d;", DataFrame.FrameNumber, DataFrame.unixtime, DataFrame.millisec);
+
+      /* Print latest found EPC tag in HEX representation */
+      EPC_PrintHexString(&DataFrame.rfid_epc);
+
+      /* Print IMU and mopping data */
+      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "%d;%d;%d;%d;%d;%d;%d;%d;%d;%d;%d;%d;%d;%d;%d;%d;%d;",
+                    DataFrame.raw_sens_value[0],
+                    DataFrame.raw_sens_value[1],
+                    DataFrame.raw_sens_value[2],
+                    DataFrame.raw_sens_value[3],
+                    DataFrame.raw_sens_value[4],
+                    DataFrame.raw_sens_value[5],
+                    DataFrame.raw_sens_value[6],
+                    DataFrame.raw_sens_value[7],
+                    DataFrame.raw_sens_value[8]);
+
+      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "%f;%f;",
+                    DataFrame.floor_handle_angle,
+                    DataFrame.frame_handle_angle);
+
+      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "%f;%f;%d;%d;%d;%d;%d;%d;",
+                    DataFrame.Mopping_speed,
+                    DataFrame.Coverage_per_Mop,
+                    DataFrame.Mop_cycles,
+                    DataFrame.Mopping_pattern,
+                    DataFrame.Motion_state,
+                    DataFrame.Total_Steps,
+                    DataFrame.Battery_voltage,
+                    DataFrame.ChargeCycle);
+
+      /* Print device status */
+      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "%d;%d;%d\n",
+                    DataFrame.Input_status,
+                    DataFrame.Output_status,
+                    DataFrame.Error_status);
     }
   }
 
@@ -155,7 +403,7 @@ void datalog_StoreFrame(void)
   System.StatusInputs &= ~STATUSFLAG_B2;  // Reset status entry
   System.StatusInputs &= ~STATUSFLAG_UB;  // Reset status entry
 
-  memset(DataFrame.rfid_record_hex, 0, 20);
+  EPC_Clear(&DataFrame.rfid_epc);
   DataFrame.rfid_record_type = 0;
 }
 
@@ -167,101 +415,132 @@ void datalog_StoreFrame(void)
  */
 void datalog_GetData(void)
 {
-  uint32_t currentDataFrame = 0UL;
+  uint32_t firstDataFrame = 0UL;
   uint32_t lastDataFrame = 0UL;
-  uint16_t byte_pos = DATALOG_FRAME_LENGTH;
-
-  /* Stop data logging */
+  uint32_t sector = 0UL;
+  uint32_t offset = 0UL;
+  uint32_t low = 0UL;
+  uint32_t high = 0UL;
+  uint32_t middle = 0UL;
+  DATALOG_SECTOR_HEADER header;
+
+  /* Stop data logging and wait until all queued frames are in the flash */
   datalog_EnableFlag = false;
+  flash_WaitForPendingRequests();
 
-  /* Caclulate start end end frame address based on user input */
+  /* Caclulate first and last frame based on user input, the frames are printed in ascending order */
   if (!setaddress_flag)
   {
-    if (System.datalog_StartFrame >= System.datalog_EndFrame)
+    firstDataFrame = MIN(System.datalog_StartFrame, System.datalog_EndFrame);
+    lastDataFrame = MAX(System.datalog_StartFrame, System.datalog_EndFrame);
+    setaddress_flag = true;
+  }
+
+  /* Frames which were overwritten in the ring buffer or not written yet are skipped */
+  if (firstDataFrame < datalog_OldestFrameNumber)
+  {
+    firstDataFrame = datalog_OldestFrameNumber;
+  }
+
+  /* Read stored frames from external flash */
+  shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "\r\n");
+  printk("\r\n");
+
+  if ((System.datalogFrameNumber > 0UL) && (datalog_next_sector > datalog_oldest_sector))
+  {
+    /* Search the last sector which starts in front of the first frame */
+    low = datalog_oldest_sector;
+    high = datalog_next_sector - 1;
+
+    while (low < high)
     {
-      currentDataFrame = System.datalog_StartFrame;
-      if ((System.datalog_StartFrame - System.datalog_EndFrame) > 0UL)
+      middle = (low + high + 1) / 2;
+
+      if ((datalog_ReadSectorHeader(GPIO_PIN_FLASH_CS1, middle, &header) == false) || (header.FirstFrameNumber <= firstDataFrame))
       {
-        lastDataFrame = System.datalog_EndFrame;
+        low = middle;
       }
       else
       {
-        lastDataFrame = 0UL;
+        high = middle - 1;
       }
     }
-    else
+
+    sector = low;
+  }
+  else
+  {
+    /* Log is empty */
+    sector = datalog_next_sector;
+  }
+
+  while ((datalog_ReadOutisActive == true) && (sector < datalog_next_sector))
+  {
+    if (datalog_ReadSectorHeader(GPIO_PIN_FLASH_CS1, sector, &header) == false)
     {
-      currentDataFrame = System.datalog_EndFrame;
-      if ((System.datalog_EndFrame - System.datalog_StartFrame) > 0UL)
-      {
-        lastDataFrame = System.datalog_StartFrame;
-      }
-      else
-      {
-        lastDataFrame = 0UL;
-      }
+      sector++;
+      continue;
     }
 
-    setaddress_flag = true;
-  }
+    datalog_ResetCodec(&datalog_read_codec, header.FirstFrameNumber);
+    offset = sizeof(DATALOG_SECTOR_HEADER);
 
-  /* Read stored frames from external flash */
-  shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "\r\n");
-  printk("\r\n");
+    while ((datalog_ReadOutisActive == true) && (datalog_read_codec.frame_number <= lastDataFrame) && (datalog_ReadNextFrame(GPIO_PIN_FLASH_CS1, sector, &offset) == true))
+    {
+      if (datalog_read_frame.FrameNumber < firstDataFrame)
+      {
+        continue;
+      }
 
-  while ((datalog_ReadOutisActive == true) && (currentDataFrame > lastDataFrame))
-  {
-    wdt_reset();
+      wdt_reset();
+
+      /* Print linenumber and unixtime in millisec resolution */
+      printf("%d;%d%03d;", datalog_read_frame.FrameNumber, datalog_read_frame.unixtime, datalog_read_frame.millisec);
+
+      /* Print latest found EPC tag in HEX representation */
+      EPC_PrintHexString(&datalog_read_frame.rfid_epc);
+      printf("%d;", datalog_read_frame.rfid_record_type);
+
+      /* Print IMU and mopping data */
+      printf("%4.2f;%4.2f;%4.2f;%4.2f;%4.2f;%4.2f;%d;%d;%d;",
+             acc_lsb_to_ms2((int16_t)datalog_read_frame.raw_sens_value[0]),  // Acc x
+             acc_lsb_to_ms2((int16_t)datalog_read_frame.raw_sens_value[1]),  // Acc y
+             acc_lsb_to_ms2((int16_t)datalog_read_frame.raw_sens_value[2]),  // Acc z
+             gyro_lsb_to_dps((int16_t)datalog_read_frame.raw_sens_value[3]), // Gyro x
+             gyro_lsb_to_dps((int16_t)datalog_read_frame.raw_sens_value[4]), // Gyro y
+             gyro_lsb_to_dps((int16_t)datalog_read_frame.raw_sens_value[5]), // Gyro z
+             datalog_read_frame.raw_sens_value[6],                           // Mag x
+             datalog_read_frame.raw_sens_value[7],                           // Mag y
+             datalog_read_frame.raw_sens_value[8]);                          // Mag z
+
+      printf("%3.2f;%3.2f;", datalog_read_frame.floor_handle_angle, datalog_read_frame.frame_handle_angle);
+
+      printf("%2.2f;%2.2f;%d;%d;%d;%d;%d;%d;",
+             datalog_read_frame.Mopping_speed,
+             datalog_read_frame.Coverage_per_Mop,
+             datalog_read_frame.Mop_cycles,
+             datalog_read_frame.Mopping_pattern,
+             datalog_read_frame.Motion_state,
+             datalog_read_frame.Total_Steps,
+             datalog_read_frame.Battery_voltage,
+             datalog_read_frame.ChargeCycle);
+
+      /* Print device status */
+      printf("%d;%d;%d\n", datalog_read_frame.Input_status,
+             datalog_read_frame.Output_status,
+             datalog_read_frame.Error_status);
+    }
 
-    flash_read(GPIO_PIN_FLASH_CS1, DATALOG_MEM + (currentDataFrame * DATALOG_FRAME_LENGTH), &DataFrame.logging_frame[0], DATALOG_FRAME_LENGTH);
-
-    /* Print linenumber and unixtime in millisec resolution */
-    printf("%d;%d%03d;", DataFrame.FrameNumber, DataFrame.unixtime, DataFrame.millisec);
-
-    /* Print latest found EPC tag in HEX representation */
-    PrintDeserializeHexToChar(&DataFrame.rfid_record_hex[0], 20);
-    printf("%d;", DataFrame.rfid_record_type);
-
-    /* Print IMU and mopping data */
-    printf("%4.2f;%4.2f;%4.2f;%4.2f;%4.2f;%4.2f;%d;%d;%d;",
-           acc_lsb_to_ms2((int16_t)DataFrame.raw_sens_value[0]),  // Acc x
-           acc_lsb_to_ms2((int16_t)DataFrame.raw_sens_value[1]),  // Acc y
-           acc_lsb_to_ms2((int16_t)DataFrame.raw_sens_value[2]),  // Acc z
-           gyro_lsb_to_dps((int16_t)DataFrame.raw_sens_value[3]), // Gyro x
-           gyro_lsb_to_dps((int16_t)DataFrame.raw_sens_value[4]), // Gyro y
-           gyro_lsb_to_dps((int16_t)DataFrame.raw_sens_value[5]), // Gyro z
-           DataFrame.raw_sens_value[6],                           // Mag x
-           DataFrame.raw_sens_value[7],                           // Mag y
-           DataFrame.raw_sens_value[8]);                          // Mag z
-
-    printf("%3.2f;%3.2f;", DataFrame.floor_handle_angle, DataFrame.frame_handle_angle);
-
-    printf("%2.2f;%2.2f;%d;%d;%d;%d;%d;%d;",
-           DataFrame.Mopping_speed,
-           DataFrame.Coverage_per_Mop,
-           DataFrame.Mop_cycles,
-           DataFrame.Mopping_pattern,
-           DataFrame.Motion_state,
-           DataFrame.Total_Steps,
-           DataFrame.Battery_voltage,
-           DataFrame.ChargeCycle);
-
-    /* Print device status */
-    printf("%d;%d;%d\n", DataFrame.Input_status,
-           DataFrame.Output_status,
-           DataFrame.Error_status);
-
-    if (currentDataFrame != 0UL)
+    if (datalog_read_codec.frame_number > lastDataFrame)
     {
-      currentDataFrame--;
+      break;
     }
+
+    sector++;
   }
 
   setaddress_flag = false;
-  byte_pos = DATALOG_FRAME_LENGTH;
   datalog_ReadOutisActive = false;
-  currentDataFrame = 0UL;
-  lastDataFrame = 0UL;
 
   if (Parameter.datalogEnable == true)
   {
@@ -277,19 +556,38 @@ void datalog_GetData(void)
 
 /*!
  * @brief This functions clears  the data log memory in the external flash and reset the write address.
+ * @details The ring buffer can have an erased sector between written ones, so the first word of every 4kB sector is checked and
+ * each 64kB block which contains a written sector is erased.
  * @note This function talks directly over the SPI bus with the external NOR flash memory. For this it uses the API calls defined in flash.c
  * @see flash.c
  */
 void datalog_CleardatalogAll(void)
 {
+  uint32_t block = 0UL;
+  uint32_t sector = 0UL;
+
   datalog_EnableFlag = false;
   datalog_EraseActive = true;
-  flash_ClearMemAll(GPIO_PIN_FLASH_CS1, DATALOG_MEM, DATALOG_MEM_LENGTH);
+  flash_WaitForPendingRequests();
+
+  for (block = 0UL; block < (DATALOG_MEM_LENGTH + 1); block += FLASH_SECTOR_SIZE)
+  {
+    wdt_reset();
+
+    for (sector = block; sector < (block + FLASH_SECTOR_SIZE); sector += FLASH_SUBSUBSECTOR_SIZE)
+    {
+      if (datalog_SectorIsErased(GPIO_PIN_FLASH_CS1, sector / FLASH_SUBSUBSECTOR_SIZE) == false)
+      {
+        flash_EraseSector_64kB(GPIO_PIN_FLASH_CS1, DATALOG_MEM + block);
+        break;
+      }
+    }
+  }
   datalog_EraseActive = false;
 
   System.TotalSteps = 0;
   System.Steps = 0;
-  System.datalogFrameNumber = 0UL;
+  datalog_ResetPosition();
 
   if (Parameter.datalogEnable == true)
   {
@@ -299,4 +597,29 @@ void datalog_CleardatalogAll(void)
   {
     datalog_EnableFlag = false;
   }
-}
\ No newline at end of file
+}
+
+/*!
+ * @brief This function resets the write position after the data log memory was erased. The first frame starts sector 0.
+ */
+void datalog_ResetPosition(void)
+{
+  System.datalogFrameNumber = 0UL;
+  datalog_OldestFrameNumber = 0UL;
+  datalog_oldest_sector = 0UL;
+  datalog_next_sector = 0UL;
+  datalog_sector_offset = FLASH_SUBSUBSECTOR_SIZE;
+}
+
+/*!
+ * @brief This function returns the sectors which hold the log, the queued frames are not necessarily written yet
+ * @param oldest_sector: Sector number of the oldest sector
+ * @param next_sector: Sector number of the sector which is started next, the newest sector is next_sector - 1
+ * @param head_length: Bytes of the newest sector which contain frames
+ */
+void datalog_GetSectorRange(uint32_t *oldest_sector, uint32_t *next_sector, uint32_t *head_length)
+{
+  *oldest_sector = datalog_oldest_sector;
+  *next_sector = datalog_next_sector;
+  *head_length = datalog_sector_offset;
+}
@@ -12,7 +12,7 @@
  * @{*/
 #include "epc_mem.h"
 
-EPC_TAG epc_ring_buffer[EPC_RING_BUFFER_SIZE];
+EPC_BINARY epc_ring_buffer[EPC_RING_BUFFER_SIZE];
 LAST_SEEN_TAG EPC_last_seen_records[EPC_LAST_SEEN_COUNT];
 RFID_RECORD room_wall_tag_last_seen[EPC_LAST_SEEN_COUNT];
 ADVANCED_MOP_RECORD last_seen_mop_records_array[MAX_MOP_PER_SHIFT];
@@ -28,8 +28,7 @@ ROOM_RECORD current_room_record;
 MOP_RECORD current_mop_record;
 ROOM_TO_MOP_MAP current_room_to_mop_mapping;
 
-char current_mob_string_reading[EPC_TOTAL_HEX_LENGTH + 1];
-char epc_extracted_last[EPC_STRING_LENGTH];
+EPC_BINARY current_mop_epc_reading;
 
 uint8_t last_seen_mop_count = 0;
 uint32_t last_seen_mop_id = 0;
@@ -46,11 +45,42 @@ uint32_t last_seen_mop_auto_clear_timer = 0;
 uint8_t mop_installed = false;
 uint16_t last_another_room_id = 0;
 
-bool epc_string_start_flag;
-bool epc_string_end_flag;
+/* RAM index of the rfid record database. It holds a hash of the binary epc and the record index, sorted by the hash, so a
+ * lookup needs no flash access for the search and only one read to fetch and confirm the record.
+ */
+static EPC_INDEX_ENTRY epc_index[EPC_INDEX_MAX_RECORDS];
+static RFID_RECORD epc_index_build_buffer[EPC_INDEX_BUILD_BLOCK_RECORDS];
+static uint16_t epc_index_count = 0;
+static uint8_t epc_index_valid = false;
+K_MUTEX_DEFINE(epc_index_mutex);
+
+/* Active database bank. All record accesses add the offset of the bank to the regions of bank 0, under epc_index_mutex. */
+static uint32_t EPC_database_offset = 0UL;
+static uint8_t epc_database_bank = 0;
+static EPC_DATABASE_HEADER epc_database_header; // Generation 0 if the active bank has no header
+static uint8_t epc_database_page[FLASH_PAGE_SIZE];
+
+/* Records of a DataUpdate table in sorted order, as index into the message. The index breaks ties of records with the same key,
+ * so duplicates are resolved by their order in the message and not by the qsort() implementation. Only used by the cloud thread.
+ */
+static uint16_t epc_database_order[EPC_INDEX_MAX_RECORDS];
+static const uint8_t *epc_database_order_records;
+static uint16_t epc_database_order_record_length;
+static int (*epc_database_order_compare)(const void *a, const void *b);
+
+/* Bank which is written by an update and its header, written when all tables are complete */
+static uint8_t epc_database_target_bank = 1;
+static EPC_DATABASE_HEADER epc_database_pending_header;
+static uint8_t epc_database_tables_written = 0; // Bit mask of EPC_TABLE
+
+const EPC_TABLE_DESCRIPTOR EPC_database_tables[EPC_TABLE_COUNT] = {
+    {RFID_RECORD_REGION, RFID_RECORD_REGION_LENGTH, RFID_RECORD_BYTE_LENGTH, "rfid"},
+    {ROOM_RECORD_REGION, ROOM_RECORD_REGION_LENGTH, ROOM_RECORD_BYTE_LENGTH, "room"},
+    {MOP_RECORD_REGION, MOP_RECORD_REGION_LENGTH, MOP_RECORD_BYTE_LENGTH, "mop"}};
 
-uint32_t j = 0;
-uint16_t epc_length = 0;
+/* Given by the RFID response parser when new tags are in the epc ring buffer, the epc thread waits on it */
+K_SEM_DEFINE(epc_new_tags_sem, 0, 1);
+static uint8_t epc_new_tags_stored = false;
 
 /*!
  * @brief This functions initialize the epc buffers, flags and counters in RAM.
@@ -61,9 +91,9 @@ void epc_mem_init(void)
 
   for (i = 0; i < EPC_LAST_SEEN_COUNT; i++)
   {
-    memcpy(EPC_last_seen_records[i].record.string, "0", EPC_TOTAL_HEX_LENGTH);
+    EPC_Clear(&EPC_last_seen_records[i].epc);
     EPC_last_seen_records[i].timestamp = 0LL;
-    memset(room_wall_tag_last_seen[i].epc, 0, EPC_TOTAL_HEX_LENGTH);
+    EPC_Clear(&room_wall_tag_last_seen[i].epc);
   }
 
   current_room_record.allowed_mop_colors = 0;
@@ -81,9 +111,9 @@ void epc_mem_init(void)
   current_room_to_mop_mapping.current_mop_id = 0;
   current_room_to_mop_mapping.previous_mop_id = 0;
   current_room_to_mop_mapping.timestamp = 0;
-  memset(current_room_to_mop_mapping.current_mop_epc, '0', EPC_TOTAL_HEX_LENGTH);
+  EPC_Clear(&current_room_to_mop_mapping.current_mop_epc);
   memset(last_seen_mop_records_array, 0, MAX_MOP_PER_SHIFT);
-  memset(current_mob_string_reading, 0, EPC_TOTAL_HEX_LENGTH);
+  EPC_Clear(&current_mop_epc_reading);
 
   clear_last_seen_location_record_array();
 }
@@ -97,7 +127,7 @@ void clear_last_seen_location_record_array(void)
 
   for (i = 0; i < LAST_SEEN_LOCATION_ARRAY_SIZE; i++)
   {
-    memset(last_seen_location_records_array[i].epc, '0', EPC_TOTAL_HEX_LENGTH);
+    EPC_Clear(&last_seen_location_records_array[i].epc);
     last_seen_location_records_array[i].id = 0;
     last_seen_location_records_array[i].type = 0;
   }
@@ -116,37 +146,33 @@ void list_last_seen_location_record_array(void)
 
   for (i = 0; i < last_seen_location_records_array_position; i++)
   {
-   // shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "%d: %s\n", i, DeserializeHexToChar(last_seen_location_records_array[i].epc, EPC_TOTAL_HEX_LENGTH));
+   // shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "%d: %s\n", i, EPC_ToHexString(&last_seen_location_records_array[i].epc, epc_string));
   }
 }
 
 /**
  * @brief  This functions takes a new location record and adds it to the "last seen location array list" if it its not already listed.
  *
- * @param location_epc: Pointer to location_epc string
- * @param epc_len: string length
+ * @param location_epc: Pointer to location epc
  * @return uint16_t: Current position in "last seen location array"
  */
-uint16_t check_or_add_location_record_in_array(uint8_t *location_epc, uint8_t epc_len) // returns the postion of the epc in the last seen location array
+uint16_t check_or_add_location_record_in_array(const EPC_BINARY *location_epc) // returns the postion of the epc in the last seen location array
 {
   uint16_t i = 0;
-  uint8_t rslt = 0;
 
   /* Search for location epc in array - if already exisiting do not add it again*/
-  for (i = 0; i < LAST_SEEN_LOCATION_ARRAY_SIZE; i++)
+  for (i = 0; i < last_seen_location_records_array_position; i++)
   {
-    rslt = memcmp(last_seen_location_records_array[i].epc, location_epc, EPC_TOTAL_HEX_LENGTH);
-
-    if (rslt == 0)
+    if (EPC_Equal(&last_seen_location_records_array[i].epc, location_epc))
     {
       return i; // already listed
     }
   }
 
   /* If location epc not found then add it into array*/
-  if (last_seen_location_records_array_position <= LAST_SEEN_LOCATION_ARRAY_SIZE)
+  if (last_seen_location_records_array_position < LAST_SEEN_LOCATION_ARRAY_SIZE)
   {
-    memcpy(last_seen_location_records_array[last_seen_location_records_array_position++].epc, location_epc, EPC_TOTAL_HEX_LENGTH);
+    last_seen_location_records_array[last_seen_location_records_array_position++].epc = *location_epc;
   }
 
   return last_seen_location_records_array_position - 1;
@@ -257,15 +283,20 @@ void EPC_Memory_Write_RFID_Record(uint8_t cs_pin, RFID_RECORD *record, uint32_t
   uint32_t wall_record_address = 0UL;
   datalog_EnableFlag = false;
 
+  /* The bank can not change while the record is accessed */
+  k_mutex_lock(&epc_index_mutex, K_FOREVER);
+
   /* Calculate address in flash */
-  wall_record_address = RFID_RECORD_REGION + (index * RFID_RECORD_BYTE_LENGTH);
+  wall_record_address = RFID_RECORD_REGION + EPC_database_offset + (index * RFID_RECORD_BYTE_LENGTH);
 
   /* Write epc tag data to flash*/
-  if (wall_record_address < (RFID_RECORD_REGION + RFID_RECORD_REGION_LENGTH))
+  if (wall_record_address < (RFID_RECORD_REGION + EPC_database_offset + RFID_RECORD_REGION_LENGTH))
   {
     flash_write(cs_pin, wall_record_address, record->rfid_record_bytes, RFID_RECORD_BYTE_LENGTH);
   }
 
+  k_mutex_unlock(&epc_index_mutex);
+
   if (Parameter.datalogEnable == true)
   {
     datalog_EnableFlag = true;
@@ -289,15 +320,20 @@ void EPC_Memory_Write_Room_Record(uint8_t cs_pin, ROOM_RECORD *record, uint32_t
   uint32_t room_record_address = 0UL;
   datalog_EnableFlag = false;
 
+  /* The bank can not change while the record is accessed */
+  k_mutex_lock(&epc_index_mutex, K_FOREVER);
+
   /* Calculate address in flash */
-  room_record_address = ROOM_RECORD_REGION + (index * ROOM_RECORD_BYTE_LENGTH);
+  room_record_address = ROOM_RECORD_REGION + EPC_database_offset + (index * ROOM_RECORD_BYTE_LENGTH);
 
   /* Write epc tag data to flash*/
-  if (room_record_address < (ROOM_RECORD_REGION + ROOM_RECORD_REGION_LENGTH))
+  if (room_record_address < (ROOM_RECORD_REGION + EPC_database_offset + ROOM_RECORD_REGION_LENGTH))
   {
     flash_write(cs_pin, room_record_address, record->room_record_bytes, ROOM_RECORD_BYTE_LENGTH);
   }
 
+  k_mutex_unlock(&epc_index_mutex);
+
   if (Parameter.datalogEnable == true)
   {
     datalog_EnableFlag = true;
@@ -321,15 +357,20 @@ void EPC_Memory_Write_Mop_Record(uint8_t cs_pin, MOP_RECORD *record, uint32_t in
   uint32_t mop_record_address = 0UL;
   datalog_EnableFlag = false;
 
+  /* The bank can not change while the record is accessed */
+  k_mutex_lock(&epc_index_mutex, K_FOREVER);
+
   /* Calculate address in flash */
-  mop_record_address = MOP_RECORD_REGION + (index * MOP_RECORD_BYTE_LENGTH);
+  mop_record_address = MOP_RECORD_REGION + EPC_database_offset + (index * MOP_RECORD_BYTE_LENGTH);
 
   /* Write epc tag data to flash*/
-  if (mop_record_address < (MOP_RECORD_REGION + MOP_RECORD_REGION_LENGTH))
+  if (mop_record_address < (MOP_RECORD_REGION + EPC_database_offset + MOP_RECORD_REGION_LENGTH))
   {
     flash_write(cs_pin, mop_record_address, record->mop_record_bytes, MOP_RECORD_BYTE_LENGTH);
   }
 
+  k_mutex_unlock(&epc_index_mutex);
+
   if (Parameter.datalogEnable == true)
   {
     datalog_EnableFlag = true;
@@ -353,15 +394,20 @@ void EPC_Memory_Read_RFID_Record(uint8_t cs_pin, RFID_RECORD *record, uint32_t i
   uint32_t flash_epc_address = 0UL;
   datalog_EnableFlag = false;
 
+  /* The bank can not change while the record is accessed */
+  k_mutex_lock(&epc_index_mutex, K_FOREVER);
+
   /* Calculate address in flash */
-  flash_epc_address = RFID_RECORD_REGION + (index * RFID_RECORD_BYTE_LENGTH);
+  flash_epc_address = RFID_RECORD_REGION + EPC_database_offset + (index * RFID_RECORD_BYTE_LENGTH);
 
   /* Read epc tag from flash*/
-  if (flash_epc_address < (RFID_RECORD_REGION + RFID_RECORD_REGION_LENGTH))
+  if (flash_epc_address < (RFID_RECORD_REGION + EPC_database_offset + RFID_RECORD_REGION_LENGTH))
   {
     flash_read(cs_pin, flash_epc_address, record->rfid_record_bytes, RFID_RECORD_BYTE_LENGTH);
   }
 
+  k_mutex_unlock(&epc_index_mutex);
+
   if (Parameter.datalogEnable == true)
   {
     datalog_EnableFlag = true;
@@ -385,15 +431,20 @@ void EPC_Memory_Read_RFID_Record_fast(uint8_t cs_pin, RFID_RECORD *record, uint3
   uint32_t flash_epc_address = 0UL;
   datalog_EnableFlag = false;
 
+  /* The bank can not change while the record is accessed */
+  k_mutex_lock(&epc_index_mutex, K_FOREVER);
+
   /* Calculate address in flash */
-  flash_epc_address = RFID_RECORD_REGION + (index * RFID_RECORD_BYTE_LENGTH);
+  flash_epc_address = RFID_RECORD_REGION + EPC_database_offset + (index * RFID_RECORD_BYTE_LENGTH);
 
   /* Read epc tag from flash*/
-  if (flash_epc_address < (RFID_RECORD_REGION + RFID_RECORD_REGION_LENGTH))
+  if (flash_epc_address < (RFID_RECORD_REGION + EPC_database_offset + RFID_RECORD_REGION_LENGTH))
   {
     flash_read_fast(cs_pin, flash_epc_address, record->rfid_record_bytes, RFID_RECORD_BYTE_LENGTH);
   }
 
+  k_mutex_unlock(&epc_index_mutex);
+
   if (Parameter.datalogEnable == true)
   {
     datalog_EnableFlag = true;
@@ -417,15 +468,20 @@ void EPC_Memory_Read_Room_Record(uint8_t cs_pin, ROOM_RECORD *record, uint32_t i
   uint32_t flash_epc_address = 0UL;
   datalog_EnableFlag = false;
 
+  /* The bank can not change while the record is accessed */
+  k_mutex_lock(&epc_index_mutex, K_FOREVER);
+
   /* Calculate address in flash */
-  flash_epc_address = ROOM_RECORD_REGION + (index * ROOM_RECORD_BYTE_LENGTH);
+  flash_epc_address = ROOM_RECORD_REGION + EPC_database_offset + (index * ROOM_RECORD_BYTE_LENGTH);
 
   /* Read epc tag from flash*/
-  if (flash_epc_address < (ROOM_RECORD_REGION + ROOM_RECORD_REGION_LENGTH))
+  if (flash_epc_address < (ROOM_RECORD_REGION + EPC_database_offset + ROOM_RECORD_REGION_LENGTH))
   {
     flash_read(cs_pin, flash_epc_address, record->room_record_bytes, ROOM_RECORD_BYTE_LENGTH);
   }
 
+  k_mutex_unlock(&epc_index_mutex);
+
   if (Parameter.datalogEnable == true)
   {
     datalog_EnableFlag = true;
@@ -448,15 +504,20 @@ void EPC_Memory_Read_Mop_Record(uint8_t cs_pin, MOP_RECORD *record, uint32_t ind
   uint32_t flash_epc_address = 0UL;
   datalog_EnableFlag = false;
 
+  /* The bank can not change while the record is accessed */
+  k_mutex_lock(&epc_index_mutex, K_FOREVER);
+
   /* Calculate address in flash */
-  flash_epc_address = MOP_RECORD_REGION + (index * MOP_RECORD_BYTE_LENGTH);
+  flash_epc_address = MOP_RECORD_REGION + EPC_database_offset + (index * MOP_RECORD_BYTE_LENGTH);
 
   /* Read epc tag from flash*/
-  if (flash_epc_address < (MOP_RECORD_REGION + MOP_RECORD_REGION_LENGTH))
+  if (flash_epc_address < (MOP_RECORD_REGION + EPC_database_offset + MOP_RECORD_REGION_LENGTH))
   {
     flash_read(cs_pin, flash_epc_address, record->mop_record_bytes, MOP_RECORD_BYTE_LENGTH);
   }
 
+  k_mutex_unlock(&epc_index_mutex);
+
   if (Parameter.datalogEnable == true)
   {
     datalog_EnableFlag = true;
@@ -525,290 +586,834 @@ uint16_t EPC_Memory_GetLastIndex(uint8_t cs_pin, uint32_t memory, uint32_t len,
 }
 
 /**
- * @brief  This function serialize an ASCII string to hex values
- * @details Example Ascii EPC tag string: 3000E280689400004003A1F5B51AA872
- *  Two Ascii digits to one 8-bit nummer
- *  "30"  -> 48
- *  "00"  -> 0
- *  "E2"  -> 226
- *  "80"  -> 128
- *  "68"  -> 104
- *  "94"  -> 148
- *  "00"  -> 0
- *  "00"  -> 0
- *  "40"  -> 64
- *  "03"  -> 3
- *  "A1"  -> 161
- *  "F5"  -> 245
- *  "B5"  -> 181
- *  "1A"  -> 26
- *  "A8"  -> 168
- *  "72"  -> 114
- * @param source: Pointer to source char string array
- * @param dest: Pointer to desition array
- * @param len: Length of source char string array
+ * @brief This function checks the header of a database bank
+ *
+ * @param cs_pin: GPIO number of the cs pin
+ * @param bank: Number of the bank
+ * @param header: Pointer to the header which is read out
+ * @return bool: true if the header is valid
  */
-void SerializeCharToHex(char *source, uint8_t *dest, uint16_t len)
+static bool EPC_Database_ReadHeader(uint8_t cs_pin, uint8_t bank, EPC_DATABASE_HEADER *header)
 {
-  uint8_t i = 0;
-  char snippet[2];
+  flash_read(cs_pin, EPC_DATABASE_HEADER_REGION + (bank * FLASH_SUBSUBSECTOR_SIZE), (uint8_t *)header, sizeof(EPC_DATABASE_HEADER));
+
+  return (header->magic == EPC_DATABASE_MAGIC) && (header->crc == crc32_ieee((uint8_t *)header, offsetof(EPC_DATABASE_HEADER, crc)));
+}
+
+/**
+ * @brief This function makes a database bank the active one and rebuilds the RAM index. Lookups wait on the index mutex, so
+ * they use either the old or the new bank completely.
+ *
+ * @param cs_pin: GPIO number of the cs pin
+ * @param bank: Number of the bank
+ * @param header: Header of the bank, record counts of 0 are replaced by the counts found in flash (bank without header)
+ */
+static void EPC_Database_Activate(uint8_t cs_pin, uint8_t bank, const EPC_DATABASE_HEADER *header)
+{
+  uint32_t offset = bank * EPC_DATABASE_BANK_OFFSET;
+
+  k_mutex_lock(&epc_index_mutex, K_FOREVER);
+
+  epc_database_bank = bank;
+  epc_database_header = *header;
+  EPC_database_offset = offset;
+
+  /* Records added by shell commands behind the records of a DataUpdate are counted as well */
+  EPC_last_rfid_record_index = MAX(header->record_count[EPC_TABLE_RFID], EPC_Memory_GetLastIndex(cs_pin, RFID_RECORD_REGION + offset, RFID_RECORD_REGION_LENGTH, RFID_RECORD_BYTE_LENGTH));
+  EPC_last_room_record_index = MAX(header->record_count[EPC_TABLE_ROOM], EPC_Memory_GetLastIndex(cs_pin, ROOM_RECORD_REGION + offset, ROOM_RECORD_REGION_LENGTH, ROOM_RECORD_BYTE_LENGTH));
+  EPC_last_mop_record_index = MAX(header->record_count[EPC_TABLE_MOP], EPC_Memory_GetLastIndex(cs_pin, MOP_RECORD_REGION + offset, MOP_RECORD_REGION_LENGTH, MOP_RECORD_BYTE_LENGTH));
+
+  EPC_Index_Build(cs_pin, EPC_last_rfid_record_index);
+
+  k_mutex_unlock(&epc_index_mutex);
+}
+
+/**
+ * @brief This function selects the active database bank at boot. It is the bank with the valid header of the highest generation,
+ * without any valid header the databases in bank 0 are used. The record counts of the active bank are set and the RAM index is built.
+ *
+ * @param cs_pin: GPIO number of the cs pin
+ */
+void EPC_Database_Init(uint8_t cs_pin)
+{
+  EPC_DATABASE_HEADER header;
+  EPC_DATABASE_HEADER active_header;
+  uint8_t active_bank = 0;
+  uint8_t bank = 0;
 
-  for (i = 0; i < len; i++)
+  memset(&active_header, 0, sizeof(active_header));
+
+  for (bank = 0; bank < EPC_DATABASE_BANK_COUNT; bank++)
   {
-    strncpy(snippet, (source + (i * 2)), 2);          // Combine two ascii digits to one new ascii string (hex number)
-    *(dest + i) = (uint8_t)strtol(snippet, NULL, 16); // convert the generated hex number string (base 16) to a decimal number (255 max, 8-bit)
+    if ((EPC_Database_ReadHeader(cs_pin, bank, &header) == true) && (header.generation > active_header.generation))
+    {
+      active_header = header;
+      active_bank = bank;
+    }
   }
+
+  EPC_Database_Activate(cs_pin, active_bank, &active_header);
 }
 
 /**
- * @brief This function serialize hex values to an ASCII string and prints it on console
- * @details Example Ascii EPC tag string: 3000E280689400004003A1F5B51AA872
- *  Two Ascii digits to one 8-bit nummer
- *  "30"  <- 48
- *  "00"  <- 0
- *  "E2"  <- 226
- *  "80"  <- 128
- *  "68"  <- 104
- *  "94"  <- 148
- *  "00"  <- 0
- *  "00"  <- 0
- *  "40"  <- 64
- *  "03"  <- 3
- *  "A1"  <- 161
- *  "F5"  <- 245
- *  "B5"  <- 181
- *  "1A"  <- 26
- *  "A8"  <- 168
- *  "72"  <- 114
- * @param source: Pointer to source char string array
- * @param len: Length of source char string array
+ * @brief This function returns the header of the active database bank (generation 0 if the bank has no header)
+ *
+ * @param bank: Pointer to the number of the active bank, can be NULL
+ * @return const EPC_DATABASE_HEADER*: Header of the active bank
  */
-void PrintDeserializeHexToChar(uint8_t *source, uint16_t len)
+const EPC_DATABASE_HEADER *EPC_Database_GetHeader(uint8_t *bank)
 {
-  uint8_t i = 0;
-  uint8_t cross_sum = 0;
+  if (bank != NULL)
+  {
+    *bank = epc_database_bank;
+  }
+  return &epc_database_header;
+}
+
+/**
+ * @brief qsort() comparator for rfid records, sorts by epc
+ */
+int EPC_Database_CompareRfidRecord(const void *a, const void *b)
+{
+  return EPC_Compare(&((const RFID_RECORD *)a)->epc, &((const RFID_RECORD *)b)->epc);
+}
+
+/**
+ * @brief qsort() comparator for room and mop records, sorts by id. Both records start with their 16 bit id.
+ */
+int EPC_Database_CompareId(const void *a, const void *b)
+{
+  uint16_t id_a = 0;
+  uint16_t id_b = 0;
+
+  memcpy(&id_a, a, sizeof(id_a));
+  memcpy(&id_b, b, sizeof(id_b));
+
+  return (int)id_a - (int)id_b;
+}
+
+/**
+ * @brief qsort() comparator for epc_database_order, sorts by the record key and records with the same key by their index
+ */
+static int EPC_Database_CompareOrder(const void *a, const void *b)
+{
+  uint16_t index_a = *(const uint16_t *)a;
+  uint16_t index_b = *(const uint16_t *)b;
+  int cmp = 0;
+
+  cmp = epc_database_order_compare(&epc_database_order_records[index_a * epc_database_order_record_length],
+                                   &epc_database_order_records[index_b * epc_database_order_record_length]);
+  if (cmp == 0)
+  {
+    cmp = (int)index_a - (int)index_b;
+  }
+
+  return cmp;
+}
+
+/**
+ * @brief This function sorts the records of a DataUpdate table into epc_database_order, the records are not moved
+ *
+ * @param records: Records in flash layout
+ * @param count: Number of records, up to EPC_INDEX_MAX_RECORDS
+ * @param record_length: Length of one record
+ * @param compare: Comparator of the record key
+ */
+static void EPC_Database_SortOrder(const uint8_t *records, uint32_t count, uint16_t record_length, int (*compare)(const void *a, const void *b))
+{
+  uint32_t i = 0;
+
+  for (i = 0; i < count; i++)
+  {
+    epc_database_order[i] = i;
+  }
+
+  epc_database_order_records = records;
+  epc_database_order_record_length = record_length;
+  epc_database_order_compare = compare;
+
+  qsort(epc_database_order, count, sizeof(epc_database_order[0]), EPC_Database_CompareOrder);
+}
+
+/**
+ * @brief This function calculates the CRC32 of a memory range in the external flash
+ */
+static uint32_t EPC_Database_FlashCrc(uint8_t cs_pin, uint32_t address, uint32_t length)
+{
+  uint32_t crc = 0UL;
+  uint32_t offset = 0UL;
+  uint32_t chunk_length = 0UL;
+
+  while (offset < length)
+  {
+    chunk_length = MIN(sizeof(epc_database_page), length - offset);
+    flash_read(cs_pin, address + offset, epc_database_page, chunk_length);
+    crc = crc32_ieee_update(crc, epc_database_page, chunk_length);
+    offset += chunk_length;
+  }
+
+  return crc;
+}
+
+/**
+ * @brief This function writes the new rfid record table into a bank. The records are sorted by epc and of records with the same
+ * epc the last one in the message is stored, then the table is written with page writes.
+ *
+ * @param cs_pin: GPIO number of the cs pin
+ * @param address: Start address of the rfid region in the target bank
+ * @param records: Records in flash layout
+ * @param length: Length of the records in bytes
+ * @param crc: Pointer to the resulting CRC32 of the written table
+ * @return int32_t: Number of written records, -1 if the table does not fit into the region
+ */
+static int32_t EPC_Database_WriteRfidTable(uint8_t cs_pin, uint32_t address, const uint8_t *records, uint32_t length, uint32_t *crc)
+{
+  const RFID_RECORD *table = (const RFID_RECORD *)records;
+  uint32_t count = length / RFID_RECORD_BYTE_LENGTH;
+  uint32_t unique = 0;
+  uint32_t page_length = 0UL;
+  uint32_t i = 0;
 
-  // check if stored EPC tag is zero
-  for (i = 0; i < len; i++)
+  *crc = 0UL;
+
+  if (count > EPC_INDEX_MAX_RECORDS)
   {
-    cross_sum += source[i];
+    return -1;
   }
 
-  // Print EPC code to console
-  if (cross_sum > 0)
+  EPC_Database_SortOrder(records, count, RFID_RECORD_BYTE_LENGTH, EPC_Database_CompareRfidRecord);
+
+  for (i = 0; i < count; i++)
   {
-    char _hex[] = "0123456789ABCDEF";
+    /* A later record with the same epc follows */
+    if (((i + 1) < count) && (EPC_Equal(&table[epc_database_order[i]].epc, &table[epc_database_order[i + 1]].epc) == true))
+    {
+      continue;
+    }
+
+    memcpy(&epc_database_page[page_length], &table[epc_database_order[i]], RFID_RECORD_BYTE_LENGTH);
+    page_length += RFID_RECORD_BYTE_LENGTH;
+    unique++;
 
-    // shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "%c%c", _hex[(int)(source[0]) / 16], _hex[(int)(source[0]) % 16]);
-    printf("%c%c", _hex[(int)(source[0]) / 16], _hex[(int)(source[0]) % 16]);
-    for (i = 1; i < len; ++i)
+    if ((page_length == sizeof(epc_database_page)) || ((i + 1) == count))
     {
-      // shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "%c%c", _hex[(int)(source[i]) / 16], _hex[(int)(source[i]) % 16]);
-      printf("%c%c", _hex[(int)(source[i]) / 16], _hex[(int)(source[i]) % 16]);
+      flash_write(cs_pin, address, epc_database_page, page_length);
+      *crc = crc32_ieee_update(*crc, epc_database_page, page_length);
+      address += page_length;
+      page_length = 0UL;
     }
   }
-  else
+
+  if ((unique != count) && (Parameter.debug == true || Parameter.epc_verbose == true))
   {
-    // shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "0");
-    printf("0");
+    rtc_print_debug_timestamp();
+    shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_YELLOW, "%d duplicate rfid records dropped\n", count - unique);
   }
-  // shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, ";");
-  printf(";");
+
+  return unique;
 }
 
 /**
- * @brief This function serialize hex values to an ASCII string
- * @details Example Ascii EPC tag string: 3000E280689400004003A1F5B51AA872
- *  Two Ascii digits to one 8-bit nummer
- *  "30"  <- 48
- *  "00"  <- 0
- *  "E2"  <- 226
- *  "80"  <- 128
- *  "68"  <- 104
- *  "94"  <- 148
- *  "00"  <- 0
- *  "00"  <- 0
- *  "40"  <- 64
- *  "03"  <- 3
- *  "A1"  <- 161
- *  "F5"  <- 245
- *  "B5"  <- 181
- *  "1A"  <- 26
- *  "A8"  <- 168
- *  "72"  <- 114
- * @param source: Pointer to source array
- * @param len: Length of source array
- * @return const char*: Pointer to resulting char array
+ * @brief This function writes a new room or mop record table into a bank. Each record is stored at the index id, like the shell
+ * commands add them and epc_process_tags() reads them. The records are sorted by id, the table is assembled page by page, gaps
+ * keep the erased state. Of records with the same id the last one in the message is stored.
+ *
+ * @param cs_pin: GPIO number of the cs pin
+ * @param address: Start address of the region in the target bank
+ * @param region_length: Length of the region
+ * @param record_length: Length of one record
+ * @param records: Records in flash layout
+ * @param length: Length of the records in bytes
+ * @param crc: Pointer to the resulting CRC32 of the written table
+ * @return int32_t: Number of record slots (highest id + 1), -1 if the table does not fit into the region
  */
-const char *DeserializeHexToChar(uint8_t *source, uint16_t len)
+static int32_t EPC_Database_WriteIdTable(uint8_t cs_pin, uint32_t address, uint32_t region_length, uint16_t record_length, const uint8_t *records, uint32_t length, uint32_t *crc)
 {
-  uint8_t i = 0;
+  uint32_t count = length / record_length;
+  uint32_t table_length = 0UL;
+  uint32_t page_address = 0UL;
+  uint32_t page_length = 0UL;
+  uint32_t record_address = 0UL;
+  uint32_t i = 0;
+  uint16_t id = 0;
 
-  static char string[45];
-  memset(string, 0, 45);
+  *crc = 0UL;
 
-  char _hex[] = "0123456789ABCDEF";
+  if (count == 0)
+  {
+    return 0;
+  }
+
+  if (count > EPC_INDEX_MAX_RECORDS)
+  {
+    return -1;
+  }
+
+  EPC_Database_SortOrder(records, count, record_length, EPC_Database_CompareId);
 
-  for (i = 0; i < len; i++)
+  memcpy(&id, &records[epc_database_order[count - 1] * record_length], sizeof(id));
+  table_length = (id + 1UL) * record_length;
+
+  if (table_length > region_length)
+  {
+    return -1;
+  }
+
+  for (page_address = 0UL; page_address < table_length; page_address += page_length)
   {
-    string[(2 * i)] = _hex[((uint16_t)source[i]) / 16];
-    string[(2 * i) + 1] = _hex[((uint16_t)source[i]) % 16];
+    page_length = MIN(sizeof(epc_database_page), table_length - page_address);
+    memset(epc_database_page, 0xFF, page_length);
+
+    /* Copy all records which belong into this page, a later record with the same id overwrites the earlier one */
+    for (; i < count; i++)
+    {
+      memcpy(&id, &records[epc_database_order[i] * record_length], sizeof(id));
+      record_address = id * record_length;
+
+      if (record_address >= (page_address + page_length))
+      {
+        break;
+      }
+
+      memcpy(&epc_database_page[record_address - page_address], &records[epc_database_order[i] * record_length], record_length);
+    }
+
+    flash_write(cs_pin, address + page_address, epc_database_page, page_length);
+    *crc = crc32_ieee_update(*crc, epc_database_page, page_length);
   }
 
-  return string;
+  return table_length / record_length;
 }
 
 /**
- * @brief This function returns the epc in ASCII format from external flash for a given index number
- * This function talks directly over the SPI bus with the external NOR flash memory. For this it uses the API calls defined in flash.c
+ * @brief This function copies a table of the active bank into the target bank, for tables which are not part of the DataUpdate
  *
  * @param cs_pin: GPIO number of the cs pin
- * @param epc_index: Index number of EPC string to read
- * @return const char*: Returns the pointer epc string array
+ * @param source: Start address of the region in the active bank
+ * @param destination: Start address of the region in the target bank
+ * @param length: Length of the table in bytes
+ * @param crc: Pointer to the resulting CRC32 of the copied table
  */
-const char *EPC_ReadEPCAtFlash_fast(uint8_t cs_pin, uint16_t epc_index)
+static void EPC_Database_CopyTable(uint8_t cs_pin, uint32_t source, uint32_t destination, uint32_t length, uint32_t *crc)
 {
-  RFID_RECORD record;
+  uint32_t offset = 0UL;
+  uint32_t chunk_length = 0UL;
+
+  *crc = 0UL;
 
-  EPC_Memory_Read_RFID_Record_fast(cs_pin, &record, epc_index);
-  return DeserializeHexToChar(record.epc, 20);
+  while (offset < length)
+  {
+    chunk_length = MIN(sizeof(epc_database_page), length - offset);
+    flash_read(cs_pin, source + offset, epc_database_page, chunk_length);
+    flash_write(cs_pin, destination + offset, epc_database_page, chunk_length);
+    *crc = crc32_ieee_update(*crc, epc_database_page, chunk_length);
+    offset += chunk_length;
+  }
 }
 
 /**
- * @brief This function returns the epc in ASCII format from external flash for a given index number
- * This function talks directly over the SPI bus with the external NOR flash memory. For this it uses the API calls defined in flash.c
+ * @brief This function starts an update of the databases. The header of the inactive bank is erased first, so the bank can not
+ * be selected at boot while it is written, then its regions are erased. The tables are written with EPC_Database_FinishTable()
+ * and activated together with EPC_Database_CommitUpdate(). An interrupted update leaves the active bank untouched.
  *
  * @param cs_pin: GPIO number of the cs pin
- * @param epc_index: Index number of EPC string to read
- * @return const char*: Returns the pointer epc string array
  */
-const char *EPC_ReadEPCAtFlash(uint8_t cs_pin, uint16_t epc_index)
+void EPC_Database_BeginUpdate(uint8_t cs_pin)
 {
-  RFID_RECORD record;
+  uint32_t offset = 0UL;
+  uint8_t table = 0;
+
+  epc_database_target_bank = (epc_database_bank + 1) % EPC_DATABASE_BANK_COUNT;
+  epc_database_tables_written = 0;
+
+  memset(&epc_database_pending_header, 0, sizeof(epc_database_pending_header));
+  epc_database_pending_header.magic = EPC_DATABASE_MAGIC;
+  epc_database_pending_header.generation = epc_database_header.generation + 1;
+
+  flash_EraseSector_4kB(cs_pin, EPC_DATABASE_HEADER_REGION + (epc_database_target_bank * FLASH_SUBSUBSECTOR_SIZE));
+
+  /* Erase the complete regions, a sparse room or mop table may have data behind erased sectors */
+  for (table = 0; table < EPC_TABLE_COUNT; table++)
+  {
+    for (offset = 0UL; offset < EPC_database_tables[table].region_length; offset += FLASH_SECTOR_SIZE)
+    {
+      flash_EraseSector_64kB(cs_pin, EPC_Database_GetTargetAddress(table) + offset);
+    }
+  }
+}
+
+/**
+ * @brief This function returns the start address of a table in the active bank, the bank offset is read under the index mutex
+ */
+uint32_t EPC_Database_GetActiveAddress(EPC_TABLE table)
+{
+  uint32_t offset = 0UL;
+
+  k_mutex_lock(&epc_index_mutex, K_FOREVER);
+  offset = EPC_database_offset;
+  k_mutex_unlock(&epc_index_mutex);
+
+  return EPC_database_tables[table].region + offset;
+}
+
+/**
+ * @brief This function returns the start address of a table in the bank which is updated
+ */
+uint32_t EPC_Database_GetTargetAddress(EPC_TABLE table)
+{
+  return EPC_database_tables[table].region + (epc_database_target_bank * EPC_DATABASE_BANK_OFFSET);
+}
+
+/**
+ * @brief This function verifies a table which was written into the updated bank by reading it back
+ *
+ * @param cs_pin: GPIO number of the cs pin
+ * @param table: Table which was written
+ * @param count: Number of records (rfid) or record slots (room, mop), negative if the table could not be written
+ * @param crc: CRC32 of the written table
+ * @return int16_t: 0 if successfull, -1 if failed
+ */
+int16_t EPC_Database_FinishTable(uint8_t cs_pin, EPC_TABLE table, int32_t count, uint32_t crc)
+{
+  if (count < 0)
+  {
+    rtc_print_debug_timestamp();
+    shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Invalid %s table, database not changed\n", EPC_database_tables[table].name);
+    return -1;
+  }
+
+  if (EPC_Database_FlashCrc(cs_pin, EPC_Database_GetTargetAddress(table), count * EPC_database_tables[table].record_length) != crc)
+  {
+    rtc_print_debug_timestamp();
+    shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Verifying %s table in bank %d failed, database not changed\n", EPC_database_tables[table].name, epc_database_target_bank);
+    return -1;
+  }
+
+  epc_database_pending_header.record_count[table] = count;
+  epc_database_tables_written |= BIT(table);
+
+  return 0;
+}
+
+/**
+ * @brief This function completes an update of the databases. Tables which were not written are copied from the active bank, then
+ * the header with the next generation number is written. From then on the updated bank is the active one, also after a reboot.
+ *
+ * @param cs_pin: GPIO number of the cs pin
+ * @param uuid: uuid of the DataUpdate, can be NULL
+ * @param uuid_length: Length of the uuid
+ * @return int16_t: 0 if successfull, -1 if failed
+ */
+int16_t EPC_Database_CommitUpdate(uint8_t cs_pin, const uint8_t *uuid, uint32_t uuid_length)
+{
+  uint16_t active_count[EPC_TABLE_COUNT] = {EPC_last_rfid_record_index, EPC_last_room_record_index, EPC_last_mop_record_index};
+  EPC_DATABASE_HEADER *header = &epc_database_pending_header;
+  uint32_t crc = 0UL;
+  uint8_t table = 0;
+
+  for (table = 0; table < EPC_TABLE_COUNT; table++)
+  {
+    if ((epc_database_tables_written & BIT(table)) == 0)
+    {
+      EPC_Database_CopyTable(cs_pin, EPC_Database_GetActiveAddress(table), EPC_Database_GetTargetAddress(table), active_count[table] * EPC_database_tables[table].record_length, &crc);
+
+      if (EPC_Database_FinishTable(cs_pin, table, active_count[table], crc) != 0)
+      {
+        return -1;
+      }
+    }
+  }
+
+  header->uuid_length = MIN(uuid_length, EPC_DATABASE_UUID_LENGTH);
+  if (uuid != NULL)
+  {
+    memcpy(header->uuid, uuid, header->uuid_length);
+  }
+
+  /* Commit: from now on the target bank is the active one */
+  header->crc = crc32_ieee((uint8_t *)header, offsetof(EPC_DATABASE_HEADER, crc));
+  flash_write(cs_pin, EPC_DATABASE_HEADER_REGION + (epc_database_target_bank * FLASH_SUBSUBSECTOR_SIZE), (uint8_t *)header, sizeof(EPC_DATABASE_HEADER));
+
+  if (EPC_Database_ReadHeader(cs_pin, epc_database_target_bank, header) == false)
+  {
+    rtc_print_debug_timestamp();
+    shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Writing header of bank %d failed, database not changed\n", epc_database_target_bank);
+    return -1;
+  }
+
+  EPC_Database_Activate(cs_pin, epc_database_target_bank, header);
 
-  EPC_Memory_Read_RFID_Record(cs_pin, &record, epc_index);
-  return DeserializeHexToChar(record.epc, 20);
+  rtc_print_debug_timestamp();
+  shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_GREEN, "Database generation %d active in bank %d: %d rfid, %d room, %d mop records\n",
+                header->generation, epc_database_bank, header->record_count[EPC_TABLE_RFID], header->record_count[EPC_TABLE_ROOM], header->record_count[EPC_TABLE_MOP]);
+
+  return 0;
 }
 
 /**
- * @brief This function takes a epc (in ASCII format) and search for it in the external flash memory
+ * @brief This function applies a DataUpdate to the rfid, room and mop databases. The tables are written with page writes into the
+ * inactive bank, verified and activated together (see EPC_Database_BeginUpdate()).
+ *
+ * @param cs_pin: GPIO number of the cs pin
+ * @param update: New content of the databases
+ * @return int16_t: 0 if successfull, -1 if failed
+ */
+int16_t EPC_Database_ApplyUpdate(uint8_t cs_pin, EPC_DATABASE_UPDATE *update)
+{
+  const EPC_TABLE_DESCRIPTOR *descriptor = NULL;
+  uint32_t crc = 0UL;
+  int32_t count = 0;
+  uint8_t table = 0;
+
+  EPC_Database_BeginUpdate(cs_pin);
+
+  for (table = 0; table < EPC_TABLE_COUNT; table++)
+  {
+    descriptor = &EPC_database_tables[table];
+
+    if (update->table[table].records == NULL)
+    {
+      continue;
+    }
+
+    if ((update->table[table].length % descriptor->record_length) != 0)
+    {
+      count = -1;
+    }
+    else if (table == EPC_TABLE_RFID)
+    {
+      count = EPC_Database_WriteRfidTable(cs_pin, EPC_Database_GetTargetAddress(table), update->table[table].records, update->table[table].length, &crc);
+    }
+    else
+    {
+      count = EPC_Database_WriteIdTable(cs_pin, EPC_Database_GetTargetAddress(table), descriptor->region_length, descriptor->record_length, update->table[table].records, update->table[table].length, &crc);
+    }
+
+    if (EPC_Database_FinishTable(cs_pin, table, count, crc) != 0)
+    {
+      return -1;
+    }
+  }
+
+  return EPC_Database_CommitUpdate(cs_pin, update->uuid, update->uuid_length);
+}
+
+/**
+ * @brief This function prints a binary epc as hex string on console, followed by the separator of the data log output
+ * @details A zero epc (no tag) is printed as "0".
+ * @param epc: Pointer to the epc
+ */
+void EPC_PrintHexString(const EPC_BINARY *epc)
+{
+  char epc_string[EPC_HEX_STRING_LENGTH];
+
+  if (EPC_IsZero(epc) == false)
+  {
+    printf("%s;", EPC_ToHexString(epc, epc_string));
+  }
+  else
+  {
+    printf("0;");
+  }
+}
+
+static int EPC_Index_Compare(const void *a, const void *b)
+{
+  uint32_t hash_a = ((const EPC_INDEX_ENTRY *)a)->hash;
+  uint32_t hash_b = ((const EPC_INDEX_ENTRY *)b)->hash;
+
+  if (hash_a != hash_b)
+  {
+    return (hash_a < hash_b) ? -1 : 1;
+  }
+
+  /* Same hash: keep the order of the records in flash */
+  return (int)((const EPC_INDEX_ENTRY *)a)->record_index - (int)((const EPC_INDEX_ENTRY *)b)->record_index;
+}
+
+/**
+ * @brief This function returns the position of the first index entry which has a hash greater or equal to the given one
+ *
+ * @param hash: Hash to search for
+ * @param iterations: Pointer to the iteration counter, can be NULL
+ * @return uint16_t: Position in the index (epc_index_count if all hashes are lower)
+ */
+static uint16_t EPC_Index_LowerBound(uint32_t hash, uint8_t *iterations)
+{
+  uint16_t low = 0;
+  uint16_t high = epc_index_count;
+  uint16_t mid = 0;
+
+  while (low < high)
+  {
+    mid = low + (high - low) / 2;
+
+    if (epc_index[mid].hash < hash)
+    {
+      low = mid + 1;
+    }
+    else
+    {
+      high = mid;
+    }
+
+    if (iterations != NULL)
+    {
+      (*iterations)++;
+    }
+  }
+
+  return low;
+}
+
+/**
+ * @brief This function builds the RAM index of the rfid record database. It is called at boot after the number of stored
+ * records was determined. The records are read in blocks, so building the index of 5000 records needs only a few reads.
+ * If the database does not fit into the index, the lookup falls back to the binary search in the external flash.
+ *
+ * @param cs_pin: GPIO number of the cs pin
+ * @param record_count: Number of stored rfid records
+ */
+void EPC_Index_Build(uint8_t cs_pin, uint16_t record_count)
+{
+  uint16_t record_index = 0;
+  uint16_t block_length = 0;
+  uint16_t i = 0;
+
+  k_mutex_lock(&epc_index_mutex, K_FOREVER);
+
+  epc_index_count = 0;
+  epc_index_valid = false;
+
+  if (record_count > EPC_INDEX_MAX_RECORDS)
+  {
+    k_mutex_unlock(&epc_index_mutex);
+
+    rtc_print_debug_timestamp();
+    shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Rfid record index too small for %d records, searching in flash\n", record_count);
+    return;
+  }
+
+  for (record_index = 0; record_index < record_count; record_index += block_length)
+  {
+    block_length = MIN(EPC_INDEX_BUILD_BLOCK_RECORDS, record_count - record_index);
+
+    flash_read(cs_pin, RFID_RECORD_REGION + EPC_database_offset + (record_index * RFID_RECORD_BYTE_LENGTH), epc_index_build_buffer[0].rfid_record_bytes, block_length * RFID_RECORD_BYTE_LENGTH);
+
+    for (i = 0; i < block_length; i++)
+    {
+      epc_index[epc_index_count].hash = EPC_Hash(&epc_index_build_buffer[i].epc);
+      epc_index[epc_index_count].record_index = record_index + i;
+      epc_index_count++;
+    }
+  }
+
+  qsort(epc_index, epc_index_count, sizeof(EPC_INDEX_ENTRY), EPC_Index_Compare);
+  epc_index_valid = true;
+
+  k_mutex_unlock(&epc_index_mutex);
+}
+
+/**
+ * @brief This function adds a new rfid record to the RAM index. It has to be called after the record was written to flash.
+ *
+ * @param record: Pointer to the new record
+ * @param record_index: Index of the record in the rfid record database
+ */
+void EPC_Index_Add(RFID_RECORD *record, uint16_t record_index)
+{
+  uint32_t hash = EPC_Hash(&record->epc);
+  uint16_t position = 0;
+
+  k_mutex_lock(&epc_index_mutex, K_FOREVER);
+
+  if (epc_index_valid == true)
+  {
+    if (epc_index_count < EPC_INDEX_MAX_RECORDS)
+    {
+      /* Insert behind all entries with the same hash, so the order of the records in flash is kept */
+      position = EPC_Index_LowerBound(hash + 1, NULL);
+      if (hash == UINT32_MAX)
+      {
+        position = epc_index_count;
+      }
+
+      memmove(&epc_index[position + 1], &epc_index[position], (epc_index_count - position) * sizeof(EPC_INDEX_ENTRY));
+      epc_index[position].hash = hash;
+      epc_index[position].record_index = record_index;
+      epc_index_count++;
+    }
+    else
+    {
+      epc_index_valid = false;
+    }
+  }
+
+  k_mutex_unlock(&epc_index_mutex);
+}
+
+/**
+ * @brief This function clears the RAM index after the rfid record database was deleted
+ */
+void EPC_Index_Clear(void)
+{
+  k_mutex_lock(&epc_index_mutex, K_FOREVER);
+  epc_index_count = 0;
+  epc_index_valid = true;
+  k_mutex_unlock(&epc_index_mutex);
+}
+
+/**
+ * @brief This function searches a binary epc in the sorted rfid record database in the external flash memory
  * This function talks directly over the SPI bus with the external NOR flash memory. For this it uses the API calls defined in flash.c
+ * It is only used if the rfid record database does not fit into the RAM index.
  *
  * @param cs_pin:  GPIO number of the cs pin
- * @param epc_value_to_find: Pointer to EPC string which should be searched for
+ * @param epc: Pointer to the binary epc which should be searched for
  * @param epc_list_length: Length of the list
- * @return EPC_BINARY_SERACH_RESULT: Result structure which containes if the string was found and how many iterations it took
+ * @param record: Pointer to data structure where the found record gets stored
+ * @return EPC_BINARY_SERACH_RESULT: Result structure which containes if the epc was found and how many iterations it took
  */
-EPC_BINARY_SERACH_RESULT EPC_BinarySearch(uint8_t cs_pin, char *epc_value_to_find, uint16_t epc_list_length)
+static EPC_BINARY_SERACH_RESULT EPC_BinarySearchAtFlash(uint8_t cs_pin, const EPC_BINARY *epc, uint16_t epc_list_length, RFID_RECORD *record)
 {
-  // Setup binary search result structure
   EPC_BINARY_SERACH_RESULT ret;
+  uint16_t lidx = 0;               // current low index of search interval
+  uint16_t hidx = epc_list_length; // index behind the search interval
+  uint16_t midx = 0;               // middle index of search interval
+  int cmp = 0;
+
   ret.epc_index = 0;
   ret.iterations_made = 0;
   ret.found = 0;
 
-  if (EPC_last_rfid_record_index != 0) // Do not execute the binary search if the rfid record database is empty
+  while (lidx < hidx)
   {
-    // Preload binary search boundaries
-    int16_t lidx = 0;                   // current low index of search interval
-    int16_t hidx = epc_list_length - 1; // top index of search interval
-    int16_t midx = (hidx - lidx) / 2;   // middle index of search interval
-    int16_t m_cmp = 0;
-    int16_t l_cmp = 0;
-    int16_t h_cmp = 0;
+    ret.iterations_made++;
 
-    char read_epc[41];
-    memset(read_epc, 0, 40);
+    midx = lidx + (hidx - lidx) / 2;
+    EPC_Memory_Read_RFID_Record_fast(cs_pin, record, midx);
+    cmp = EPC_Compare(epc, &record->epc);
 
-    // Test if low or high boundary already matches to wanted EPC tag
-    memcpy(read_epc, EPC_ReadEPCAtFlash_fast(cs_pin, lidx), 40);
-    l_cmp = memcmp(epc_value_to_find, read_epc, 40);
-    memcpy(read_epc, EPC_ReadEPCAtFlash_fast(cs_pin, hidx), 40);
-    h_cmp = memcmp(epc_value_to_find, read_epc, 40);
+    if (cmp == 0)
+    { // EPC tag found
+      ret.epc_index = midx;
+      ret.found = 1;
+      break;
+    }
+    else if (cmp < 0)
+    { // epc is lower than current probe in flash memory
+      hidx = midx;
+    }
+    else
+    { // epc is higer than current probe in flash memory
+      lidx = midx + 1;
+    }
+  }
 
-    while (1)
-    {
-      /* Limit iterations to 30 avoid never ending loops */
-      if (ret.iterations_made > 30)
-      {
-        ret.epc_index = midx;
-        ret.found = 0;
-        break;
-      }
-      else
-      {
-        ret.iterations_made++;
-      }
+  return ret;
+}
 
-      if (l_cmp == 0)
-      { // EPC tag found
-        ret.epc_index = lidx;
-        ret.found = 1;
-        break;
-      }
+/**
+ * @brief This function searches a binary epc in the first records of the rfid record database
+ *
+ * @param cs_pin:  GPIO number of the cs pin
+ * @param epc: Pointer to the binary epc
+ * @param epc_list_length: Number of records to search in, records behind are ignored
+ * @param record: Pointer to data structure where the found record gets stored
+ * @return EPC_BINARY_SERACH_RESULT: Result structure which containes if the epc was found and how many iterations it took
+ */
+static EPC_BINARY_SERACH_RESULT EPC_Index_LookupInRange(uint8_t cs_pin, const EPC_BINARY *epc, uint16_t epc_list_length, RFID_RECORD *record)
+{
+  EPC_BINARY_SERACH_RESULT ret;
+  uint32_t hash = EPC_Hash(epc);
+  uint16_t position = 0;
 
-      if (h_cmp == 0)
-      { // EPC tag found
-        ret.epc_index = hidx;
-        ret.found = 1;
-        break;
-      }
+  ret.epc_index = 0;
+  ret.iterations_made = 0;
+  ret.found = 0;
 
-      // Test if current middle index matches to wanted EPC tag
-      midx = lidx + (hidx - lidx) / 2; // subdivision index
-      memcpy(read_epc, EPC_ReadEPCAtFlash_fast(cs_pin, midx), 40);
-      m_cmp = memcmp(epc_value_to_find, read_epc, 40);
+  k_mutex_lock(&epc_index_mutex, K_FOREVER);
 
-      if (m_cmp == 0)
-      { // EPC tag found
-        ret.epc_index = midx;
-        ret.found = 1;
-        break;
-      }
-      else if (m_cmp < 0)
-      { // EPC_value_to_find is lower than current probe in flash memory
-        hidx = midx;
-        memcpy(read_epc, EPC_ReadEPCAtFlash_fast(cs_pin, hidx), 40);
-        h_cmp = memcmp(epc_value_to_find, read_epc, 40);
-      }
-      else if (m_cmp > 0)
-      { // EPC_value_to_find is higer than current probe in flash memory
-        lidx = midx;
-        memcpy(read_epc, EPC_ReadEPCAtFlash_fast(cs_pin, lidx), 40);
-        l_cmp = memcmp(epc_value_to_find, read_epc, 40);
-      }
+  if (epc_index_valid == false)
+  {
+    k_mutex_unlock(&epc_index_mutex);
 
-      if ((lidx + 1) == hidx)
-      {
-        break;
-      }
-    }
+    return EPC_BinarySearchAtFlash(cs_pin, epc, MIN(epc_list_length, EPC_last_rfid_record_index), record);
   }
-  else
+
+  for (position = EPC_Index_LowerBound(hash, &ret.iterations_made); (position < epc_index_count) && (epc_index[position].hash == hash); position++)
   {
-    ret.found = 0;
+    if (epc_index[position].record_index >= epc_list_length)
+    {
+      continue;
+    }
+
+    EPC_Memory_Read_RFID_Record(cs_pin, record, epc_index[position].record_index);
+
+    if (EPC_Equal(&record->epc, epc))
+    {
+      ret.epc_index = epc_index[position].record_index;
+      ret.found = 1;
+      break;
+    }
   }
 
+  k_mutex_unlock(&epc_index_mutex);
+
   return ret;
 }
 
+/**
+ * @brief This function searches a binary epc in the rfid record database and returns the matching record.
+ * @details The hash of the epc is searched in the RAM index. Each record with a matching hash is read from flash and compared
+ * completely, so usually exactly one flash read is needed. If the index is not available, the binary search in flash is used.
+ *
+ * @param cs_pin:  GPIO number of the cs pin
+ * @param epc: Pointer to the binary epc
+ * @param record: Pointer to data structure where the found record gets stored
+ * @return EPC_BINARY_SERACH_RESULT: Result structure which containes if the epc was found and how many iterations it took
+ */
+EPC_BINARY_SERACH_RESULT EPC_Index_Lookup(uint8_t cs_pin, const EPC_BINARY *epc, RFID_RECORD *record)
+{
+  return EPC_Index_LookupInRange(cs_pin, epc, EPC_last_rfid_record_index, record);
+}
+
+/**
+ * @brief This function takes a epc (in ASCII format) and search for it in the rfid record database
+ *
+ * @param cs_pin:  GPIO number of the cs pin
+ * @param epc_value_to_find: Pointer to EPC string which should be searched for
+ * @param epc_list_length: Number of records to search in
+ * @return EPC_BINARY_SERACH_RESULT: Result structure which containes if the string was found and how many iterations it took
+ */
+EPC_BINARY_SERACH_RESULT EPC_BinarySearch(uint8_t cs_pin, char *epc_value_to_find, uint16_t epc_list_length)
+{
+  EPC_BINARY_SERACH_RESULT ret = {0, 0, 0};
+  EPC_BINARY epc;
+  RFID_RECORD record;
+
+  if (EPC_FromHexString(epc_value_to_find, strlen(epc_value_to_find), &epc) == false)
+  {
+    return ret;
+  }
+
+  return EPC_Index_LookupInRange(cs_pin, &epc, epc_list_length, &record);
+}
+
 /**
  * @brief This functions adds rfid record in the "last seen records array". If it is already listed it only updates its timestamp
  *
- * @param epc_new_rfid_record: Pointer to the epc string which should be added
+ * @param epc: Pointer to the epc which should be added
  */
-void EPC_Update_last_seen(char *epc_new_rfid_record)
+void EPC_Update_last_seen(const EPC_BINARY *epc)
 {
   /* Search for EPC in list */
-  volatile uint8_t i = 0;
-  volatile uint8_t found = 0;
-  volatile int8_t rslt = 0;
+  uint8_t i = 0;
+  uint8_t found = 0;
 
   for (i = 0; i < EPC_LAST_SEEN_COUNT; i++)
   {
-    rslt = memcmp(EPC_last_seen_records[i].record.string, epc_new_rfid_record, EPC_LENGTH_MAX);
-
-    if (rslt == 0)
+    if (EPC_Equal(&EPC_last_seen_records[i].epc, epc))
     {
       EPC_last_seen_records[i].timestamp = unixtime_ms;
       EPC_last_seen_records[i].counts++;
@@ -833,7 +1438,7 @@ void EPC_Update_last_seen(char *epc_new_rfid_record)
     }
 
     /* Insert new rfid record at index 0 */
-    memcpy(EPC_last_seen_records[0].record.string, epc_new_rfid_record, EPC_LENGTH_MAX);
+    EPC_last_seen_records[0].epc = *epc;
     EPC_last_seen_records[0].timestamp = unixtime_ms;
     EPC_last_seen_records[0].counts = 1;
 
@@ -853,7 +1458,7 @@ void EPC_Clear_last_seen(void)
 
   for (i = 0; i < EPC_LAST_SEEN_COUNT; i++)
   {
-    strcpy(EPC_last_seen_records[i].record.string, "0");
+    EPC_Clear(&EPC_last_seen_records[i].epc);
     EPC_last_seen_records[i].timestamp = 0LL;
     EPC_last_seen_records[i].counts = 0;
   }
@@ -887,26 +1492,23 @@ void EPC_Sort_last_seen(void)
 }
 
 /**
- * @brief  This function takes a room epc (in ASCII format) adds it in the last seen room id array (if it is not already listed)
+ * @brief  This function takes a room epc adds it in the last seen room id array (if it is not already listed)
  *
- * @param room_wall_epc: Pointer to string which contains the room epc
+ * @param room_wall_epc: Pointer to the room epc
  * @param type: Type number of tag
  * @param id: Tag id number
- * @param length: Length of epc string
+ * @param length: Number of elements in the array
  * @return uint8_t:  0 if epc is already listed, 1 if epc was added
  */
-uint8_t update_last_seen_room_id_array(uint8_t *room_wall_epc, uint8_t type, uint32_t id, uint16_t length)
+uint8_t update_last_seen_room_id_array(const EPC_BINARY *room_wall_epc, uint8_t type, uint32_t id, uint16_t length)
 {
   uint8_t i = 0;
-  int8_t rslt = 0;
   uint8_t listed = false;
 
   /* Search for room wall epc in list */
   for (i = 0; i < length; i++)
   {
-    rslt = memcmp(room_wall_tag_last_seen[i].epc, room_wall_epc, EPC_TOTAL_HEX_LENGTH);
-
-    if (rslt == 0)
+    if (EPC_Equal(&room_wall_tag_last_seen[i].epc, room_wall_epc))
     {
       listed = true;
     }
@@ -915,13 +1517,13 @@ uint8_t update_last_seen_room_id_array(uint8_t *room_wall_epc, uint8_t type, uin
   /* Add array list (FILO) */
   for (i = length - 1; i > 0; i--)
   {
-    memcpy(&room_wall_tag_last_seen[i].epc, &room_wall_tag_last_seen[i - 1].epc, EPC_TOTAL_HEX_LENGTH);
+    room_wall_tag_last_seen[i].epc = room_wall_tag_last_seen[i - 1].epc;
     room_wall_tag_last_seen[i].type = room_wall_tag_last_seen[i - 1].type;
     room_wall_tag_last_seen[i].id = room_wall_tag_last_seen[i - 1].id;
   }
 
   /* Add new tag */
-  memcpy(&room_wall_tag_last_seen[0].epc, room_wall_epc, EPC_TOTAL_HEX_LENGTH);
+  room_wall_tag_last_seen[0].epc = *room_wall_epc;
   room_wall_tag_last_seen[0].type = type;
   room_wall_tag_last_seen[0].id = id;
 
@@ -940,7 +1542,7 @@ void clear_last_seen_room_id_array(uint16_t length)
   /* Clear array list (FILO) */
   for (i = 0; i < length; i++)
   {
-    memset(room_wall_tag_last_seen[i].epc, 0, EPC_TOTAL_HEX_LENGTH);
+    EPC_Clear(&room_wall_tag_last_seen[i].epc);
     room_wall_tag_last_seen[i].type = 0;
     room_wall_tag_last_seen[i].id = 0;
   }
@@ -1135,7 +1737,7 @@ uint8_t room_to_mop_linkage(void)
  */
 void reset_room_to_mop_mapping(void)
 {
-  memset(current_room_to_mop_mapping.current_mop_epc, '0', 20);
+  EPC_Clear(&current_room_to_mop_mapping.current_mop_epc);
   current_room_to_mop_mapping.mop_linked_room_id = 0;
   current_room_to_mop_mapping.current_mop_id = 0;  
   mop_installed = false;
@@ -1170,10 +1772,8 @@ void epc_process_tags(void)
   {
     // shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_MAGENTA, "%d\n", epc_tail_position);
 
-    uint8_t rfid_epc_hex[EPC_TOTAL_HEX_LENGTH];
-    memset(rfid_epc_hex, 0, EPC_TOTAL_HEX_LENGTH);
-
-    SerializeCharToHex((char *)&epc_ring_buffer[epc_tail_position].string, rfid_epc_hex, EPC_TOTAL_HEX_LENGTH);
+    EPC_BINARY rfid_epc = epc_ring_buffer[epc_tail_position];
+    char epc_string[EPC_HEX_STRING_LENGTH];
 
     /* Trigger rfid confirmation led if enabled*/
     if (Parameter.rfid_blink_notification == true)
@@ -1185,14 +1785,14 @@ void epc_process_tags(void)
     if (Parameter.epc_raw_verbose == true)
     {
       // rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_CYAN, "Process: %d, %s\n", epc_tail_position, &epc_ring_buffer[epc_tail_position].string);
+      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_CYAN, "Process: %d, %s\n", epc_tail_position, EPC_ToHexString(&rfid_epc, epc_string));
     }
 
     /* capture initial time stamp */
     start_time = k_cycle_get_32();
 
-    /* Search for rfid record in data base*/
-    binary_search_result = EPC_BinarySearch(GPIO_PIN_FLASH_CS2, &epc_ring_buffer[epc_tail_position].string, EPC_last_rfid_record_index);
+    /* Search for rfid record in data base (the record is read while confirming the match) */
+    binary_search_result = EPC_Index_Lookup(GPIO_PIN_FLASH_CS2, &rfid_epc, &new_rfid_record);
 
     /* capture final time stamp */
     stop_time = k_cycle_get_32();
@@ -1203,14 +1803,11 @@ void epc_process_tags(void)
 
     if (binary_search_result.found == true)
     {
-      /* Read rfid record */
-      EPC_Memory_Read_RFID_Record(GPIO_PIN_FLASH_CS2, &new_rfid_record, binary_search_result.epc_index);
-
       /* Live view on console */
       if (Parameter.binary_search_verbose == true)
       {
         rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_YELLOW, "Binary search result: RFID record index %d, record: %s, type: %d, id: %d", binary_search_result.epc_index, DeserializeHexToChar(new_rfid_record.epc, 20), new_rfid_record.type, new_rfid_record.id);
+        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_YELLOW, "Binary search result: RFID record index %d, record: %s, type: %d, id: %d", binary_search_result.epc_index, EPC_ToHexString(&new_rfid_record.epc, epc_string), new_rfid_record.type, new_rfid_record.id);
         shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_CYAN, " --- iterations: %d, time: %2.2f ms\n", binary_search_result.iterations_made, ((float)nanoseconds_spent / 1000000.0));
       }
 
@@ -1234,8 +1831,7 @@ void epc_process_tags(void)
             System.StatusInputs |= STATUSFLAG_RO;
 
             /* Read room details from room database */
-            EPC_Memory_Read_Room_Record(GPIO_PIN_FLASH_CS2, &new_room_record, new_rfid_record.id - 1);
-            new_room_record.room_id++; // ID is one number greater than index in array
+            EPC_Memory_Read_Room_Record(GPIO_PIN_FLASH_CS2, &new_room_record, new_rfid_record.id); // Room records are stored at the index of their id
 
             /* Print rfid record and room record details if listed in databases */
             if ((Parameter.epc_verbose == true || Parameter.debug == true) && datalog_ReadOutisActive == false)
@@ -1245,15 +1841,15 @@ void epc_process_tags(void)
             }
 
             /* Check room last seen array if this room is listed */
-            room_already_seen_flag = update_last_seen_room_id_array(rfid_epc_hex, new_rfid_record.type, new_rfid_record.id, EPC_LAST_SEEN_COUNT); // returns 1 if room wall tag already exists in array
+            room_already_seen_flag = update_last_seen_room_id_array(&rfid_epc, new_rfid_record.type, new_rfid_record.id, EPC_LAST_SEEN_COUNT); // returns 1 if room wall tag already exists in array
 
             if (room_already_seen_flag == 0)
             {
               /* Create event for cloud and user notification (this is triggered within the event) */
               uint8_t rslt = 0;
 
-              rslt = check_or_add_location_record_in_array(rfid_epc_hex, EPC_TOTAL_HEX_LENGTH);
-              NewEvent0x07(last_seen_location_records_array[rslt].epc, EPC_TOTAL_HEX_LENGTH);
+              rslt = check_or_add_location_record_in_array(&rfid_epc);
+              NewEvent0x07(last_seen_location_records_array[rslt].epc.bytes, EPC_BINARY_LENGTH);
             }
 
             /* Check if user changed room */
@@ -1325,8 +1921,7 @@ void epc_process_tags(void)
             }
 
             /* Read room details from room database */
-            EPC_Memory_Read_Room_Record(GPIO_PIN_FLASH_CS2, &new_room_record, new_rfid_record.id - 1);
-            new_room_record.room_id++; // ID is one number greater than index in array
+            EPC_Memory_Read_Room_Record(GPIO_PIN_FLASH_CS2, &new_room_record, new_rfid_record.id); // Room records are stored at the index of their id
 
             /* Print rfid record and room record details if listed in databases */
             if ((Parameter.epc_verbose == true || Parameter.debug == true) && datalog_ReadOutisActive == false)
@@ -1336,15 +1931,15 @@ void epc_process_tags(void)
             }
 
             /* Check room last seen array if this room is listed */
-            room_already_seen_flag = update_last_seen_room_id_array(rfid_epc_hex, new_rfid_record.type, new_rfid_record.id, EPC_LAST_SEEN_COUNT); // returns 0 if room wall tag already exists in array
+            room_already_seen_flag = update_last_seen_room_id_array(&rfid_epc, new_rfid_record.type, new_rfid_record.id, EPC_LAST_SEEN_COUNT); // returns 0 if room wall tag already exists in array
 
             if (room_already_seen_flag == 0)
             {
               /* Create event for cloud and user notification (this is triggered within the event) */
               uint8_t rslt = 0;
 
-              rslt = check_or_add_location_record_in_array(rfid_epc_hex, EPC_TOTAL_HEX_LENGTH);
-              NewEvent0x07(last_seen_location_records_array[rslt].epc, EPC_TOTAL_HEX_LENGTH);
+              rslt = check_or_add_location_record_in_array(&rfid_epc);
+              NewEvent0x07(last_seen_location_records_array[rslt].epc.bytes, EPC_BINARY_LENGTH);
             }
 
             /* Check if user changed room */
@@ -1360,15 +1955,15 @@ void epc_process_tags(void)
             System.StatusInputs |= STATUSFLAG_RO;
 
             /* Check room last seen array if this room is listed */
-            room_already_seen_flag = update_last_seen_room_id_array(rfid_epc_hex, new_rfid_record.type, new_rfid_record.id, EPC_LAST_SEEN_COUNT); // returns 0 if room wall tag already exists in array
+            room_already_seen_flag = update_last_seen_room_id_array(&rfid_epc, new_rfid_record.type, new_rfid_record.id, EPC_LAST_SEEN_COUNT); // returns 0 if room wall tag already exists in array
 
             if (room_already_seen_flag == 0)
             {
               /* Create event for cloud and user notification (this is triggered within the event) */
               uint8_t rslt = 0;
 
-              rslt = check_or_add_location_record_in_array(rfid_epc_hex, EPC_TOTAL_HEX_LENGTH);
-              NewEvent0x07(last_seen_location_records_array[rslt].epc, EPC_TOTAL_HEX_LENGTH);
+              rslt = check_or_add_location_record_in_array(&rfid_epc);
+              NewEvent0x07(last_seen_location_records_array[rslt].epc.bytes, EPC_BINARY_LENGTH);
             }
 
             /* Check if mop is allowed */
@@ -1397,8 +1992,7 @@ void epc_process_tags(void)
           System.StatusInputs |= STATUSFLAG_RM;
 
           /* Read mop details from room database */
-          EPC_Memory_Read_Mop_Record(GPIO_PIN_FLASH_CS2, &new_mop_record, new_rfid_record.id - 1);
-          new_mop_record.mop_id++; // ID is one number greater than index in array
+          EPC_Memory_Read_Mop_Record(GPIO_PIN_FLASH_CS2, &new_mop_record, new_rfid_record.id); // Mop records are stored at the index of their id
 
           new_advanced_mop_record.mop_color = new_mop_record.mop_color;
           new_advanced_mop_record.mop_id = new_mop_record.mop_id;
@@ -1416,7 +2010,7 @@ void epc_process_tags(void)
             shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Mop id: %d, mop_color: %X, mop_typegroup: %X, mop_size: %d, mop_sides: %d\n", new_mop_record.mop_id, new_mop_record.mop_color, new_mop_record.mop_typegroup, new_mop_record.mop_size, new_mop_record.mop_sides);
           }
 
-          memcpy(current_mob_string_reading, new_rfid_record.epc, 20);
+          current_mop_epc_reading = new_rfid_record.epc;
           break;
 
         default:
@@ -1426,7 +2020,7 @@ void epc_process_tags(void)
     }
 
     /* Prepare tag to store in data log */
-    SerializeCharToHex((char *)&epc_ring_buffer[epc_head_position].string, DataFrame.rfid_record_hex, 20);
+    DataFrame.rfid_epc = rfid_epc;
 
     if (binary_search_result.found == true)
     {
@@ -1468,98 +2062,72 @@ void epc_process_tags(void)
   }
 }
 
-void epc_extract_tags_from_buffer(void)
+/*!
+ *  @brief Puts one epc reported by the RFID response parser into the epc ring buffer
+ *  @param epc_hex: Pointer to the trimmed epc hex digits (without PC and CRC), no termination needed
+ *  @param length: Number of hex digits
+ *  @param rssi: Signal strength reported by the reader, RFID_RSSI_NONE if the reader did not send one
+ */
+void epc_store_tag(const char *epc_hex, uint8_t length, int16_t rssi)
 {
-  if (uart1_TransmissionLength > 0)
+  /* Set write position (head) in ring buffer */
+  if ((epc_head_position + 1) != epc_tail_position) // if (head + 1) is equal to tail -> the buffer is full
   {
-    /* Step through uart1_InputBuffer and extract epc tag strings. The rule is:
-    epc tag string starts with a <LF> (0x0A, \n) first character and stop with a
-    <CR><LF>.(0x0D 0x0A, \r\n)*/
-
-    for (int i = 0; i < uart1_TransmissionLength; i++)
+    if (epc_head_position >= (EPC_RING_BUFFER_SIZE - 1))
     {
-      /* Start of epc tag string */
-      if (uart1_InputBuffer[i] == '\n')
-      {
-        epc_string_start_flag = true;
-        j = 0;
-      }
-
-      /* End of epc tag string */
-      if ((epc_string_start_flag == true) && (uart1_InputBuffer[i] == '\r') && (uart1_InputBuffer[i + 1] == '\n'))
-      {
-        epc_string_end_flag = true;
-        epc_string_start_flag = false;
-
-        if (Parameter.rfid_verbose == true)
-        {
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_YELLOW, "%s\n", epc_extracted_last);
-        }
-
-        epc_length = strlen(epc_extracted_last);
-
-        /* Set write position (head) in ring buffer */
-        if ((epc_head_position + 1) != epc_tail_position) // if (head + 1) is equal to tail -> the buffer is full
-        {
-          if (epc_head_position >= (EPC_RING_BUFFER_SIZE - 1))
-          {
-            epc_head_position = 0;
-          }
-        }
-        else
-        {
-          if (Parameter.epc_raw_verbose == true)
-          {
-            shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "epc ring buffer is full\n");
-          }
-        }
-
-        /* Set each element of restulting string to "0" */
-        memset(&epc_ring_buffer[epc_head_position].string, '0', EPC_STRING_LENGTH);
-
-        /* Incomming EPC data has to be trimmed. The rule: take the string (length: epc_length), cut of the first 4 bytes (incoming "PC"), cut of the last 4 bytes and take the middle content
-           as the EPC string. The resulting string has to be 20 bytes long. */
-        if ((epc_length <= EPC_STRING_LENGTH) && (epc_length > (EPC_CUT_OFF_START + EPC_CUT_OFF_END)))
-        {
-          /* Push the trimmed epc tag into the ring buffer */
-          memcpy(&epc_ring_buffer[epc_head_position].string[(EPC_STRING_LENGTH - 1) - (epc_length - (EPC_CUT_OFF_START + EPC_CUT_OFF_END))], &epc_extracted_last[EPC_CUT_OFF_START], (epc_length - (EPC_CUT_OFF_START + EPC_CUT_OFF_END)));
-          epc_ring_buffer[epc_head_position].string[EPC_STRING_LENGTH - 1] = 0;
+      epc_head_position = 0;
+    }
+  }
+  else
+  {
+    if (Parameter.epc_raw_verbose == true)
+    {
+      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "epc ring buffer is full\n");
+    }
+  }
 
-          if (Parameter.epc_raw_verbose == true)
-          {
-            shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_YELLOW, "New tag: %d, %d, %d, %s\n", epc_total_tag_counter, epc_session_tag_counter, epc_head_position, epc_ring_buffer[epc_head_position].string);
-          }
+  /* The epc is converted to the binary epc right away, right aligned and padded with leading zeros */
+  if (EPC_FromHexString(epc_hex, length, &epc_ring_buffer[epc_head_position]) == true)
+  {
+    if (Parameter.epc_raw_verbose == true)
+    {
+      char epc_string[EPC_HEX_STRING_LENGTH];
 
-          /* Update last seen array */
-          EPC_Update_last_seen((char *)&epc_ring_buffer[epc_head_position].string);
+      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_YELLOW, "New tag: %d, %d, %d, %s, rssi: %d\n", epc_total_tag_counter, epc_session_tag_counter, epc_head_position, EPC_ToHexString(&epc_ring_buffer[epc_head_position], epc_string), rssi);
+    }
 
-          epc_total_tag_counter++;   // Counts every tag scaned since boot
-          epc_session_tag_counter++; // Counts every tag which was seen since the last motion detection (within the imu motion reset time)
-          epc_head_position++;       // Counts the number of tags in thw queue which are not yet search in the database (binary search)
-        }
+    /* Update last seen array */
+    EPC_Update_last_seen(&epc_ring_buffer[epc_head_position]);
 
-        memset(epc_extracted_last, 0, sizeof(epc_extracted_last));
-      }
+    epc_total_tag_counter++;   // Counts every tag scaned since boot
+    epc_session_tag_counter++; // Counts every tag which was seen since the last motion detection (within the imu motion reset time)
+    epc_head_position++;       // Counts the number of tags in thw queue which are not yet search in the database (binary search)
 
-      /* Extract epc from input buffer */
-      if (epc_string_start_flag == true)
-      {
-        if (j < EPC_STRING_LENGTH)
-        {
-          if ((uart1_InputBuffer[i] != '\r') && (uart1_InputBuffer[i] != '\n') && (uart1_InputBuffer[i] != 'X') && (uart1_InputBuffer[i] != 'U'))
-          {
-            epc_extracted_last[j++] = uart1_InputBuffer[i];
-          }
-        }
-      }
-    }
+    epc_new_tags_stored = true;
+  }
+}
 
-    /* Clear input buffer */
-    memset(uart1_InputBuffer, 0, sizeof(uart1_InputBuffer));
-    uart1_TransmissionLength = 0;
+/*!
+ *  @brief Wakes up the epc thread if tags were stored since the last call. Called by the RFID response parser after it has parsed a
+ *  received chunk, so all tags of one multi read cycle are processed as one batch.
+ */
+void epc_signal_new_tags(void)
+{
+  if (epc_new_tags_stored == true)
+  {
+    epc_new_tags_stored = false;
+    k_sem_give(&epc_new_tags_sem);
   }
 }
 
+/*!
+ *  @brief Returns true if tags in the epc ring buffer wait for processing
+ */
+bool epc_tags_pending(void)
+{
+  return (epc_head_position != epc_tail_position);
+}
+
 /*!
  *  @brief This is the function description
  */
@@ -1576,15 +2144,15 @@ void bubblesort(LAST_SEEN_TAG array[], uint16_t length)
       {
         tmp.counts = array[j].counts;
         tmp.timestamp = array[j].timestamp;
-        memcpy(&tmp.record, &array[j].record, sizeof(array[j].record));
+        tmp.epc = array[j].epc;
 
         array[j].counts = array[j + 1].counts;
         array[j].timestamp = array[j + 1].timestamp;
-        memcpy(&array[j].record, &array[j + 1].record, sizeof(array[j + 1].record));
+        array[j].epc = array[j + 1].epc;
 
         array[j + 1].counts = tmp.counts;
         array[j + 1].timestamp = tmp.timestamp;
-        memcpy(&array[j + 1].record, &tmp.record, sizeof(tmp.record));
+        array[j + 1].epc = tmp.epc;
       }
     }
   }
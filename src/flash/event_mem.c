@@ -14,104 +14,396 @@
 
 EVENT_LIST_OF_OUTSOURCED_MESSAGES Event_ListOfOutsourcedMessages[EVENT_MAX_OUTSOURCED_MESSAGES];
 uint32_t Event_NumberOfOutsourcedMessages = 0;
-uint32_t Event_flash_write_head = 0UL;
+uint32_t Event_flash_write_head = 0UL; // Offset of the sector where the next journal record starts
+uint32_t Event_journal_sequence = 1UL; // Sequence number of the next journal record
 uint8_t event_clearing_in_progress = false;
+EVENT_QUEUE_STATISTICS Event_QueueStatistics;
+
+/* ProtobufCBuffer which streams a serialized message page by page into the event memory */
+typedef struct
+{
+    ProtobufCBuffer base;
+    uint32_t address;    // Flash address of the next page write
+    uint32_t length;     // Bytes streamed so far
+    uint32_t max_length; // Reserved space in the journal record
+    uint32_t crc;        // CRC32 (IEEE) of the streamed bytes
+    uint16_t fill;       // Bytes in the page buffer
+    bool overflow;       // Message was longer than reserved
+    uint8_t page[FLASH_PAGE_SIZE];
+} EVENT_FLASH_BUFFER;
 
 /*!
- * @brief This functions writes a complete data frame (structe) in the external flash.
- * @note This function talks directly over the SPI bus with the external NOR flash memory. For this it uses the API calls defined in flash.c
- * @see flash.c
+ * @brief This function reports a segment which could not be queued and prints the reason
+ * @details The events are only lost if the event array in RAM is full, because the caller has to clear it then. Otherwise they stay
+ * in RAM and are stored with the next try.
+ * @param count: Number of events in the segment
+ * @param counter: Pointer to the loss counter of the reason
+ * @param reason: Text for the debug output
  */
-void Event_StorePackedUsageObjectToFlash(void)
+static void Event_StoreFailed(uint32_t count, uint32_t *counter, const char *reason)
 {
-    uint8_t *payload = NULL;
-    uint32_t len = 0;
+    rtc_print_debug_timestamp();
+
+    if (count >= EVENT_MAX_ITEMS_IN_ARRAY)
+    {
+        *counter += count;
+        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "%s, %d events lost\n", reason, count);
+    }
+    else
+    {
+        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "%s, %d events stay in RAM\n", reason, count);
+    }
+}
+
+/*!
+ * @brief This function returns the number of bytes a journal record occupies in the event memory (always whole sectors)
+ * @param length: Length of the payload
+ */
+static uint32_t Event_JournalRecordSize(uint32_t length)
+{
+    return ((sizeof(EVENT_JOURNAL_HEADER) + length + EVENT_JOURNAL_SECTOR_SIZE - 1) / EVENT_JOURNAL_SECTOR_SIZE) * EVENT_JOURNAL_SECTOR_SIZE;
+}
 
-    /* Pack UsageObject inlcuding all events in a protobuf object */
-    len = protobuf_EncodeUsageUpdateObject(&payload); // payload holds the packed protobuf message
+/*!
+ * @brief This function calculates the CRC32 of a payload which is stored in the event memory
+ * @param address: Offset of the payload in the event memory
+ * @param length: Length of the payload
+ */
+static uint32_t Event_JournalPayloadCrc(uint32_t address, uint32_t length)
+{
+    uint8_t chunk[EVENT_JOURNAL_CRC_CHUNK_SIZE];
+    uint32_t crc = 0UL;
+    uint32_t offset = 0UL;
+    uint32_t chunk_length = 0UL;
 
-    /* Write data to flash */
-    if (len > 0)
+    while (offset < length)
     {
-        if (Event_NumberOfOutsourcedMessages < EVENT_MAX_OUTSOURCED_MESSAGES)
-        {
-            if (Parameter.events_verbose)
-            {
-                rtc_print_debug_timestamp();             
-                shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_YELLOW, "Packing (protobuf) and outsourcing local event array in RAM to external flash memory. Length: %d bytes\n", len);         
-            }
+        chunk_length = MIN(sizeof(chunk), length - offset);
+        flash_read(GPIO_PIN_FLASH_CS1, EVENT_MEM + address + offset, chunk, chunk_length);
+        crc = crc32_ieee_update(crc, chunk, chunk_length);
+        offset += chunk_length;
+    }
 
-            if (Event_flash_write_head < (EVENT_MEM + EVENT_MEM_LENGTH))
-            {
-                /* Erase sector if the address points to the first element of the sector */
-                if (!(EVENT_MEM + Event_flash_write_head) % FLASH_SUBSUBSECTOR_SIZE)
-                {
-                    flash_EraseSector_64kB(GPIO_PIN_FLASH_CS1, EVENT_MEM + Event_flash_write_head); 
-
-                    if (Parameter.events_verbose)
-                    {
-                        rtc_print_debug_timestamp();
-                        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Flash sector erase. Adress: 0x%X\n", Event_flash_write_head);
-                    }
-                }
-                flash_write(GPIO_PIN_FLASH_CS1, EVENT_MEM + Event_flash_write_head, payload, len);
-            }
-            else
-            {
-                rtc_print_debug_timestamp();
-                shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Event flash memory is full.");
-            }
+    return crc;
+}
 
-            /* Store outsourced message information in list array */
-            Event_NumberOfOutsourcedMessages++;
-            Event_ListOfOutsourcedMessages[Event_NumberOfOutsourcedMessages - 1].start_address = Event_flash_write_head;
-            Event_ListOfOutsourcedMessages[Event_NumberOfOutsourcedMessages - 1].length = len;
+/*!
+ * @brief This function finds the offset for a new journal record of the given size without overwriting unsent records
+ * @details The journal is a ring buffer, the unsent records lie between the oldest record in the list and the write head.
+ * A record never wraps around the end of the event memory.
+ * @param size: Size of the record in bytes (whole sectors)
+ * @param address: Pointer to the resulting offset
+ * @return bool: false if there is not enough free space
+ */
+static bool Event_JournalAllocate(uint32_t size, uint32_t *address)
+{
+    uint32_t tail = 0UL;
 
-            if (Parameter.events_verbose)
-            {
-                rtc_print_debug_timestamp();
-                shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_YELLOW, "Outsourced messages: %d, start addr: 0x%X, length: %d\n", Event_NumberOfOutsourcedMessages, EVENT_MEM + Event_ListOfOutsourcedMessages[Event_NumberOfOutsourcedMessages - 1].start_address, Event_ListOfOutsourcedMessages[Event_NumberOfOutsourcedMessages - 1].length);
-            }
+    if (Event_NumberOfOutsourcedMessages == 0)
+    {
+        *address = ((Event_flash_write_head + size) > EVENT_JOURNAL_SIZE) ? 0UL : Event_flash_write_head;
+        return (size <= EVENT_JOURNAL_SIZE);
+    }
+
+    tail = Event_ListOfOutsourcedMessages[0].start_address;
+
+    /* Free space is behind the write head up to the end of the memory and from the beginning of the memory up to the oldest record */
+    if (Event_flash_write_head > tail)
+    {
+        if ((Event_flash_write_head + size) <= EVENT_JOURNAL_SIZE)
+        {
+            *address = Event_flash_write_head;
+            return true;
         }
-        else
+
+        if (size <= tail)
         {
-            if (Parameter.events_verbose)
-            {
-                rtc_print_debug_timestamp();
-                shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Reached maximum number of %d outsourced messages", EVENT_MAX_OUTSOURCED_MESSAGES);
-            }
+            *address = 0UL;
+            return true;
         }
 
-        /* Update address in flash for next write cycle */
-        Event_flash_write_head += (len + 1);
+        return false;
+    }
+
+    /* The unsent records wrap around the end of the memory, free space is only between the write head and the oldest record */
+    if ((Event_flash_write_head + size) <= tail)
+    {
+        *address = Event_flash_write_head;
+        return true;
+    }
+
+    return false;
+}
+
+/*!
+ * @brief Append function of the flash stream buffer, collects the serialized bytes in one flash page and writes full pages
+ * @details Bytes beyond the reserved record size are dropped and mark the buffer as overflowed
+ */
+static void Event_FlashBufferAppend(ProtobufCBuffer *buffer, size_t len, const uint8_t *data)
+{
+    EVENT_FLASH_BUFFER *flash_buffer = CONTAINER_OF(buffer, EVENT_FLASH_BUFFER, base);
+    size_t chunk = 0;
+
+    if ((flash_buffer->length + len) > flash_buffer->max_length)
+    {
+        flash_buffer->overflow = true;
+        return;
+    }
+
+    flash_buffer->crc = crc32_ieee_update(flash_buffer->crc, data, len);
+    flash_buffer->length += len;
+
+    while (len > 0)
+    {
+        chunk = MIN(len, sizeof(flash_buffer->page) - flash_buffer->fill);
+        memcpy(&flash_buffer->page[flash_buffer->fill], data, chunk);
+        flash_buffer->fill += chunk;
+        data += chunk;
+        len -= chunk;
 
-        /* Free the allocated serialized buffer */
-        free(payload);
+        if (flash_buffer->fill == sizeof(flash_buffer->page))
+        {
+            flash_write(GPIO_PIN_FLASH_CS1, flash_buffer->address, flash_buffer->page, flash_buffer->fill);
+            flash_buffer->address += flash_buffer->fill;
+            flash_buffer->fill = 0;
+        }
     }
 }
 
 /*!
- * @brief This functions reads event objects from the external flash memory and prints it on console.
+ * @brief This function appends the packed event array (one segment) and the current DeviceStatus as journal record to the external flash.
+ * @details The protobuf message is streamed page by page into the flash, so it never has to be in RAM completely. The payload is
+ * written before the header, so a record is only found at boot when it was written completely. The sectors of the record are erased
+ * right before they are written. Takes event_mutex, so no event is added or cleared while the array is packed.
  * @note This function talks directly over the SPI bus with the external NOR flash memory. For this it uses the API calls defined in flash.c
  * @see flash.c
+ * @return bool: true if the segment is in the journal and the event array can be cleared, false if the events are still only in RAM
  */
-uint8_t Event_ReadFromFlash(uint32_t address, uint32_t length, uint8_t **buf)
+bool Event_StorePackedUsageObjectToFlash(void)
 {
-    uint8_t *memory = NULL;
+    static EVENT_FLASH_BUFFER flash_buffer;
+    EVENT_JOURNAL_HEADER header;
+    uint32_t len = 0;
+    uint32_t address = 0UL;
+    uint32_t size = 0UL;
+    uint32_t offset = 0UL;
+    uint32_t events = 0UL;
+
+    k_mutex_lock(&event_mutex, K_FOREVER);
 
-    memory = malloc(length);
+    events = Event_ItemsInArray;
 
-    if (memory != NULL)
+    if (Event_NumberOfOutsourcedMessages >= EVENT_MAX_OUTSOURCED_MESSAGES)
     {
-        flash_read(GPIO_PIN_FLASH_CS1, EVENT_MEM + address, memory, length);
-        *buf = memory;
-        return true;
+        Event_StoreFailed(events, &Event_QueueStatistics.lost_list_full, "Reached maximum number of outsourced messages");
+        k_mutex_unlock(&event_mutex);
+        return false;
     }
-    else
+
+    /* Link and update UsageObject inlcuding all events, the packed size is needed to reserve the sectors */
+    len = protobuf_PrepareUsageUpdateObject();
+    size = Event_JournalRecordSize(len);
+
+    if (Event_JournalAllocate(size, &address) == false)
     {
+        Event_StoreFailed(events, &Event_QueueStatistics.lost_flash_full, "Event flash memory is full");
+        k_mutex_unlock(&event_mutex);
         return false;
     }
- }
+
+    if (Parameter.events_verbose)
+    {
+        rtc_print_debug_timestamp();
+        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_YELLOW, "Packing (protobuf) and outsourcing local event array in RAM to external flash memory. Length: %d bytes\n", len);
+    }
+
+    for (offset = 0UL; offset < size; offset += EVENT_JOURNAL_SECTOR_SIZE)
+    {
+        flash_EraseSector_4kB(GPIO_PIN_FLASH_CS1, EVENT_MEM + address + offset);
+    }
+
+    /* Stream the protobuf message into the flash */
+    flash_buffer.base.append = Event_FlashBufferAppend;
+    flash_buffer.address = EVENT_MEM + address + sizeof(EVENT_JOURNAL_HEADER);
+    flash_buffer.max_length = size - sizeof(EVENT_JOURNAL_HEADER);
+    flash_buffer.length = 0UL;
+    flash_buffer.crc = 0UL;
+    flash_buffer.fill = 0;
+    flash_buffer.overflow = false;
+
+    protobuf_EncodeUsageUpdateObject(&flash_buffer.base);
+
+    if (flash_buffer.fill > 0)
+    {
+        flash_write(GPIO_PIN_FLASH_CS1, flash_buffer.address, flash_buffer.page, flash_buffer.fill);
+    }
+
+    /* The event array changed while it was packed, the record is not valid without header */
+    if ((flash_buffer.overflow == true) || (flash_buffer.length == 0))
+    {
+        Event_StoreFailed(events, &Event_QueueStatistics.lost_pack_error, "Could not pack the event array");
+        k_mutex_unlock(&event_mutex);
+        return false;
+    }
+
+    header.magic = EVENT_JOURNAL_MAGIC;
+    header.sequence = Event_journal_sequence;
+    header.length = flash_buffer.length;
+    header.crc = flash_buffer.crc;
+    header.ack = EVENT_JOURNAL_ACK_PENDING;
+
+    flash_write(GPIO_PIN_FLASH_CS1, EVENT_MEM + address, (uint8_t *)&header, sizeof(EVENT_JOURNAL_HEADER));
+
+    /* Store outsourced message information in list array */
+    Event_ListOfOutsourcedMessages[Event_NumberOfOutsourcedMessages].start_address = address;
+    Event_ListOfOutsourcedMessages[Event_NumberOfOutsourcedMessages].length = flash_buffer.length;
+    Event_ListOfOutsourcedMessages[Event_NumberOfOutsourcedMessages].sequence = Event_journal_sequence;
+    Event_NumberOfOutsourcedMessages++;
+
+    Event_QueueStatistics.spilled_segments++;
+    Event_QueueStatistics.spilled_events += events;
+
+    if (Parameter.events_verbose)
+    {
+        rtc_print_debug_timestamp();
+        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_YELLOW, "Outsourced messages: %d, journal record: %d, start addr: 0x%X, length: %d\n", Event_NumberOfOutsourcedMessages, Event_journal_sequence, EVENT_MEM + address, flash_buffer.length);
+    }
+
+    /* Update address in flash for next write cycle */
+    Event_flash_write_head = address + size;
+    Event_journal_sequence++;
+
+    k_mutex_unlock(&event_mutex);
+    return true;
+}
+
+/*!
+ * @brief This function marks the oldest outsourced messages as acknowledged after the cloud confirmed them and removes them from the list.
+ * @details The ack word in the record header is cleared (bits can be programmed to 0 without an erase), so the record is not sent again
+ * after a reboot. The sectors of the record are free for new records from now on.
+ * @param count: Number of sent messages (counted from the oldest one)
+ */
+void Event_AcknowledgeOutsourcedMessages(uint32_t count)
+{
+    uint32_t i = 0;
+    uint32_t ack = EVENT_JOURNAL_ACK_DONE;
+
+    k_mutex_lock(&event_mutex, K_FOREVER);
+
+    if (count > Event_NumberOfOutsourcedMessages)
+    {
+        count = Event_NumberOfOutsourcedMessages;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        flash_write(GPIO_PIN_FLASH_CS1, EVENT_MEM + Event_ListOfOutsourcedMessages[i].start_address + offsetof(EVENT_JOURNAL_HEADER, ack), (uint8_t *)&ack, sizeof(ack));
+    }
+
+    memmove(&Event_ListOfOutsourcedMessages[0], &Event_ListOfOutsourcedMessages[count], (Event_NumberOfOutsourcedMessages - count) * sizeof(EVENT_LIST_OF_OUTSOURCED_MESSAGES));
+    Event_NumberOfOutsourcedMessages -= count;
+    Event_QueueStatistics.sent_segments += count;
+
+    k_mutex_unlock(&event_mutex);
+}
+
+/*!
+ * @brief This function rebuilds the list of unsent messages from the journal in the external flash after a reboot.
+ * @details Records always start at a sector boundary, so only the first bytes of each sector are read. Records which were not
+ * acknowledged and have a valid CRC are queued again in the order of their sequence numbers. The write head is placed behind the newest record.
+ * Takes event_mutex, the list and the write head are shared with the event and cloud threads.
+ */
+void Event_JournalRecover(void)
+{
+    EVENT_JOURNAL_HEADER header;
+    EVENT_LIST_OF_OUTSOURCED_MESSAGES entry;
+    uint32_t address = 0UL;
+    uint32_t newest_sequence = 0UL;
+    uint32_t newest_end = 0UL;
+    uint32_t i = 0;
+    uint32_t j = 0;
+
+    k_mutex_lock(&event_mutex, K_FOREVER);
+
+    Event_NumberOfOutsourcedMessages = 0;
+
+    while (address < EVENT_JOURNAL_SIZE)
+    {
+        flash_read(GPIO_PIN_FLASH_CS1, EVENT_MEM + address, (uint8_t *)&header, sizeof(EVENT_JOURNAL_HEADER));
+
+        if ((header.magic != EVENT_JOURNAL_MAGIC) || (header.length == 0) || ((address + Event_JournalRecordSize(header.length)) > EVENT_JOURNAL_SIZE))
+        {
+            address += EVENT_JOURNAL_SECTOR_SIZE;
+            continue;
+        }
+
+        if (header.sequence >= newest_sequence)
+        {
+            newest_sequence = header.sequence;
+            newest_end = address + Event_JournalRecordSize(header.length);
+        }
+
+        if (header.ack == EVENT_JOURNAL_ACK_PENDING)
+        {
+            if (Event_JournalPayloadCrc(address + sizeof(EVENT_JOURNAL_HEADER), header.length) != header.crc)
+            {
+                Event_QueueStatistics.lost_corrupt++;
+            }
+            else if (Event_NumberOfOutsourcedMessages < EVENT_MAX_OUTSOURCED_MESSAGES)
+            {
+                Event_ListOfOutsourcedMessages[Event_NumberOfOutsourcedMessages].start_address = address;
+                Event_ListOfOutsourcedMessages[Event_NumberOfOutsourcedMessages].length = header.length;
+                Event_ListOfOutsourcedMessages[Event_NumberOfOutsourcedMessages].sequence = header.sequence;
+                Event_NumberOfOutsourcedMessages++;
+            }
+        }
+
+        address += Event_JournalRecordSize(header.length);
+    }
+
+    /* Sort the unsent records by their sequence number (oldest first), the list is almost sorted after a ring buffer wrap */
+    for (i = 1; i < Event_NumberOfOutsourcedMessages; i++)
+    {
+        entry = Event_ListOfOutsourcedMessages[i];
+
+        for (j = i; (j > 0) && (Event_ListOfOutsourcedMessages[j - 1].sequence > entry.sequence); j--)
+        {
+            Event_ListOfOutsourcedMessages[j] = Event_ListOfOutsourcedMessages[j - 1];
+        }
+        Event_ListOfOutsourcedMessages[j] = entry;
+    }
+
+    Event_flash_write_head = (newest_end < EVENT_JOURNAL_SIZE) ? newest_end : 0UL;
+    Event_journal_sequence = newest_sequence + 1;
+    Event_QueueStatistics.recovered_segments = Event_NumberOfOutsourcedMessages;
+
+    k_mutex_unlock(&event_mutex);
+
+    rtc_print_debug_timestamp();
+    shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Recovered %d unsent event messages from flash memory\n", Event_NumberOfOutsourcedMessages);
+}
+
+/*!
+ * @brief Read function of the payload source, reads a part of the payload of a journal record from the external flash memory
+ */
+static void Event_ReadPayload(const COAP_PAYLOAD_SOURCE *source, uint32_t offset, uint8_t *data, uint16_t len)
+{
+    const EVENT_LIST_OF_OUTSOURCED_MESSAGES *message = source->context;
+
+    flash_read(GPIO_PIN_FLASH_CS1, EVENT_MEM + message->start_address + sizeof(EVENT_JOURNAL_HEADER) + offset, data, len);
+}
+
+/*!
+ * @brief This function creates a payload source to send a journal record block by block to the cloud without loading it into RAM.
+ * @param message: Outsourced message, has to stay valid until the payload was sent
+ * @param source: Pointer to the payload source which is filled
+ */
+void Event_GetPayloadSource(const EVENT_LIST_OF_OUTSOURCED_MESSAGES *message, COAP_PAYLOAD_SOURCE *source)
+{
+    source->length = message->length;
+    source->read = Event_ReadPayload;
+    source->context = message;
+}
 
 /*!
  * @brief This functions clears the event memory in the external flash and reset the write address.
@@ -120,10 +412,13 @@ uint8_t Event_ReadFromFlash(uint32_t address, uint32_t length, uint8_t **buf)
  */
 void Event_ClearCompleteFlash(void)
 {
+    k_mutex_lock(&event_mutex, K_FOREVER);
     event_clearing_in_progress = true;
 
     flash_ClearMemAll(GPIO_PIN_FLASH_CS1, EVENT_MEM, EVENT_MEM_LENGTH);
     Event_flash_write_head = 0UL;
+    Event_NumberOfOutsourcedMessages = 0;
 
     event_clearing_in_progress = false;
+    k_mutex_unlock(&event_mutex);
  }
\ No newline at end of file
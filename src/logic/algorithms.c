@@ -17,27 +17,27 @@
 // a vector to keep the last Nf=10 samples (one sample every 50ms)
 
 /* Create variables and arrays */
-float Accx_Nfvec[NF];
-float Accy_Nfvec[NF];
-float Accz_Nfvec[NF];
+WINDOW Accx_Nfvec;
+WINDOW Accy_Nfvec;
+WINDOW Accz_Nfvec;
 
-float Gyrx_Nfvec[NF];
-float Gyry_Nfvec[NF];
-float Gyrz_Nfvec[NF];
+WINDOW Gyrx_Nfvec;
+WINDOW Gyry_Nfvec;
+WINDOW Gyrz_Nfvec;
 
-float Magx_Nfvec[NF];
-float Magy_Nfvec[NF];
-float Magz_Nfvec[NF];
+WINDOW Magx_Nfvec;
+WINDOW Magy_Nfvec;
+WINDOW Magz_Nfvec;
 
-float Acc_dcNfvec[NF];
-float Acc_acvec[NF];
-float Acc_acfvec[NF];
+WINDOW Acc_dcNfvec;
+WINDOW Acc_acvec;
+WINDOW Acc_acfvec;
 
-float Gyr_fx_thr_Nfvec[NF];
-float Gyr_fy_thr_Nfvec[NF];
-float Gyr_fz_thr_Nfvec[NF];
-float Gyrx_acvec[NF];
-float Gyry_acvec[NF];
+WINDOW Gyr_fx_thr_Nfvec;
+WINDOW Gyr_fy_thr_Nfvec;
+WINDOW Gyr_fz_thr_Nfvec;
+WINDOW Gyrx_acvec;
+WINDOW Gyry_acvec;
 
 float Acc_acf_to = 0.0;
 float Acc_acf_tn = 0.0;
@@ -58,6 +58,9 @@ uint16_t last_num_of_mopcycles = 0;
 float velocity = 0.0;
 int64_t Frame_flip_tsp = 0ULL;  // frame flip timestamp
 uint8_t Frame_flip_flag = 0;    // flag indicating the a frame flip event.
+
+static ALGO_BENCHMARK algo_benchmark;
+K_MUTEX_DEFINE(algo_benchmark_mutex); // algo_benchmark is updated by the imu thread and read by the shell
 uint8_t Frame_side[2] = {0, 0}; // indicates frame side
 
 float mopping_coverage_per_handle_total = 0.0;
@@ -102,8 +105,8 @@ int64_t Mop_change_tsp = 0LL;
 uint8_t Mop_on_floor_after_Change_Flag = 0;
 int64_t Mop_on_floor_after_Change_Flag_tsp = 0LL;
 
-char Currentmop_RFID[EPC_TOTAL_HEX_LENGTH];
-char Newmop_RFID[EPC_TOTAL_HEX_LENGTH];
+EPC_BINARY Currentmop_RFID;
+EPC_BINARY Newmop_RFID;
 uint8_t Newmop_RFID_flag = 0;
 uint8_t Prevmop_RFID_replaced_flag = 0;
 int64_t Newmop_RFID_tsp = 0LL;
@@ -156,7 +159,7 @@ float Coverage_per_mop = 0.0;
 float dt = 0.0;
 
 float Acc_dc_avg = 0.0;
-double result = 0.0;
+float result = 0.0f;
 float Acc_adpt_thr = 0.0;
 int64_t Acc_acf_peak_lastupdate_tsp = 0LL;
 
@@ -218,37 +221,70 @@ uint32_t mop_id_refresh_timer = 0;
 
 uint8_t algorithm_lock = true;
 
+/* Coefficients of the FIR low pass filter (Fc=20Hz), index 0 weights the newest sample */
+static const float algo_lowpass_coefficients[8] = {1.0f / 16.0f, 2.0f / 16.0f, 3.0f / 16.0f, 4.0f / 16.0f, 3.0f / 16.0f, 2.0f / 16.0f, 0.0f, 1.0f / 16.0f};
+
 /*!
- * @brief This functions initalize all variables related the algorithm
+ * @brief This function filters the newest samples of a window with the FIR low pass filter
+ * @param[in] window: Pointer to the window, at least 8 samples long
+ * @return Filtered value
  */
-void init_algorithms(void)
+static float algo_LowPass(const WINDOW *window)
 {
-    memset(Accx_Nfvec, 0, NF);
-    memset(Accy_Nfvec, 0, NF);
-    memset(Accz_Nfvec, 0, NF);
+    float samples[8];
+    uint16_t i = 0;
 
-    memset(Gyrx_Nfvec, 0, NF);
-    memset(Gyry_Nfvec, 0, NF);
-    memset(Gyrz_Nfvec, 0, NF);
+    for (i = 0; i < 8; i++)
+    {
+        samples[i] = window_Get(window, i);
+    }
 
-    memset(Magx_Nfvec, 0, NF);
-    memset(Magy_Nfvec, 0, NF);
-    memset(Magz_Nfvec, 0, NF);
+    return fmath_Dot(samples, algo_lowpass_coefficients, 8);
+}
 
-    memset(Acc_dcNfvec, EARTH_GRAVITY, NF);
-    memset(Acc_acvec, 0, NF);
-    memset(Acc_acfvec, 0, NF);
+/*!
+ * @brief This functions initalizes the signal history windows
+ */
+static void algo_init_windows(void)
+{
+    window_Init(&Accx_Nfvec, NF, 0.0f, false);
+    window_Init(&Accy_Nfvec, NF, 0.0f, false);
+    window_Init(&Accz_Nfvec, NF, 0.0f, false);
+
+    window_Init(&Gyrx_Nfvec, NF, 0.0f, false);
+    window_Init(&Gyry_Nfvec, NF, 0.0f, false);
+    window_Init(&Gyrz_Nfvec, NF, 0.0f, false);
+
+    window_Init(&Magx_Nfvec, NF, 0.0f, false);
+    window_Init(&Magy_Nfvec, NF, 0.0f, false);
+    window_Init(&Magz_Nfvec, NF, 0.0f, false);
+
+    window_Init(&Acc_dcNfvec, NF, EARTH_GRAVITY, false);
+    window_Init(&Acc_acvec, NF, 0.0f, false);
+    window_Init(&Acc_acfvec, NF, 0.0f, false);
+
+    window_Init(&Gyr_fx_thr_Nfvec, NF, 0.0f, false);
+    window_Init(&Gyr_fy_thr_Nfvec, NF, 0.0f, false);
+    window_Init(&Gyr_fz_thr_Nfvec, NF, 0.0f, false);
+    window_Init(&Gyrx_acvec, NF, 0.0f, false);
+    window_Init(&Gyry_acvec, NF, 0.0f, false);
+}
+
+/*!
+ * @brief This functions initalize all variables related the algorithm
+ */
+void init_algorithms(void)
+{
+    algo_init_windows();
 
-    memset(Gyr_fx_thr_Nfvec, 0, NF);
-    memset(Gyr_fy_thr_Nfvec, 0, NF);
-    memset(Gyr_fz_thr_Nfvec, 0, NF);
-    memset(Gyrx_acvec, 0, NF);
-    memset(Gyry_acvec, 0, NF);
+    EPC_Clear(&Currentmop_RFID);
+    EPC_Clear(&Newmop_RFID);
 
-    memset(Currentmop_RFID, '0', EPC_TOTAL_HEX_LENGTH);
-    memset(Newmop_RFID, '0', EPC_TOTAL_HEX_LENGTH);
+    dt = (float)Parameter.imu_interval / 1000.0f; // Raw IMU data sampling time in sec
 
-    dt = (float)Parameter.imu_interval / 1000.0; // Raw IMU data sampling time in sec
+    timing_init();
+    timing_start();
+    algo_benchmark_Reset();
 }
 
 /*!
@@ -256,40 +292,20 @@ void init_algorithms(void)
  */
 void algo_reset_variables(void)
 {
-    memset(Accx_Nfvec, 0, NF);
-    memset(Accy_Nfvec, 0, NF);
-    memset(Accz_Nfvec, 0, NF);
-
-    memset(Gyrx_Nfvec, 0, NF);
-    memset(Gyry_Nfvec, 0, NF);
-    memset(Gyrz_Nfvec, 0, NF);
-
-    memset(Magx_Nfvec, 0, NF);
-    memset(Magy_Nfvec, 0, NF);
-    memset(Magz_Nfvec, 0, NF);
-
-    memset(Acc_dcNfvec, EARTH_GRAVITY, NF);
-    memset(Acc_acvec, 0, NF);
-    memset(Acc_acfvec, 0, NF);
+    algo_init_windows();
 
-    memset(Gyr_fx_thr_Nfvec, 0, NF);
-    memset(Gyr_fy_thr_Nfvec, 0, NF);
-    memset(Gyr_fz_thr_Nfvec, 0, NF);
-    memset(Gyrx_acvec, 0, NF);
-    memset(Gyry_acvec, 0, NF);
+    EPC_Clear(&Currentmop_RFID);
+    EPC_Clear(&Newmop_RFID);
 
-    memset(Currentmop_RFID, '0', EPC_TOTAL_HEX_LENGTH);
-    memset(Newmop_RFID, '0', EPC_TOTAL_HEX_LENGTH);
-
-    Acc_acf_to = 0.0;
-    Acc_acf_tn = 0.0;
+    Acc_acf_to = 0.0f;
+    Acc_acf_tn = 0.0f;
     sAacf_to = 0;
     sAacf_tn = 0;
-    Acc_acfvec_avg = 0.0;
-    Acc_acf_peak = 0.0;
-    Acc_acf_tn_abs = 0.0;
-    Acc_acf_sumabs = 0.0;
-    Acc_acf_adpt_thr = 0.0;
+    Acc_acfvec_avg = 0.0f;
+    Acc_acf_peak = 0.0f;
+    Acc_acf_tn_abs = 0.0f;
+    Acc_acf_sumabs = 0.0f;
+    Acc_acf_adpt_thr = 0.0f;
     mopcycle_duration_ms = 0UL;
     lastmopcycle_tsp = 0ULL;
     prev_to_lastmopcycle_tsp = 0ULL;
@@ -299,46 +315,46 @@ void algo_reset_variables(void)
     MoppingFlag[0] = 0;
     MoppingFlag[1] = 0;
     last_num_of_mopcycles = 0;
-    velocity = 0.0;
+    velocity = 0.0f;
     Frame_flip_tsp = 0ULL; // frame flip timestamp
     Frame_flip_flag = 0;   // flag indicating the a frame flip event.
     Frame_side[0] = 0;     // indicates frame side
     Frame_side[1] = 0;     // indicates frame side
 
-    mopping_coverage_per_handle_total = 0.0;
-    mopping_coverage_per_mop = 0.0;
-    mopping_coverage_side1 = 0.0;
-    mopping_coverage_side2 = 0.0;
+    mopping_coverage_per_handle_total = 0.0f;
+    mopping_coverage_per_mop = 0.0f;
+    mopping_coverage_side1 = 0.0f;
+    mopping_coverage_side2 = 0.0f;
     Mopping_start_tsp = 0LL;
     Mopping_stop_tsp = 0LL;
     motion_state[0] = 0;
     motion_state[1] = 0;
 
-    dAccx = 0.0;
-    dAccy = 0.0;
-    dAccz = 0.0;
-    dGyrx = 0.0;
-    dGyry = 0.0;
-    dGyrz = 0.0;
-    dMagx = 0.0;
-    dMagy = 0.0;
-    dMagz = 0.0;
-
-    Accx_f = 0.0;
-    Accy_f = 0.0;
-    Accz_f = 0.0;
-    Gyrx_f = 0.0;
-    Gyry_f = 0.0;
-    Gyrz_f = 0.0;
-    Magx_f = 0.0;
-    Magy_f = 0.0;
-    Magz_f = 0.0;
-
-    floor_handle_angle[0] = 0.0;
-    floor_handle_angle[1] = 0.0;
-
-    frame_handle_angle[0] = 0.0;
-    frame_handle_angle[1] = 0.0;
+    dAccx = 0.0f;
+    dAccy = 0.0f;
+    dAccz = 0.0f;
+    dGyrx = 0.0f;
+    dGyry = 0.0f;
+    dGyrz = 0.0f;
+    dMagx = 0.0f;
+    dMagy = 0.0f;
+    dMagz = 0.0f;
+
+    Accx_f = 0.0f;
+    Accy_f = 0.0f;
+    Accz_f = 0.0f;
+    Gyrx_f = 0.0f;
+    Gyry_f = 0.0f;
+    Gyrz_f = 0.0f;
+    Magx_f = 0.0f;
+    Magy_f = 0.0f;
+    Magz_f = 0.0f;
+
+    floor_handle_angle[0] = 0.0f;
+    floor_handle_angle[1] = 0.0f;
+
+    frame_handle_angle[0] = 0.0f;
+    frame_handle_angle[1] = 0.0f;
 
     TPflag = -1;
     mopcycles = 0;
@@ -369,44 +385,44 @@ void algo_reset_variables(void)
     Hit_Shock_flag = 0;
     freefall_tsp = 0LL;
     Hit_Shock_tsp = 0LL;
-    Hit_Shock_mag = 0.0;
+    Hit_Shock_mag = 0.0f;
     fall_duration_ms = 0;
     free_fall_height = 0;
 
-    Gyr_fx = 0.0;
-    Gyr_fx_abs = 0.0;
-    Gyr_fx_peak = 0.0;
+    Gyr_fx = 0.0f;
+    Gyr_fx_abs = 0.0f;
+    Gyr_fx_peak = 0.0f;
     Gyr_fx_peak_lastupdate_tsp = 0LL;
-    Gyrx_adpt_thr = 0.0;
-    Gyr_fx_thr = 0.0;
-    Gyr_fx_thr_ergy = 0.0;
-    Gyr_fy = 0.0;
-    Gyr_fy_abs = 0.0;
-    Gyr_fy_peak = 0.0;
+    Gyrx_adpt_thr = 0.0f;
+    Gyr_fx_thr = 0.0f;
+    Gyr_fx_thr_ergy = 0.0f;
+    Gyr_fy = 0.0f;
+    Gyr_fy_abs = 0.0f;
+    Gyr_fy_peak = 0.0f;
     Gyr_fy_peak_lastupdate_tsp = 0LL;
-    Gyry_adpt_thr = 0.0;
-    Gyr_fy_thr = 0.0;
-    Gyr_fy_thr_ergy = 0.0;
-    Gyr_fz = 0.0;
-    Gyr_fz_abs = 0.0;
-    Gyr_fz_peak = 0.0;
+    Gyry_adpt_thr = 0.0f;
+    Gyr_fy_thr = 0.0f;
+    Gyr_fy_thr_ergy = 0.0f;
+    Gyr_fz = 0.0f;
+    Gyr_fz_abs = 0.0f;
+    Gyr_fz_peak = 0.0f;
     Gyr_fz_peak_lastupdate_tsp = 0LL;
-    Gyrz_adpt_thr = 0.0;
-    Gyr_fz_thr = 0.0;
-    Gyr_fz_thr_ergy = 0.0;
+    Gyrz_adpt_thr = 0.0f;
+    Gyr_fz_thr = 0.0f;
+    Gyr_fz_thr_ergy = 0.0f;
 
     mopping_pattern[0] = 0;
     mopping_pattern[1] = 0;
     mopping_pattern_lastupdate_tsp = 0LL;
     mopping_speed_lastupdate_tsp = 0LL;
-    mopping_speed = 0.0;
+    mopping_speed = 0.0f;
     Total_mops_used = 0UL;
-    Coverage_per_mop = 0.0;
-    dt = (float)Parameter.imu_interval / 1000.0; // Raw IMU data sampling time in sec
+    Coverage_per_mop = 0.0f;
+    dt = (float)Parameter.imu_interval / 1000.0f; // Raw IMU data sampling time in sec
 
-    Acc_dc_avg = 0.0;
-    result = 0.0;
-    Acc_adpt_thr = 0.0;
+    Acc_dc_avg = 0.0f;
+    result = 0.0f;
+    Acc_adpt_thr = 0.0f;
     Acc_acf_peak_lastupdate_tsp = 0LL;
 
     flag_changed = false;
@@ -416,11 +432,11 @@ void algo_reset_variables(void)
     Flag_SameMopAlreadyUsedNotification = false;
     dirtymop_blink_flag = false;
 
-    Acc_dc_avg_min = 0.0;
+    Acc_dc_avg_min = 0.0f;
     Acc_dc_avg_min_lastupdate_tsp = 0LL;
 
-    Gyrx_acf = 0.0;
-    Gyry_acf = 0.0;
+    Gyrx_acf = 0.0f;
+    Gyry_acf = 0.0f;
 
     Mopping_motion_gyr_flag = 0;
     Mopping_motion_gyr_flag_lastupdate_tsp = 0LL;
@@ -525,7 +541,7 @@ void update_average_usage_numbers(void)
 // and returns the standard derivation as a float value
 float standard_deviation(float *array, int length)
 {
-    float sum = 0.0, mean, standardDeviation = 0.0;
+    float sum = 0.0f, mean, standardDeviation = 0.0f;
     int i;
 
     for (i = 0; i < length; ++i)
@@ -537,70 +553,66 @@ float standard_deviation(float *array, int length)
 
     for (i = 0; i < length; ++i)
     {
-        standardDeviation += pow(array[i] - mean, 2);
+        standardDeviation += (array[i] - mean) * (array[i] - mean);
     }
 
-    return sqrt(standardDeviation / length);
+    return sqrtf(standardDeviation / length);
 }
 
 /*!
- * @brief Adds a float element at array index 0 in a float array
- * @param[in] array: Pointer to the float array
- * @param[in] sample: Value to be added
- * @param[in] array_length: Length of the array
+ * @brief Resets the execution time statistic of the algorithm
  */
-void algo_fAddArrayElement(float *array, float sample, uint16_t array_length)
+void algo_benchmark_Reset(void)
 {
-    uint16_t i = 0;
-
-    /* Shift every element by one */
-    for (i = array_length - 1; i > 0; i--)
-    {
-        array[i] = array[i - 1];
-    }
-
-    /* Add new element */
-    array[0] = sample;
+    k_mutex_lock(&algo_benchmark_mutex, K_FOREVER);
+    algo_benchmark.calls = 0;
+    algo_benchmark.total_cycles = 0;
+    algo_benchmark.min_cycles = UINT64_MAX;
+    algo_benchmark.max_cycles = 0;
+    algo_benchmark.start_uptime = k_uptime_get();
+    k_mutex_unlock(&algo_benchmark_mutex);
 }
 
 /*!
- * @brief Adds a float element at array index 0 in a float array
- * @param[in] array: Pointer to the float array
- * @param[in] array_length: Length of the array
- * @return Sum of each array element
+ * @brief Copies the execution time statistic of the algorithm, all values belong to the same sample
+ * @param[out] snapshot: Pointer to the copy
  */
-float algo_fsum(float *array, uint16_t array_length)
+void algo_benchmark_Get(ALGO_BENCHMARK *snapshot)
 {
-    uint16_t i = 0;
-    float sum = 0.0;
-
-    for (i = 0; i < array_length; i++)
-    {
-        sum += array[i];
-    }
-
-    return sum;
+    k_mutex_lock(&algo_benchmark_mutex, K_FOREVER);
+    *snapshot = algo_benchmark;
+    k_mutex_unlock(&algo_benchmark_mutex);
 }
 
 /*!
- * @brief Calculates the mean of an float array
- * @param[in] array: Pointer to the float array
- * @param[in] array_length: Length of the array
- * @return Mean value of the float array
+ * @brief Executes the algorithm for one imu sample and measures the cpu cycles it takes
  */
-float algo_fmean(float *array, uint16_t array_length)
+void algo_benchmark_Execute(void)
 {
-    uint16_t i = 0;
-    float sum = 0.0;
-    float mean = 0.0;
+    timing_t start_time;
+    timing_t stop_time;
+    uint64_t cycles = 0;
+
+    start_time = timing_counter_get();
+    algorithm_execute_process();
+    stop_time = timing_counter_get();
+
+    cycles = timing_cycles_get(&start_time, &stop_time);
+
+    k_mutex_lock(&algo_benchmark_mutex, K_FOREVER);
+    algo_benchmark.calls++;
+    algo_benchmark.total_cycles += cycles;
 
-    for (i = 0; i < array_length; i++)
+    if (cycles < algo_benchmark.min_cycles)
     {
-        sum += array[i];
+        algo_benchmark.min_cycles = cycles;
     }
 
-    mean = sum / array_length;
-    return mean;
+    if (cycles > algo_benchmark.max_cycles)
+    {
+        algo_benchmark.max_cycles = cycles;
+    }
+    k_mutex_unlock(&algo_benchmark_mutex);
 }
 
 /*!
@@ -608,7 +620,8 @@ float algo_fmean(float *array, uint16_t array_length)
  */
 void algorithm_execute_process(void)
 {
-    int8_t cmp_rslt = 0;
+    char epc_string[EPC_HEX_STRING_LENGTH];
+    float vector[3];
 
     if (((System.charger_connected == false) || (Parameter.notifications_while_usb_connected == true)) && (algorithm_lock == false) && (System.boot_complete == true))
     {
@@ -692,9 +705,9 @@ void algorithm_execute_process(void)
         {
             // Check if current mob string is not zero (a chipped mob is attached)
             uint8_t chipped_mob_installed = false;
-            chipped_mob_installed = zero_sum_of_digits(current_mob_string_reading, EPC_TOTAL_HEX_LENGTH); // return 0 if sum is 0, otherwise 1
+            chipped_mob_installed = (EPC_IsZero(&current_mop_epc_reading) == false);
 
-            if ((chipped_mob_installed == 0) && (mopping_coverage_per_mop > (Parameter.mopping_coverage_per_mop_thr + 1.5)) && (Mopping_motion_gyr_flag == 1) && (Newmop_RFID_tsp < Mopping_start_tsp))
+            if ((chipped_mob_installed == 0) && (mopping_coverage_per_mop > (Parameter.mopping_coverage_per_mop_thr + 1.5f)) && (Mopping_motion_gyr_flag == 1) && (Newmop_RFID_tsp < Mopping_start_tsp))
             {
                 mop_null_readings++;
                 Newmop_RFID_flag = 0;
@@ -709,7 +722,7 @@ void algorithm_execute_process(void)
                             shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Unchipped mop coverage reset\n");
                         }
                     }
-                    if ((Total_mops_used >= 1) && (mopping_coverage_per_mop > 0.5)) // Send the square meter only if there was a previous mop installed
+                    if ((Total_mops_used >= 1) && (mopping_coverage_per_mop > 0.5f)) // Send the square meter only if there was a previous mop installed
                     {
                         current_room_to_mop_mapping.previous_mop_id = prev_mop_id;
                         NewEvent0x1C(current_room_to_mop_mapping.previous_mop_id, mopping_coverage_side1, mopping_coverage_side2);
@@ -731,10 +744,8 @@ void algorithm_execute_process(void)
             /* checks if a new chipped mop is installed (is executed only when the device scans a valid mop epc and when this new scan is different from the past one) */
             if (chipped_mob_installed == true)
             {
-                cmp_rslt = memcmp(current_mob_string_reading, Newmop_RFID, EPC_TOTAL_HEX_LENGTH);
-
-                if (cmp_rslt == 0)
-                { // strcmp returns 0 if strings are equal; >0 is str1>str2 and <0 if str1<str2
+                if (EPC_Equal(&current_mop_epc_reading, &Newmop_RFID) == true)
+                {
                     mop_null_readings = 0UL;
                     Newmop_RFID_tsp = unixtime_ms;
                     Newmop_RFID_readings++; // make it signed long int to avoid overflows
@@ -742,7 +753,7 @@ void algorithm_execute_process(void)
 
                     if ((Newmop_RFID_readings == Parameter.mop_rfid_detection_thr) && (Newmop_RFID_flag == 0) && (prev_mop_id != new_advanced_mop_record.mop_id))
                     {
-                        memcpy(Currentmop_RFID, Newmop_RFID, EPC_TOTAL_HEX_LENGTH); // new mop rfid reliably detected
+                        Currentmop_RFID = Newmop_RFID; // new mop rfid reliably detected
                         Newmop_RFID_flag = 1;                                       // new mop detected
                         Prevmop_RFID_replaced_flag = 1;
                         mop_rfid_readings = Parameter.mop_rfid_detection_thr;
@@ -778,7 +789,7 @@ void algorithm_execute_process(void)
                                     reset_room_to_mop_mapping();
 
                                     /* Set current mop as new mop in room_to_mop_mapping */
-                                    memcpy(current_room_to_mop_mapping.current_mop_epc, Currentmop_RFID, 20);
+                                    current_room_to_mop_mapping.current_mop_epc = Currentmop_RFID;
                                     current_room_to_mop_mapping.current_mop_id = new_mop_record.mop_id;
                                     current_room_to_mop_mapping.timestamp = unixtime_ms;
                                     Flag_SameMopAlreadyUsedNotification = false;
@@ -807,7 +818,7 @@ void algorithm_execute_process(void)
                                             rtc_print_debug_timestamp();
                                             shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_GREEN, "%d New chipped Mop is placed on Frame. New mop ID: %d \t[mop_color: %X, mop_type: %X, mop_size: %d, mop_sides: %d]\n", Total_mops_used, current_room_to_mop_mapping.current_mop_id, new_advanced_mop_record.mop_color, new_advanced_mop_record.mop_typegroup, new_advanced_mop_record.mop_size, new_advanced_mop_record.mop_sides);
                                             rtc_print_debug_timestamp();
-                                            shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Mop EPC: %s\n", DeserializeHexToChar(Currentmop_RFID, 20));
+                                            shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Mop EPC: %s\n", EPC_ToHexString(&Currentmop_RFID, epc_string));
                                         }
                                     }
                                 }
@@ -831,7 +842,7 @@ void algorithm_execute_process(void)
                                         rtc_print_debug_timestamp();
                                         shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "%d Mop already used in the current shift, Mop ID: %d\n", Total_mops_used, new_advanced_mop_record.mop_id);
                                         rtc_print_debug_timestamp();
-                                        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Mop EPC: %s\n", DeserializeHexToChar(Currentmop_RFID, 20));
+                                        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Mop EPC: %s\n", EPC_ToHexString(&Currentmop_RFID, epc_string));
                                     }
                                 }
                             }
@@ -865,8 +876,8 @@ void algorithm_execute_process(void)
                     Prevmop_RFID_replaced_flag = 1; // mop is replaced by another chipped mopped
                     Newmop_RFID_flag = 0;
                 }
-                memcpy(Newmop_RFID, current_mob_string_reading, EPC_TOTAL_HEX_LENGTH);
-                memset(current_mob_string_reading, 0, EPC_TOTAL_HEX_LENGTH);
+                Newmop_RFID = current_mop_epc_reading;
+                EPC_Clear(&current_mop_epc_reading);
             }
         }
         // shell_fprintf(shell_backend_uart_get_ptr(), 0, "NewmopRFID_readings=%d, PrevmopRFID_replaced_flag=%d, Newmop_RFID_flag=%d, Currentmop_iswithout_RFID_Flag=%d, Reg_mopID=%d - LastmopID=%d\t mop_null_rds=%d, mop_rfid_rds=%d\n", Newmop_RFID_readings, Prevmop_RFID_replaced_flag, Newmop_RFID_flag, Currentmop_iswithout_RFID_Flag, prev_mop_id, new_advanced_mop_record.mop_id, mop_null_readings, mop_rfid_readings);
@@ -884,37 +895,40 @@ void algorithm_execute_process(void)
         dMagy = bmm150.data.y;
         dMagz = bmm150.data.z;
 
-        algo_fAddArrayElement(Accx_Nfvec, dAccx, NF);
-        algo_fAddArrayElement(Accy_Nfvec, dAccy, NF);
-        algo_fAddArrayElement(Accz_Nfvec, dAccz, NF);
+        window_Add(&Accx_Nfvec, dAccx);
+        window_Add(&Accy_Nfvec, dAccy);
+        window_Add(&Accz_Nfvec, dAccz);
 
-        algo_fAddArrayElement(Gyrx_Nfvec, dGyrx, NF);
-        algo_fAddArrayElement(Gyry_Nfvec, dGyry, NF);
-        algo_fAddArrayElement(Gyrz_Nfvec, dGyrz, NF);
+        window_Add(&Gyrx_Nfvec, dGyrx);
+        window_Add(&Gyry_Nfvec, dGyry);
+        window_Add(&Gyrz_Nfvec, dGyrz);
 
-        algo_fAddArrayElement(Magx_Nfvec, (float)dMagx, NF);
-        algo_fAddArrayElement(Magy_Nfvec, (float)dMagy, NF);
-        algo_fAddArrayElement(Magz_Nfvec, (float)dMagz, NF);
+        window_Add(&Magx_Nfvec, (float)dMagx);
+        window_Add(&Magy_Nfvec, (float)dMagy);
+        window_Add(&Magz_Nfvec, (float)dMagz);
 
         /* Caclulate mean values based on recent values */
-        Accx_f = algo_fmean(Accx_Nfvec, NF);
-        Accy_f = algo_fmean(Accy_Nfvec, NF);
-        Accz_f = algo_fmean(Accz_Nfvec, NF);
+        Accx_f = window_Mean(&Accx_Nfvec);
+        Accy_f = window_Mean(&Accy_Nfvec);
+        Accz_f = window_Mean(&Accz_Nfvec);
 
-        Gyrx_f = algo_fmean(Gyrx_Nfvec, NF);
-        Gyry_f = algo_fmean(Gyry_Nfvec, NF);
-        Gyrz_f = algo_fmean(Gyrz_Nfvec, NF);
+        Gyrx_f = window_Mean(&Gyrx_Nfvec);
+        Gyry_f = window_Mean(&Gyry_Nfvec);
+        Gyrz_f = window_Mean(&Gyrz_Nfvec);
 
-        Magx_f = algo_fmean(Magx_Nfvec, NF);
-        Magy_f = algo_fmean(Magy_Nfvec, NF);
-        Magz_f = algo_fmean(Magz_Nfvec, NF);
+        Magx_f = window_Mean(&Magx_Nfvec);
+        Magy_f = window_Mean(&Magy_Nfvec);
+        Magz_f = window_Mean(&Magz_Nfvec);
 
         /* Complex computations */
-        result = sqrt((dAccx * dAccx) + (dAccy * dAccy) + (dAccz * dAccz));
-        algo_fAddArrayElement(Acc_dcNfvec, (float)result, NF); // shift elements of the vectors and update with the recent values.
+        vector[0] = dAccx;
+        vector[1] = dAccy;
+        vector[2] = dAccz;
+        result = fmath_Norm(vector, 3);
+        window_Add(&Acc_dcNfvec, result); // shift elements of the vectors and update with the recent values.
 
-        Acc_dc_avg = algo_fmean(Acc_dcNfvec, NF);
-        algo_fAddArrayElement(Acc_acvec, (Acc_dcNfvec[0] - Acc_dc_avg), NF);
+        Acc_dc_avg = window_Mean(&Acc_dcNfvec);
+        window_Add(&Acc_acvec, (window_Get(&Acc_dcNfvec, 0) - Acc_dc_avg));
 
         // Detect Acc_dc_avg signal min
         if (Acc_dc_avg < Acc_dc_avg_min)
@@ -924,29 +938,32 @@ void algorithm_execute_process(void)
         }
         else if ((unixtime_ms - Acc_dc_avg_min_lastupdate_tsp) > 500)
         {
-            Acc_dc_avg_min = (Acc_dc_avg_min + Acc_dc_avg) / 2.0;
+            Acc_dc_avg_min = (Acc_dc_avg_min + Acc_dc_avg) / 2.0f;
             Acc_dc_avg_min_lastupdate_tsp = unixtime_ms;
         }
-        result = (1.0 / 16.0) * (Acc_acvec[0] + 2.0 * Acc_acvec[1] + 3.0 * Acc_acvec[2] + 4.0 * Acc_acvec[3] + 3.0 * Acc_acvec[4] + 2.0 * Acc_acvec[5] + Acc_acvec[7]); // low pass filtering with Fc=20Hz
-        algo_fAddArrayElement(Acc_acfvec, (float)result, NF);
+        result = algo_LowPass(&Acc_acvec); // low pass filtering with Fc=20Hz
+        window_Add(&Acc_acfvec, result);
 
         Acc_acf_to = Acc_acf_tn;
-        Acc_acf_tn = Acc_acfvec[0];
+        Acc_acf_tn = window_Get(&Acc_acfvec, 0);
 
-        Acc_acf_sumabs = Acc_acf_sumabs + (float)fabs((double)Acc_acf_tn);
+        Acc_acf_sumabs = Acc_acf_sumabs + fabsf(Acc_acf_tn);
 
-        if (Acc_acf_sumabs > 75.0)
+        if (Acc_acf_sumabs > 75.0f)
         { // to filter possible recurring shocks
-            Acc_acf_sumabs = 75.0;
+            Acc_acf_sumabs = 75.0f;
         }
 
         /* Extract features, all angles should be 0 when the device is placed horizontically on the floor */
-        floor_handle_angle[0] = Parameter.angle_smooth_factor * floor_handle_angle[0] + (1.0 - Parameter.angle_smooth_factor) * (float)atan2(((double)Accy_f * -1.0), sqrt((double)Accx_f * (double)Accx_f + (double)Accz_f * (double)Accz_f)) * 180.0 / PI;
+        floor_handle_angle[0] = Parameter.angle_smooth_factor * floor_handle_angle[0] + (1.0f - Parameter.angle_smooth_factor) * fmath_Atan2(-Accy_f, fmath_Norm2(Accx_f, Accz_f)) * FMATH_RAD_TO_DEG;
 
-        result = sqrt(Magx_f * Magx_f + Magy_f * Magy_f + Magz_f * Magz_f);
+        vector[0] = Magx_f;
+        vector[1] = Magy_f;
+        vector[2] = Magz_f;
+        result = fmath_Norm(vector, 3);
         if (result > Parameter.mag_noise_thr)
         {
-            frame_handle_angle[0] = Parameter.angle_smooth_factor * frame_handle_angle[0] + (1.0 - Parameter.angle_smooth_factor) * (float)atan2((double)Magx_f, sqrt((double)Magy_f * (double)Magy_f + (double)Magz_f * (double)Magz_f)) * 180.0 / PI;
+            frame_handle_angle[0] = Parameter.angle_smooth_factor * frame_handle_angle[0] + (1.0f - Parameter.angle_smooth_factor) * fmath_Atan2(Magx_f, fmath_Norm2(Magy_f, Magz_f)) * FMATH_RAD_TO_DEG;
         }
         else
         {
@@ -954,7 +971,7 @@ void algorithm_execute_process(void)
         }
 
         /* Acc_acf acceleration */
-        Acc_acf_tn_abs = (float)fabs((double)Acc_acfvec[0]);
+        Acc_acf_tn_abs = fabsf(window_Get(&Acc_acfvec, 0));
 
         // Track Acc_acf max
         if (Acc_acf_tn_abs > Acc_acf_peak)
@@ -973,25 +990,25 @@ void algorithm_execute_process(void)
         }
 
         /* Adaptive signal thresholding */
-        Acc_adpt_thr = Parameter.acc_noise_thr + ((Acc_acf_peak - Parameter.acc_noise_thr) * (EARTH_GRAVITY / 100.0));
+        Acc_adpt_thr = Parameter.acc_noise_thr + ((Acc_acf_peak - Parameter.acc_noise_thr) * (EARTH_GRAVITY / 100.0f));
         if ((floor_handle_angle[0] > Parameter.floor_handle_angle_mopping_thr_min) && (floor_handle_angle[0] < Parameter.floor_handle_angle_mopping_thr_max))
         {
-            if (Acc_acfvec[0] > Acc_adpt_thr)
+            if (window_Get(&Acc_acfvec, 0) > Acc_adpt_thr)
             {
                 Acc_acf_adpt_thr = Acc_acf_tn_abs - Acc_adpt_thr;
             }
-            else if (Acc_acfvec[0] < Acc_adpt_thr)
+            else if (window_Get(&Acc_acfvec, 0) < Acc_adpt_thr)
             {
-                Acc_acf_adpt_thr = (Acc_acf_tn_abs * -1.0) + Acc_adpt_thr;
+                Acc_acf_adpt_thr = (Acc_acf_tn_abs * -1.0f) + Acc_adpt_thr;
             }
             else
             {
-                Acc_acf_adpt_thr = 0.0;
+                Acc_acf_adpt_thr = 0.0f;
             }
         }
         else
         {
-            Acc_acf_adpt_thr = 0.0;
+            Acc_acf_adpt_thr = 0.0f;
         }
 
         /* Detect mopping + mopping cycles + mopping m2 coverage */
@@ -1024,13 +1041,13 @@ void algorithm_execute_process(void)
 
             if ((sAacf_to == -1) && (sAacf_tn == 1))
             { // local Min= -=>+
-                if ((Acc_acf_tn < (Acc_adpt_thr * -1.0)) && (TPflag == 1))
+                if ((Acc_acf_tn < (Acc_adpt_thr * -1.0f)) && (TPflag == 1))
                 { // lesser than moving average and comes after True Max Peak
                     TPflag = -1;
                     mopcycle_duration_ms = (uint32_t)(unixtime_ms - Acc_acf_min_lastupdate_tsp);
                     Acc_acf_min_lastupdate_tsp = unixtime_ms;
 
-                    if ((Mopping_motion_gyr_flag == 1) && ((mopcycle_duration_ms > (1000 * Parameter.min_mopcycle_duration)) && (mopcycle_duration_ms < (1000 * 2.0 * Parameter.max_mopcycle_duration))))
+                    if ((Mopping_motion_gyr_flag == 1) && ((mopcycle_duration_ms > (1000 * Parameter.min_mopcycle_duration)) && (mopcycle_duration_ms < (1000 * 2.0f * Parameter.max_mopcycle_duration))))
                     {
                         mopcycles++; // if True Min Peak after True Max Peak => 1 cycle
                         mopcyclesFlag = 1;
@@ -1043,23 +1060,23 @@ void algorithm_execute_process(void)
                             velocity = 0;
                             mopping_speed = 0;
                         }
-                        mopping_speed = 0.5 * mopping_speed + (1.0 - 0.5) * velocity;
-                        if ((mopping_speed > 0.5) && (mopping_speed < 1.0))
+                        mopping_speed = 0.5f * mopping_speed + (1.0f - 0.5f) * velocity;
+                        if ((mopping_speed > 0.5f) && (mopping_speed < 1.0f))
                         {
                             velocity = velocity / mopping_speed;
                         }
 
-                        mopping_coverage_per_handle_total = mopping_coverage_per_handle_total + velocity * ((float)mopcycle_duration_ms / 1000.0) * (Parameter.mop_width * (100.0 - Parameter.mop_overlap) / 100);
-                        mopping_coverage_per_mop = mopping_coverage_per_mop + velocity * ((float)mopcycle_duration_ms / 1000.0) * (Parameter.mop_width * (100.0 - Parameter.mop_overlap) / 100.0);
+                        mopping_coverage_per_handle_total = mopping_coverage_per_handle_total + velocity * ((float)mopcycle_duration_ms / 1000.0f) * (Parameter.mop_width * (100.0f - Parameter.mop_overlap) / 100.0f);
+                        mopping_coverage_per_mop = mopping_coverage_per_mop + velocity * ((float)mopcycle_duration_ms / 1000.0f) * (Parameter.mop_width * (100.0f - Parameter.mop_overlap) / 100.0f);
 
                         if (Frame_side[0] == 0)
                         {
-                            mopping_coverage_side1 = mopping_coverage_side1 + velocity * ((float)mopcycle_duration_ms / 1000.0) * (Parameter.mop_width * (100.0 - Parameter.mop_overlap) / 100.0);
+                            mopping_coverage_side1 = mopping_coverage_side1 + velocity * ((float)mopcycle_duration_ms / 1000.0f) * (Parameter.mop_width * (100.0f - Parameter.mop_overlap) / 100.0f);
                         }
 
                         if (Frame_side[0] == 1)
                         {
-                            mopping_coverage_side2 = mopping_coverage_side2 + velocity * ((float)mopcycle_duration_ms / 1000.0) * (Parameter.mop_width * (100.0 - Parameter.mop_overlap) / 100.0);
+                            mopping_coverage_side2 = mopping_coverage_side2 + velocity * ((float)mopcycle_duration_ms / 1000.0f) * (Parameter.mop_width * (100.0f - Parameter.mop_overlap) / 100.0f);
                         }
                     }
                     Acc_acf_sumabs = 0;
@@ -1081,7 +1098,7 @@ void algorithm_execute_process(void)
         }
 
         /* Check if mopping started */
-        if ((MoppingFlag[0] == 0) && ((gcycle_angley > (4.0 * Parameter.gyr_spin_thr)) || ((mopcyclesFlag == 1) && (Mopping_motion_gyr_flag == 1) && ((unixtime_ms - Mopping_stop_tsp) > 1000 * Parameter.max_mopcycle_duration) && ((float)(mopcycles - last_num_of_mopcycles) >= Parameter.mopcycle_sequence_thr))))
+        if ((MoppingFlag[0] == 0) && ((gcycle_angley > (4.0f * Parameter.gyr_spin_thr)) || ((mopcyclesFlag == 1) && (Mopping_motion_gyr_flag == 1) && ((unixtime_ms - Mopping_stop_tsp) > 1000 * Parameter.max_mopcycle_duration) && ((float)(mopcycles - last_num_of_mopcycles) >= Parameter.mopcycle_sequence_thr))))
         {
             MoppingFlag[0] = 1;
             Mopping_start_tsp = unixtime_ms;
@@ -1231,7 +1248,7 @@ void algorithm_execute_process(void)
                 System.StatusInputs |= STATUSFLAG_FS; // Create status entry
             }
         }
-        else if ((frame_handle_angle[0] < (-1.0 * Parameter.frame_handle_angle_thr)) && (floor_handle_angle[0] > Parameter.floor_handle_angle_mopping_thr_min) && (unixtime_ms - Frame_flip_tsp) > (1000ULL * Parameter.min_mopframeflip_duration))
+        else if ((frame_handle_angle[0] < (-1.0f * Parameter.frame_handle_angle_thr)) && (floor_handle_angle[0] > Parameter.floor_handle_angle_mopping_thr_min) && (unixtime_ms - Frame_flip_tsp) > (1000ULL * Parameter.min_mopframeflip_duration))
         {
             if (((MoppingFlag[0] == 1) || ((unixtime_ms - Mopping_stop_tsp) < (1000ULL * Parameter.min_mopframeflip_duration))) && (Frame_flip_flag == 0) && (Frame_side[0] == 0) && (frame_lift_flag[0] == 0) && (mopping_coverage_per_mop > Parameter.mopping_coverage_per_mop_thr))
             {
@@ -1376,7 +1393,7 @@ void algorithm_execute_process(void)
                         shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Registered mop id %d is absent for %d sec\n", current_room_to_mop_mapping.current_mop_id, Parameter.mop_id_refresh_timer);
                         rtc_print_debug_timestamp();
                         shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Mop is released and room to mop mapping is reset.\n");
-                        if ((Total_mops_used >= 1) && (mopping_coverage_per_mop > 0.5))
+                        if ((Total_mops_used >= 1) && (mopping_coverage_per_mop > 0.5f))
                         {
                             NewEvent0x1C(current_room_to_mop_mapping.current_mop_id, mopping_coverage_side1, mopping_coverage_side2);
                         }
@@ -1384,7 +1401,7 @@ void algorithm_execute_process(void)
 
                         reset_room_to_mop_mapping();         // Reset room to mop mapping
                         mop_change_status = MOP_RESET_STATE; // reset flag
-                        memset(Newmop_RFID, '0', EPC_TOTAL_HEX_LENGTH);
+                        EPC_Clear(&Newmop_RFID);
                         prev_mop_id = 0;
                         mopping_coverage_per_mop = 0;
                         mopping_coverage_side1 = 0;
@@ -1445,7 +1462,7 @@ void algorithm_execute_process(void)
         }
 
         /** ALGORITHM TO DETECTED THAT USER USES CURRENTLY AN UNCHIPPED MOP ***/
-        if ((Mop_on_floor_after_Change_Flag == 1) && (mopping_coverage_per_mop > (Parameter.mopping_coverage_per_mop_thr + 0.1)) && (unchipped_mop_coverage_reset_flag) && (Newmop_RFID_flag == 0))
+        if ((Mop_on_floor_after_Change_Flag == 1) && (mopping_coverage_per_mop > (Parameter.mopping_coverage_per_mop_thr + 0.1f)) && (unchipped_mop_coverage_reset_flag) && (Newmop_RFID_flag == 0))
         {
             Total_mops_used++;
             mob_max_side1_sqm_reached = false;
@@ -1461,7 +1478,7 @@ void algorithm_execute_process(void)
             mop_change_status = MOP_RESET_STATE; // reset flag
 
             reset_room_to_mop_mapping(); /* Reset room to mop mapping */
-            memset(Newmop_RFID, '0', EPC_TOTAL_HEX_LENGTH);
+            EPC_Clear(&Newmop_RFID);
             NewEvent0x02(0); // Mop id 0 creates an Event for cloud upload but triggers no user notification
 
             if (Parameter.debug == true || Parameter.algo_verbose == true)
@@ -1480,31 +1497,31 @@ void algorithm_execute_process(void)
         //========================================================
 
         /* Detect free fall or hit */
-        Acc_dc_smooth = (0.7 * Acc_dcNfvec[0]) + (0.3 * Acc_dc_smooth);
-        if ((Free_Fall_flag == 0) && (Acc_dcNfvec[0] < (EARTH_GRAVITY / 10.0)) && (Acc_dc_smooth < (EARTH_GRAVITY / 5.0)))
+        Acc_dc_smooth = (0.7f * window_Get(&Acc_dcNfvec, 0)) + (0.3f * Acc_dc_smooth);
+        if ((Free_Fall_flag == 0) && (window_Get(&Acc_dcNfvec, 0) < (EARTH_GRAVITY / 10.0f)) && (Acc_dc_smooth < (EARTH_GRAVITY / 5.0f)))
         { // free fall detected
             freefall_tsp = unixtime_ms;
             Free_Fall_flag = 1;
         }
 
-        if (((Free_Fall_flag == 1) && (Acc_dc_avg > (0.95 * EARTH_GRAVITY))) || ((unixtime_ms - freefall_tsp) > 5000LL))
+        if (((Free_Fall_flag == 1) && (Acc_dc_avg > (0.95f * EARTH_GRAVITY))) || ((unixtime_ms - freefall_tsp) > 5000LL))
         {
             Free_Fall_flag = 0;
         }
 
-        if ((Free_Fall_flag == 1) && (Acc_dcNfvec[0] > (Parameter.hit_shock_mag_thr * EARTH_GRAVITY)))
+        if ((Free_Fall_flag == 1) && (window_Get(&Acc_dcNfvec, 0) > (Parameter.hit_shock_mag_thr * EARTH_GRAVITY)))
         {
             Hit_Shock_tsp = unixtime_ms;
             Hit_Shock_flag = 1;
             Free_Fall_flag = 0;
-            Hit_Shock_mag = Acc_dcNfvec[0];
+            Hit_Shock_mag = window_Get(&Acc_dcNfvec, 0);
             fall_duration_ms = unixtime_ms - freefall_tsp;
         }
 
-        if ((Hit_Shock_flag == 1) && (Acc_dc_avg > (0.95 * EARTH_GRAVITY)))
+        if ((Hit_Shock_flag == 1) && (Acc_dc_avg > (0.95f * EARTH_GRAVITY)))
         {
             Hit_Shock_flag = 0;
-            free_fall_height = 1.0 / 2.0 * EARTH_GRAVITY * (fall_duration_ms / 1000.0) * (fall_duration_ms / 1000.0); // free_fall_height = 1 / 2 * EARTH_GRAVITY * (fall_duration_ms / 1000) ^ 2;
+            free_fall_height = 1.0f / 2.0f * EARTH_GRAVITY * (fall_duration_ms / 1000.0f) * (fall_duration_ms / 1000.0f); // free_fall_height = 1 / 2 * EARTH_GRAVITY * (fall_duration_ms / 1000) ^ 2;
 
             if (Parameter.debug == true || Parameter.algo_verbose == true)
             {
@@ -1522,7 +1539,7 @@ void algorithm_execute_process(void)
 
         ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
         /* Detect Gyr_fx signal peak */
-        Gyr_fx_abs = (float)fabs((double)Gyrx_f);
+        Gyr_fx_abs = fabsf(Gyrx_f);
 
         if (Gyr_fx_abs > Gyr_fx_peak)
         {
@@ -1531,12 +1548,12 @@ void algorithm_execute_process(void)
         }
         else if ((unixtime_ms - Gyr_fx_peak_lastupdate_tsp) > (1000 * Parameter.peakfollower_update_delay))
         {
-            Gyr_fx_peak = (Gyr_fx_peak + Gyr_fx_abs) / 2.0;
+            Gyr_fx_peak = (Gyr_fx_peak + Gyr_fx_abs) / 2.0f;
             Gyr_fx_peak_lastupdate_tsp = unixtime_ms;
         }
 
         /* Adaptive signal thresholding */
-        Gyrx_adpt_thr = ((Gyr_fx_peak) / 10) + (Parameter.gyr_noise_thr) / 2.0;
+        Gyrx_adpt_thr = ((Gyr_fx_peak) / 10) + (Parameter.gyr_noise_thr) / 2.0f;
         Gyr_fx_thr = Gyr_fx_abs - Gyrx_adpt_thr;
 
         if (Gyr_fx_thr < 0)
@@ -1545,11 +1562,11 @@ void algorithm_execute_process(void)
         }
 
         /* shift values and compute energy */
-        algo_fAddArrayElement(Gyr_fx_thr_Nfvec, Gyr_fx_thr, NF);
-        Gyr_fx_thr_ergy = (Parameter.gyr_smooth_factor * Gyr_fx_thr_ergy) + ((1 - Parameter.gyr_smooth_factor) * algo_fsum(Gyr_fx_thr_Nfvec, NF)); // Gyr_fx_thr_ergy=sum(Gyr_fx_thr_Nfvec);
+        window_Add(&Gyr_fx_thr_Nfvec, Gyr_fx_thr);
+        Gyr_fx_thr_ergy = (Parameter.gyr_smooth_factor * Gyr_fx_thr_ergy) + ((1 - Parameter.gyr_smooth_factor) * window_Sum(&Gyr_fx_thr_Nfvec)); // Gyr_fx_thr_ergy=sum(Gyr_fx_thr_Nfvec);
 
         /* Detect Gyr_fy signal peak */
-        Gyr_fy_abs = (float)fabs((double)Gyry_f);
+        Gyr_fy_abs = fabsf(Gyry_f);
 
         if (Gyr_fy_abs > Gyr_fy_peak)
         {
@@ -1558,12 +1575,12 @@ void algorithm_execute_process(void)
         }
         else if ((unixtime_ms - Gyr_fy_peak_lastupdate_tsp) > 1000 * 2 * Parameter.peakfollower_update_delay)
         {
-            Gyr_fy_peak = (Gyr_fy_peak + Gyr_fy_abs) / 2.0;
+            Gyr_fy_peak = (Gyr_fy_peak + Gyr_fy_abs) / 2.0f;
             Gyr_fy_peak_lastupdate_tsp = unixtime_ms;
         }
 
         /* Adaptive signal thresholding */
-        Gyry_adpt_thr = (Gyr_fy_peak) / 2.0 + Parameter.gyr_noise_thr;
+        Gyry_adpt_thr = (Gyr_fy_peak) / 2.0f + Parameter.gyr_noise_thr;
         Gyr_fy_thr = Gyr_fy_abs - Gyry_adpt_thr;
 
         if (Gyr_fy_thr < 0)
@@ -1572,11 +1589,11 @@ void algorithm_execute_process(void)
         }
 
         /* shift values and compute energy */
-        algo_fAddArrayElement(Gyr_fy_thr_Nfvec, Gyr_fy_thr, NF);
-        Gyr_fy_thr_ergy = (Parameter.gyr_smooth_factor * Gyr_fy_thr_ergy) + ((1 - Parameter.gyr_smooth_factor) * algo_fsum(Gyr_fy_thr_Nfvec, NF)); //   Gyr_fy_thr_ergy= sum(Gyr_fy_thr_Nfvec);
+        window_Add(&Gyr_fy_thr_Nfvec, Gyr_fy_thr);
+        Gyr_fy_thr_ergy = (Parameter.gyr_smooth_factor * Gyr_fy_thr_ergy) + ((1 - Parameter.gyr_smooth_factor) * window_Sum(&Gyr_fy_thr_Nfvec)); //   Gyr_fy_thr_ergy= sum(Gyr_fy_thr_Nfvec);
 
         /* Detect Gyr_fz signal peak */
-        Gyr_fz_abs = (float)fabs((double)Gyrz_f);
+        Gyr_fz_abs = fabsf(Gyrz_f);
 
         if (Gyr_fz_abs > Gyr_fz_peak)
         {
@@ -1585,12 +1602,12 @@ void algorithm_execute_process(void)
         }
         else if ((unixtime_ms - Gyr_fz_peak_lastupdate_tsp) > 1000 * 3 * Parameter.peakfollower_update_delay)
         {
-            Gyr_fz_peak = (Gyr_fz_peak + Gyr_fz_abs) / 2.0;
+            Gyr_fz_peak = (Gyr_fz_peak + Gyr_fz_abs) / 2.0f;
             Gyr_fz_peak_lastupdate_tsp = unixtime_ms;
         }
 
         /* Adaptive signal thresholding */
-        Gyrz_adpt_thr = (Gyr_fz_peak) / 3.0 + (Parameter.gyr_noise_thr) / 2.0;
+        Gyrz_adpt_thr = (Gyr_fz_peak) / 3.0f + (Parameter.gyr_noise_thr) / 2.0f;
         Gyr_fz_thr = Gyr_fz_abs - Gyrz_adpt_thr;
 
         if (Gyr_fz_thr < 0)
@@ -1599,13 +1616,13 @@ void algorithm_execute_process(void)
         }
 
         /* shift values and compute energy */
-        algo_fAddArrayElement(Gyr_fz_thr_Nfvec, Gyr_fz_thr, NF);
-        Gyr_fz_thr_ergy = (Parameter.gyr_smooth_factor * Gyr_fz_thr_ergy) + ((1 - Parameter.gyr_smooth_factor) * algo_fsum(Gyr_fz_thr_Nfvec, NF)); //   Gyr_fy_thr_ergy= sum(Gyr_fy_thr_Nfvec);
+        window_Add(&Gyr_fz_thr_Nfvec, Gyr_fz_thr);
+        Gyr_fz_thr_ergy = (Parameter.gyr_smooth_factor * Gyr_fz_thr_ergy) + ((1 - Parameter.gyr_smooth_factor) * window_Sum(&Gyr_fz_thr_Nfvec)); //   Gyr_fy_thr_ergy= sum(Gyr_fy_thr_Nfvec);
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
         //// gyro x axis
-        algo_fAddArrayElement(Gyrx_acvec, (dGyrx - Gyrx_f), NF);                                                                                                                 // remove dc offset-bias//
-        Gyrx_acf = (1.0 / 16.0) * (Gyrx_acvec[0] + 2.0 * Gyrx_acvec[1] + 3.0 * Gyrx_acvec[2] + 4.0 * Gyrx_acvec[3] + 3.0 * Gyrx_acvec[4] + 2.0 * Gyrx_acvec[5] + Gyrx_acvec[7]); // low pass filtering with Fc=20Hz
+        window_Add(&Gyrx_acvec, (dGyrx - Gyrx_f));                                                                                                                 // remove dc offset-bias//
+        Gyrx_acf = algo_LowPass(&Gyrx_acvec); // low pass filtering with Fc=20Hz
 
         gyr_snx = Gyrx_acf; // Gyrx_f;
         // get sign of gyr signal slope
@@ -1622,7 +1639,7 @@ void algorithm_execute_process(void)
         { // local Max= +=>-
             gcycle_duration_msx = unixtime_ms - gyr_zerocross_lastupdate_tspx;
             lastgcycle_tspx = unixtime_ms;
-            if ((gcycle_duration_msx > (1000 * Parameter.min_mopcycle_duration / 2.0)) && (gcycle_duration_msx < (1000 * Parameter.max_mopcycle_duration / 2.0)))
+            if ((gcycle_duration_msx > (1000 * Parameter.min_mopcycle_duration / 2.0f)) && (gcycle_duration_msx < (1000 * Parameter.max_mopcycle_duration / 2.0f)))
             {
                 gTPflagx = 1;
             }
@@ -1631,7 +1648,7 @@ void algorithm_execute_process(void)
         { // local Min= -=>+
             gcycle_duration_msx = unixtime_ms - gyr_zerocross_lastupdate_tspx;
             lastgcycle_tspx = unixtime_ms;
-            if ((gcycle_duration_msx > (1000 * Parameter.min_mopcycle_duration / 2.0)) && (gcycle_duration_msx < (1000 * Parameter.max_mopcycle_duration / 2.0)))
+            if ((gcycle_duration_msx > (1000 * Parameter.min_mopcycle_duration / 2.0f)) && (gcycle_duration_msx < (1000 * Parameter.max_mopcycle_duration / 2.0f)))
             {
                 gTPflagx = -1;
                 gyr_activityFlagx = 1;
@@ -1649,13 +1666,13 @@ void algorithm_execute_process(void)
         }
         if ((gyr_activityFlagx == 1) && ((unixtime_ms - Mop_on_floor_after_Change_Flag_tsp) > 1000ULL * Parameter.max_mopcycle_duration))
         {
-            gcycle_anglex = gcycle_anglex + (float)fabs((double)gyr_snx) * dt;
+            gcycle_anglex = gcycle_anglex + fabsf(gyr_snx) * dt;
         }
         else
         {
             gcycle_anglex = 0;
         }
-        if (gcycle_anglex > (Parameter.gyr_spin_thr / 4.0))
+        if (gcycle_anglex > (Parameter.gyr_spin_thr / 4.0f))
         {
             Mopping_motion_gyr_flagx = 1;
         }
@@ -1668,8 +1685,8 @@ void algorithm_execute_process(void)
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         // //// gyro y axis
 
-        algo_fAddArrayElement(Gyry_acvec, (dGyry - Gyry_f), NF);
-        Gyry_acf = (1.0 / 16.0) * (Gyry_acvec[0] + 2.0 * Gyry_acvec[1] + 3.0 * Gyry_acvec[2] + 4.0 * Gyry_acvec[3] + 3.0 * Gyry_acvec[4] + 2.0 * Gyry_acvec[5] + Gyry_acvec[7]); // low pass filtering with Fc=20Hz
+        window_Add(&Gyry_acvec, (dGyry - Gyry_f));
+        Gyry_acf = algo_LowPass(&Gyry_acvec); // low pass filtering with Fc=20Hz
 
         gyr_sny = Gyry_acf; // Gyry_f;
 
@@ -1687,7 +1704,7 @@ void algorithm_execute_process(void)
         { // local Max= +=>-
             gcycle_duration_msy = unixtime_ms - gyr_zerocross_lastupdate_tspy;
             lastgcycle_tspy = unixtime_ms;
-            if ((gcycle_duration_msy > (1000 * Parameter.min_mopcycle_duration / 2.0)) && (gcycle_duration_msy < (1000 * Parameter.max_mopcycle_duration / 2.0)))
+            if ((gcycle_duration_msy > (1000 * Parameter.min_mopcycle_duration / 2.0f)) && (gcycle_duration_msy < (1000 * Parameter.max_mopcycle_duration / 2.0f)))
             {
                 gTPflagy = 1;
             }
@@ -1696,7 +1713,7 @@ void algorithm_execute_process(void)
         { // local Min= -=>+
             gcycle_duration_msy = unixtime_ms - gyr_zerocross_lastupdate_tspy;
             lastgcycle_tspy = unixtime_ms;
-            if ((gcycle_duration_msy > (1000 * Parameter.min_mopcycle_duration / 2.0)) && (gcycle_duration_msy < (1000 * Parameter.max_mopcycle_duration / 2.0)))
+            if ((gcycle_duration_msy > (1000 * Parameter.min_mopcycle_duration / 2.0f)) && (gcycle_duration_msy < (1000 * Parameter.max_mopcycle_duration / 2.0f)))
             {
                 gTPflagy = -1;
                 gyr_activityFlagy = 1;
@@ -1713,7 +1730,7 @@ void algorithm_execute_process(void)
         }
         if ((gyr_activityFlagy == 1) && ((unixtime_ms - Mop_on_floor_after_Change_Flag_tsp) > 1000ULL * Parameter.max_mopcycle_duration))
         {
-            gcycle_angley = gcycle_angley + (float)fabs((double)gyr_sny) * dt;
+            gcycle_angley = gcycle_angley + fabsf(gyr_sny) * dt;
         }
         else
         {
@@ -1730,7 +1747,7 @@ void algorithm_execute_process(void)
         gyr_soy = gyr_sny;
         gyr_troy = gyr_trny;
 
-        if ((handle_in_mopping_position[0] == 0) || ((Gyr_fy_thr_ergy + Gyr_fx_thr_ergy) <= (1.5 * Gyr_fz_thr_ergy)))
+        if ((handle_in_mopping_position[0] == 0) || ((Gyr_fy_thr_ergy + Gyr_fx_thr_ergy) <= (1.5f * Gyr_fz_thr_ergy)))
         {
             gcycle_angley = 0;
             gcycle_anglex = 0;
@@ -1741,7 +1758,7 @@ void algorithm_execute_process(void)
 
         ///////////////////////////////////
 
-        if (((Mopping_motion_gyr_flagy == 1) || (Mopping_motion_gyr_flagx == 1)) && (handle_in_mopping_position[0] == 1) && (Acc_dc_avg_min > 0.9 * EARTH_GRAVITY) && ((Gyr_fy_thr_ergy + Gyr_fx_thr_ergy) > 1.5 * Gyr_fz_thr_ergy))
+        if (((Mopping_motion_gyr_flagy == 1) || (Mopping_motion_gyr_flagx == 1)) && (handle_in_mopping_position[0] == 1) && (Acc_dc_avg_min > 0.9f * EARTH_GRAVITY) && ((Gyr_fy_thr_ergy + Gyr_fx_thr_ergy) > 1.5f * Gyr_fz_thr_ergy))
         {
             Mopping_motion_gyr_flag = 1;
             Mopping_motion_gyr_flag_lastupdate_tsp = unixtime_ms;
@@ -1757,7 +1774,7 @@ void algorithm_execute_process(void)
         {
             mopping_pattern_lastupdate_tsp = unixtime_ms;
 
-            if ((MoppingFlag[0] == 1) && (Mopping_motion_gyr_flagy == 1) && (gcycle_angley >= 1.5 * gcycle_anglex) && (Gyr_fy_thr_ergy > 0.5 * Gyr_fx_thr_ergy))
+            if ((MoppingFlag[0] == 1) && (Mopping_motion_gyr_flagy == 1) && (gcycle_angley >= 1.5f * gcycle_anglex) && (Gyr_fy_thr_ergy > 0.5f * Gyr_fx_thr_ergy))
             {
                 // user mops with s or 8 shape movement
                 mopping_pattern[0] = 3;
@@ -1767,7 +1784,7 @@ void algorithm_execute_process(void)
                     shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Mopping with S-shape movement\n");
                 }
             }
-            else if ((MoppingFlag[0] == 1) && (Mopping_motion_gyr_flagx == 1) && (Gyr_fy_thr_ergy < 0.5 * Gyr_fx_thr_ergy))
+            else if ((MoppingFlag[0] == 1) && (Mopping_motion_gyr_flagx == 1) && (Gyr_fy_thr_ergy < 0.5f * Gyr_fx_thr_ergy))
             {
                 // user mops with back and forth movement
                 mopping_pattern[0] = 2;
@@ -1777,7 +1794,7 @@ void algorithm_execute_process(void)
                     shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Mopping with back-forth movement\n");
                 }
             }
-            else if ((MoppingFlag[0] == 1) && (Acc_dc_avg_min >= 1.1 * EARTH_GRAVITY))
+            else if ((MoppingFlag[0] == 1) && (Acc_dc_avg_min >= 1.1f * EARTH_GRAVITY))
             {
                 // user mops with unknown pattern
                 mopping_pattern[0] = 1;
@@ -1888,7 +1905,7 @@ void check_max_sqm_coveraged_per_mop(void)
     /* Check sqm coverage for each side (and total) */
     if (current_mop_sides == 2)
     {
-        if ((mob_max_sqm_reached == false) && (mopping_coverage_side1 >= (Parameter.max_sqm_coveraged_per_mop / 2.0)) && (mopping_coverage_side2 >= (Parameter.max_sqm_coveraged_per_mop / 2.0)))
+        if ((mob_max_sqm_reached == false) && (mopping_coverage_side1 >= (Parameter.max_sqm_coveraged_per_mop / 2.0f)) && (mopping_coverage_side2 >= (Parameter.max_sqm_coveraged_per_mop / 2.0f)))
         {
             Notification.next_state = NOTIFICATION_MAX_SQM_COVERAGE_REACHED;
             mob_max_sqm_reached = true;
@@ -1902,7 +1919,7 @@ void check_max_sqm_coveraged_per_mop(void)
                 }
             }
         }
-        else if ((mob_max_side1_sqm_reached == false) && (mopping_coverage_side1 >= (Parameter.max_sqm_coveraged_per_mop / 2.0)) && (mopping_coverage_per_mop < Parameter.max_sqm_coveraged_per_mop))
+        else if ((mob_max_side1_sqm_reached == false) && (mopping_coverage_side1 >= (Parameter.max_sqm_coveraged_per_mop / 2.0f)) && (mopping_coverage_per_mop < Parameter.max_sqm_coveraged_per_mop))
         {
             Notification.next_state = NOTIFICATION_SIDE_MAX_SQM_COVERAGE_REACHED;
             mob_max_side1_sqm_reached = true;
@@ -1916,7 +1933,7 @@ void check_max_sqm_coveraged_per_mop(void)
                 }
             }
         }
-        else if ((mob_max_side2_sqm_reached == false) && (mopping_coverage_side2 >= (Parameter.max_sqm_coveraged_per_mop / 2.0)) && (mopping_coverage_per_mop < Parameter.max_sqm_coveraged_per_mop))
+        else if ((mob_max_side2_sqm_reached == false) && (mopping_coverage_side2 >= (Parameter.max_sqm_coveraged_per_mop / 2.0f)) && (mopping_coverage_per_mop < Parameter.max_sqm_coveraged_per_mop))
         {
             Notification.next_state = NOTIFICATION_SIDE_MAX_SQM_COVERAGE_REACHED;
             mob_max_side2_sqm_reached = true;
@@ -1933,7 +1950,7 @@ void check_max_sqm_coveraged_per_mop(void)
     }
     if (current_mop_sides == 1)
     {
-        if ((mob_max_sqm_reached == false) && (mopping_coverage_per_mop >= (Parameter.max_sqm_coveraged_per_mop / 2.0)))
+        if ((mob_max_sqm_reached == false) && (mopping_coverage_per_mop >= (Parameter.max_sqm_coveraged_per_mop / 2.0f)))
         {
             Notification.next_state = NOTIFICATION_MAX_SQM_COVERAGE_REACHED;
             mob_max_sqm_reached = true;
@@ -15,7 +15,6 @@
 
 #include "cloud.h"
 
-int64_t memerror_upd_tsp = 0LL;
 uint8_t Cloud_TestCredentials = false;
 time_t timestamp_last_cloud_transmission = 0;
 uint32_t coap_last_transmission_timer = 0;
@@ -109,21 +108,31 @@ void protobuf_UpdateDeviceStatusData(DeviceStatus *DeviceStatusObject)
 }
 
 /**
- * @brief Triggers protobuf pack function and send the packed protobuf data to the cloud (with DTLS CoAP)
- *
+ * @brief Links the DeviceStatus and the EventArray into the PackageDevice2Hub object and updates the DeviceStatus
+ * @details Has to be called right before protobuf_EncodeUsageUpdateObject(), the returned size is exactly the number of bytes the encoder will stream
+ * @return uint32_t: Packed size of the PackageDevice2Hub object
  */
-uint32_t protobuf_EncodeUsageUpdateObject(uint8_t **buf)
+uint32_t protobuf_PrepareUsageUpdateObject(void)
 {
   /* https://github.com/protobuf-c/protobuf-c/wiki/Examples */
-  uint16_t len = 0;
-  uint16_t i = 0;
-  uint8_t *memory = NULL;
+  uint32_t len = 0;
 
   /* Point myPackageDevice2Hub to myPackageDevice2Hub object*/
   myPackageDevice2Hub.usage_update_message = &myUsageUpdate;
 
-  dataupdate_uuid.len = 5;
-  dataupdate_uuid.data = "12345";
+  /* Confirm the DataUpdate the active databases were created from */
+  const EPC_DATABASE_HEADER *database_header = EPC_Database_GetHeader(NULL);
+
+  if (database_header->generation > 0)
+  {
+    dataupdate_uuid.len = database_header->uuid_length;
+    dataupdate_uuid.data = (uint8_t *)database_header->uuid;
+  }
+  else
+  {
+    dataupdate_uuid.len = 5;
+    dataupdate_uuid.data = "12345";
+  }
 
   hubupdate_uuid.len = 5;
   hubupdate_uuid.data = "67890";
@@ -147,7 +156,6 @@ uint32_t protobuf_EncodeUsageUpdateObject(uint8_t **buf)
     shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "EventArray packed size: %d bytes\n", len);
   }
 
-  /* Serialize message */
   len = package_device2_hub__get_packed_size(&myPackageDevice2Hub);
 
   /* Print out debug messages */
@@ -157,53 +165,27 @@ uint32_t protobuf_EncodeUsageUpdateObject(uint8_t **buf)
     shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "myPackageDevice2Hub packed size: %d bytes\n", len);
   }
 
-  /* Serialize message */
-  memory = malloc(len);
-
-  if (memory != NULL)
-  {
-    /* Serialize message */
-    package_device2_hub__pack(&myPackageDevice2Hub, memory); // Pack (serialize) msg, including submessages
+  return len;
+}
 
-    /* Print out debug messages */
-    if (Parameter.debug == true || Parameter.protobuf_verbose == true)
-    {
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Total serialized length: %d bytes bytes\n", len);
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Serialized message:\n");
+/**
+ * @brief Serializes the PackageDevice2Hub object prepared by protobuf_PrepareUsageUpdateObject()
+ * @details The message is streamed piece by piece into the append function of the buffer (e.g. flash pages), so it never has to be
+ * in RAM completely and no heap is needed
+ * @param buffer: Buffer which receives the serialized message
+ * @return uint32_t: Number of bytes streamed into the buffer
+ */
+uint32_t protobuf_EncodeUsageUpdateObject(ProtobufCBuffer *buffer)
+{
+  uint32_t len = 0;
 
-      for (i = 0; i < len; i++)
-      {
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, " 0x%02X", memory[i]);
-      }
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "\n");
-    }
+  len = package_device2_hub__pack_to_buffer(&myPackageDevice2Hub, buffer); // Pack (serialize) msg, including submessages
 
-    *buf = memory;
-  }
-  else
+  /* Print out debug messages */
+  if (Parameter.debug == true || Parameter.protobuf_verbose == true)
   {
-    //***************** TL new input 05.03.22 bug fix for memory allocation *******************************************
-    shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Error: Can not allocate memory for UsageObject, need %d bytes, but only %d available on heap\n", len, memcheck_heap_freespace());
-
-    /* Clear EventArray (free all allocated memory to clean up heap memory) and reset last seen location strings */
-    Event_ClearArray();
-    // clear_last_seen_location_record_array();
-
-    if ((unixtime_ms - memerror_upd_tsp) > 2 * Parameter.cloud_sync_interval_idle)
-    {
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "System will reboot, it can not allocate memory for coap UsageObject.\n");
-
-      Device_PushRAMToFlash();
-      lte_lc_power_off();
-
-      k_msleep(1000); // Delay the reboot to give the system enough time to ouput the debug message on console
-
-      sys_reboot(0);
-    }
-    memerror_upd_tsp = unixtime_ms;
+    rtc_print_debug_timestamp();
+    shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Total serialized length: %d bytes\n", len);
   }
 
   return len;
@@ -211,88 +193,96 @@ uint32_t protobuf_EncodeUsageUpdateObject(uint8_t **buf)
 
 /**
  * @brief Triggers protobuf pack function and send the packed protobuf data to the cloud (with DTLS CoAP)
- *
+ * @details The events in RAM and the current DeviceStatus are appended to the event journal in the external flash as newest message.
+ * Then all messages are streamed block by block from the flash to the cloud, oldest first.
  */
 void cloud_SendUsageUpdateObject(void)
 {
-  uint8_t *payload = NULL;
-  uint16_t len = 0;
-  uint8_t rslt = 0;
+  COAP_PAYLOAD_SOURCE source;
+  EVENT_LIST_OF_OUTSOURCED_MESSAGES message;
+  int16_t err = 0;
   uint32_t message_count = 0;
+  uint32_t messages_in_list = 0;
+
+  /* ########### LOCAL EVENT MESSAGES STORED IN RAM ############# */
 
-  /* Pack UsageObject in RAM inlcuding all events in a protobuf object */
+  /* Pack UsageObject in RAM inlcuding all events in a protobuf object and queue it behind the older messages to keep the order */
   if (Parameter.protobuf_verbose == true)
   {
     rtc_print_debug_timestamp();
-    shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Send protobuf message from RAM array in blocks\n", EVENT_MAX_ITEMS_IN_ARRAY, Event_NumberOfOutsourcedMessages);
+    shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Queue protobuf message from RAM array (%d events) behind %d outsourced messages\n", Event_ItemsInArray, Event_NumberOfOutsourcedMessages);
   }
 
+  /* Store and clear under one lock, otherwise an event added in between would be cleared without being stored. Without events
+     no journal record is written, so an idle device does not erase a flash sector every sync interval */
+  k_mutex_lock(&event_mutex, K_FOREVER);
+
+  if ((Event_ItemsInArray > 0) && (Event_StorePackedUsageObjectToFlash() == true))
+  {
+    /* Clear EventArray (return all event objects to the pool), the events are in the flash now */
+    Event_ClearArray();
+  }
+  // else: Keep the events in RAM, they are stored again with the next cloud cycle (or when the array is full)
+
+  k_mutex_unlock(&event_mutex);
+
   /* ############# OUTSOURCED EVENT MESSAGES FROM FLASH MEMORY ##############*/
 
-  /* Send payload as CoAP message and delete then the allocated memories (call Event_ClearArray)
-     payload contains 64 events in maximum, more then 64 events gets send in another CoAP message */
-  while ((message_count < Event_NumberOfOutsourcedMessages) && (MoppingFlag[0] == 0))
+  /* Send each message as CoAP blockwise transfer, the oldest message is sent first. The sending stops at the first failure and the
+     remaining messages stay in the flash. Each list entry is copied under the lock, the lock is not held while sending */
+  while (MoppingFlag[0] == 0)
   {
-    if (Parameter.protobuf_verbose == true)
+    k_mutex_lock(&event_mutex, K_FOREVER);
+    messages_in_list = Event_NumberOfOutsourcedMessages;
+    if (message_count < messages_in_list)
     {
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_YELLOW, "Fetching (%d events per block, byte length %d, flash addr: 0x%X) protobuf messsage no. %d/%d from external flash and send them in blocks\n", EVENT_MAX_ITEMS_IN_ARRAY, Event_ListOfOutsourcedMessages[message_count].length, EVENT_MEM + Event_ListOfOutsourcedMessages[message_count].start_address, message_count + 1, Event_NumberOfOutsourcedMessages);
+      message = Event_ListOfOutsourcedMessages[message_count];
     }
+    k_mutex_unlock(&event_mutex);
 
-    rslt = Event_ReadFromFlash(Event_ListOfOutsourcedMessages[message_count].start_address, Event_ListOfOutsourcedMessages[message_count].length, &payload);
+    if (message_count >= messages_in_list)
+    {
+      break;
+    }
 
-    if (rslt == true)
+    if (Parameter.protobuf_verbose == true)
     {
-      k_msleep(10);
-      send_coap_request(COAP_METHOD_POST, payload, Event_ListOfOutsourcedMessages[message_count].length);
+      rtc_print_debug_timestamp();
+      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_YELLOW, "Sending (byte length %d, flash addr: 0x%X) protobuf messsage no. %d/%d from external flash in blocks\n", message.length, EVENT_MEM + message.start_address, message_count + 1, messages_in_list);
+    }
 
-      if (Parameter.events_verbose)
-      {
-        rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_YELLOW, "Sent outsourced message no. %d of %d\n", message_count + 1, Event_NumberOfOutsourcedMessages);
-      }
+    Event_GetPayloadSource(&message, &source);
 
-      message_count++;
+    k_msleep(10);
+    err = send_coap_request_from_source(COAP_METHOD_POST, &source);
 
-      /* Free the allocated serialized buffer */
-      free(payload);
-    }
-    else
+    if (err != 0)
     {
       rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory to import protbuf message from external flash\n");
+      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not send outsourced message no. %d, keep it in the flash\n", message_count + 1);
       break;
     }
 
-    k_msleep(100);
-  }
-
-  /* Clear list of outsourced messages */
-  for (uint32_t j = 0; j < Event_NumberOfOutsourcedMessages; j++)
-  {
-    Event_ListOfOutsourcedMessages[j].start_address = 0UL;
-    Event_ListOfOutsourcedMessages[j].length = 0UL;
-  }
-
-  message_count = 0;
-  Event_NumberOfOutsourcedMessages = 0;
+    if (Parameter.events_verbose)
+    {
+      rtc_print_debug_timestamp();
+      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_YELLOW, "Sent outsourced message no. %d of %d\n", message_count + 1, messages_in_list);
+    }
 
-  /* ########### LOCAL EVENT MESSAGES STORED IN RAM ############# */
-  len = protobuf_EncodeUsageUpdateObject(&payload); // payload holds the packed protobuf message (UsageUpdate object)
- 
+    message_count++;
 
-  send_coap_request(COAP_METHOD_POST, payload, len);
+    k_msleep(100);
+  }
 
-  /* Free the allocated serialized buffer */
-  free(payload);
+  /* Mark the sent messages as acknowledged in the journal and remove them from the list */
+  Event_AcknowledgeOutsourcedMessages(message_count);
 
   /* Reset variables */
   time_since_last_cloud_transmission = 0;
   timestamp_last_cloud_transmission = unixtime_ms;
   coap_last_transmission_timer = 0;
 
-  /* Clear EventArray (free all allocated memory to clean up heap memory) and reset last seen location strings */
-  Event_ClearArray();
+  /* Reset last seen location strings */
   clear_last_seen_location_record_array();
 
   /* Check for messages from cloud*/
@@ -414,6 +404,46 @@ void cloud_DecodeDataUpdateProtobuf(uint8_t *message, uint16_t len)
   }
   else
   {
+    /* Apply the rfid, room and mop databases. The record blobs have the flash layout of the records. */
+    if (ptrDataUpdate->contains_localdata == true && ptrDataUpdate->local_data != NULL)
+    {
+      EPC_DATABASE_UPDATE database_update;
+
+      ptrLocalData = ptrDataUpdate->local_data;
+      memset(&database_update, 0, sizeof(database_update));
+
+      if (ptrLocalData->contains_rfids == true)
+      {
+        database_update.table[EPC_TABLE_RFID].records = ptrLocalData->rfids.data;
+        database_update.table[EPC_TABLE_RFID].length = ptrLocalData->rfids.len;
+      }
+
+      if (ptrLocalData->contains_rooms == true)
+      {
+        database_update.table[EPC_TABLE_ROOM].records = ptrLocalData->rooms.data;
+        database_update.table[EPC_TABLE_ROOM].length = ptrLocalData->rooms.len;
+      }
+
+      if (ptrLocalData->contains_mops == true)
+      {
+        database_update.table[EPC_TABLE_MOP].records = ptrLocalData->mops.data;
+        database_update.table[EPC_TABLE_MOP].length = ptrLocalData->mops.len;
+      }
+
+      database_update.uuid = ptrDataUpdate->dataupdate_uuid.data;
+      database_update.uuid_length = ptrDataUpdate->dataupdate_uuid.len;
+
+      if (Provision_IsActive() == true)
+      {
+        /* The uuid is not confirmed, the server sends the DataUpdate again */
+        rtc_print_debug_timestamp();
+        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_YELLOW, "Provisioning over the shell active, DataUpdate local data ignored\n");
+      }
+      else
+      {
+        EPC_Database_ApplyUpdate(GPIO_PIN_FLASH_CS2, &database_update);
+      }
+    }
 
     //// Point submessages to correct message
     // ptrHubCommands = ptrHubUpdate->hub_commands;
@@ -427,5 +457,8 @@ void cloud_DecodeDataUpdateProtobuf(uint8_t *message, uint16_t len)
     //  //   printk("Received: event=%d\n", ptrMyEventArray->event_message[0]->one_of_generic_event_case);
   }
 
-  data_update__free_unpacked(ptrDataUpdate, NULL);
+  if (ptrDataUpdate != NULL)
+  {
+    data_update__free_unpacked(ptrDataUpdate, NULL);
+  }
 }
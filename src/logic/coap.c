@@ -41,27 +41,39 @@ int nfds;
 
 char uri_path[] = "telemetry"; // Resource to use
 
+static bool coap_address_valid = false;      // server holds a resolved address
+static int64_t coap_address_resolved_at = 0; // k_uptime_get() when the address was resolved
+static bool coap_connected = false;          // coap_sock is open and connected
+static bool coap_connection_reused = false;  // The last start_coap_client() call returned an already open socket
+static int64_t coap_last_activity = 0;       // k_uptime_get() of the last successful transfer
+static atomic_t coap_connection_invalid = ATOMIC_INIT(0);
+
 /*!
- * @brief Creates a DTLS CoAP socket to the Bosch IoT cloud
+ * @brief Resolves the IP address of the Bosch IoT cloud, the address is cached for COAP_DNS_CACHE_TTL
  * @return 0 if successfull, -1 if failed
  */
-int16_t start_coap_client(void)
+static int16_t coap_resolve_server(void)
 {
+  int16_t err = 0;
+
+  if ((coap_address_valid == true) && ((k_uptime_get() - coap_address_resolved_at) < (COAP_DNS_CACHE_TTL * MSEC_PER_SEC)))
+  {
+    return 0;
+  }
+
   if (Parameter.debug == true || Parameter.coap_verbose == true)
   {
     rtc_print_debug_timestamp();
     shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Start resolving IP address\n");
   }
 
-  int16_t err = 0;
-
   char ipv4_addr[NET_IPV4_ADDR_LEN];
   struct addrinfo *result_coap;
   struct addrinfo hints_coap = {
       .ai_family = AF_INET,
       .ai_socktype = SOCK_DGRAM};
 
-  err = getaddrinfo("coap.bosch-iot-hub.com", NULL, &hints_coap, &result_coap); // Bosch IoT Suite from FHCS (IP: 3.124.207.218)  // err = getaddrinfo("64.225.102.80", NULL, &hints_coap, &result_coap); // keiltronic CoAP test server on digital ocean droplet
+  err = getaddrinfo(COAP_SERVER_HOSTNAME, NULL, &hints_coap, &result_coap); // Bosch IoT Suite from FHCS (IP: 3.124.207.218)  // err = getaddrinfo("64.225.102.80", NULL, &hints_coap, &result_coap); // keiltronic CoAP test server on digital ocean droplet
 
   //  err = getaddrinfo("3.123.219.173", NULL, &hints_coap, &result_coap); // Bosch IoT Suite from FHCS (IP: 3.124.207.218)  // err = getaddrinfo("64.225.102.80", NULL, &hints_coap, &result_coap); // keiltronic CoAP test server on digital ocean droplet
   // err = getaddrinfo("3.69.222.237", NULL, &hints_coap, &result_coap); // Bosch IoT Suite from FHCS (IP: 3.124.207.218)  // err = getaddrinfo("64.225.102.80", NULL, &hints_coap, &result_coap); // keiltronic CoAP test server on digital ocean droplet
@@ -86,6 +98,9 @@ int16_t start_coap_client(void)
 
     /* Free the address. */
     freeaddrinfo(result_coap);
+
+    coap_address_valid = true;
+    coap_address_resolved_at = k_uptime_get();
   }
   else
   {
@@ -103,6 +118,68 @@ int16_t start_coap_client(void)
     return -1;
   }
 
+  return 0;
+}
+
+/*!
+ * @brief Closes the DTLS CoAP socket. The next start_coap_client() call connects again (with DTLS session resumption if the modem cached the session).
+ */
+void coap_disconnect(void)
+{
+  if (coap_connected == true)
+  {
+    (void)close(coap_sock);
+    coap_connected = false;
+
+    if (Parameter.debug == true || Parameter.coap_verbose == true)
+    {
+      rtc_print_debug_timestamp();
+      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Socket closed\n");
+    }
+  }
+}
+
+/*!
+ * @brief Marks the open CoAP connection as unusable, e.g. after the LTE link was lost. Can be called from any context, the socket
+ * is closed by the next transfer.
+ */
+void coap_invalidate_connection(void)
+{
+  atomic_set(&coap_connection_invalid, 1);
+}
+
+/*!
+ * @brief Creates a DTLS CoAP socket to the Bosch IoT cloud or reuses the open one
+ * @details The socket stays open between the sync intervals, so the DTLS handshake is only done once. The idle limit follows the
+ * longest sync interval (plus COAP_SOCKET_IDLE_MARGIN), so every regular sync reuses the socket. After a longer pause (e.g. missed
+ * syncs) a new socket is connected and the modem resumes the cached DTLS session. If the NAT binding of the operator expired
+ * earlier, the failed transfer on the reused socket is repeated on a new one (send_coap_request_from_source).
+ * @return 0 if successfull, -1 if failed
+ */
+int16_t start_coap_client(void)
+{
+  int16_t err = 0;
+  int64_t idle_limit = (int64_t)(MAX(Parameter.cloud_sync_interval_idle, Parameter.cloud_sync_interval_moving) + COAP_SOCKET_IDLE_MARGIN) * MSEC_PER_SEC;
+
+  if (atomic_cas(&coap_connection_invalid, 1, 0))
+  {
+    coap_disconnect();
+  }
+
+  if ((coap_connected == true) && ((k_uptime_get() - coap_last_activity) < idle_limit))
+  {
+    coap_connection_reused = true;
+    return 0;
+  }
+
+  coap_disconnect();
+  coap_connection_reused = false;
+
+  if (coap_resolve_server() != 0)
+  {
+    return -1;
+  }
+
   if (Parameter.debug == true || Parameter.coap_verbose == true)
   {
     rtc_print_debug_timestamp();
@@ -120,7 +197,6 @@ int16_t start_coap_client(void)
       rtc_print_debug_timestamp();
       shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Failed to create UDP socket with DTLS\n");
     }
-    (void)close(coap_sock);
     return -1;
   }
   else
@@ -153,6 +229,32 @@ int16_t start_coap_client(void)
     }
   }
 
+#if defined(TLS_SESSION_CACHE)
+  /* Let the modem cache the DTLS session, a reconnect is then only an abbreviated handshake. Not fatal if it is not supported. */
+  int session_cache = 1; // TLS_SESSION_CACHE_ENABLED
+
+  err = setsockopt(coap_sock, SOL_TLS, TLS_SESSION_CACHE, &session_cache, sizeof(session_cache));
+
+  if ((err < 0) && (Parameter.debug == true || Parameter.coap_verbose == true))
+  {
+    rtc_print_debug_timestamp();
+    shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "DTLS session cache not supported\n");
+  }
+#endif
+
+#if defined(TLS_DTLS_CID)
+  /* With a DTLS connection id the session survives a changed NAT binding. Not fatal if modem or server do not support it. */
+  int dtls_cid = TLS_DTLS_CID_SUPPORTED;
+
+  err = setsockopt(coap_sock, SOL_TLS, TLS_DTLS_CID, &dtls_cid, sizeof(dtls_cid));
+
+  if ((err < 0) && (Parameter.debug == true || Parameter.coap_verbose == true))
+  {
+    rtc_print_debug_timestamp();
+    shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "DTLS connection id not supported\n");
+  }
+#endif
+
   err = connect(coap_sock, (struct sockaddr *)&server, sizeof(struct sockaddr_in));
 
   if (err == 0)
@@ -171,14 +273,28 @@ int16_t start_coap_client(void)
       shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Failed to connect to socket.\n");
     }
     (void)close(coap_sock);
+
+    /* The server may have moved, resolve the address again with the next try */
+    coap_address_valid = false;
     return -1;
   }
 
   prepare_fds();
 
+  coap_connected = true;
+  coap_last_activity = k_uptime_get();
+
   return 0;
 }
 
+/*!
+ * @brief Read function of a payload source which is completely in RAM
+ */
+static void coap_read_memory_payload(const COAP_PAYLOAD_SOURCE *source, uint32_t offset, uint8_t *data, uint16_t len)
+{
+  memcpy(data, (const uint8_t *)source->context + offset, len);
+}
+
 /**
  * @brief Sends blockwise data over CoAP to the cloud
  * 
@@ -189,225 +305,498 @@ int16_t start_coap_client(void)
  */
 int16_t send_coap_request(uint8_t method, uint8_t *message, uint16_t len)
 {
+  COAP_PAYLOAD_SOURCE source = {
+      .length = len,
+      .read = coap_read_memory_payload,
+      .context = message};
+
+  return send_coap_request_from_source(method, &source);
+}
+
+/* One Block1 request which is on its way to the server */
+typedef struct
+{
+  bool used;
+  bool acked;             // Empty ACK received, the response follows separately
+  bool last;              // Block without the more flag, its response is the response to the whole request
+  uint16_t message_id;
+  uint8_t token[COAP_TOKEN_LENGTH];
+  uint32_t offset;        // Offset of the block in the payload
+  uint16_t length;        // Payload bytes in this block
+  uint8_t szx;            // Block size exponent the block was sent with
+  uint8_t retransmissions;
+  uint32_t timeout;       // Current retransmission timeout in ms, doubled with each retransmission
+  int64_t deadline;       // k_uptime_get() of the next retransmission
+} COAP_BLOCK1_EXCHANGE;
+
+static COAP_BLOCK1_EXCHANGE coap_exchanges[COAP_NSTART];
+static uint8_t coap_block1_szx = COAP_BLOCK_SIZE; // Block size the server accepted last, kept for the next transfers
+static uint8_t coap_rx_buffer[MAX_COAP_MSG_LEN];
+
+/**
+ * @brief Builds the CoAP request of one Block1 exchange into the request buffer. A retransmission builds the identical packet again,
+ * so the payload does not need to be kept in RAM while the block is in flight.
+ *
+ * @param method: COAP_METHOD_GET, COAP_METHOD_DELETE, COAP_METHOD_PUT, COAP_METHOD_POST
+ * @param source: Payload source
+ * @param exchange: Block which is sent
+ * @return int16_t: 0 if successfull, negative value if failed
+ */
+static int16_t coap_block1_build(uint8_t method, const COAP_PAYLOAD_SOURCE *source, const COAP_BLOCK1_EXCHANGE *exchange)
+{
+  static uint8_t block[COAP_BLOCK_SIZE_BYTES];
+  uint8_t content_type = COAP_CONTENT_FORMAT_APP_OCTET_STREAM;
+  uint32_t block1 = 0;
   int16_t rslt = 0;
-  uint16_t packet_id = 0;
 
-  /* Open UDP socket to server address and connect to it */
-  rslt = start_coap_client();
+  rslt = coap_packet_init(&request, data, MAX_COAP_MSG_LEN, COAP_VERSION_1, COAP_TYPE_CON, COAP_TOKEN_LENGTH, exchange->token, method, exchange->message_id);
+
+  if (rslt >= 0)
+  {
+    rslt = coap_packet_append_option(&request, COAP_OPTION_URI_PATH, uri_path, strlen(uri_path));
+  }
 
-  if (rslt == 0)
+  if (rslt >= 0)
   {
-    /* Init structure for block transfer */
-    struct coap_block_context ctx;
+    rslt = coap_packet_append_option(&request, COAP_OPTION_CONTENT_FORMAT, &content_type, sizeof(content_type));
+  }
 
-    int16_t coap_next_block_available = true;
-    uint8_t block_number = 0;
+  /* Block1 option: block number, more flag and block size exponent (RFC 7959, chapter 2.2) */
+  block1 = ((exchange->offset >> (exchange->szx + 4)) << 4) | ((exchange->last == false) ? 0x08 : 0) | exchange->szx;
 
-    /* Will return 0 when it's the last block. */
-    memset(&ctx, 0, sizeof(ctx));
+  if (rslt >= 0)
+  {
+    rslt = coap_append_option_int(&request, COAP_OPTION_BLOCK1, block1);
+  }
 
-    while (coap_next_block_available)
+  /* Size1 tells the server the size of the whole payload, so it can reject it before all blocks are sent */
+  if ((rslt >= 0) && (exchange->offset == 0))
+  {
+    rslt = coap_append_option_int(&request, COAP_OPTION_SIZE1, source->length);
+  }
+
+  if ((rslt >= 0) && (exchange->length > 0))
+  {
+    source->read(source, exchange->offset, block, exchange->length);
+
+    rslt = coap_packet_append_payload_marker(&request);
+
+    if (rslt >= 0)
     {
-      if (Parameter.debug == true || Parameter.coap_verbose == true)
+      rslt = coap_packet_append_payload(&request, block, exchange->length);
+    }
+  }
+
+  if ((rslt < 0) && (Parameter.debug == true || Parameter.coap_verbose == true))
+  {
+    rtc_print_debug_timestamp();
+    shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "ERROR %d: Could not build CoAP packet of block at offset %d\n", rslt, exchange->offset);
+  }
+
+  return rslt;
+}
+
+/**
+ * @brief Builds and sends (or resends) the request of one Block1 exchange
+ * @return int16_t: 0 if successfull, -1 if failed
+ */
+static int16_t coap_block1_send(uint8_t method, const COAP_PAYLOAD_SOURCE *source, const COAP_BLOCK1_EXCHANGE *exchange)
+{
+  if (coap_block1_build(method, source, exchange) < 0)
+  {
+    return -1;
+  }
+
+  if (send(coap_sock, request.data, request.offset, 0) <= 0)
+  {
+    if (Parameter.debug == true || Parameter.coap_verbose == true)
+    {
+      rtc_print_debug_timestamp();
+      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "ERROR: Sending CoAP packet failed\n");
+    }
+    return -1;
+  }
+
+  if (Parameter.debug == true || Parameter.coap_verbose == true)
+  {
+    rtc_print_debug_timestamp();
+    shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "%s block no. %d (%d bytes, MID %d), packet length: %d bytes\n",
+                  (exchange->retransmissions == 0) ? "Send" : "Retransmit", exchange->offset >> (exchange->szx + 4), exchange->length, exchange->message_id, request.offset);
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Acknowledges a confirmable separate response of the server with an empty ACK
+ */
+static void coap_send_empty_ack(uint16_t message_id)
+{
+  struct coap_packet ack;
+  uint8_t ack_data[COAP_EMPTY_MESSAGE_LENGTH];
+
+  if (coap_packet_init(&ack, ack_data, sizeof(ack_data), COAP_VERSION_1, COAP_TYPE_ACK, 0, NULL, COAP_CODE_EMPTY, message_id) >= 0)
+  {
+    (void)send(coap_sock, ack.data, ack.offset, 0);
+  }
+}
+
+/**
+ * @brief Returns the exchange the received message belongs to. ACK and RST are matched by the message id, separate responses by
+ * the token. A piggybacked response must additionally carry the token of the request.
+ * @return COAP_BLOCK1_EXCHANGE*: Matching exchange or NULL (e.g. a late duplicate of an already completed exchange)
+ */
+static COAP_BLOCK1_EXCHANGE *coap_block1_match(const struct coap_packet *reply)
+{
+  uint8_t type = coap_header_get_type(reply);
+  uint16_t message_id = coap_header_get_id(reply);
+  uint8_t token[COAP_TOKEN_MAX_LEN];
+  uint8_t token_length = coap_header_get_token(reply, token);
+  uint8_t i = 0;
+
+  for (i = 0; i < COAP_NSTART; i++)
+  {
+    COAP_BLOCK1_EXCHANGE *exchange = &coap_exchanges[i];
+    bool token_match = (token_length == COAP_TOKEN_LENGTH) && (memcmp(token, exchange->token, COAP_TOKEN_LENGTH) == 0);
+
+    if (exchange->used == false)
+    {
+      continue;
+    }
+
+    if ((type == COAP_TYPE_ACK) || (type == COAP_TYPE_RESET))
+    {
+      if (exchange->message_id != message_id)
       {
-        rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_YELLOW, "###### CoAP blockwise transfer no. %d ##############################################\n", block_number);
+        continue;
       }
 
-      if (ctx.total_size == 0)
+      /* Empty ACK and RST have no token */
+      if ((type == COAP_TYPE_RESET) || (coap_header_get_code(reply) == COAP_CODE_EMPTY) || (token_match == true))
       {
-        coap_block_transfer_init(&ctx, COAP_BLOCK_SIZE, len);
+        return exchange;
       }
+    }
+    else if (token_match == true)
+    {
+      return exchange;
+    }
+  }
 
-      /* Build new CoAP packet (PUT method, TYPE-CON) and insert URI path, URI query and payload */
-      packet_id = coap_next_id();
-      rslt = coap_packet_init(&request, data, MAX_COAP_MSG_LEN, 1, COAP_TYPE_CON, 0, NULL, method, packet_id);
+  return NULL;
+}
 
-      if (Parameter.debug == true || Parameter.coap_verbose == true)
+/**
+ * @brief Sends blockwise data over the CoAP connection (RFC 7959 Block1), the payload is read block by block from the source
+ * @details Every block is a confirmable request. The block is retransmitted with exponential backoff (RFC 7252, chapter 4.2) until
+ * the response of the server arrived, either piggybacked in the ACK or as separate response. The transfer starts with the last block
+ * size the server accepted. If the server answers 2.31 Continue or 4.13 Request Entity Too Large with a smaller block size, the
+ * transfer continues (or restarts) with this size. When the block size is confirmed, up to COAP_NSTART blocks are in flight. The
+ * last block is sent when all other blocks are acknowledged, its response is the response to the whole request.
+ *
+ * @param method: COAP_METHOD_GET, COAP_METHOD_DELETE, COAP_METHOD_PUT, COAP_METHOD_POST
+ * @param source: Payload source
+ * @return int16_t: 0 if successfull, -1 if failed
+ */
+static int16_t coap_transfer(uint8_t method, const COAP_PAYLOAD_SOURCE *source)
+{
+  struct coap_packet reply;
+  uint32_t total_length = source->length;
+  uint32_t next_offset = 0;     // Offset of the next block which is sent the first time
+  uint8_t szx = coap_block1_szx;
+  bool size_confirmed = false;  // First response received, the block size is known
+  bool completed = false;
+  int16_t transfer_rslt = 0;
+  uint8_t in_flight = 0;
+  uint8_t i = 0;
+
+  /* GET and DELETE have no payload */
+  if ((method == COAP_METHOD_GET) || (method == COAP_METHOD_DELETE))
+  {
+    total_length = 0;
+  }
+
+  /* Open UDP socket to server address and connect to it (or reuse the open socket) */
+  if (start_coap_client() != 0)
+  {
+    return -1;
+  }
+
+  memset(coap_exchanges, 0, sizeof(coap_exchanges));
+
+  while ((completed == false) && (transfer_rslt == 0))
+  {
+    int64_t now = k_uptime_get();
+    int64_t next_deadline = now + (COAP_SEPARATE_RESPONSE_TIMEOUT * MSEC_PER_SEC);
+
+    /* Fill the window with new blocks, the last block only when all other blocks are acknowledged */
+    in_flight = 0;
+    for (i = 0; i < COAP_NSTART; i++)
+    {
+      in_flight += (coap_exchanges[i].used == true) ? 1 : 0;
+    }
+
+    for (i = 0; (i < COAP_NSTART) && (transfer_rslt == 0); i++)
+    {
+      COAP_BLOCK1_EXCHANGE *exchange = &coap_exchanges[i];
+      uint16_t block_size = 1 << (szx + 4);
+      bool last = ((next_offset + block_size) >= total_length);
+
+      if ((exchange->used == true) || (next_offset > total_length) || ((next_offset == total_length) && (total_length != 0)))
       {
-        rtc_print_debug_timestamp();
-        if (rslt < 0)
-        {
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "ERROR %d: Could not init CoAP packet\n", rslt);
-        }
-        else
-        {
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Init CoAP packet successful\n");
-        }
+        continue;
       }
 
-      rslt = coap_packet_append_option(&request, COAP_OPTION_URI_PATH, uri_path, strlen(uri_path));
-
-      if (Parameter.debug == true || Parameter.coap_verbose == true)
+      if ((in_flight > 0) && ((size_confirmed == false) || (last == true) || (in_flight >= COAP_NSTART)))
       {
-        rtc_print_debug_timestamp();
-        if (rslt < 0)
-        {
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "ERROR %d: Could not append uri_path\n", rslt);
-        }
-        else
-        {
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Appending uri_path successful\n");
-        }
+        break;
       }
 
-      /* Append Content-Format = application/octet-stream -> COAP_CONTENT_FORMAT_APP_OCTET_STREAM*/
-      uint8_t content_type = 42; // 42 = COAP_CONTENT_FORMAT_APP_OCTET_STREAM
+      memset(exchange, 0, sizeof(COAP_BLOCK1_EXCHANGE));
+      exchange->used = true;
+      exchange->last = last;
+      exchange->message_id = coap_next_id();
+      sys_rand_get(exchange->token, COAP_TOKEN_LENGTH);
+      exchange->offset = next_offset;
+      exchange->length = MIN(total_length - next_offset, block_size);
+      exchange->szx = szx;
+      exchange->timeout = COAP_ACK_TIMEOUT + (sys_rand32_get() % (((COAP_ACK_TIMEOUT * COAP_ACK_RANDOM_FACTOR) / 1000) - COAP_ACK_TIMEOUT));
+      exchange->deadline = now + exchange->timeout;
 
-      rslt = coap_packet_append_option(&request, COAP_OPTION_CONTENT_FORMAT, &content_type, sizeof(content_type));
+      transfer_rslt = coap_block1_send(method, source, exchange);
 
-      if (Parameter.debug == true || Parameter.coap_verbose == true)
+      next_offset += block_size;
+      in_flight++;
+
+      /* A request without payload is sent exactly once */
+      if (total_length == 0)
       {
-        rtc_print_debug_timestamp();
-        if (rslt < 0)
-        {
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "ERROR %d: Could not append content-format option\n", rslt);
-        }
-        else
-        {
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Appending content-format successful\n");
-        }
+        next_offset = 1;
       }
+    }
+
+    if (transfer_rslt != 0)
+    {
+      break;
+    }
 
-      rslt = coap_append_block1_option(&request, &ctx);
+    /* Retransmit blocks without ACK, give up on blocks which reached the retransmission limit */
+    for (i = 0; i < COAP_NSTART; i++)
+    {
+      COAP_BLOCK1_EXCHANGE *exchange = &coap_exchanges[i];
 
-      if (Parameter.debug == true || Parameter.coap_verbose == true)
+      if (exchange->used == false)
       {
-        rtc_print_debug_timestamp();
-        if (rslt < 0)
-        {
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "ERROR %d: Could not append block1 option\n", rslt);
-        }
-        else
-        {
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Appending block1 successful\n");
-        }
+        continue;
       }
 
-      rslt = coap_append_size1_option(&request, &ctx);
-
-      if (Parameter.debug == true || Parameter.coap_verbose == true)
+      if (now >= exchange->deadline)
       {
-        rtc_print_debug_timestamp();
-        if (rslt < 0)
+        if ((exchange->acked == true) || (exchange->retransmissions >= COAP_MAX_RETRANSMIT))
         {
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "ERROR %d: Could not append size1 option\n", rslt);
+          if (Parameter.debug == true || Parameter.coap_verbose == true)
+          {
+            rtc_print_debug_timestamp();
+            shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "ERROR: No response of the server to block no. %d\n", exchange->offset >> (exchange->szx + 4));
+          }
+          transfer_rslt = -1;
+          break;
         }
-        else
+
+        exchange->retransmissions++;
+        exchange->timeout *= 2;
+        exchange->deadline = now + exchange->timeout;
+
+        if (coap_block1_send(method, source, exchange) != 0)
         {
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Appending size1 successful\n");
+          transfer_rslt = -1;
+          break;
         }
       }
 
-      /* Append payload if method is PUT or POST */
-      switch (method)
-      {
+      next_deadline = MIN(next_deadline, exchange->deadline);
+    }
 
-      case COAP_METHOD_GET:
-      case COAP_METHOD_DELETE:
-        break;
+    if (transfer_rslt != 0)
+    {
+      break;
+    }
 
-      case COAP_METHOD_PUT:
-      case COAP_METHOD_POST:
+    /* Wait for the next message of the server or the next retransmission */
+    coap_fds[0].revents = 0;
+    if (poll(coap_fds, nfds, (int)MAX(next_deadline - k_uptime_get(), 0)) <= 0)
+    {
+      continue;
+    }
 
-        rslt = coap_packet_append_payload_marker(&request);
+    if ((coap_fds[0].revents & (POLLERR | POLLHUP | POLLNVAL)) != 0)
+    {
+      transfer_rslt = -1;
+      break;
+    }
 
-        if (Parameter.debug == true || Parameter.coap_verbose == true)
-        {
-          rtc_print_debug_timestamp();
-          if (rslt < 0)
-          {
-            shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "ERROR %d: Could not append payload marker\n", rslt);
-          }
-          else
-          {
-            shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Appending payload marker successful\n");
-          }
-        }
+    int rcvd = recv(coap_sock, coap_rx_buffer, sizeof(coap_rx_buffer), MSG_DONTWAIT);
+
+    if (rcvd <= 0)
+    {
+      if ((rcvd < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK))
+      {
+        transfer_rslt = -1;
+      }
+      continue;
+    }
 
-        /* Split payload into several block to fit into one packet with set block size */
-        uint16_t rest_payload_length = len - (block_number * coap_block_size_to_bytes(COAP_BLOCK_SIZE));
+    if (coap_packet_parse(&reply, coap_rx_buffer, rcvd, NULL, 0) < 0)
+    {
+      continue;
+    }
 
-        if (rest_payload_length > coap_block_size_to_bytes(COAP_BLOCK_SIZE))
-        {
-          rslt = coap_packet_append_payload(&request, &message[block_number * coap_block_size_to_bytes(COAP_BLOCK_SIZE)], coap_block_size_to_bytes(COAP_BLOCK_SIZE));
-        }
-        else
-        {
-          rslt = coap_packet_append_payload(&request, &message[block_number * coap_block_size_to_bytes(COAP_BLOCK_SIZE)], rest_payload_length);
-        }
+    uint8_t type = coap_header_get_type(&reply);
+    uint8_t code = coap_header_get_code(&reply);
 
-        if (Parameter.debug == true || Parameter.coap_verbose == true)
-        {
-          rtc_print_debug_timestamp();
-          if (rslt < 0)
-          {
-            shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "ERROR %d: Could not append payload\n", rslt);
-          }
-          else
-          {
-            if (rest_payload_length > coap_block_size_to_bytes(COAP_BLOCK_SIZE))
-            {
-              shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Appending payload successful, payload size: %d bytes\n", coap_block_size_to_bytes(COAP_BLOCK_SIZE));
-            }
-            else
-            {
-              shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Appending end of payload successful, payload size: %d bytes\n", rest_payload_length);
-            }
-          }
-        }
+    /* A confirmable separate response has to be acknowledged, also if it is a duplicate */
+    if (type == COAP_TYPE_CON)
+    {
+      coap_send_empty_ack(coap_header_get_id(&reply));
+    }
 
-        break;
+    COAP_BLOCK1_EXCHANGE *exchange = coap_block1_match(&reply);
 
-      default:
-        break;
+    if (exchange == NULL)
+    {
+      continue;
+    }
+
+    if (type == COAP_TYPE_RESET)
+    {
+      if (Parameter.debug == true || Parameter.coap_verbose == true)
+      {
+        rtc_print_debug_timestamp();
+        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "ERROR: Server rejected block no. %d with RST\n", exchange->offset >> (exchange->szx + 4));
       }
+      transfer_rslt = -1;
+      break;
+    }
+
+    /* Empty ACK: stop retransmitting and wait for the separate response */
+    if (code == COAP_CODE_EMPTY)
+    {
+      exchange->acked = true;
+      exchange->deadline = k_uptime_get() + (COAP_SEPARATE_RESPONSE_TIMEOUT * MSEC_PER_SEC);
+      continue;
+    }
 
-      /* Get next block */
-      coap_next_block_available = coap_next_block(&request, &ctx);
+    int block1 = coap_get_option_int(&reply, COAP_OPTION_BLOCK1);
+    uint8_t server_szx = (block1 >= 0) ? (block1 & 0x07) : exchange->szx;
 
-      if (coap_next_block_available != 0)
+    if (Parameter.debug == true || Parameter.coap_verbose == true)
+    {
+      rtc_print_debug_timestamp();
+      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Response %d.%02d to block no. %d\n", code >> 5, code & 0x1F, exchange->offset >> (exchange->szx + 4));
+    }
+
+    if (code == COAP_RESPONSE_CODE_REQUEST_TOO_LARGE)
+    {
+      /* Server wants smaller blocks: use its size or the next smaller one and send the whole payload again */
+      if (server_szx >= exchange->szx)
       {
-        block_number++;
+        if (exchange->szx == COAP_BLOCK_16)
+        {
+          transfer_rslt = -1;
+          break;
+        }
+        server_szx = exchange->szx - 1;
       }
 
+      szx = server_szx;
+      coap_block1_szx = szx;
+      size_confirmed = false;
+      next_offset = 0;
+      memset(coap_exchanges, 0, sizeof(coap_exchanges));
+      continue;
+    }
+
+    if ((code >> 5) != 2)
+    {
       if (Parameter.debug == true || Parameter.coap_verbose == true)
       {
         rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "coap_next_block result: %d\n", coap_next_block_available);
+        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "ERROR: Server responded %d.%02d\n", code >> 5, code & 0x1F);
       }
+      transfer_rslt = -1;
+      break;
+    }
 
-      /* Send CoAP message over the socket (IP4, UDP) */
-      rslt = send(coap_sock, request.data, request.offset, 0);
+    /* 2.31 Continue (or any success code): the block arrived */
+    size_confirmed = true;
 
-      if (Parameter.debug == true || Parameter.coap_verbose == true)
+    if (server_szx < exchange->szx)
+    {
+      /* The server took only the first bytes of the block in its smaller block size (RFC 7959, chapter 2.3). Continue behind them
+       * with this size, blocks still in flight are sent again. */
+      szx = server_szx;
+      coap_block1_szx = szx;
+      next_offset = ((uint32_t)(block1 >> 4) + 1) << (szx + 4);
+      exchange->used = false;
+
+      for (i = 0; i < COAP_NSTART; i++)
       {
-
-        rtc_print_debug_timestamp();
-        if (rslt > 0)
+        if (coap_exchanges[i].used == true)
         {
-         shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "successfully send CoAP packet, packet length: %d bytes byte\n", request.offset);
-        }
-        else
-        {
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "ERROR: Sending CoAP packet failed\n");
+          next_offset = MIN(next_offset, coap_exchanges[i].offset);
         }
       }
+      memset(coap_exchanges, 0, sizeof(coap_exchanges));
 
-      /* Just delay the blockwise transfer a bit after each block */
-      k_msleep(30);
+      if (next_offset >= total_length)
+      {
+        completed = true;
+      }
+      continue;
     }
 
-    (void)close(coap_sock);
-
-    if (Parameter.debug == true || Parameter.coap_verbose == true)
+    if (exchange->last == true)
     {
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Socket closed\n");
+      completed = true;
     }
+
+    exchange->used = false;
   }
 
-  return 0;
+  if (transfer_rslt == 0)
+  {
+    coap_last_activity = k_uptime_get();
+  }
+  else
+  {
+    /* Reconnect with the next transfer */
+    coap_disconnect();
+  }
+
+  return transfer_rslt;
+}
+
+/**
+ * @brief Sends blockwise data over CoAP to the cloud, the payload is read block by block from the source
+ * @details The connection of the previous transfer is reused. If the transfer fails on a reused connection (e.g. the server dropped
+ * the DTLS session), it is repeated once on a new connection.
+ *
+ * @param method: COAP_METHOD_GET, COAP_METHOD_DELETE, COAP_METHOD_PUT, COAP_METHOD_POST
+ * @param source: Payload source (e.g. a message in the external flash)
+ * @return int16_t: 0 if successfull, -1 if failed
+ */
+int16_t send_coap_request_from_source(uint8_t method, const COAP_PAYLOAD_SOURCE *source)
+{
+  int16_t rslt = 0;
+
+  rslt = coap_transfer(method, source);
+
+  if ((rslt != 0) && (coap_connection_reused == true))
+  {
+    rslt = coap_transfer(method, source);
+  }
+
+  return rslt;
 }
 
 /*!
@@ -431,9 +820,9 @@ void convert_ASCII_text_in_hexadecimal_string(char *destination, char *source)
  */
 void prepare_fds(void)
 {
-  coap_fds[nfds].fd = coap_sock;
-  coap_fds[nfds].events = POLLIN;
-  nfds++;
+  coap_fds[0].fd = coap_sock;
+  coap_fds[0].events = POLLIN;
+  nfds = 1;
 }
 
 /*!
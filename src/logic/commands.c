@@ -125,45 +125,40 @@ static int cmd_flash_verbose(const struct shell *shell, size_t argc, char **argv
  */
 static int cmd_flash_device_id(const struct shell *shell, size_t argc, char **argv)
 {
-  ARG_UNUSED(argc);
-  ARG_UNUSED(argv);
-
-  uint8_t id[4];
-  uint16_t err;
+  uint8_t id[3];
+  FLASH_COMMAND_SET *command_set;
 
-  flash_cs(atoi(argv[1]), 0);
-  err = flash_access_register(spi_dev, &spi_cfg, FLASH_MANUFACTURER_ID_CMD, &id, sizeof(id));
-  flash_cs(atoi(argv[1]), 1);
-
-  if (err)
+  if (argc != 2)
   {
-    return -EIO;
+    shell_print(shell, "Invalid parameter list");
+    return 0;
   }
 
-  shell_print(shell, "First 4 ID bytes: 0x%02X 0x%02X 0x%02X 0x%02X", id[0], id[1], id[2], id[3]);
+  flash_ReadJedecId(atoi(argv[1]), id);
+  shell_print(shell, "JEDEC ID bytes: 0x%02X 0x%02X 0x%02X", id[0], id[1], id[2]);
 
-  if (id[0] != 0x20)
-  { // Manufacturer ID - 0x20 = Micron
-    return -EIO;
-  }
-
-  if (id[1] != 0xBA)
-  { //  1. byte Device ID - 0xBA = 3V version
+  /* Identify the part again and print the selected command set */
+  if (flash_DetectDevice(atoi(argv[1])) == false)
+  {
     return -EIO;
   }
 
-  if (id[2] != 0x21)
-  { //  2. byte Device ID - 0x21 = 1GBit verion
-    return -EIO;
-  }
+  command_set = flash_GetCommandSet(atoi(argv[1]));
+  shell_print(shell, "Found %s NOR flash memory (%d MB), %d-byte addressing, read cmd: 0x%02X, dummy bytes: %d", command_set->part->name, command_set->part->size / 1048576UL, command_set->address_bytes, command_set->read_cmd, command_set->read_dummy_bytes);
 
-  if (id[3] != 0x10)
-  { //  3. byte Device ID - 0x10 = number of remaining ID bytes (16 bytes left)
-    return -EIO;
-  }
+  return 0;
+}
 
-  shell_print(shell, "Found Micron 3V 1Gbit NOR flash memory");
+/*!
+ *  @brief Prints the requests which wait for the flash service thread and how often its queues were full
+ */
+static int cmd_flash_queue(const struct shell *shell, size_t argc, char **argv)
+{
+  ARG_UNUSED(argc);
+  ARG_UNUSED(argv);
 
+  shell_print(shell, "Queued flash requests: high priority %d, normal priority %d (%d per priority)", flash_PendingRequests(FLASH_PRIORITY_HIGH), flash_PendingRequests(FLASH_PRIORITY_NORMAL), FLASH_REQUEST_QUEUE_SIZE);
+  shell_print(shell, "Rejected requests (queue full): %d", flash_request_queue_overflows);
   return 0;
 }
 
@@ -652,13 +647,26 @@ static int cmd_add_rfid_record(const struct shell *shell, size_t argc, char **ar
   if (argc == 4)
   {
     RFID_RECORD new_rfid_record;
-    memset(new_rfid_record.epc, 0, 21);
+    memset(new_rfid_record.rfid_record_bytes, 0, RFID_RECORD_BYTE_LENGTH);
+
+    if (EPC_last_rfid_record_index >= RFID_RECORD_MAX_COUNT)
+    {
+      shell_print(shell, "Rfid record database is full");
+      return -ENOMEM;
+    }
+
+    if (EPC_FromHexString(argv[1], strlen(argv[1]), &new_rfid_record.epc) == false)
+    {
+      shell_print(shell, "Invalid epc");
+      return -EINVAL;
+    }
 
-    SerializeCharToHex(argv[1], new_rfid_record.epc, (strlen(argv[1]) / 2));
     new_rfid_record.type = atoi(argv[2]);
     new_rfid_record.id = atoi(argv[3]);
 
-    EPC_Memory_Write_RFID_Record(GPIO_PIN_FLASH_CS2, &new_rfid_record, EPC_last_rfid_record_index++);
+    EPC_Memory_Write_RFID_Record(GPIO_PIN_FLASH_CS2, &new_rfid_record, EPC_last_rfid_record_index);
+    EPC_Index_Add(&new_rfid_record, EPC_last_rfid_record_index);
+    EPC_last_rfid_record_index++;
   }
   else
   {
@@ -728,12 +736,13 @@ static int cmd_read_rfid_record(const struct shell *shell, size_t argc, char **a
   if (argc == 2)
   {
     RFID_RECORD new_rfid_record;
+    char epc_string[EPC_HEX_STRING_LENGTH];
     uint32_t index = 0;
 
     index = atol(argv[1]);
 
     EPC_Memory_Read_RFID_Record(GPIO_PIN_FLASH_CS2, &new_rfid_record, index);
-    shell_print(shell, "epc: %s, type: %d, id: %d", DeserializeHexToChar(new_rfid_record.epc, 20), new_rfid_record.type, new_rfid_record.id);
+    shell_print(shell, "epc: %s, type: %d, id: %d", EPC_ToHexString(&new_rfid_record.epc, epc_string), new_rfid_record.type, new_rfid_record.id);
   }
   else
   {
@@ -799,6 +808,7 @@ static int cmd_clear_epc_database(const struct shell *shell, size_t argc, char *
   /* Clear RFID records */
   EPC_Memory_Delete_All_Records(GPIO_PIN_FLASH_CS2, RFID_RECORD_REGION, RFID_RECORD_REGION_LENGTH);
   EPC_last_rfid_record_index = 0;
+  EPC_Index_Clear();
 
   k_msleep(100);
 
@@ -826,6 +836,7 @@ static int cmd_clear_rfid_record(const struct shell *shell, size_t argc, char **
 
   EPC_Memory_Delete_All_Records(GPIO_PIN_FLASH_CS2, RFID_RECORD_REGION, RFID_RECORD_REGION_LENGTH);
   EPC_last_rfid_record_index = 0;
+  EPC_Index_Clear();
   return 0;
 }
 
@@ -896,9 +907,10 @@ static int cmd_search_rfid_record(const struct shell *shell, size_t argc, char *
     RFID_RECORD new_rfid_record;
     ROOM_RECORD new_room_record;
     MOP_RECORD new_mop_record;
+    char epc_string[EPC_HEX_STRING_LENGTH];
 
     EPC_Memory_Read_RFID_Record(GPIO_PIN_FLASH_CS2, &new_rfid_record, myresult.epc_index);
-    shell_print(shell, "RFID record index: %d, record: %s, type: %d, id: %d", myresult.epc_index, DeserializeHexToChar(new_rfid_record.epc, 20), new_rfid_record.type, new_rfid_record.id);
+    shell_print(shell, "RFID record index: %d, record: %s, type: %d, id: %d", myresult.epc_index, EPC_ToHexString(&new_rfid_record.epc, epc_string), new_rfid_record.type, new_rfid_record.id);
 
     switch (new_rfid_record.type)
     {
@@ -941,7 +953,8 @@ static int cmd_search_rfid_record(const struct shell *shell, size_t argc, char *
  */
 static int cmd_count_rfid_record(const struct shell *shell, size_t argc, char **argv)
 {
-  EPC_last_rfid_record_index = EPC_Memory_GetLastIndex(GPIO_PIN_FLASH_CS2, RFID_RECORD_REGION, RFID_RECORD_REGION_LENGTH, RFID_RECORD_BYTE_LENGTH);
+  EPC_last_rfid_record_index = EPC_Memory_GetLastIndex(GPIO_PIN_FLASH_CS2, EPC_Database_GetActiveAddress(EPC_TABLE_RFID), RFID_RECORD_REGION_LENGTH, RFID_RECORD_BYTE_LENGTH);
+  EPC_Index_Build(GPIO_PIN_FLASH_CS2, EPC_last_rfid_record_index);
   shell_print(shell, "Last index number in wall records: %d", EPC_last_rfid_record_index);
   return 0;
 }
@@ -951,7 +964,7 @@ static int cmd_count_rfid_record(const struct shell *shell, size_t argc, char **
  */
 static int cmd_count_room_record(const struct shell *shell, size_t argc, char **argv)
 {
-  EPC_last_room_record_index = EPC_Memory_GetLastIndex(GPIO_PIN_FLASH_CS2, ROOM_RECORD_REGION, ROOM_RECORD_REGION_LENGTH, ROOM_RECORD_BYTE_LENGTH);
+  EPC_last_room_record_index = EPC_Memory_GetLastIndex(GPIO_PIN_FLASH_CS2, EPC_Database_GetActiveAddress(EPC_TABLE_ROOM), ROOM_RECORD_REGION_LENGTH, ROOM_RECORD_BYTE_LENGTH);
   shell_print(shell, "Last index number in room records: %d", EPC_last_room_record_index);
   return 0;
 }
@@ -961,11 +974,51 @@ static int cmd_count_room_record(const struct shell *shell, size_t argc, char **
  */
 static int cmd_count_mop_record(const struct shell *shell, size_t argc, char **argv)
 {
-  EPC_last_mop_record_index = EPC_Memory_GetLastIndex(GPIO_PIN_FLASH_CS2, MOP_RECORD_REGION, MOP_RECORD_REGION_LENGTH, MOP_RECORD_BYTE_LENGTH);
+  EPC_last_mop_record_index = EPC_Memory_GetLastIndex(GPIO_PIN_FLASH_CS2, EPC_Database_GetActiveAddress(EPC_TABLE_MOP), MOP_RECORD_REGION_LENGTH, MOP_RECORD_BYTE_LENGTH);
   shell_print(shell, "Last index number in mop records: %d", EPC_last_mop_record_index);
   return 0;
 }
 
+/*!
+ *  @brief Shows the active database bank and the DataUpdate it was created from
+ */
+static int cmd_epc_database(const struct shell *shell, size_t argc, char **argv)
+{
+  ARG_UNUSED(argc);
+  ARG_UNUSED(argv);
+
+  uint8_t bank = 0;
+  const EPC_DATABASE_HEADER *header = EPC_Database_GetHeader(&bank);
+
+  shell_print(shell, "Active bank: %d, generation: %d", bank, header->generation);
+  shell_print(shell, "Records: %d rfid, %d room, %d mop", EPC_last_rfid_record_index, EPC_last_room_record_index, EPC_last_mop_record_index);
+
+  if (header->generation > 0)
+  {
+    shell_fprintf(shell, SHELL_VT100_COLOR_DEFAULT, "DataUpdate uuid:");
+    for (uint8_t i = 0; i < header->uuid_length; i++)
+    {
+      shell_fprintf(shell, SHELL_VT100_COLOR_DEFAULT, " %02X", header->uuid[i]);
+    }
+    shell_fprintf(shell, SHELL_VT100_COLOR_DEFAULT, "\n");
+  }
+  return 0;
+}
+
+/*!
+ *  @brief Enters the binary provisioning mode to load the rfid, room and mop databases (protocol see provisioning.h)
+ */
+static int cmd_epc_provision(const struct shell *shell, size_t argc, char **argv)
+{
+  ARG_UNUSED(argc);
+  ARG_UNUSED(argv);
+
+  shell_print(shell, "Provisioning mode, waiting for frames (timeout %d s)", PROVISION_TIMEOUT);
+  Provision_Start(shell);
+
+  return 0;
+}
+
 /*!
  *  @brief This is the function description
  */
@@ -974,11 +1027,12 @@ static int cmd_listall_rfid_record(const struct shell *shell, size_t argc, char
   uint16_t i = 0;
 
   RFID_RECORD new_rfid_record;
+  char epc_string[EPC_HEX_STRING_LENGTH];
 
   for (i = 0; i < EPC_last_rfid_record_index; i++)
   {
     EPC_Memory_Read_RFID_Record(GPIO_PIN_FLASH_CS2, &new_rfid_record, i);
-    shell_print(shell, "Index: %d, epc: %s, type: %d, id: %d", i, DeserializeHexToChar(new_rfid_record.epc, 20), new_rfid_record.type, new_rfid_record.id);
+    shell_print(shell, "Index: %d, epc: %s, type: %d, id: %d", i, EPC_ToHexString(&new_rfid_record.epc, epc_string), new_rfid_record.type, new_rfid_record.id);
   }
   return 0;
 }
@@ -1034,6 +1088,7 @@ static int cmd_epc_last_seen_record(const struct shell *shell, size_t argc, char
   float percentage = 0.0;
 
   uint8_t sortet_array_index[EPC_LAST_SEEN_COUNT];
+  char epc_string[EPC_HEX_STRING_LENGTH];
   memset(sortet_array_index, 0, EPC_LAST_SEEN_COUNT);
 
   /* Calculate total number of all seen tags */
@@ -1063,7 +1118,7 @@ static int cmd_epc_last_seen_record(const struct shell *shell, size_t argc, char
       /* Calulate percentage ratio */
       percentage = (((float)EPC_last_seen_records[i].counts * 100.0) / count_sum);
 
-      shell_print(shell, "%d: %s, last seen timestamp: %s:%03d, counts: %d, percentage: %3.2f\%", (EPC_LAST_SEEN_COUNT - i), EPC_last_seen_records[i].record.string, buf, milli, EPC_last_seen_records[i].counts, percentage);
+      shell_print(shell, "%d: %s, last seen timestamp: %s:%03d, counts: %d, percentage: %3.2f\%", (EPC_LAST_SEEN_COUNT - i), EPC_ToHexString(&EPC_last_seen_records[i].epc, epc_string), buf, milli, EPC_last_seen_records[i].counts, percentage);
     }
   }
   return 0;
@@ -1158,10 +1213,10 @@ static int cmd_datalog_get_count(const struct shell *shell, size_t argc, char **
   ARG_UNUSED(argc);
   ARG_UNUSED(argv);
 
-  uint32_t rslt = 0UL;
+  uint32_t rslt = System.datalogFrameNumber;
 
-  rslt = flash_GetLastFrameNumber(GPIO_PIN_FLASH_CS1, FLASH_SUBSUBSECTOR_SIZE, DATALOG_MEM, DATALOG_MEM_LENGTH, DATALOG_FRAME_LENGTH);
-  shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Last frame number: %ld, addr: %ld\n", rslt, DATALOG_MEM + (rslt * DATALOG_FRAME_LENGTH));
+  shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Last frame number: %ld, addr: %ld\n", rslt, DATALOG_MEM + flash_logaddress_write);
+  shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Oldest frame number: %ld, stored frames: %ld\n", datalog_OldestFrameNumber, rslt - datalog_OldestFrameNumber);
 
   return 0;
 }
@@ -1341,6 +1396,34 @@ static int cmd_datalog_get_data(const struct shell *shell, size_t argc, char **a
   return 0;
 }
 
+/*!
+ *  @brief Starts the binary export of the data log (protocol see datalog_export.h). Without a sector number an active export is
+ *  stopped, with a sector number an active export starts again with this sector.
+ */
+static int cmd_datalog_export(const struct shell *shell, size_t argc, char **argv)
+{
+  if (datalog_ReadOutisActive == true)
+  {
+    shell_print(shell, "Data log read out is active");
+    return 0;
+  }
+
+  if (argc == 1 && datalog_ExportActive == true)
+  {
+    datalog_ExportStop();
+  }
+  else if (argc == 1)
+  {
+    datalog_ExportStart(shell, 0UL);
+  }
+  else
+  {
+    datalog_ExportStart(shell, strtoul(argv[1], NULL, 10));
+  }
+
+  return 0;
+}
+
 /*!
  *  @brief This is the function description
  */
@@ -2385,9 +2468,10 @@ static int cmd_modem_status(const struct shell *shell, size_t argc, char **argv)
  */
 static int cmd_rfid_command(const struct shell *shell, size_t argc, char **argv)
 {
-  char command[8];
+  char command[UART1_TX_MESSAGE_SIZE + 1];
+  char response[RFID_LINE_BUFFER_SIZE + 1];
 
-  if (argc == 2)
+  if ((argc == 2) && (strlen(argv[1]) <= (UART1_TX_MESSAGE_SIZE - 2)))
   {
 
     System.RFID_TransparentMode = true;
@@ -2396,33 +2480,24 @@ static int cmd_rfid_command(const struct shell *shell, size_t argc, char **argv)
     {
       RFID_TurnOn();
       config_RFID();
-      k_msleep(500);
     }
 
-    // System.RFID_TransparentMode = true;
-    memset(uart1_RFIDResponse, '\0', sizeof(uart1_RFIDResponse));
-    uart1_RFIDResponseTransmissionLength = 0;
-    uart1_RFIDResponseFinished = false;
-
     /* Build a command with \n and \r signs which the RFID reader IC can understand */
     strcpy(command, "\n");
     strcat(command, argv[1]);
     strcat(command, "\r");
 
-    uart_fifo_fill(uart1, command, sizeof(command) - 1);
-
-    /* Record uart input coming from rfid module for 1000 ms */
-    while (!uart1_RFIDResponseFinished)
+    /* The response line of the reader starts with the command character */
+    if (rfid_RequestText(command, argv[1][0], RFID_RESPONSE_TIMEOUT_MS, response, sizeof(response)) == 0)
     {
+      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "%s\n", response);
+    }
+    else
+    {
+      shell_error(shell, "No response from RFID reader.");
     }
 
     System.RFID_TransparentMode = false;
-
-    shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "%s\n", uart1_RFIDResponse);
-
-    memset(uart1_RFIDResponse, '\0', sizeof(uart1_RFIDResponse));
-    uart1_RFIDResponseTransmissionLength = 0;
-    uart1_RFIDResponseFinished = false;
   }
   else
   {
@@ -3288,6 +3363,52 @@ static int cmd_event1statistics_interval(const struct shell *shell, size_t argc,
   return 0;
 }
 
+/*!
+ *  @brief Prints the execution time statistic of the algorithm. With argument "reset" the statistic is restarted.
+ */
+static int cmd_algo_benchmark(const struct shell *shell, size_t argc, char **argv)
+{
+  ALGO_BENCHMARK benchmark;
+  uint64_t average_cycles = 0;
+  uint64_t average_ns = 0;
+  int64_t elapsed_ms = 0;
+
+  if ((argc == 2) && (strcmp(argv[1], "reset") == 0))
+  {
+    algo_benchmark_Reset();
+    shell_print(shell, "Algorithm benchmark reset");
+    return 0;
+  }
+
+  algo_benchmark_Get(&benchmark);
+
+  if (benchmark.calls == 0)
+  {
+    shell_print(shell, "No algorithm samples processed yet");
+    return 0;
+  }
+
+  average_cycles = benchmark.total_cycles / benchmark.calls;
+  average_ns = timing_cycles_to_ns_avg(benchmark.total_cycles, benchmark.calls);
+  elapsed_ms = k_uptime_get() - benchmark.start_uptime;
+
+  shell_print(shell, "Processed samples: %d", benchmark.calls);
+  shell_print(shell, "Cycles per sample: avg %llu, min %llu, max %llu", average_cycles, benchmark.min_cycles, benchmark.max_cycles);
+  shell_print(shell, "Time per sample: avg %lluns, max %lluns", average_ns, timing_cycles_to_ns(benchmark.max_cycles));
+
+  if (average_ns > 0)
+  {
+    shell_print(shell, "Max. throughput: %llu samples/s", 1000000000ULL / average_ns);
+  }
+
+  if (elapsed_ms > 0)
+  {
+    shell_print(shell, "Current rate: %.1f samples/s, cpu load %.3f%%", ((double)benchmark.calls * 1000.0) / (double)elapsed_ms, ((double)average_ns * (double)benchmark.calls) / ((double)elapsed_ms * 10000.0));
+  }
+
+  return 0;
+}
+
 /*!
  *  @brief This is the function description
  */
@@ -4124,6 +4245,34 @@ static int cmd_count_events(const struct shell *shell, size_t argc, char **argv)
   return 0;
 }
 
+/*!
+ *  @brief This is the function description
+ */
+static int cmd_event_pool(const struct shell *shell, size_t argc, char **argv)
+{
+  ARG_UNUSED(argc);
+  ARG_UNUSED(argv);
+
+  shell_print(shell, "Event pool: %d of %d objects in use (%d bytes each)", Event_PoolUsed(), EVENT_POOL_SIZE, sizeof(EVENT_OBJECT));
+  shell_print(shell, "High water mark: %d, allocations: %d, allocation failures: %d", Event_PoolStatistics.max_used, Event_PoolStatistics.allocations, Event_PoolStatistics.allocation_failures);
+  return 0;
+}
+
+/*!
+ *  @brief This is the function description
+ */
+static int cmd_event_queue(const struct shell *shell, size_t argc, char **argv)
+{
+  ARG_UNUSED(argc);
+  ARG_UNUSED(argv);
+
+  shell_print(shell, "Events in RAM: %d of %d", Event_ItemsInArray, EVENT_MAX_ITEMS_IN_ARRAY);
+  shell_print(shell, "Segments in flash: %d of %d, write head: 0x%X", Event_NumberOfOutsourcedMessages, EVENT_MAX_OUTSOURCED_MESSAGES, Event_flash_write_head);
+  shell_print(shell, "Spilled segments: %d (%d events), sent segments: %d, recovered at boot: %d", Event_QueueStatistics.spilled_segments, Event_QueueStatistics.spilled_events, Event_QueueStatistics.sent_segments, Event_QueueStatistics.recovered_segments);
+  shell_print(shell, "Lost events: list full: %d, flash full: %d, pack error: %d, spill pending: %d, corrupt segments: %d", Event_QueueStatistics.lost_list_full, Event_QueueStatistics.lost_flash_full, Event_QueueStatistics.lost_pack_error, Event_QueueStatistics.lost_spill_pending, Event_QueueStatistics.lost_corrupt);
+  return 0;
+}
+
 /*!
  *  @brief This is the function description
  */
@@ -4146,10 +4295,11 @@ static int cmd_list_last_seen_location_records(const struct shell *shell, size_t
   ARG_UNUSED(argv);
 
   uint16_t i = 0;
+  char epc_string[EPC_HEX_STRING_LENGTH];
 
   for (i = 0; i < EPC_LAST_SEEN_COUNT; i++)
   {
-    shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "No: %d, epc: %s, type: %d:, id: %d\n", i, DeserializeHexToChar(room_wall_tag_last_seen[i].epc, 20), room_wall_tag_last_seen[i].type, room_wall_tag_last_seen[i].id);
+    shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "No: %d, epc: %s, type: %d:, id: %d\n", i, EPC_ToHexString(&room_wall_tag_last_seen[i].epc, epc_string), room_wall_tag_last_seen[i].type, room_wall_tag_last_seen[i].id);
   }
   return 0;
 }
@@ -4183,8 +4333,10 @@ static int cmd_list_room_and_mop(const struct shell *shell, size_t argc, char **
   ARG_UNUSED(argc);
   ARG_UNUSED(argv);
 
+  char epc_string[EPC_HEX_STRING_LENGTH];
+
   shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_CYAN, "Mop id: %d linked to room id: %d\n", current_room_to_mop_mapping.current_mop_id, current_room_to_mop_mapping.mop_linked_room_id);
-  shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_CYAN, "Current mop epc: %s\n", DeserializeHexToChar(current_room_to_mop_mapping.current_mop_epc, 20));
+  shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_CYAN, "Current mop epc: %s\n", EPC_ToHexString(&current_room_to_mop_mapping.current_mop_epc, epc_string));
   return 0;
 }
 
@@ -4409,6 +4561,7 @@ void command_init(void)
                                  SHELL_CMD(verbose, NULL, "Show algorithm debug information", cmd_algo_verbose),
                                  SHELL_CMD(flag_verbose, NULL, "Show algorithm flag information", cmd_algo_flag_verbose),
                                  SHELL_CMD(settings, NULL, "Show all algorithm parameters", cmd_algo_settings),
+                                 SHELL_CMD(benchmark, NULL, "Show execution time per sample (optional: reset)", cmd_algo_benchmark),
                                  SHELL_CMD(current_shift_mop_check, NULL, "enables check for 'mop was already used in current shift'", cmd_current_shift_mop_check),
                                  SHELL_CMD(mop_id_refresh_timer, NULL, "sec to release the current registered mop id", cmd_mop_id_refresh_timer),
                                  SHELL_CMD(hit_shock_mag_thr, NULL, "thres for shock detection", cmd_hit_shock_mag_thr),
@@ -4476,6 +4629,8 @@ void command_init(void)
                                  SHELL_CMD(list, NULL, "Displays the last events.", cmd_list_events),
                                  SHELL_CMD(count, NULL, "Returns event count stored int the event array.", cmd_count_events),
                                  SHELL_CMD(clear, NULL, "Clear event list.", cmd_clear_events),
+                                 SHELL_CMD(pool, NULL, "Shows event pool usage and allocation statistics.", cmd_event_pool),
+                                 SHELL_CMD(queue, NULL, "Shows the event queue in RAM and flash and the lost events.", cmd_event_queue),
                                  SHELL_SUBCMD_SET_END /* Array terminated. */
   );
   SHELL_CMD_REGISTER(events, &events, "Commands to monitor events", NULL);
@@ -4505,6 +4660,8 @@ void command_init(void)
                                  SHELL_CMD(count_rfid_record, NULL, "Returns the number of rfid records in rfid record database", cmd_count_rfid_record),
                                  SHELL_CMD(count_room_record, NULL, "Returns the number of room records in room record database", cmd_count_room_record),
                                  SHELL_CMD(count_mop_record, NULL, "Returns the number of mop records in mop record database", cmd_count_mop_record),
+                                 SHELL_CMD(database, NULL, "Shows the active database bank and its generation", cmd_epc_database),
+                                 SHELL_CMD(provision, NULL, "Loads the rfid, room and mop databases with the binary protocol", cmd_epc_provision),
                                  SHELL_CMD(listall_rfid_record, NULL, "Displays all rfid records entries in rfid record database", cmd_listall_rfid_record),
                                  SHELL_CMD(listall_room_record, NULL, "Displays all room records entries in room record database", cmd_listall_room_record),
                                  SHELL_CMD(listall_mop_record, NULL, "Displays all mop records entries in mop record database", cmd_listall_mop_record),
@@ -4528,6 +4685,7 @@ void command_init(void)
   SHELL_STATIC_SUBCMD_SET_CREATE(datalog,
                                  SHELL_CMD(count, NULL, "Requests the total data log frame count", cmd_datalog_get_count),
                                  SHELL_CMD(read, NULL, "Prints out the entire log data to console. Parameter: <Start frame number> <End frame number>", cmd_datalog_get_data),
+                                 SHELL_CMD(export, NULL, "Sends the log data in binary frames, stops an active export without parameter. Parameter: <Start sector number>", cmd_datalog_export),
                                  SHELL_CMD(clear, NULL, "Clear only data log area in which data is stored", cmd_datalog_clear),
                                  SHELL_CMD(format, NULL, "Clear the entire data log", cmd_datalog_format),
                                  SHELL_CMD(interval, NULL, "Changes the storing interval of log frames (default 1000ms)", cmd_datalog_interval),
@@ -4547,7 +4705,8 @@ void command_init(void)
 
   SHELL_STATIC_SUBCMD_SET_CREATE(flash,
                                  SHELL_CMD(verbose, NULL, "Displays flash information", cmd_flash_verbose),
-                                 SHELL_CMD(id, NULL, "Returns the device ID", cmd_flash_device_id),
+                                 SHELL_CMD(id, NULL, "Returns the device ID and the selected command set. Parameter: <CS_pin_no>", cmd_flash_device_id),
+                                 SHELL_CMD(queue, NULL, "Prints the queued requests of the flash service thread and the queue overflows", cmd_flash_queue),
                                  SHELL_CMD(check, NULL, "Start an integrety check.  Parameter: <CS_pin_no>", cmd_flashtest),
                                  SHELL_CMD(erasesector, NULL, "Erase the sector at a specific address.  Parameter: <CS_pin_no>", cmd_erasesector),
                                  SHELL_CMD(eraseall, NULL, "Erase the whole flash.  Parameter: <CS_pin_no>", cmd_eraseall),
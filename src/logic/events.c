@@ -17,100 +17,143 @@ EventArray myEventArray = EVENT_ARRAY__INIT;
 EventArray__EventArrayEntry my_event_array_entries[EVENT_MAX_ITEMS_IN_ARRAY];
 EventArray__EventArrayEntry *my_event_array_entries_pointer[EVENT_MAX_ITEMS_IN_ARRAY];
 ProtobufCBinaryData binary_data;
-uint8_t current_location_epc_string[20];
+uint8_t current_location_epc_string[EPC_BINARY_LENGTH];
 uint32_t Event_ItemsInArray = 0; // Counts the element in the buffer
 bool event_simulation_in_progress = false;
 uint16_t event1statistics_interval_timer = 0;
+EVENT_POOL_STATISTICS Event_PoolStatistics;
+
+K_MEM_SLAB_DEFINE_STATIC(event_slab, sizeof(EVENT_OBJECT), EVENT_POOL_SIZE, 4);
+K_MUTEX_DEFINE(event_mutex); // Event array in RAM, its spill to the flash and the list of outsourced messages
+static atomic_t event_spill_pending = ATOMIC_INIT(0); // The full event array waits for the flash service thread
+
+/*!
+ * @brief This function takes one event object out of the fixed size event pool
+ * @details Constant time and no heap usage, so a long uptime can not fragment the heap. If the pool is empty the event is lost and counted.
+ * @return EVENT_OBJECT*: Pointer to the event object or NULL if the pool is empty
+ */
+EVENT_OBJECT *Event_Alloc(void)
+{
+  EVENT_OBJECT *object = NULL;
+  uint32_t used = 0;
+
+  if (k_mem_slab_alloc(&event_slab, (void **)&object, K_NO_WAIT) != 0)
+  {
+    Event_PoolStatistics.allocation_failures++;
+
+    if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
+    {
+      rtc_print_debug_timestamp();
+      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Event pool is empty, %d events lost\n", Event_PoolStatistics.allocation_failures);
+    }
+    return NULL;
+  }
+
+  Event_PoolStatistics.allocations++;
+
+  used = k_mem_slab_num_used_get(&event_slab);
+  if (used > Event_PoolStatistics.max_used)
+  {
+    Event_PoolStatistics.max_used = used;
+  }
+
+  return object;
+}
+
+/*!
+ * @brief This function returns an event object, including its payload, to the event pool
+ * @param event: Pointer to the GenericEvent of the object returned by Event_Alloc()
+ */
+void Event_Free(GenericEvent *event)
+{
+  void *object = CONTAINER_OF(event, EVENT_OBJECT, generic);
+
+  k_mem_slab_free(&event_slab, &object);
+}
+
+/*!
+ * @brief This function returns the number of event objects currently in use
+ */
+uint32_t Event_PoolUsed(void)
+{
+  return k_mem_slab_num_used_get(&event_slab);
+}
 
 /**
  * @brief This function checks if the Event is already listed in event array and if it is allowed to be stored again
+ * @details Only events with EVENT_POLICY_UNIQUE in the registry are filtered, they are discarded if an event of the same type
+ * with the same filter key (e.g. room and mop id) is already in the event array
  * @param NewEvent: Current generic event
  * @return uint8_t: 0 (false) if event should be added to event array, 1 (true) if it is already listed
  */
 uint8_t Event_filter(GenericEvent *NewEvent)
 {
+  const EVENT_OBJECT *new_object = CONTAINER_OF(NewEvent, EVENT_OBJECT, generic);
+  const EVENT_OBJECT *listed_object = NULL;
+  const EVENT_DESCRIPTOR *descriptor = Event_GetDescriptor(new_object->payload.header.event_id);
   uint32_t i = 0;
 
+  if ((descriptor == NULL) || ((descriptor->policy & EVENT_POLICY_UNIQUE) == 0))
+  {
+    return false;
+  }
+
   for (i = 0; i < Event_ItemsInArray; i++)
   {
-    /* Check if new event number is already listed somewhere in array */
     if (NewEvent->one_of_generic_event_case == my_event_array_entries[i].value->one_of_generic_event_case)
     {
-      switch (NewEvent->one_of_generic_event_case)
-      {
+      listed_object = CONTAINER_OF(my_event_array_entries[i].value, EVENT_OBJECT, generic);
 
-      case GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X05:
+      if (listed_object->filter_key == new_object->filter_key)
+      {
+        return true; // Discard adding event in event array
+      }
+    }
+  }
+  return false;
+}
 
-        if (NewEvent->field_event0x05->mop_id == my_event_array_entries[i].value->field_event0x05->mop_id)
-        {
-          if (NewEvent->field_event0x05->room_id == my_event_array_entries[i].value->field_event0x05->room_id)
-          {
-            return true; // Discard adding event in event array
-          }
-          else
-          {
-            return false; // Allow adding event in event array
-          }
-        }
-        else
-        {
-          return false; // Allow adding event in event array
-        }
-        break;
+/*!
+ * @brief This function packs (protobuf) and outsources the full event array to the external flash memory and frees it
+ * @details Takes event_mutex. The full array is cleared also if it could not be stored, the lost events are counted.
+ */
+static void Event_SpillArray(void)
+{
+  k_mutex_lock(&event_mutex, K_FOREVER);
 
-      case GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X06:
+  if (Event_ItemsInArray >= EVENT_MAX_ITEMS_IN_ARRAY)
+  {
+    Event_StorePackedUsageObjectToFlash();
 
-        if (NewEvent->field_event0x06->mop_id == my_event_array_entries[i].value->field_event0x06->mop_id)
-        {
-          if (NewEvent->field_event0x06->room_id == my_event_array_entries[i].value->field_event0x06->room_id)
-          {
-            return true; // Discard adding event in event array
-          }
-          else
-          {
-            return false; // Allow adding event in event array
-          }
-        }
-        else
-        {
-          return false; // Allow adding event in event array
-        }
-        break;
+    /* Clear event array in RAM */
+    Event_ClearArray();
+   // clear_last_seen_location_record_array();  //!#
+  }
 
-      case GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X19:
+  k_mutex_unlock(&event_mutex);
+}
 
-        if (NewEvent->field_event0x19->mop_id == my_event_array_entries[i].value->field_event0x19->mop_id)
-        {
-          if (NewEvent->field_event0x19->room_id == my_event_array_entries[i].value->field_event0x19->room_id)
-          {
-            return true; // Discard adding event in event array
-          }
-          else
-          {
-            return false; // Allow adding event in event array
-          }
-        }
-        else
-        {
-          return false; // Allow adding event in event array
-        }
-        break;
+/* Called by the flash service thread. The spill is queued with high priority, so it does not wait behind queued datalog writes. */
+static void Event_SpillCallback(const FLASH_REQUEST *request, int result)
+{
+  ARG_UNUSED(request);
+  ARG_UNUSED(result);
 
-      default:
-        return false;
-        break;
-      }
-    }
-  }
-  return false;
+  Event_SpillArray();
+  atomic_set(&event_spill_pending, 0);
 }
 
 /*!
- *  @brief This is the function description
- *  @details: 0x01 - New movement detected
+ *  @brief This function adds an event to the event array in RAM
+ *  @details If the array is full, it is spilled to the external flash by the flash service thread, so the sector erases do not
+ *  block the calling thread (e.g. the imu thread). Events which come while the spill is pending are lost and counted.
  */
 void Event_AddInArray(GenericEvent *NewEvent)
 {
+  FLASH_REQUEST request = {.type = FLASH_REQUEST_SYNC, .callback = Event_SpillCallback};
+
+  k_mutex_lock(&event_mutex, K_FOREVER);
+
   /* Add newest event */
   if (Event_ItemsInArray < EVENT_MAX_ITEMS_IN_ARRAY)
   {
@@ -120,125 +163,39 @@ void Event_AddInArray(GenericEvent *NewEvent)
     myEventArray.event_array = my_event_array_entries_pointer;
     myEventArray.n_event_array = ++Event_ItemsInArray;
   }
+  else
+  {
+    Event_Free(NewEvent);
+    Event_QueueStatistics.lost_spill_pending++;
+  }
 
   /* If local event buffer in RAm is full, pack (protobuf) and outsource the whole buffer to the external flash memory to free the local event buffer in RAM */
-  if (Event_ItemsInArray >= EVENT_MAX_ITEMS_IN_ARRAY)
+  if ((Event_ItemsInArray >= EVENT_MAX_ITEMS_IN_ARRAY) && (atomic_cas(&event_spill_pending, 0, 1) == true))
   {
-  //  Event_StorePackedUsageObjectToFlash(); //!#
-
-    /* Clear event array in RAM */
-    Event_ClearArray();
-   // clear_last_seen_location_record_array();  //!#
+    if (flash_SubmitRequest(&request, FLASH_PRIORITY_HIGH) != 0)
+    {
+      /* The queue of the flash service thread is full, spill right here */
+      Event_SpillArray();
+      atomic_set(&event_spill_pending, 0);
+    }
   }
+
+  k_mutex_unlock(&event_mutex);
 }
 
 /*!
- *  @brief This funtion frees all object generated with k_malloc
- *  @details: For ech event there are two object to free: The Event0xXX and a GenericEvent object
+ *  @brief This funtion returns all event objects to the event pool
+ *  @details: The GenericEvent and its Event0xXX payload share one pool block
  */
 void Event_ClearArray(void)
 {
   uint16_t i = 0;
 
+  k_mutex_lock(&event_mutex, K_FOREVER);
+
   for (i = 0; i < Event_ItemsInArray; i++)
   {
-    /* Free specific event */
-    switch (my_event_array_entries[i].value->one_of_generic_event_case)
-    {
-    case GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X01:
-      free(my_event_array_entries[i].value->field_event0x01);
-      break;
-
-    case GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X02:
-      free(my_event_array_entries[i].value->field_event0x02);
-      break;
-
-    case GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X04:
-      free(my_event_array_entries[i].value->field_event0x04);
-      break;
-
-    case GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X05:
-      free(my_event_array_entries[i].value->field_event0x05);
-      break;
-
-    case GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X06:
-      free(my_event_array_entries[i].value->field_event0x06);
-      break;
-
-    case GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X07:
-      free(my_event_array_entries[i].value->field_event0x07);
-      break;
-
-    case GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X09:
-      free(my_event_array_entries[i].value->field_event0x09);
-      break;
-
-    case GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X0_B:
-      free(my_event_array_entries[i].value->field_event0x0b);
-      break;
-
-    case GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X0_C:
-      free(my_event_array_entries[i].value->field_event0x0c);
-      break;
-
-    case GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X0_D:
-      free(my_event_array_entries[i].value->field_event0x0d);
-      break;
-
-    case GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X0_F:
-      free(my_event_array_entries[i].value->field_event0x0f);
-      break;
-
-    case GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X10:
-      free(my_event_array_entries[i].value->field_event0x10);
-      break;
-
-    case GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X11:
-      free(my_event_array_entries[i].value->field_event0x11);
-      break;
-
-    case GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X12:
-      free(my_event_array_entries[i].value->field_event0x12);
-      break;
-
-    case GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X13:
-      free(my_event_array_entries[i].value->field_event0x13);
-      break;
-
-    case GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X17:
-      free(my_event_array_entries[i].value->field_event0x17);
-      break;
-
-    case GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X18:
-      free(my_event_array_entries[i].value->field_event0x18);
-      break;
-
-    case GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X19:
-      free(my_event_array_entries[i].value->field_event0x19);
-      break;
-
-    case GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X1_A:
-      free(my_event_array_entries[i].value->field_event0x1a);
-      break;
-
-    case GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X1_B:
-      free(my_event_array_entries[i].value->field_event0x1b);
-      break;
-
-    case GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X1_C:
-      free(my_event_array_entries[i].value->field_event0x1c);
-      break;
-
-    case GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X_FF:
-      free(my_event_array_entries[i].value->field_event0xff);
-      break;
-
-    default:
-      break;
-    }
-
-    /* Free the GenericEvent object */
-    free(my_event_array_entries[i].value);
+    Event_Free(my_event_array_entries[i].value);
   }
 
   Event_ItemsInArray = 0;
@@ -249,11 +206,13 @@ void Event_ClearArray(void)
     event_array__event_array_entry__init(&my_event_array_entries[i]);
     my_event_array_entries_pointer[i] = NULL;
   }
-  memset(current_location_epc_string, 0, EPC_TOTAL_HEX_LENGTH);
+  memset(current_location_epc_string, 0, EPC_BINARY_LENGTH);
 
-  binary_data.len = EPC_TOTAL_HEX_LENGTH;
+  binary_data.len = EPC_BINARY_LENGTH;
   binary_data.data = current_location_epc_string;
 
+  k_mutex_unlock(&event_mutex);
+
   if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
   {
     rtc_print_debug_timestamp();
@@ -272,6 +231,7 @@ void Event_PrintPreviousEvents(void)
   char buf[50] = {0};
   uint16_t milli = 0;
   int64_t timestamp = 0;
+  const EVENT_DESCRIPTOR *descriptor = NULL;
 
   for (i = 0; i < Event_ItemsInArray; i++)
   {
@@ -285,8 +245,10 @@ void Event_PrintPreviousEvents(void)
     ptm = localtime(&timestamp);
     strftime(buf, 20, "%F %T", ptm);
 
+    descriptor = Event_GetDescriptor(my_event_array_entries[i].value->field_event0x01->event_id);
+
     rtc_print_debug_timestamp();
-    shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Event no. %d: 0x%02X, %s:%03d\n", my_event_array_entries[i].key, my_event_array_entries[i].value->field_event0x01->event_id, buf, milli);
+    shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Event no. %d: 0x%02X, %s:%03d, %s\n", my_event_array_entries[i].key, my_event_array_entries[i].value->field_event0x01->event_id, buf, milli, (descriptor != NULL) ? descriptor->name : "unknown");
   }
 }
 
@@ -315,372 +277,265 @@ void Event_BackwardsTimeStampUpdate(time_t initial_unixtime_ms, uint32_t ms_sinc
 }
 
 /*!
- *  @brief This is the function description
- *  @details: 0x01 - New movement detected
+ *  @brief Functions which append the payload fields of an event to the verbose output
  */
-void NewEvent0x01(time_t interval_start, time_t interval_end, float pattern_idle, float pattern_moving, float pattern_mopping)
+static void Event_Details0x01(const EVENT_OBJECT *object, char *text, size_t size)
 {
-  Event0x01 *ptrNewEvent = malloc(sizeof(Event0x01));
+  snprintf(text, size, ". idle: %.2f%%, moving: %.2f%%, mopping: %.2f%%", object->payload.event0x01.pattern_idle, object->payload.event0x01.pattern_moving, object->payload.event0x01.pattern_mopping);
+}
 
-  if (ptrNewEvent != NULL)
+static void Event_Details0x02(const EVENT_OBJECT *object, char *text, size_t size)
+{
+  if (object->payload.event0x02.mop_id > 0)
+  {
+    snprintf(text, size, ", new mop id: %d", object->payload.event0x02.mop_id);
+  }
+  else
   {
-    event0x01__init(ptrNewEvent);
+    snprintf(text, size, ", new mop id: 0, without user notification");
+  }
+}
 
-    ptrNewEvent->event_id = 0x01;
-    ptrNewEvent->event_timestamp = unixtime_ms;
-    ptrNewEvent->interval_start = interval_start;
-    ptrNewEvent->interval_end = interval_end;
-    ptrNewEvent->pattern_idle = pattern_idle;
-    ptrNewEvent->pattern_moving = pattern_moving;
-    ptrNewEvent->pattern_mopping = pattern_mopping;
+static void Event_Details0x07(const EVENT_OBJECT *object, char *text, size_t size)
+{
+  const ProtobufCBinaryData *location_epc = &object->payload.event0x07.location_epc;
+  EPC_BINARY event_epc;
+  char epc_string[EPC_HEX_STRING_LENGTH];
 
-    GenericEvent *ptrNewGenericEvent = malloc(sizeof(GenericEvent));
+  EPC_Clear(&event_epc);
+  memcpy(&event_epc.bytes[EPC_BINARY_LENGTH - location_epc->len], location_epc->data, location_epc->len);
 
-    if (ptrNewGenericEvent != NULL)
-    {
-      generic_event__init(ptrNewGenericEvent);
+  snprintf(text, size, ", tag epc: %s", EPC_ToHexString(&event_epc, epc_string));
+}
 
-      ptrNewGenericEvent->one_of_generic_event_case = GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X01;
-      ptrNewGenericEvent->field_event0x01 = ptrNewEvent;
+static void Event_Details0x1C(const EVENT_OBJECT *object, char *text, size_t size)
+{
+  snprintf(text, size, ", MopID: %d, sqm_side_0: %.1f, sqm_side_1: %.1f", object->payload.event0x1c.mop_id, object->payload.event0x1c.sqm_side_0, object->payload.event0x1c.sqm_side_1);
+}
 
-      /* Add this event in event array */
-      if (Event_filter(ptrNewGenericEvent) == false) // Event is not listed in event array yet
-      {
-        if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-        {
-          rtc_print_debug_timestamp();
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "Created Event0x01 'New movement detected', Event number: %d. idle: %.2f\%, moving: %.2f\%, mopping: %.2f\%\n", System.EventNumber, pattern_idle, pattern_moving, pattern_mopping);
-        }
+/*!
+ *  @brief Registry of all events the device creates
+ *  @details: Each entry describes the event id, the protobuf payload (layout, init and encoding), the text for the shell and
+ *  the filter / notification policy. Event_Create() and Event_Emit() are the only code paths which build and store events,
+ *  the NewEvent0xXX functions below only copy their arguments into the payload.
+ */
+static const EVENT_DESCRIPTOR Event_Descriptors[] = {
+    {0x01, GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X01, &event0x01__descriptor, "New movement detected", EVENT_POLICY_NOTIFY, Event_Details0x01},
+    {0x02, GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X02, &event0x02__descriptor, "Mop change detected", EVENT_POLICY_NOTIFY, Event_Details0x02},
+    {0x04, GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X04, &event0x04__descriptor, "Another room detected", EVENT_POLICY_NOTIFY, NULL},
+    {0x05, GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X05, &event0x05__descriptor, "Wrong mop is used in the room", EVENT_POLICY_NOTIFY | EVENT_POLICY_UNIQUE, NULL},
+    {0x06, GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X06, &event0x06__descriptor, "Same mop used in another room", EVENT_POLICY_NOTIFY | EVENT_POLICY_UNIQUE, NULL},
+    {0x07, GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X07, &event0x07__descriptor, "New location detected", EVENT_POLICY_NOTIFY, Event_Details0x07},
+    {0x09, GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X09, &event0x09__descriptor, "Battery charge low", EVENT_POLICY_NOTIFY, NULL},
+    {0x0B, GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X0_B, &event0x0_b__descriptor, "Connection up", EVENT_POLICY_NOTIFY, NULL},
+    {0x0C, GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X0_C, &event0x0_c__descriptor, "Connection down", EVENT_POLICY_NOTIFY, NULL},
+    {0x0D, GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X0_D, &event0x0_d__descriptor, "Button pressed", EVENT_POLICY_NOTIFY, NULL},
+    {0x0F, GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X0_F, &event0x0_f__descriptor, "USB plugged in", EVENT_POLICY_NOTIFY, NULL},
+    {0x10, GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X10, &event0x10__descriptor, "USB plugged off", EVENT_POLICY_NOTIFY, NULL},
+    {0x11, GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X11, &event0x11__descriptor, "Charging started", EVENT_POLICY_NOTIFY, NULL},
+    {0x12, GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X12, &event0x12__descriptor, "Charging stopped", EVENT_POLICY_NOTIFY, NULL},
+    {0x13, GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X13, &event0x13__descriptor, "Power on", EVENT_POLICY_NOTIFY, NULL},
+    {0x17, GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X17, &event0x17__descriptor, "Hit shock", EVENT_POLICY_NOTIFY, NULL},
+    {0x18, GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X18, &event0x18__descriptor, "Frame side flip", EVENT_POLICY_NOTIFY, NULL},
+    {0x19, GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X19, &event0x19__descriptor, "Inappropriate mop is used in the room in mopping state", EVENT_POLICY_NOTIFY | EVENT_POLICY_UNIQUE, NULL},
+    {0x1A, GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X1_A, &event0x1_a__descriptor, "Inappropriate mop is near the room", EVENT_POLICY_NOTIFY, NULL},
+    {0x1B, GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X1_B, &event0x1_b__descriptor, "Mop change", EVENT_POLICY_NOTIFY, NULL},
+    {0x1C, GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X1_C, &event0x1_c__descriptor, "Square meters", EVENT_POLICY_NONE, Event_Details0x1C},
+    {0xFF, GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X_FF, &event0x_ff__descriptor, "Debug info", EVENT_POLICY_NONE, NULL},
+};
 
-        Event_AddInArray(ptrNewGenericEvent);
-      }
-      else
-      {
-        /* Free allocated memory */
-        free(ptrNewEvent);
-        free(ptrNewGenericEvent);
-      }
-    }
-    else
-    {
-      if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-      {
-        rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewGenericEvent in Event0x01\n");
-      }
+/*!
+ * @brief This function returns the registry entry of an event
+ * @param id: Event id
+ * @return const EVENT_DESCRIPTOR*: Registry entry or NULL if the id is unknown
+ */
+const EVENT_DESCRIPTOR *Event_GetDescriptor(uint8_t id)
+{
+  uint8_t i = 0;
 
-      /* Free allocated memory */
-      free(ptrNewEvent);
-    }
-  }
-  else
+  for (i = 0; i < ARRAY_SIZE(Event_Descriptors); i++)
   {
-    if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
+    if (Event_Descriptors[i].id == id)
     {
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewEvent0x01\n");
+      return &Event_Descriptors[i];
     }
   }
-
-  /* Trigger user notification */
-  if (Parameter.notification_test == false)
-  {
-    Notification.next_state = ActionMatrixArray[0x01];
-  }
+  return NULL;
 }
 
 /*!
- *  @brief This is the function description
- *  @details: 0x02 - Mop change detected
+ * @brief This function takes an event object from the pool and initializes the payload and the GenericEvent from the registry
+ * @param id: Event id
+ * @return EVENT_OBJECT*: Event object with id and time stamp set, NULL if the pool is empty
  */
-void NewEvent0x02(uint32_t mop_id)
+static EVENT_OBJECT *Event_Create(uint8_t id)
 {
-  Event0x02 *ptrNewEvent = malloc(sizeof(Event0x02));
+  const EVENT_DESCRIPTOR *descriptor = Event_GetDescriptor(id);
+  EVENT_OBJECT *object = NULL;
 
-  if (ptrNewEvent != NULL)
+  if (descriptor == NULL)
   {
-    event0x02__init(ptrNewEvent);
-
-    ptrNewEvent->event_id = 0x02;
-    ptrNewEvent->event_timestamp = unixtime_ms;
-    ptrNewEvent->mop_id = mop_id;
-
-    GenericEvent *ptrNewGenericEvent = malloc(sizeof(GenericEvent));
-
-    if (ptrNewGenericEvent != NULL)
-    {
-      generic_event__init(ptrNewGenericEvent);
-
-      ptrNewGenericEvent->one_of_generic_event_case = GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X02;
-      ptrNewGenericEvent->field_event0x02 = ptrNewEvent;
-
-      /* Add this event in event array */
-      if (Event_filter(ptrNewGenericEvent) == false) // Event is not listed in event array yet
-      {
-        if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-        {
-          rtc_print_debug_timestamp();
-
-          if (mop_id > 0)
-          {
-            shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "Created Event0x02 'Mop change detected, new mop id: %d', Event number: %d\n", mop_id, System.EventNumber);
-          }
-          else
-          {
-            shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "Created Event0x02 'Mop change detected' , new mop id: %d, without user notification, Event number: %d\n", mop_id, System.EventNumber);
-          }
-        }
+    return NULL;
+  }
 
-        Event_AddInArray(ptrNewGenericEvent);
-      }
-      else
-      {
-        /* Free allocated memory */
-        free(ptrNewEvent);
-        free(ptrNewGenericEvent);
-      }
-    }
-    else
-    {
-      if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-      {
-        rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewGenericEvent in Event0x02\n");
-      }
+  object = Event_Alloc();
 
-      /* Free allocated memory */
-      free(ptrNewEvent);
-    }
-  }
-  else
+  if (object == NULL)
   {
     if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
     {
       rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewEvent0x02\n");
+      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewEvent0x%02X\n", id);
     }
+    return NULL;
   }
 
-  /* Trigger user notification */
-  if ((Parameter.notification_test == false) && (mop_id > 0))
-  {
-    Notification.next_state = ActionMatrixArray[0x02];
-  }
+  protobuf_c_message_init(descriptor->message, &object->payload);
+  object->payload.header.event_id = id;
+  object->payload.header.event_timestamp = unixtime_ms;
+  object->filter_key = 0;
+
+  generic_event__init(&object->generic);
+  object->generic.one_of_generic_event_case = descriptor->generic_case;
+  object->generic.field_event0x01 = &object->payload.event0x01; // All members of the oneof union point to the same payload
+
+  return object;
 }
 
 /*!
- *  @brief This is the function description
- *  @details: 0x04 - Another room detected
+ * @brief This function stores a filled event in the event array (if the filter allows it) and triggers the user notification
+ * @param id: Event id
+ * @param object: Event object from Event_Create(), can be NULL if the pool was empty (notification is triggered anyway)
+ * @param notify: false suppresses the user notification for this event only
  */
-void NewEvent0x04(uint32_t room_id)
+static void Event_Emit(uint8_t id, EVENT_OBJECT *object, bool notify)
 {
-  Event0x04 *ptrNewEvent = malloc(sizeof(Event0x04));
+  const EVENT_DESCRIPTOR *descriptor = Event_GetDescriptor(id);
+  char details[80] = {0};
 
-  if (ptrNewEvent != NULL)
+  if (descriptor == NULL)
   {
-    event0x04__init(ptrNewEvent);
-
-    ptrNewEvent->event_id = 0x04;
-    ptrNewEvent->event_timestamp = unixtime_ms;
-    ptrNewEvent->room_id = room_id;
+    return;
+  }
 
-    GenericEvent *ptrNewGenericEvent = malloc(sizeof(GenericEvent));
+  if (object != NULL)
+  {
+    /* Filter and add under one lock, so no other thread can add the same event in between */
+    k_mutex_lock(&event_mutex, K_FOREVER);
 
-    if (ptrNewGenericEvent != NULL)
+    /* Add this event in event array */
+    if (Event_filter(&object->generic) == false) // Event is not listed in event array yet
     {
-      generic_event__init(ptrNewGenericEvent);
-
-      ptrNewGenericEvent->one_of_generic_event_case = GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X04;
-      ptrNewGenericEvent->field_event0x04 = ptrNewEvent;
-
-      /* Add this event in event array */
-      if (Event_filter(ptrNewGenericEvent) == false) // Event is not listed in event array yet
+      if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
       {
-        if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
+        if (descriptor->details != NULL)
         {
-          rtc_print_debug_timestamp();
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "Created Event0x04 'Another room detected', Event number: %d\n", System.EventNumber);
+          descriptor->details(object, details, sizeof(details));
         }
 
-        Event_AddInArray(ptrNewGenericEvent);
-      }
-      else
-      {
-        /* Free allocated memory */
-        free(ptrNewEvent);
-        free(ptrNewGenericEvent);
-      }
-    }
-    else
-    {
-      if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-      {
         rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewGenericEvent in Event0x04\n");
+        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "Created Event0x%02X '%s'%s, Event number: %d\n", id, descriptor->name, details, System.EventNumber);
       }
 
-      /* Free allocated memory */
-      free(ptrNewEvent);
+      Event_AddInArray(&object->generic);
     }
-  }
-  else
-  {
-    if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
+    else
     {
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewEvent0x04\n");
+      /* Return the event object to the pool */
+      Event_Free(&object->generic);
     }
+
+    k_mutex_unlock(&event_mutex);
   }
 
   /* Trigger user notification */
-  if (Parameter.notification_test == false)
+  if (((descriptor->policy & EVENT_POLICY_NOTIFY) != 0) && (notify == true) && (Parameter.notification_test == false))
   {
-    Notification.next_state = ActionMatrixArray[0x04];
+    Notification.next_state = ActionMatrixArray[id];
   }
 }
 
 /*!
  *  @brief This is the function description
- *  @details: 0x05 - Wrong mop is used in the room
+ *  @details: 0x01 - New movement detected
  */
-void NewEvent0x05(uint32_t room_id, uint32_t mop_id)
+void NewEvent0x01(time_t interval_start, time_t interval_end, float pattern_idle, float pattern_moving, float pattern_mopping)
 {
-  Event0x05 *ptrNewEvent = malloc(sizeof(Event0x05));
+  EVENT_OBJECT *object = Event_Create(0x01);
 
-  if (ptrNewEvent != NULL)
+  if (object != NULL)
   {
-    event0x05__init(ptrNewEvent);
-
-    ptrNewEvent->event_id = 0x05;
-    ptrNewEvent->event_timestamp = unixtime_ms;
-    ptrNewEvent->room_id = room_id;
-    ptrNewEvent->mop_id = mop_id;
-
-    GenericEvent *ptrNewGenericEvent = malloc(sizeof(GenericEvent));
-
-    if (ptrNewGenericEvent != NULL)
-    {
-      generic_event__init(ptrNewGenericEvent);
-
-      ptrNewGenericEvent->one_of_generic_event_case = GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X05;
-      ptrNewGenericEvent->field_event0x05 = ptrNewEvent;
-
-      /* Add this event in event array */
-      if (Event_filter(ptrNewGenericEvent) == false) // Event is not listed in event array yet
-      {
-        if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-        {
-          rtc_print_debug_timestamp();
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "Created Event0x05 'Wrong mop is used in the room', Event number: %d\n", System.EventNumber);
-        }
+    object->payload.event0x01.interval_start = interval_start;
+    object->payload.event0x01.interval_end = interval_end;
+    object->payload.event0x01.pattern_idle = pattern_idle;
+    object->payload.event0x01.pattern_moving = pattern_moving;
+    object->payload.event0x01.pattern_mopping = pattern_mopping;
+  }
+  Event_Emit(0x01, object, true);
+}
 
-        Event_AddInArray(ptrNewGenericEvent);
-      }
-      else
-      {
-        /* Free allocated memory */
-        free(ptrNewEvent);
-        free(ptrNewGenericEvent);
-      }
-    }
-    else
-    {
-      if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-      {
-        rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewGenericEvent in Event0x05\n");
-      }
+/*!
+ *  @brief This is the function description
+ *  @details: 0x02 - Mop change detected. Mop id 0 creates an event for cloud upload but triggers no user notification
+ */
+void NewEvent0x02(uint32_t mop_id)
+{
+  EVENT_OBJECT *object = Event_Create(0x02);
 
-      /* Free allocated memory */
-      free(ptrNewEvent);
-    }
-  }
-  else
+  if (object != NULL)
   {
-    if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-    {
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewEvent0x05\n");
-    }
+    object->payload.event0x02.mop_id = mop_id;
   }
+  Event_Emit(0x02, object, (mop_id > 0));
+}
 
-  /* Trigger user notification */
-  if (Parameter.notification_test == false)
+/*!
+ *  @brief This is the function description
+ *  @details: 0x04 - Another room detected
+ */
+void NewEvent0x04(uint32_t room_id)
+{
+  EVENT_OBJECT *object = Event_Create(0x04);
+
+  if (object != NULL)
   {
-    Notification.next_state = ActionMatrixArray[0x05];
+    object->payload.event0x04.room_id = room_id;
   }
+  Event_Emit(0x04, object, true);
 }
 
 /*!
  *  @brief This is the function description
- *  @details: 0x06 - Same mop used in another room
+ *  @details: 0x05 - Wrong mop is used in the room
  */
-void NewEvent0x06(uint32_t room_id, uint32_t mop_id)
+void NewEvent0x05(uint32_t room_id, uint32_t mop_id)
 {
-  Event0x06 *ptrNewEvent = malloc(sizeof(Event0x06));
+  EVENT_OBJECT *object = Event_Create(0x05);
 
-  if (ptrNewEvent != NULL)
+  if (object != NULL)
   {
-    event0x06__init(ptrNewEvent);
-
-    ptrNewEvent->event_id = 0x06;
-    ptrNewEvent->event_timestamp = unixtime_ms;
-    ptrNewEvent->room_id = room_id;
-    ptrNewEvent->mop_id = mop_id;
-
-    GenericEvent *ptrNewGenericEvent = malloc(sizeof(GenericEvent));
-
-    if (ptrNewGenericEvent != NULL)
-    {
-      generic_event__init(ptrNewGenericEvent);
-
-      ptrNewGenericEvent->one_of_generic_event_case = GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X06;
-      ptrNewGenericEvent->field_event0x06 = ptrNewEvent;
-
-      /* Add this event in event array */
-      if (Event_filter(ptrNewGenericEvent) == false) // Event is not listed in event array yet
-      {
-        if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-        {
-          rtc_print_debug_timestamp();
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "Created Event0x06 'Same mop used in another room', Event number: %d\n", System.EventNumber);
-        }
-
-        Event_AddInArray(ptrNewGenericEvent);
-      }
-      else
-      {
-        /* Free allocated memory */
-        free(ptrNewEvent);
-        free(ptrNewGenericEvent);
-      }
-    }
-    else
-    {
-      if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-      {
-        rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewGenericEvent in Event0x06\n");
-      }
-
-      /* Free allocated memory */
-      free(ptrNewEvent);
-    }
-  }
-  else
-  {
-    if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-    {
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewEvent0x06\n");
-    }
+    object->payload.event0x05.room_id = room_id;
+    object->payload.event0x05.mop_id = mop_id;
+    object->filter_key = EVENT_FILTER_KEY(room_id, mop_id);
   }
+  Event_Emit(0x05, object, true);
+}
 
-  /* Trigger user notification */
-  if (Parameter.notification_test == false)
+/*!
+ *  @brief This is the function description
+ *  @details: 0x06 - Same mop used in another room
+ */
+void NewEvent0x06(uint32_t room_id, uint32_t mop_id)
+{
+  EVENT_OBJECT *object = Event_Create(0x06);
+
+  if (object != NULL)
   {
-    Notification.next_state = ActionMatrixArray[0x06];
+    object->payload.event0x06.room_id = room_id;
+    object->payload.event0x06.mop_id = mop_id;
+    object->filter_key = EVENT_FILTER_KEY(room_id, mop_id);
   }
+  Event_Emit(0x06, object, true);
 }
 
 /*!
@@ -689,70 +544,24 @@ void NewEvent0x06(uint32_t room_id, uint32_t mop_id)
  */
 extern void NewEvent0x07(uint8_t *location_epc, uint8_t epc_len) // 0x07 - New location detected
 {
-  Event0x07 *ptrNewEvent = malloc(sizeof(Event0x07));
+  EVENT_OBJECT *object = Event_Create(0x07);
 
-  if (ptrNewEvent != NULL)
+  if (object != NULL)
   {
-    event0x07__init(ptrNewEvent);
-
-    ptrNewEvent->event_id = 0x07;
-    ptrNewEvent->event_timestamp = unixtime_ms;
+    if (epc_len > EPC_BINARY_LENGTH)
+    {
+      epc_len = EPC_BINARY_LENGTH;
+    }
 
-    /* Copy current location epc string also into a variable which is used in DeviceStatus object */
+    /* Copy current location epc also into a variable which is used in DeviceStatus object */
     memcpy(current_location_epc_string, location_epc, epc_len);
 
-    /* Copy current location in allocated memory */
     binary_data.len = epc_len;
     binary_data.data = location_epc;
 
-    ptrNewEvent->location_epc = binary_data;
-
-    /* Create a new GeneraticEvent */
-    GenericEvent *ptrNewGenericEvent = malloc(sizeof(GenericEvent));
-
-    if (ptrNewGenericEvent != NULL)
-    {
-      generic_event__init(ptrNewGenericEvent);
-
-      ptrNewGenericEvent->one_of_generic_event_case = GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X07;
-      ptrNewGenericEvent->field_event0x07 = ptrNewEvent;
-
-      /* Add this event in event array */
-      if (Event_filter(ptrNewGenericEvent) == false) // Event is not listed in event array yet
-      {
-        if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-        {
-          rtc_print_debug_timestamp();
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "Created Event0x07 'New location detected, tag epc: %s', Event number: %d\n", DeserializeHexToChar(ptrNewGenericEvent->field_event0x07->location_epc.data, 20), System.EventNumber);
-        }
-
-        Event_AddInArray(ptrNewGenericEvent);
-      }
-      else
-      {
-        /* Free allocated memory */
-        free(ptrNewEvent);
-        free(ptrNewGenericEvent);
-      }
-    }
-    else
-    {
-      if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-      {
-        rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewGenericEvent in Event0x07, Event number: %d\n", System.EventNumber);
-      }
-
-      /* Free allocated memory */
-      free(ptrNewEvent);
-    }
-  }
-
-  /* Trigger user notification */
-  if (Parameter.notification_test == false)
-  {
-    Notification.next_state = ActionMatrixArray[0x07];
+    object->payload.event0x07.location_epc = binary_data;
   }
+  Event_Emit(0x07, object, true);
 }
 
 /*!
@@ -769,68 +578,7 @@ void NewEvent0x08(uint32_t notification_id, uint64_t notification_ttl, uint8_t n
  */
 void NewEvent0x09(void)
 {
-  Event0x09 *ptrNewEvent = malloc(sizeof(Event0x09));
-
-  if (ptrNewEvent != NULL)
-  {
-    event0x09__init(ptrNewEvent);
-
-    ptrNewEvent->event_id = 0x09;
-    ptrNewEvent->event_timestamp = unixtime_ms;
-
-    GenericEvent *ptrNewGenericEvent = malloc(sizeof(GenericEvent));
-
-    if (ptrNewGenericEvent != NULL)
-    {
-      generic_event__init(ptrNewGenericEvent);
-
-      ptrNewGenericEvent->one_of_generic_event_case = GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X09;
-      ptrNewGenericEvent->field_event0x09 = ptrNewEvent;
-
-      /* Add this event in event array */
-      if (Event_filter(ptrNewGenericEvent) == false) // Event is not listed in event array yet
-      {
-        if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-        {
-          rtc_print_debug_timestamp();
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "Created Event0x09 'Battery charge low'\n");
-        }
-
-        Event_AddInArray(ptrNewGenericEvent);
-      }
-      else
-      {
-        /* Free allocated memory */
-        free(ptrNewEvent);
-        free(ptrNewGenericEvent);
-      }
-    }
-    else
-    {
-      if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-      {
-        rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewGenericEvent in Event0x09, Event number: %d\n", System.EventNumber);
-      }
-
-      /* Free allocated memory */
-      free(ptrNewEvent);
-    }
-  }
-  else
-  {
-    if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-    {
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewEvent0x09\n");
-    }
-  }
-
-  /* Trigger user notification */
-  if (Parameter.notification_test == false)
-  {
-    Notification.next_state = ActionMatrixArray[0x09];
-  }
+  Event_Emit(0x09, Event_Create(0x09), true);
 }
 
 /*!
@@ -839,1063 +587,177 @@ void NewEvent0x09(void)
  */
 void NewEvent0x0B(void)
 {
-  Event0x0B *ptrNewEvent = malloc(sizeof(Event0x0B));
+  Event_Emit(0x0B, Event_Create(0x0B), true);
+}
 
-  if (ptrNewEvent != NULL)
-  {
-    event0x0_b__init(ptrNewEvent);
+/*!
+ *  @brief This is the function description
+ *  @details: 0x0C - Connection down
+ */
+void NewEvent0x0C(void)
+{
+  Event_Emit(0x0C, Event_Create(0x0C), true);
+}
 
-    ptrNewEvent->event_id = 0x0B;
-    ptrNewEvent->event_timestamp = unixtime_ms;
+/*!
+ *  @brief This is the function description
+ *  @details: 0x0D - Button pressed
+ */
+void NewEvent0x0D(void)
+{
+  Event_Emit(0x0D, Event_Create(0x0D), true);
+}
 
-    GenericEvent *ptrNewGenericEvent = malloc(sizeof(GenericEvent));
+/*!
+ *  @brief This is the function description
+ *  @details: 0x0F - USB plugged in
+ */
+void NewEvent0x0F(void)
+{
+  Event_Emit(0x0F, Event_Create(0x0F), true);
+}
 
-    if (ptrNewGenericEvent != NULL)
-    {
-      generic_event__init(ptrNewGenericEvent);
+/*!
+ *  @brief This is the function description
+ *  @details: 0x10 - USB plugged off
+ */
+void NewEvent0x10(void)
+{
+  Event_Emit(0x10, Event_Create(0x10), true);
+}
 
-      ptrNewGenericEvent->one_of_generic_event_case = GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X0_B;
-      ptrNewGenericEvent->field_event0x0b = ptrNewEvent;
+/*!
+ *  @brief This is the function description
+ *  @details: 0x11 - Charging started
+ */
+void NewEvent0x11(void)
+{
+  Event_Emit(0x11, Event_Create(0x11), true);
+}
 
-      /* Add this event in event array */
-      if (Event_filter(ptrNewGenericEvent) == false) // Event is not listed in event array yet
-      {
-        if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-        {
-          rtc_print_debug_timestamp();
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "Created Event0x0B 'Connection up', Event number: %d\n", System.EventNumber);
-        }
+/*!
+ *  @brief This is the function description
+ *  @details: 0x12 - Charging stopped
+ */
+void NewEvent0x12(void)
+{
+  Event_Emit(0x12, Event_Create(0x12), true);
+}
 
-        Event_AddInArray(ptrNewGenericEvent);
-      }
-      else
-      {
-        /* Free allocated memory */
-        free(ptrNewEvent);
-        free(ptrNewGenericEvent);
-      }
-    }
-    else
-    {
-      if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-      {
-        rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewGenericEvent in Event0x0B, Event number: %d\n", System.EventNumber);
-      }
+/*!
+ *  @brief This is the function description
+ *  @details: 0x13 - Power on
+ */
+void NewEvent0x13(void)
+{
+  Event_Emit(0x13, Event_Create(0x13), true);
+}
 
-      /* Free allocated memory */
-      free(ptrNewEvent);
-    }
-  }
-  else
-  {
-    if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-    {
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewEvent0x0B\n");
-    }
-  }
+/*!
+ *  @brief This is the function description
+ *  @details: 0x17 - Hit shock
+ */
+void NewEvent0x17(uint32_t schock_acc)
+{
+  EVENT_OBJECT *object = Event_Create(0x17);
 
-  /* Trigger user notification */
-  if (Parameter.notification_test == false)
+  if (object != NULL)
   {
-    Notification.next_state = ActionMatrixArray[0x0B];
+    object->payload.event0x17.schock_acc = schock_acc;
   }
+  Event_Emit(0x17, object, true);
 }
 
 /*!
  *  @brief This is the function description
- *  @details: 0x0C - Connection down
+ *  @details: 0x18 - Frame side flip
  */
-void NewEvent0x0C(void)
+void NewEvent0x18(uint32_t frame_side)
 {
-  Event0x0C *ptrNewEvent = malloc(sizeof(Event0x0C));
+  EVENT_OBJECT *object = Event_Create(0x18);
 
-  if (ptrNewEvent != NULL)
+  if (object != NULL)
   {
-    event0x0_c__init(ptrNewEvent);
-
-    ptrNewEvent->event_id = 0x0C;
-    ptrNewEvent->event_timestamp = unixtime_ms;
-
-    GenericEvent *ptrNewGenericEvent = malloc(sizeof(GenericEvent));
-
-    if (ptrNewGenericEvent != NULL)
-    {
-      generic_event__init(ptrNewGenericEvent);
-
-      ptrNewGenericEvent->one_of_generic_event_case = GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X0_C;
-      ptrNewGenericEvent->field_event0x0c = ptrNewEvent;
-
-      /* Add this event in event array */
-      if (Event_filter(ptrNewGenericEvent) == false) // Event is not listed in event array yet
-      {
-        if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-        {
-          rtc_print_debug_timestamp();
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "Created Event0x0C 'Connection down', Event number: %d\n", System.EventNumber);
-        }
+    object->payload.event0x18.frame_side = frame_side;
+  }
+  Event_Emit(0x18, object, true);
+}
 
-        Event_AddInArray(ptrNewGenericEvent);
-      }
-      else
-      {
-        /* Free allocated memory */
-        free(ptrNewEvent);
-        free(ptrNewGenericEvent);
-      }
-    }
-    else
-    {
-      if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-      {
-        rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewGenericEvent in Event0x0C\n");
-      }
+/*!
+ *  @brief This is the function description
+ *  @details: 0x19 - Inappropriate mop is used in the room in mopping state
+ */
+void NewEvent0x19(uint32_t room_id, uint32_t mop_id)
+{
+  EVENT_OBJECT *object = Event_Create(0x19);
 
-      /* Free allocated memory */
-      free(ptrNewEvent);
-    }
-  }
-  else
+  if (object != NULL)
   {
-    if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-    {
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewEvent0x0C\n");
-    }
+    object->payload.event0x19.room_id = room_id;
+    object->payload.event0x19.mop_id = mop_id;
+    object->filter_key = EVENT_FILTER_KEY(room_id, mop_id);
   }
+  Event_Emit(0x19, object, true);
+}
 
-  /* Trigger user notification */
-  if (Parameter.notification_test == false)
+/*!
+ *  @brief This is the function description
+ *  @details: 0x1A - Inappropriate mop is near the room
+ */
+void NewEvent0x1A(uint32_t room_id, uint32_t mop_id)
+{
+  EVENT_OBJECT *object = Event_Create(0x1A);
+
+  if (object != NULL)
   {
-    Notification.next_state = ActionMatrixArray[0x0C];
+    object->payload.event0x1a.room_id = room_id;
+    object->payload.event0x1a.mop_id = mop_id;
   }
+  Event_Emit(0x1A, object, true);
 }
 
 /*!
  *  @brief This is the function description
- *  @details: 0x0D - Button pressed
+ *  @details: 0x1B - Mop change
  */
-void NewEvent0x0D(void)
+void NewEvent0x1B(void)
 {
-  Event0x0D *ptrNewEvent = malloc(sizeof(Event0x0D));
+  Event_Emit(0x1B, Event_Create(0x1B), true);
+}
 
-  if (ptrNewEvent != NULL)
-  {
-    event0x0_d__init(ptrNewEvent);
+/*!
+ *  @brief This is the function description
+ *  @details: 0x1C - Square meters
+ */
+void NewEvent0x1C(uint32_t mop_id, float sqm_side_0, float sqm_side_1)
+{
+  EVENT_OBJECT *object = Event_Create(0x1C);
 
-    ptrNewEvent->event_id = 0x0D;
-    ptrNewEvent->event_timestamp = unixtime_ms;
+  if (object != NULL)
+  {
+    object->payload.event0x1c.mop_id = mop_id;
+    object->payload.event0x1c.sqm_side_0 = sqm_side_0;
+    object->payload.event0x1c.sqm_side_1 = sqm_side_1;
+  }
+  Event_Emit(0x1C, object, true);
+}
 
-    GenericEvent *ptrNewGenericEvent = malloc(sizeof(GenericEvent));
+/*!
+ *  @brief This is the function description
+ *  @details: 0xFF - Debug info
+ */
+void NewEvent0xFF(uint32_t msg_id, uint8_t *msg, uint16_t len)
+{
+  EVENT_OBJECT *object = Event_Create(0xFF);
 
-    if (ptrNewGenericEvent != NULL)
-    {
-      generic_event__init(ptrNewGenericEvent);
+  if (object != NULL)
+  {
+    object->payload.event0xff.msg_id = msg_id;
 
-      ptrNewGenericEvent->one_of_generic_event_case = GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X0_D;
-      ptrNewGenericEvent->field_event0x0d = ptrNewEvent;
+    binary_data.len = len;
+    binary_data.data = msg;
 
-      /* Add this event in event array */
-      if (Event_filter(ptrNewGenericEvent) == false) // Event is not listed in event array yet
-      {
-        if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-        {
-          rtc_print_debug_timestamp();
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "Created Event0x0D 'Button pressed', Event number: %d\n", System.EventNumber);
-        }
-
-        Event_AddInArray(ptrNewGenericEvent);
-      }
-      else
-      {
-        /* Free allocated memory */
-        free(ptrNewEvent);
-        free(ptrNewGenericEvent);
-      }
-    }
-    else
-    {
-      if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-      {
-        rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewGenericEvent in Event0x0D\n");
-      }
-
-      /* Free allocated memory */
-      free(ptrNewEvent);
-    }
-  }
-  else
-  {
-    if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-    {
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewEvent0x0D\n");
-    }
-  }
-
-  /* Trigger user notification */
-  if (Parameter.notification_test == false)
-  {
-    Notification.next_state = ActionMatrixArray[0x0D];
-  }
-}
-
-/*!
- *  @brief This is the function description
- *  @details: 0x0F - USB plugged in
- */
-void NewEvent0x0F(void)
-{
-  Event0x0F *ptrNewEvent = malloc(sizeof(Event0x0F));
-
-  if (ptrNewEvent != NULL)
-  {
-    event0x0_f__init(ptrNewEvent);
-
-    ptrNewEvent->event_id = 0x0F;
-    ptrNewEvent->event_timestamp = unixtime_ms;
-
-    GenericEvent *ptrNewGenericEvent = malloc(sizeof(GenericEvent));
-
-    if (ptrNewGenericEvent != NULL)
-    {
-      generic_event__init(ptrNewGenericEvent);
-
-      ptrNewGenericEvent->one_of_generic_event_case = GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X0_F;
-      ptrNewGenericEvent->field_event0x0f = ptrNewEvent;
-
-      /* Add this event in event array */
-      if (Event_filter(ptrNewGenericEvent) == false) // Event is not listed in event array yet
-      {
-        if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-        {
-          rtc_print_debug_timestamp();
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "Created Event0x0F 'USB plugged in', Event number: %d\n", System.EventNumber);
-        }
-
-        Event_AddInArray(ptrNewGenericEvent);
-      }
-      else
-      {
-        /* Free allocated memory */
-        free(ptrNewEvent);
-        free(ptrNewGenericEvent);
-      }
-    }
-    else
-    {
-      if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-      {
-        rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewGenericEvent in Event0x0F\n");
-      }
-
-      /* Free allocated memory */
-      free(ptrNewEvent);
-    }
-  }
-  else
-  {
-    if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-    {
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewEvent0x0F\n");
-    }
-  }
-
-  /* Trigger user notification */
-  if (Parameter.notification_test == false)
-  {
-    Notification.next_state = ActionMatrixArray[0x0F];
-  }
-}
-
-/*!
- *  @brief This is the function description
- *  @details: 0x10 - USB plugged off
- */
-void NewEvent0x10(void)
-{
-  Event0x10 *ptrNewEvent = malloc(sizeof(Event0x10));
-
-  if (ptrNewEvent != NULL)
-  {
-    event0x10__init(ptrNewEvent);
-
-    ptrNewEvent->event_id = 0x10;
-    ptrNewEvent->event_timestamp = unixtime_ms;
-
-    GenericEvent *ptrNewGenericEvent = malloc(sizeof(GenericEvent));
-
-    if (ptrNewGenericEvent != NULL)
-    {
-      generic_event__init(ptrNewGenericEvent);
-
-      ptrNewGenericEvent->one_of_generic_event_case = GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X10;
-      ptrNewGenericEvent->field_event0x10 = ptrNewEvent;
-
-      /* Add this event in event array */
-      if (Event_filter(ptrNewGenericEvent) == false) // Event is not listed in event array yet
-      {
-        if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-        {
-          rtc_print_debug_timestamp();
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "Created Event0x10 'USB plugged off', Event number: %d\n", System.EventNumber);
-        }
-
-        Event_AddInArray(ptrNewGenericEvent);
-      }
-      else
-      {
-        /* Free allocated memory */
-        free(ptrNewEvent);
-        free(ptrNewGenericEvent);
-      }
-    }
-    else
-    {
-      if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-      {
-        rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewGenericEvent in Event0x10\n");
-      }
-
-      /* Free allocated memory */
-      free(ptrNewEvent);
-    }
-  }
-  else
-  {
-    if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-    {
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewEvent0x10\n");
-    }
-  }
-
-  /* Trigger user notification */
-  if (Parameter.notification_test == false)
-  {
-    Notification.next_state = ActionMatrixArray[0x10];
-  }
-}
-
-/*!
- *  @brief This is the function description
- *  @details: 0x11 - Charging started
- */
-void NewEvent0x11(void)
-{
-  Event0x11 *ptrNewEvent = malloc(sizeof(Event0x11));
-
-  if (ptrNewEvent != NULL)
-  {
-    event0x11__init(ptrNewEvent);
-
-    ptrNewEvent->event_id = 0x11;
-    ptrNewEvent->event_timestamp = unixtime_ms;
-
-    GenericEvent *ptrNewGenericEvent = malloc(sizeof(GenericEvent));
-
-    if (ptrNewGenericEvent != NULL)
-    {
-      generic_event__init(ptrNewGenericEvent);
-
-      ptrNewGenericEvent->one_of_generic_event_case = GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X11;
-      ptrNewGenericEvent->field_event0x11 = ptrNewEvent;
-
-      /* Add this event in event array */
-      if (Event_filter(ptrNewGenericEvent) == false) // Event is not listed in event array yet
-      {
-        if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-        {
-          rtc_print_debug_timestamp();
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "Created Event0x11 'Charging started', Event number: %d\n", System.EventNumber);
-        }
-
-        Event_AddInArray(ptrNewGenericEvent);
-      }
-      else
-      {
-        /* Free allocated memory */
-        free(ptrNewEvent);
-        free(ptrNewGenericEvent);
-      }
-    }
-    else
-    {
-      if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-      {
-        rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewGenericEvent in Event0x11\n");
-      }
-
-      /* Free allocated memory */
-      free(ptrNewEvent);
-    }
-  }
-  else
-  {
-    if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-    {
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewEvent0x11\n");
-    }
-  }
-
-  /* Trigger user notification */
-  if (Parameter.notification_test == false)
-  {
-    Notification.next_state = ActionMatrixArray[0x11];
-  }
-}
-
-/*!
- *  @brief This is the function description
- *  @details: 0x12 - Charging stopped
- */
-void NewEvent0x12(void)
-{
-  Event0x12 *ptrNewEvent = malloc(sizeof(Event0x12));
-
-  if (ptrNewEvent != NULL)
-  {
-    event0x12__init(ptrNewEvent);
-
-    ptrNewEvent->event_id = 0x12;
-    ptrNewEvent->event_timestamp = unixtime_ms;
-
-    GenericEvent *ptrNewGenericEvent = malloc(sizeof(GenericEvent));
-
-    if (ptrNewGenericEvent != NULL)
-    {
-      generic_event__init(ptrNewGenericEvent);
-
-      ptrNewGenericEvent->one_of_generic_event_case = GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X12;
-      ptrNewGenericEvent->field_event0x12 = ptrNewEvent;
-
-      /* Add this event in event array */
-      if (Event_filter(ptrNewGenericEvent) == false) // Event is not listed in event array yet
-      {
-
-        if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-        {
-          rtc_print_debug_timestamp();
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "Created Event0x12 'Charging stopped', Event number: %d\n", System.EventNumber);
-        }
-
-        Event_AddInArray(ptrNewGenericEvent);
-      }
-      else
-      {
-        /* Free allocated memory */
-        free(ptrNewEvent);
-        free(ptrNewGenericEvent);
-      }
-    }
-    else
-    {
-      if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-      {
-        rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewGenericEvent in Event0x12\n");
-      }
-
-      /* Free allocated memory */
-      free(ptrNewEvent);
-    }
-  }
-  else
-  {
-    if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-    {
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewEvent0x12\n");
-    }
-  }
-
-  /* Trigger user notification */
-  if (Parameter.notification_test == false)
-  {
-    Notification.next_state = ActionMatrixArray[0x12];
-  }
-}
-
-/*!
- *  @brief This is the function description
- *  @details: 0x13 - Power on
- */
-void NewEvent0x13(void)
-{
-  Event0x13 *ptrNewEvent = malloc(sizeof(Event0x13));
-
-  if (ptrNewEvent != NULL)
-  {
-    event0x13__init(ptrNewEvent);
-
-    ptrNewEvent->event_id = 0x13;
-    ptrNewEvent->event_timestamp = unixtime_ms;
-
-    GenericEvent *ptrNewGenericEvent = malloc(sizeof(GenericEvent));
-
-    if (ptrNewGenericEvent != NULL)
-    {
-      generic_event__init(ptrNewGenericEvent);
-
-      ptrNewGenericEvent->one_of_generic_event_case = GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X13;
-      ptrNewGenericEvent->field_event0x13 = ptrNewEvent;
-
-      /* Add this event in event array */
-      if (Event_filter(ptrNewGenericEvent) == false) // Event is not listed in event array yet
-      {
-        if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-        {
-          rtc_print_debug_timestamp();
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "Created Event0x13 'Power on', Event number: %d\n", System.EventNumber);
-        }
-
-        Event_AddInArray(ptrNewGenericEvent);
-      }
-      else
-      {
-        /* Free allocated memory */
-        free(ptrNewEvent);
-        free(ptrNewGenericEvent);
-      }
-    }
-    else
-    {
-      if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-      {
-        rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewGenericEvent in Event0x13\n");
-      }
-
-      /* Free allocated memory */
-      free(ptrNewEvent);
-    }
-  }
-  else
-  {
-    if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-    {
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewEvent0x13\n");
-    }
-  }
-
-  /* Trigger user notification */
-  if (Parameter.notification_test == false)
-  {
-    Notification.next_state = ActionMatrixArray[0x13];
-  }
-}
-
-/*!
- *  @brief This is the function description
- *  @details: 0x17 - Hit shock
- */
-void NewEvent0x17(uint32_t schock_acc)
-{
-  Event0x17 *ptrNewEvent = malloc(sizeof(Event0x17));
-
-  if (ptrNewEvent != NULL)
-  {
-    event0x17__init(ptrNewEvent);
-
-    ptrNewEvent->event_id = 0x17;
-    ptrNewEvent->event_timestamp = unixtime_ms;
-    ptrNewEvent->schock_acc = schock_acc;
-
-    GenericEvent *ptrNewGenericEvent = malloc(sizeof(GenericEvent));
-
-    if (ptrNewGenericEvent != NULL)
-    {
-      generic_event__init(ptrNewGenericEvent);
-
-      ptrNewGenericEvent->one_of_generic_event_case = GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X17;
-      ptrNewGenericEvent->field_event0x17 = ptrNewEvent;
-
-      /* Add this event in event array */
-      if (Event_filter(ptrNewGenericEvent) == false) // Event is not listed in event array yet
-      {
-        if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-        {
-          rtc_print_debug_timestamp();
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "Created Event0x17 'Hit shock', Event number: %d\n", System.EventNumber);
-        }
-
-        Event_AddInArray(ptrNewGenericEvent);
-      }
-      else
-      {
-        /* Free allocated memory */
-        free(ptrNewEvent);
-        free(ptrNewGenericEvent);
-      }
-    }
-    else
-    {
-      if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-      {
-        rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewGenericEvent in Event0x17\n");
-      }
-
-      /* Free allocated memory */
-      free(ptrNewEvent);
-    }
-  }
-  else
-  {
-    if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-    {
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewEvent0x17\n");
-    }
-  }
-
-  /* Trigger user notification */
-  if (Parameter.notification_test == false)
-  {
-    Notification.next_state = ActionMatrixArray[0x17];
-  }
-}
-
-/*!
- *  @brief This is the function description
- *  @details: 0x18 - Frame side flip
- */
-void NewEvent0x18(uint32_t frame_side)
-{
-  Event0x18 *ptrNewEvent = malloc(sizeof(Event0x18));
-
-  if (ptrNewEvent != NULL)
-  {
-    event0x18__init(ptrNewEvent);
-
-    ptrNewEvent->event_id = 0x18;
-    ptrNewEvent->event_timestamp = unixtime_ms;
-    ptrNewEvent->frame_side = frame_side;
-
-    GenericEvent *ptrNewGenericEvent = malloc(sizeof(GenericEvent));
-
-    if (ptrNewGenericEvent != NULL)
-    {
-      generic_event__init(ptrNewGenericEvent);
-
-      ptrNewGenericEvent->one_of_generic_event_case = GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X18;
-      ptrNewGenericEvent->field_event0x18 = ptrNewEvent;
-
-      /* Add this event in event array */
-      if (Event_filter(ptrNewGenericEvent) == false) // Event is not listed in event array yet
-      {
-        if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-        {
-          rtc_print_debug_timestamp();
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "Created Event0x18 'Frame side flip', Event number: %d\n", System.EventNumber);
-        }
-
-        Event_AddInArray(ptrNewGenericEvent);
-      }
-      else
-      {
-        /* Free allocated memory */
-        free(ptrNewEvent);
-        free(ptrNewGenericEvent);
-      }
-    }
-    else
-    {
-      if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-      {
-        rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewGenericEvent in Event0x18\n");
-      }
-
-      /* Free allocated memory */
-      free(ptrNewEvent);
-    }
-  }
-  else
-  {
-    if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-    {
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewEvent0x18\n");
-    }
-  }
-
-  /* Trigger user notification */
-  if (Parameter.notification_test == false)
-  {
-    Notification.next_state = ActionMatrixArray[0x18];
-  }
-}
-
-/*!
- *  @brief This is the function description
- *  @details: 0x19 - Inappropriate mop is used in the room in mopping state
- */
-void NewEvent0x19(uint32_t room_id, uint32_t mop_id)
-{
-  Event0x19 *ptrNewEvent = malloc(sizeof(Event0x19));
-
-  if (ptrNewEvent != NULL)
-  {
-    event0x19__init(ptrNewEvent);
-
-    ptrNewEvent->event_id = 0x19;
-    ptrNewEvent->event_timestamp = unixtime_ms;
-    ptrNewEvent->room_id = room_id;
-    ptrNewEvent->mop_id = mop_id;
-
-    GenericEvent *ptrNewGenericEvent = malloc(sizeof(GenericEvent));
-
-    if (ptrNewGenericEvent != NULL)
-    {
-      generic_event__init(ptrNewGenericEvent);
-
-      ptrNewGenericEvent->one_of_generic_event_case = GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X19;
-      ptrNewGenericEvent->field_event0x19 = ptrNewEvent;
-
-      /* Add this event in event array */
-      if (Event_filter(ptrNewGenericEvent) == false) // Check if event should be added multiple times
-      {
-        if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-        {
-          rtc_print_debug_timestamp();
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "Created Event0x19 'Inappropriate mop is used in the room in mopping state', Event number: %d\n", System.EventNumber);
-        }
-
-        Event_AddInArray(ptrNewGenericEvent);
-      }
-      else
-      {
-        /* Free allocated memory */
-        free(ptrNewEvent);
-        free(ptrNewGenericEvent);
-      }
-    }
-    else
-    {
-      if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-      {
-        rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewGenericEvent in Event0x19\n");
-      }
-
-      /* Free allocated memory */
-      free(ptrNewEvent);
-    }
-  }
-  else
-  {
-    if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-    {
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewEvent0x19\n");
-    }
-  }
-
-  /* Trigger user notification */
-  if (Parameter.notification_test == false)
-  {
-    Notification.next_state = ActionMatrixArray[0x19];
-  }
-}
-
-/*!
- *  @brief This is the function description
- *  @details: 0x19 - Inappropriate mop is used in the room in mopping state
- */
-void NewEvent0x1A(uint32_t room_id, uint32_t mop_id)
-{
-  Event0x1A *ptrNewEvent = malloc(sizeof(Event0x1A));
-
-  if (ptrNewEvent != NULL)
-  {
-    event0x1_a__init(ptrNewEvent);
-
-    ptrNewEvent->event_id = 0x1A;
-    ptrNewEvent->event_timestamp = unixtime_ms;
-    ptrNewEvent->room_id = room_id;
-    ptrNewEvent->mop_id = mop_id;
-
-    GenericEvent *ptrNewGenericEvent = malloc(sizeof(GenericEvent));
-
-    if (ptrNewGenericEvent != NULL)
-    {
-      generic_event__init(ptrNewGenericEvent);
-
-      ptrNewGenericEvent->one_of_generic_event_case = GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X1_A;
-      ptrNewGenericEvent->field_event0x1a = ptrNewEvent;
-
-      /* Add this event in event array */
-      if (Event_filter(ptrNewGenericEvent) == false) // Event is not listed in event array yet
-      {
-        if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-        {
-          rtc_print_debug_timestamp();
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "Created Event0x1A 'Inappropriate mop is near the room', Event number: %d\n", System.EventNumber);
-        }
-
-        Event_AddInArray(ptrNewGenericEvent);
-      }
-      else
-      {
-        /* Free allocated memory */
-        free(ptrNewEvent);
-        free(ptrNewGenericEvent);
-      }
-    }
-    else
-    {
-      if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-      {
-        rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewGenericEvent in Event0x1A\n");
-      }
-
-      /* Free allocated memory */
-      free(ptrNewEvent);
-    }
-  }
-  else
-  {
-    if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-    {
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewEvent0x1A\n");
-    }
-  }
-
-  /* Trigger user notification */
-  if (Parameter.notification_test == false)
-  {
-    Notification.next_state = ActionMatrixArray[0x1A];
-  }
-}
-
-/*!
- *  @brief This is the function description
- *  @details: 0x19 - Inappropriate mop is used in the room in mopping state
- */
-void NewEvent0x1B(void)
-{
-  Event0x1B *ptrNewEvent = malloc(sizeof(Event0x1B));
-
-  if (ptrNewEvent != NULL)
-  {
-    event0x1_b__init(ptrNewEvent);
-
-    ptrNewEvent->event_id = 0x1B;
-    ptrNewEvent->event_timestamp = unixtime_ms;
-
-    GenericEvent *ptrNewGenericEvent = malloc(sizeof(GenericEvent));
-
-    if (ptrNewGenericEvent != NULL)
-    {
-      generic_event__init(ptrNewGenericEvent);
-
-      ptrNewGenericEvent->one_of_generic_event_case = GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X1_B;
-      ptrNewGenericEvent->field_event0x1b = ptrNewEvent;
-
-      /* Add this event in event array */
-      if (Event_filter(ptrNewGenericEvent) == false) // Event is not listed in event array yet
-      {
-        if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-        {
-          rtc_print_debug_timestamp();
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "Created Event0x1B 'Mop change', Event number: %d\n", System.EventNumber);
-        }
-
-        Event_AddInArray(ptrNewGenericEvent);
-      }
-      else
-      {
-        /* Free allocated memory */
-        free(ptrNewEvent);
-        free(ptrNewGenericEvent);
-      }
-    }
-    else
-    {
-      if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-      {
-        rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewGenericEvent in Event0x1B\n");
-      }
-
-      /* Free allocated memory */
-      free(ptrNewEvent);
-    }
-  }
-  else
-  {
-    if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-    {
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewEvent0x1B\n");
-    }
-  }
-
-  /* Trigger user notification */
-  if (Parameter.notification_test == false)
-  {
-    Notification.next_state = ActionMatrixArray[0x1B];
-  }
-}
-
-/*!
- *  @brief This is the function description
- *  @details: 0x1C - Square meters
- */
-void NewEvent0x1C(uint32_t mop_id, float sqm_side_0, float sqm_side_1)
-{
-  Event0x1C *ptrNewEvent = malloc(sizeof(Event0x1C));
-
-  if (ptrNewEvent != NULL)
-  {
-    event0x1_c__init(ptrNewEvent);
-
-    ptrNewEvent->event_id = 0x1C;
-    ptrNewEvent->event_timestamp = unixtime_ms;
-    ptrNewEvent->mop_id = mop_id;
-    ptrNewEvent->sqm_side_0 = sqm_side_0;
-    ptrNewEvent->sqm_side_1 = sqm_side_1;
-
-    GenericEvent *ptrNewGenericEvent = malloc(sizeof(GenericEvent));
-
-    if (ptrNewGenericEvent != NULL)
-    {
-      generic_event__init(ptrNewGenericEvent);
-
-      ptrNewGenericEvent->one_of_generic_event_case = GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X1_C;
-      ptrNewGenericEvent->field_event0x1c = ptrNewEvent;
-
-      /* Add this event in event array */
-      if (Event_filter(ptrNewGenericEvent) == false) // Event is not listed in event array yet
-      {
-        if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-        {
-          rtc_print_debug_timestamp();
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "Created Event0x1C 'MopID:%d, sqm_side_0: %.1f, sqm_side_1 : %.1f, Event number: %d\n", mop_id, sqm_side_0, sqm_side_1, System.EventNumber);
-        }
-
-        Event_AddInArray(ptrNewGenericEvent);
-      }
-      else
-      {
-        /* Free allocated memory */
-        free(ptrNewEvent);
-        free(ptrNewGenericEvent);
-      }
-    }
-    else
-    {
-      if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-      {
-        rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewGenericEvent in Event0x1C\n");
-      }
-
-      /* Free allocated memory */
-      free(ptrNewEvent);
-    }
-  }
-  else
-  {
-    if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-    {
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewEvent0x1C\n");
-    }
-  }
-
-  /* Trigger user notification */
-  //  if (Parameter.notification_test == false)
-  // {
-  //   Notification.next_state = ActionMatrixArray[0x1B];
-  // }
-}
-
-/*!
- *  @brief This is the function description
- *  @details: 0xFF - Debug info
- */
-void NewEvent0xFF(uint32_t msg_id, uint8_t *msg, uint16_t len)
-{
-  Event0xFF *ptrNewEvent = malloc(sizeof(Event0xFF));
-
-  if (ptrNewEvent != NULL)
-  {
-    event0x_ff__init(ptrNewEvent);
-
-    ptrNewEvent->event_id = 0xFF;
-    ptrNewEvent->event_timestamp = unixtime_ms;
-    ptrNewEvent->msg_id = msg_id;
-
-    /* Copy current location in allocated memory */
-    binary_data.len = len;
-    binary_data.data = msg;
-
-    ptrNewEvent->msg = binary_data;
-
-    GenericEvent *ptrNewGenericEvent = malloc(sizeof(GenericEvent));
-
-    if (ptrNewGenericEvent != NULL)
-    {
-      generic_event__init(ptrNewGenericEvent);
-
-      ptrNewGenericEvent->one_of_generic_event_case = GENERIC_EVENT__ONE_OF_GENERIC_EVENT_FIELD_EVENT0X_FF;
-      ptrNewGenericEvent->field_event0xff = ptrNewEvent;
-
-      /* Add this event in event array */
-      if (Event_filter(ptrNewGenericEvent) == false) // Event is not listed in event array yet
-      {
-        if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-        {
-          rtc_print_debug_timestamp();
-          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "Created Event0xFF 'Debug info', Event number: %d\n", System.EventNumber);
-        }
-
-        Event_AddInArray(ptrNewGenericEvent);
-      }
-      else
-      {
-        /* Free allocated memory */
-        free(ptrNewEvent);
-        free(ptrNewGenericEvent);
-      }
-    }
-    else
-    {
-      if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-      {
-        rtc_print_debug_timestamp();
-        shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewGenericEvent in Event0xFF\n");
-      }
-
-      /* Free allocated memory */
-      free(ptrNewEvent);
-    }
-  }
-  else
-  {
-    if ((Parameter.events_verbose == true) && (pcb_test_is_running == false))
-    {
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Could not allocate memory for NewEvent0xFF\n");
-    }
+    object->payload.event0xff.msg = binary_data;
   }
-
-  /* Trigger user notification */
-  //  if (Parameter.notification_test == false)
-  // {
-  //   Notification.next_state = ActionMatrixArray[0x1B];
-  // }
+  Event_Emit(0xFF, object, true);
 }
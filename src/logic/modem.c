@@ -48,6 +48,7 @@ void lte_handler(const struct lte_lc_evt *const evt)
       case LTE_LC_NW_REG_NOT_REGISTERED:
          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_YELLOW, "LTE event: LTE_LC_NW_REG_NOT_REGISTERED\n");
          modem.connection_stat = false;
+         coap_invalidate_connection(); // The socket does not survive the lost registration
          break;
 
       case LTE_LC_NW_REG_REGISTERED_HOME:
@@ -73,11 +74,13 @@ void lte_handler(const struct lte_lc_evt *const evt)
       case LTE_LC_NW_REG_SEARCHING:
          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_YELLOW, "LTE event: LTE_LC_NW_REG_SEARCHING\n");
          modem.connection_stat = false;
+         coap_invalidate_connection(); // The socket does not survive the lost registration
          break;
 
       case LTE_LC_NW_REG_REGISTRATION_DENIED:
          shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_YELLOW, "LTE event: LTE_LC_NW_REG_REGISTRATION_DENIED\n");
          modem.connection_stat = false;
+         coap_invalidate_connection(); // The socket does not survive the lost registration
          break;
 
       case LTE_LC_NW_REG_UNKNOWN:
@@ -86,6 +89,7 @@ void lte_handler(const struct lte_lc_evt *const evt)
          /* Add event in event array which is send to cloud in next sync interval */
          NewEvent0x0C(); // Connection down event
          modem.connection_stat = false;
+         coap_invalidate_connection(); // The socket does not survive the lost registration
          break;
 
       case LTE_LC_NW_REG_REGISTERED_ROAMING:
@@ -119,6 +123,7 @@ void lte_handler(const struct lte_lc_evt *const evt)
          /* Add event in event array which is send to cloud in next sync interval */
          NewEvent0x0C(); // Connection down event
          modem.connection_stat = false;
+         coap_invalidate_connection(); // The socket does not survive the lost registration
          break;
       default:
          break;
@@ -0,0 +1,688 @@
+/**
+ * @file provisioning.c
+ * @author Thomas Keilbach | keiltronic GmbH
+ * @date 17 Oct 2026
+ * @brief This file contains the binary protocol to load the rfid, room and mop databases over the shell uart
+ * @version 2.0.0
+ */
+
+/*!
+ * @defgroup Memory
+ * @brief This file contains the binary protocol to load the rfid, room and mop databases over the shell uart
+ * @{*/
+#include "provisioning.h"
+
+typedef enum
+{
+  PROVISION_PARSER_SYNC_1 = 0,
+  PROVISION_PARSER_SYNC_2,
+  PROVISION_PARSER_HEADER,
+  PROVISION_PARSER_PAYLOAD,
+  PROVISION_PARSER_CRC
+} PROVISION_PARSER_STATE;
+
+/* A sorted batch of records in the staging area */
+typedef struct
+{
+  uint32_t address;   // Next record which is not merged yet
+  uint32_t remaining; // Records which are not merged yet
+  uint8_t record[RFID_RECORD_BYTE_LENGTH];
+} PROVISION_RUN;
+
+static const struct shell *provision_shell = NULL;
+static bool provision_active = false;
+static int64_t provision_last_activity = 0;
+
+/* Frame parser */
+static PROVISION_PARSER_STATE provision_parser_state = PROVISION_PARSER_SYNC_1;
+static uint8_t provision_header[PROVISION_HEADER_LENGTH];
+static uint8_t provision_payload[PROVISION_MAX_PAYLOAD];
+static uint8_t provision_frame_crc[sizeof(uint32_t)];
+static uint16_t provision_position = 0;
+static uint16_t provision_payload_length = 0;
+
+/* Session */
+static uint16_t provision_expected_sequence = 0;
+static bool provision_nak_sent = false;
+static bool provision_update_started = false;
+static uint8_t provision_tables_done = 0; // Bitmask of EPC_TABLE
+static int8_t provision_table = -1;       // Table between START and END, -1 if none
+static uint32_t provision_record_count = 0;
+static uint32_t provision_records_received = 0;
+static uint32_t provision_stream_crc = 0UL;
+
+/* Sorting */
+static uint8_t provision_batch[PROVISION_BATCH_SIZE];
+static uint32_t provision_batch_length = 0;
+static uint32_t provision_staging_length = 0;
+static PROVISION_RUN provision_runs[PROVISION_MAX_RUNS];
+static uint8_t provision_run_count = 0;
+static int (*provision_compare)(const void *a, const void *b) = NULL;
+
+/* Table output */
+static uint8_t provision_page[FLASH_PAGE_SIZE];
+static uint16_t provision_page_length = 0;
+static uint32_t provision_output_address = 0UL;
+static uint32_t provision_output_length = 0UL;
+static uint32_t provision_output_crc = 0UL;
+
+K_MUTEX_DEFINE(provision_mutex);
+
+static void Provision_Stop(const char *reason);
+
+/* The inactivity timeout is checked in the system work queue, the timer runs in interrupt context */
+static void Provision_TimeoutHandler(struct k_work *work)
+{
+  k_mutex_lock(&provision_mutex, K_FOREVER);
+
+  if ((provision_active == true) && ((k_uptime_get() - provision_last_activity) >= (PROVISION_TIMEOUT * MSEC_PER_SEC)))
+  {
+    Provision_Stop("timeout");
+  }
+
+  k_mutex_unlock(&provision_mutex);
+}
+K_WORK_DEFINE(provision_timeout_work, Provision_TimeoutHandler);
+
+static void Provision_TimerHandler(struct k_timer *timer)
+{
+  k_work_submit(&provision_timeout_work);
+}
+K_TIMER_DEFINE(provision_timer, Provision_TimerHandler, NULL);
+
+/**
+ * @brief This function writes raw bytes to the shell uart, the shell itself must not touch them
+ */
+static void Provision_Write(const uint8_t *data, size_t length)
+{
+  size_t written = 0;
+
+  while (length > 0)
+  {
+    if (provision_shell->iface->api->write(provision_shell->iface, data, length, &written) != 0)
+    {
+      return;
+    }
+
+    data += written;
+    length -= written;
+
+    if (written == 0)
+    {
+      k_msleep(1);
+    }
+  }
+}
+
+/**
+ * @brief This function sends an ACK or NAK with the next expected sequence number
+ */
+static void Provision_SendResponse(uint8_t type, uint8_t status)
+{
+  uint8_t frame[2 + PROVISION_HEADER_LENGTH + 3 + sizeof(uint32_t)] = {PROVISION_SYNC_1, PROVISION_SYNC_2, type, 0, 0, 3, 0};
+  uint32_t crc = 0UL;
+
+  frame[7] = provision_expected_sequence & 0xFF;
+  frame[8] = provision_expected_sequence >> 8;
+  frame[9] = status;
+
+  crc = crc32_ieee(&frame[2], PROVISION_HEADER_LENGTH + 3);
+  memcpy(&frame[10], &crc, sizeof(crc));
+
+  Provision_Write(frame, sizeof(frame));
+}
+
+/**
+ * @brief This function requests a retransmission starting with the expected frame. Following frames of the window are dropped
+ * silently until it arrives, so the host gets only one NAK for a lost frame.
+ */
+static void Provision_RequestRetransmission(uint8_t status)
+{
+  if (provision_nak_sent == false)
+  {
+    Provision_SendResponse(PROVISION_FRAME_NAK, status);
+    provision_nak_sent = true;
+  }
+}
+
+/**
+ * @brief This function collects the bytes of the table in page size blocks and writes them into the updated bank
+ *
+ * @param data: Pointer to the bytes, NULL for erased bytes (gaps of the room and mop tables)
+ * @param length: Number of bytes
+ */
+static void Provision_Output(const uint8_t *data, uint32_t length)
+{
+  uint32_t chunk_length = 0UL;
+
+  while (length > 0)
+  {
+    chunk_length = MIN(length, FLASH_PAGE_SIZE - provision_page_length);
+
+    if (data != NULL)
+    {
+      memcpy(&provision_page[provision_page_length], data, chunk_length);
+      data += chunk_length;
+    }
+    else
+    {
+      memset(&provision_page[provision_page_length], 0xFF, chunk_length);
+    }
+
+    provision_page_length += chunk_length;
+    provision_output_length += chunk_length;
+    length -= chunk_length;
+
+    if (provision_page_length == FLASH_PAGE_SIZE)
+    {
+      flash_write(GPIO_PIN_FLASH_CS2, provision_output_address + provision_output_length - provision_page_length, provision_page, provision_page_length);
+      provision_output_crc = crc32_ieee_update(provision_output_crc, provision_page, provision_page_length);
+      provision_page_length = 0;
+    }
+  }
+}
+
+static void Provision_FlushOutput(void)
+{
+  if (provision_page_length > 0)
+  {
+    flash_write(GPIO_PIN_FLASH_CS2, provision_output_address + provision_output_length - provision_page_length, provision_page, provision_page_length);
+    provision_output_crc = crc32_ieee_update(provision_output_crc, provision_page, provision_page_length);
+    provision_page_length = 0;
+  }
+}
+
+/**
+ * @brief This function sorts the records in RAM and writes them as one sorted run into the staging area
+ * @return uint8_t: PROVISION_OK or PROVISION_ERROR_SIZE if all runs are used or the staging area is full
+ */
+static uint8_t Provision_FlushBatch(void)
+{
+  uint16_t record_length = EPC_database_tables[provision_table].record_length;
+  PROVISION_RUN *run = NULL;
+
+  if (provision_batch_length == 0)
+  {
+    return PROVISION_OK;
+  }
+
+  if ((provision_run_count >= PROVISION_MAX_RUNS) || ((provision_staging_length + provision_batch_length) > PROVISION_STAGING_REGION_LENGTH))
+  {
+    return PROVISION_ERROR_SIZE;
+  }
+
+  run = &provision_runs[provision_run_count];
+
+  qsort(provision_batch, provision_batch_length / record_length, record_length, provision_compare);
+
+  run->address = PROVISION_STAGING_REGION + provision_staging_length;
+  run->remaining = provision_batch_length / record_length;
+  flash_write(GPIO_PIN_FLASH_CS2, run->address, provision_batch, provision_batch_length);
+
+  provision_staging_length += provision_batch_length;
+  provision_run_count++;
+  provision_batch_length = 0;
+
+  return PROVISION_OK;
+}
+
+/**
+ * @brief This function merges the sorted runs of the staging area into the table of the updated bank. Rfid records are written
+ * sorted by epc, room and mop records at the index of their id with erased gaps (like EPC_Database_WriteIdTable()).
+ *
+ * @param count: Pointer to the number of records (rfid) or record slots (room, mop) of the written table
+ * @return uint8_t: PROVISION_OK or the reason why the table is rejected
+ */
+static uint8_t Provision_MergeRuns(int32_t *count)
+{
+  const EPC_TABLE_DESCRIPTOR *descriptor = &EPC_database_tables[provision_table];
+  uint8_t previous[RFID_RECORD_BYTE_LENGTH];
+  PROVISION_RUN *run = NULL;
+  uint32_t record_address = 0UL;
+  uint16_t id = 0;
+  uint8_t i = 0;
+  int16_t smallest = -1;
+  bool first = true;
+
+  provision_output_address = EPC_Database_GetTargetAddress(provision_table);
+  provision_output_length = 0UL;
+  provision_output_crc = 0UL;
+  provision_page_length = 0;
+
+  for (i = 0; i < provision_run_count; i++)
+  {
+    flash_read(GPIO_PIN_FLASH_CS2, provision_runs[i].address, provision_runs[i].record, descriptor->record_length);
+  }
+
+  while (true)
+  {
+    /* The smallest head of all runs is the next record of the table */
+    smallest = -1;
+    for (i = 0; i < provision_run_count; i++)
+    {
+      if ((provision_runs[i].remaining > 0) && ((smallest < 0) || (provision_compare(provision_runs[i].record, provision_runs[smallest].record) < 0)))
+      {
+        smallest = i;
+      }
+    }
+
+    if (smallest < 0)
+    {
+      break;
+    }
+
+    run = &provision_runs[smallest];
+
+    if ((first == false) && (provision_compare(previous, run->record) == 0))
+    {
+      return PROVISION_ERROR_DUPLICATE;
+    }
+    memcpy(previous, run->record, descriptor->record_length);
+    first = false;
+
+    if (provision_table != EPC_TABLE_RFID)
+    {
+      memcpy(&id, run->record, sizeof(id));
+      record_address = id * descriptor->record_length;
+
+      if ((record_address + descriptor->record_length) > descriptor->region_length)
+      {
+        return PROVISION_ERROR_SIZE;
+      }
+
+      Provision_Output(NULL, record_address - provision_output_length);
+    }
+
+    Provision_Output(run->record, descriptor->record_length);
+
+    run->remaining--;
+    run->address += descriptor->record_length;
+    if (run->remaining > 0)
+    {
+      flash_read(GPIO_PIN_FLASH_CS2, run->address, run->record, descriptor->record_length);
+    }
+  }
+
+  Provision_FlushOutput();
+  *count = provision_output_length / descriptor->record_length;
+
+  return PROVISION_OK;
+}
+
+static uint8_t Provision_HandleStart(const uint8_t *payload, uint16_t length)
+{
+  const EPC_TABLE_DESCRIPTOR *descriptor = NULL;
+  uint32_t offset = 0UL;
+  uint32_t count = 0UL;
+
+  if ((length != 5) || (payload[0] >= EPC_TABLE_COUNT))
+  {
+    return PROVISION_ERROR_FRAME;
+  }
+
+  if ((provision_table >= 0) || ((provision_tables_done & BIT(payload[0])) != 0))
+  {
+    return PROVISION_ERROR_STATE;
+  }
+
+  descriptor = &EPC_database_tables[payload[0]];
+  memcpy(&count, &payload[1], sizeof(count));
+
+  /* Divided, a count multiplied with the record length can wrap */
+  if ((count > (MIN(descriptor->region_length + 1, PROVISION_STAGING_REGION_LENGTH) / descriptor->record_length)) ||
+      ((payload[0] == EPC_TABLE_RFID) && (count > RFID_RECORD_MAX_COUNT)))
+  {
+    return PROVISION_ERROR_SIZE;
+  }
+
+  /* The inactive bank is erased once per session, the tables of the session are activated together */
+  if (provision_update_started == false)
+  {
+    EPC_Database_BeginUpdate(GPIO_PIN_FLASH_CS2);
+    provision_update_started = true;
+  }
+
+  for (offset = 0UL; offset < (count * descriptor->record_length); offset += FLASH_SECTOR_SIZE)
+  {
+    flash_EraseSector_64kB(GPIO_PIN_FLASH_CS2, PROVISION_STAGING_REGION + offset);
+  }
+
+  provision_table = payload[0];
+  provision_compare = (provision_table == EPC_TABLE_RFID) ? EPC_Database_CompareRfidRecord : EPC_Database_CompareId;
+  provision_record_count = count;
+  provision_records_received = 0;
+  provision_stream_crc = 0UL;
+  provision_batch_length = 0;
+  provision_staging_length = 0;
+  provision_run_count = 0;
+
+  return PROVISION_OK;
+}
+
+static uint8_t Provision_HandleData(const uint8_t *payload, uint16_t length)
+{
+  uint16_t record_length = 0;
+  uint32_t chunk_length = 0UL;
+
+  if (provision_table < 0)
+  {
+    return PROVISION_ERROR_STATE;
+  }
+
+  record_length = EPC_database_tables[provision_table].record_length;
+
+  if ((length % record_length) != 0)
+  {
+    return PROVISION_ERROR_FRAME;
+  }
+
+  if ((provision_records_received + (length / record_length)) > provision_record_count)
+  {
+    return PROVISION_ERROR_SIZE;
+  }
+
+  provision_records_received += length / record_length;
+  provision_stream_crc = crc32_ieee_update(provision_stream_crc, payload, length);
+
+  while (length > 0)
+  {
+    chunk_length = MIN(length, PROVISION_BATCH_SIZE - provision_batch_length);
+    memcpy(&provision_batch[provision_batch_length], payload, chunk_length);
+    provision_batch_length += chunk_length;
+    payload += chunk_length;
+    length -= chunk_length;
+
+    if ((provision_batch_length == PROVISION_BATCH_SIZE) && (Provision_FlushBatch() != PROVISION_OK))
+    {
+      return PROVISION_ERROR_SIZE;
+    }
+  }
+
+  return PROVISION_OK;
+}
+
+static uint8_t Provision_HandleEnd(const uint8_t *payload, uint16_t length)
+{
+  uint32_t crc = 0UL;
+  int32_t count = 0;
+  uint8_t status = PROVISION_OK;
+
+  if (provision_table < 0)
+  {
+    return PROVISION_ERROR_STATE;
+  }
+
+  if (length != sizeof(crc))
+  {
+    return PROVISION_ERROR_FRAME;
+  }
+
+  memcpy(&crc, payload, sizeof(crc));
+
+  if ((crc != provision_stream_crc) || (provision_records_received != provision_record_count))
+  {
+    return PROVISION_ERROR_TABLE_CRC;
+  }
+
+  status = Provision_FlushBatch();
+  if (status == PROVISION_OK)
+  {
+    status = Provision_MergeRuns(&count);
+  }
+  if (status != PROVISION_OK)
+  {
+    return status;
+  }
+
+  if (EPC_Database_FinishTable(GPIO_PIN_FLASH_CS2, provision_table, count, provision_output_crc) != 0)
+  {
+    return PROVISION_ERROR_FLASH;
+  }
+
+  if (Parameter.debug == true || Parameter.epc_verbose == true)
+  {
+    rtc_print_debug_timestamp();
+    shell_fprintf(provision_shell, SHELL_VT100_COLOR_DEFAULT, "Provisioned %s table: %d records in %d runs\n", EPC_database_tables[provision_table].name, provision_record_count, provision_run_count);
+  }
+
+  provision_tables_done |= BIT(provision_table);
+  provision_table = -1;
+
+  return PROVISION_OK;
+}
+
+static uint8_t Provision_HandleCommit(const uint8_t *payload, uint16_t length)
+{
+  if ((provision_table >= 0) || (provision_update_started == false))
+  {
+    return PROVISION_ERROR_STATE;
+  }
+
+  if (length > EPC_DATABASE_UUID_LENGTH)
+  {
+    return PROVISION_ERROR_FRAME;
+  }
+
+  if (EPC_Database_CommitUpdate(GPIO_PIN_FLASH_CS2, payload, length) != 0)
+  {
+    return PROVISION_ERROR_FLASH;
+  }
+
+  return PROVISION_OK;
+}
+
+/**
+ * @brief This function checks a complete frame and its sequence number and executes it
+ */
+static void Provision_ProcessFrame(void)
+{
+  uint32_t crc = 0UL;
+  uint32_t frame_crc = 0UL;
+  uint16_t sequence = 0;
+  uint8_t type = provision_header[0];
+  uint8_t status = PROVISION_OK;
+
+  crc = crc32_ieee(provision_header, PROVISION_HEADER_LENGTH);
+  crc = crc32_ieee_update(crc, provision_payload, provision_payload_length);
+  memcpy(&frame_crc, provision_frame_crc, sizeof(frame_crc));
+
+  if (crc != frame_crc)
+  {
+    Provision_RequestRetransmission(PROVISION_ERROR_CRC);
+    return;
+  }
+
+  memcpy(&sequence, &provision_header[1], sizeof(sequence));
+
+  /* Frame was received already, its ACK got lost */
+  if ((int16_t)(sequence - provision_expected_sequence) < 0)
+  {
+    Provision_SendResponse(PROVISION_FRAME_ACK, PROVISION_OK);
+    return;
+  }
+
+  if (sequence != provision_expected_sequence)
+  {
+    Provision_RequestRetransmission(PROVISION_ERROR_SEQUENCE);
+    return;
+  }
+
+  provision_nak_sent = false;
+
+  switch (type)
+  {
+  case PROVISION_FRAME_START:
+    status = Provision_HandleStart(provision_payload, provision_payload_length);
+    break;
+
+  case PROVISION_FRAME_DATA:
+    status = Provision_HandleData(provision_payload, provision_payload_length);
+    break;
+
+  case PROVISION_FRAME_END:
+    status = Provision_HandleEnd(provision_payload, provision_payload_length);
+    break;
+
+  case PROVISION_FRAME_COMMIT:
+    status = Provision_HandleCommit(provision_payload, provision_payload_length);
+    break;
+
+  case PROVISION_FRAME_ABORT:
+    break;
+
+  default:
+    status = PROVISION_ERROR_FRAME;
+    break;
+  }
+
+  if (status != PROVISION_OK)
+  {
+    Provision_SendResponse(PROVISION_FRAME_NAK, status);
+    Provision_Stop("frame rejected");
+    return;
+  }
+
+  provision_expected_sequence++;
+  Provision_SendResponse(PROVISION_FRAME_ACK, PROVISION_OK);
+
+  if (type == PROVISION_FRAME_COMMIT)
+  {
+    Provision_Stop("databases updated");
+  }
+  else if (type == PROVISION_FRAME_ABORT)
+  {
+    Provision_Stop("aborted");
+  }
+}
+
+/**
+ * @brief This function receives all bytes of the shell uart while the provisioning mode is active (shell bypass)
+ */
+static void Provision_Receive(const struct shell *shell, uint8_t *data, size_t length)
+{
+  size_t i = 0;
+
+  k_mutex_lock(&provision_mutex, K_FOREVER);
+
+  provision_last_activity = k_uptime_get();
+
+  for (i = 0; (i < length) && (provision_active == true); i++)
+  {
+    switch (provision_parser_state)
+    {
+    case PROVISION_PARSER_SYNC_1:
+      if (data[i] == PROVISION_SYNC_1)
+      {
+        provision_parser_state = PROVISION_PARSER_SYNC_2;
+      }
+      break;
+
+    case PROVISION_PARSER_SYNC_2:
+      if (data[i] == PROVISION_SYNC_2)
+      {
+        provision_parser_state = PROVISION_PARSER_HEADER;
+        provision_position = 0;
+      }
+      else if (data[i] != PROVISION_SYNC_1)
+      {
+        provision_parser_state = PROVISION_PARSER_SYNC_1;
+      }
+      break;
+
+    case PROVISION_PARSER_HEADER:
+      provision_header[provision_position++] = data[i];
+
+      if (provision_position == PROVISION_HEADER_LENGTH)
+      {
+        provision_payload_length = provision_header[3] | (provision_header[4] << 8);
+        provision_position = 0;
+
+        if (provision_payload_length > PROVISION_MAX_PAYLOAD)
+        {
+          /* Corrupted length, search the next frame */
+          Provision_RequestRetransmission(PROVISION_ERROR_CRC);
+          provision_parser_state = PROVISION_PARSER_SYNC_1;
+        }
+        else
+        {
+          provision_parser_state = (provision_payload_length > 0) ? PROVISION_PARSER_PAYLOAD : PROVISION_PARSER_CRC;
+        }
+      }
+      break;
+
+    case PROVISION_PARSER_PAYLOAD:
+      provision_payload[provision_position++] = data[i];
+
+      if (provision_position == provision_payload_length)
+      {
+        provision_position = 0;
+        provision_parser_state = PROVISION_PARSER_CRC;
+      }
+      break;
+
+    case PROVISION_PARSER_CRC:
+      provision_frame_crc[provision_position++] = data[i];
+
+      if (provision_position == sizeof(provision_frame_crc))
+      {
+        provision_parser_state = PROVISION_PARSER_SYNC_1;
+        Provision_ProcessFrame();
+      }
+      break;
+    }
+  }
+
+  /* END and COMMIT may take seconds, the host waits for their ACK */
+  provision_last_activity = k_uptime_get();
+
+  k_mutex_unlock(&provision_mutex);
+}
+
+/**
+ * @brief This function leaves the provisioning mode, the shell takes over the uart again
+ */
+static void Provision_Stop(const char *reason)
+{
+  k_timer_stop(&provision_timer);
+  shell_set_bypass(provision_shell, NULL);
+  provision_active = false;
+
+  rtc_print_debug_timestamp();
+  shell_fprintf(provision_shell, SHELL_VT100_COLOR_DEFAULT, "Provisioning mode left: %s\n", reason);
+}
+
+/**
+ * @brief This function enters the provisioning mode. All following bytes of the shell uart are frames of the binary protocol
+ * (see provisioning.h) until COMMIT, ABORT or PROVISION_TIMEOUT without a frame.
+ *
+ * @param shell: Shell which received the command
+ */
+void Provision_Start(const struct shell *shell)
+{
+  k_mutex_lock(&provision_mutex, K_FOREVER);
+
+  provision_shell = shell;
+  provision_parser_state = PROVISION_PARSER_SYNC_1;
+  provision_expected_sequence = 0;
+  provision_nak_sent = false;
+  provision_update_started = false;
+  provision_tables_done = 0;
+  provision_table = -1;
+  provision_last_activity = k_uptime_get();
+  provision_active = true;
+
+  shell_set_bypass(shell, Provision_Receive);
+  k_timer_start(&provision_timer, K_SECONDS(1), K_SECONDS(1));
+
+  k_mutex_unlock(&provision_mutex);
+}
+
+/**
+ * @brief This function returns true while the databases are loaded over the shell uart
+ */
+bool Provision_IsActive(void)
+{
+  return provision_active;
+}
+
+/**@}*/
@@ -15,6 +15,7 @@
 K_THREAD_STACK_DEFINE(notification_stack_area, STACKSIZE_SMALL);
 K_THREAD_STACK_DEFINE(imu_stack_area, STACKSIZE_LARGE);
 K_THREAD_STACK_DEFINE(rfid_stack_area, STACKSIZE_LARGE);
+K_THREAD_STACK_DEFINE(rfid_rx_stack_area, STACKSIZE_LARGE);
 K_THREAD_STACK_DEFINE(epc_stack_area, STACKSIZE_LARGE);
 K_THREAD_STACK_DEFINE(datalog_stack_area, STACKSIZE_LARGE);
 K_THREAD_STACK_DEFINE(battery_area, STACKSIZE_SMALL);
@@ -27,10 +28,12 @@ K_THREAD_STACK_DEFINE(autosave_area, STACKSIZE_SMALL);
 K_THREAD_STACK_DEFINE(safety_area, STACKSIZE_SMALL);
 K_THREAD_STACK_DEFINE(magnet_detection_area, STACKSIZE_SMALL);
 K_THREAD_STACK_DEFINE(seconds_loop_area, STACKSIZE_LARGE);
+K_THREAD_STACK_DEFINE(flash_service_area, STACKSIZE_LARGE);
 
 static struct k_thread notification_data;
 static struct k_thread imu_data;
 static struct k_thread rfid_data;
+static struct k_thread rfid_rx_data;
 static struct k_thread epc_data;
 static struct k_thread datalog_data;
 static struct k_thread battery_data;
@@ -43,6 +46,7 @@ static struct k_thread safety_data;
 static struct k_thread magnet_detection_data;
 static struct k_thread seconds_loop_data;
 static struct k_thread button_data;
+static struct k_thread flash_service_data;
 
 k_tid_t tid;
 
@@ -175,6 +179,37 @@ void notification_thread(void *dummy1, void *dummy2, void *dummy3)
   }
 }
 
+/*!
+ *  @brief Runs the algorithm for one imu interval with the values in accel, gyro and bmm150.data
+ */
+static void imu_process_interval(void)
+{
+  if (datalog_ReadOutisActive == false)
+  {
+    algo_benchmark_Execute(); // process main algorithm designed bei Dr. Theofanis Lambrou (check if device is moving, mopping; turn on of/rfid reader, etc..)
+
+    if (step_interrupt_triggered)
+    {
+      if (Parameter.stepdetection_verbose || Parameter.debug)
+      {
+        rtc_print_debug_timestamp();
+        shell_print(shell_backend_uart_get_ptr(), "Step detected. Total step count: %d, step sequence count: %d", System.TotalSteps, System.Steps);
+      }
+      step_interrupt_triggered = false;
+    }
+
+    if (trace_imu_flag)
+    {
+      trace_imu();
+    }
+
+    if (trace_imu_reduced_flag)
+    {
+      trace_imu_reduced();
+    }
+  }
+}
+
 static void imu_thread(void *dummy1, void *dummy2, void *dummy3)
 {
   ARG_UNUSED(dummy1);
@@ -183,32 +218,21 @@ static void imu_thread(void *dummy1, void *dummy2, void *dummy3)
 
   while (1)
   {
-    if (datalog_ReadOutisActive == false)
+    if (imu_IsInitialized)
     {
-      imu_fetch_data();            // fetch data from IMU (new samples from  accelerometer, gyrometer and magnetometer)
-      algorithm_execute_process(); // process main algorithm designed bei Dr. Theofanis Lambrou (check if device is moving, mopping; turn on of/rfid reader, etc..)
+      k_sem_take(&imu_fifo_sem, K_MSEC(IMU_FIFO_TIMEOUT_MS)); // woken up by the fifo watermark (or any motion) interrupt on INT2
+      imu_fetch_data();                                       // read all new samples from the fifo into the sample queue
 
-      if (step_interrupt_triggered)
+      while (imu_get_next_interval() == true)
       {
-        if (Parameter.stepdetection_verbose || Parameter.debug)
-        {
-          rtc_print_debug_timestamp();
-          shell_print(shell_backend_uart_get_ptr(), "Step detected. Total step count: %d, step sequence count: %d", System.TotalSteps, System.Steps);
-        }
-        step_interrupt_triggered = false;
-      }
-
-      if (trace_imu_flag)
-      {
-        trace_imu();
-      }
-
-      if (trace_imu_reduced_flag)
-      {
-        trace_imu_reduced();
+        imu_process_interval();
       }
     }
-    k_msleep(Parameter.imu_interval);
+    else
+    {
+      imu_process_interval();
+      k_msleep(Parameter.imu_interval);
+    }
   }
 }
 
@@ -228,7 +252,6 @@ void rfid_thread(void *dummy1, void *dummy2, void *dummy3)
         if (RFID_ScanEnable == true)
         {
           rfid_trigger_multi_read();
-          epc_extract_tags_from_buffer();
         }
       }
     }
@@ -245,6 +268,20 @@ void rfid_thread(void *dummy1, void *dummy2, void *dummy3)
   }
 }
 
+void rfid_rx_thread(void *dummy1, void *dummy2, void *dummy3)
+{
+  ARG_UNUSED(dummy1);
+  ARG_UNUSED(dummy2);
+  ARG_UNUSED(dummy3);
+
+  while (1)
+  {
+    /* Woken up by the uart callback for every received chunk, parses tags and command responses */
+    k_sem_take(&uart1_rx_sem, K_FOREVER);
+    rfid_ProcessReceivedData();
+  }
+}
+
 void epc_thread(void *dummy1, void *dummy2, void *dummy3)
 {
   ARG_UNUSED(dummy1);
@@ -253,13 +290,15 @@ void epc_thread(void *dummy1, void *dummy2, void *dummy3)
 
   while (1)
   {
-    /* Check new tags if the are listed in epc database and check if it is a mop, tag or room tag */
-    if ((event_clearing_in_progress == false) && (pcb_test_is_running == false) && ((System.charger_connected == false) || (Parameter.notifications_while_usb_connected == true)))
+    /* Sleep until the RFID response parser has stored new tags */
+    k_sem_take(&epc_new_tags_sem, K_FOREVER);
+
+    /* Check new tags if the are listed in epc database and check if it is a mop, tag or room tag. All tags of the multi read cycle
+       are processed as one batch, tags which are not processed now stay in the ring buffer until the next cycle */
+    while ((epc_tags_pending() == true) && (event_clearing_in_progress == false) && (pcb_test_is_running == false) && ((System.charger_connected == false) || (Parameter.notifications_while_usb_connected == true)))
     {
       epc_process_tags();
     }
-
-    k_msleep(1);
   }
 }
 
@@ -577,10 +616,28 @@ void datalog_readout_thread(void *dummy1, void *dummy2, void *dummy3)
     {
       datalog_GetData();
     }
+
+    if (datalog_ExportActive == true)
+    {
+      datalog_Export();
+    }
     k_msleep(1);
   }
 }
 
+void flash_service_thread(void *dummy1, void *dummy2, void *dummy3)
+{
+  ARG_UNUSED(dummy1);
+  ARG_UNUSED(dummy2);
+  ARG_UNUSED(dummy3);
+
+  while (1)
+  {
+    /* Execute queued flash requests (blocks until a request is available) */
+    flash_ProcessRequests();
+  }
+}
+
 void autosave_thread(void *dummy1, void *dummy2, void *dummy3)
 {
   ARG_UNUSED(dummy1);
@@ -615,6 +672,9 @@ void init_threads(void)
   tid = k_thread_create(&rfid_data, rfid_stack_area, STACKSIZE_LARGE, rfid_thread, NULL, NULL, NULL, K_PRIO_PREEMPT(0), 0, K_NO_WAIT);
   k_thread_name_set(tid, "rfid-thread");
 
+  tid = k_thread_create(&rfid_rx_data, rfid_rx_stack_area, STACKSIZE_LARGE, rfid_rx_thread, NULL, NULL, NULL, K_PRIO_PREEMPT(0), 0, K_NO_WAIT);
+  k_thread_name_set(tid, "rfid-rx-thread");
+
   tid = k_thread_create(&epc_data, epc_stack_area, STACKSIZE_LARGE, epc_thread, NULL, NULL, NULL, K_PRIO_PREEMPT(0), 0, K_NO_WAIT);
   k_thread_name_set(tid, "epc-thread-thread");
 
@@ -650,4 +710,8 @@ void init_threads(void)
 
   tid = k_thread_create(&button_data, button_area, STACKSIZE_SMALL, button_thread, NULL, NULL, NULL, K_PRIO_PREEMPT(3), 0, K_NO_WAIT);
   k_thread_name_set(tid, "button-thread");
+
+  /* Runs below the epc thread, so tag lookups get the flash bus before queued bulk writes */
+  tid = k_thread_create(&flash_service_data, flash_service_area, STACKSIZE_LARGE, flash_service_thread, NULL, NULL, NULL, K_PRIO_PREEMPT(2), 0, K_NO_WAIT);
+  k_thread_name_set(tid, "flash-service-thread");
 }
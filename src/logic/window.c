@@ -0,0 +1,197 @@
+/**
+ * @file window.c
+ * @author Thomas Keilbach | keiltronic GmbH
+ * @date 17 Oct 2026
+ * @brief This file contains the sliding window type which is used by the algorithm to keep the history of a signal
+ * @version 1.0.0
+ */
+
+/*!
+ * @defgroup Algorithms
+ * @brief This file contains the sliding window type which is used by the algorithm to keep the history of a signal
+ * @{*/
+#include "window.h"
+
+/*!
+ * @brief Removes the entries which dropped out of the window from the front of a deque
+ */
+static void window_DequeExpire(WINDOW_DEQUE *deque, uint32_t sequence, uint16_t length)
+{
+  while ((deque->count > 0) && ((deque->sequence[deque->first] + length) <= sequence))
+  {
+    deque->first = (deque->first + 1) % WINDOW_MAX_LENGTH;
+    deque->count--;
+  }
+}
+
+/*!
+ * @brief Appends a sample at the back of a deque after removing all entries it dominates. For the minimum deque these are
+ * all entries which are greater or equal than the sample, for the maximum deque all entries which are lower or equal.
+ */
+static void window_DequePush(WINDOW_DEQUE *deque, float sample, uint32_t sequence, bool minimum)
+{
+  uint16_t back = 0;
+
+  while (deque->count > 0)
+  {
+    back = (deque->first + deque->count - 1) % WINDOW_MAX_LENGTH;
+
+    if (((minimum == true) && (deque->value[back] >= sample)) || ((minimum == false) && (deque->value[back] <= sample)))
+    {
+      deque->count--;
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  back = (deque->first + deque->count) % WINDOW_MAX_LENGTH;
+  deque->value[back] = sample;
+  deque->sequence[back] = sequence;
+  deque->count++;
+}
+
+/*!
+ * @brief Initializes a window. The window is filled with the initial value, so the statistics are valid from the first sample on
+ * @param[in] window: Pointer to the window
+ * @param[in] length: Window length in samples (1 to WINDOW_MAX_LENGTH)
+ * @param[in] initial_value: Value of all samples after init
+ * @param[in] track_extrema: true if window_Min and window_Max are used
+ */
+void window_Init(WINDOW *window, uint16_t length, float initial_value, bool track_extrema)
+{
+  uint16_t i = 0;
+
+  if (length == 0)
+  {
+    length = 1;
+  }
+
+  if (length > WINDOW_MAX_LENGTH)
+  {
+    length = WINDOW_MAX_LENGTH;
+  }
+
+  memset(window, 0, sizeof(WINDOW));
+  window->length = length;
+  window->track_extrema = track_extrema;
+
+  for (i = 0; i < length; i++)
+  {
+    window_Add(window, initial_value);
+  }
+}
+
+/*!
+ * @brief Adds a sample to the window, the oldest sample drops out
+ * @param[in] window: Pointer to the window
+ * @param[in] sample: Value to be added
+ */
+void window_Add(WINDOW *window, float sample)
+{
+  uint16_t i = 0;
+  float oldest = window->samples[window->head];
+
+  window->sum += sample - oldest;
+  window->sum_squares += (sample * sample) - (oldest * oldest);
+  window->samples[window->head] = sample;
+  window->head++;
+
+  /* Recalculate the running sums once per window length, so rounding errors do not accumulate */
+  if (window->head >= window->length)
+  {
+    window->head = 0;
+    window->sum = 0.0f;
+    window->sum_squares = 0.0f;
+
+    for (i = 0; i < window->length; i++)
+    {
+      window->sum += window->samples[i];
+      window->sum_squares += window->samples[i] * window->samples[i];
+    }
+  }
+
+  if (window->track_extrema == true)
+  {
+    window_DequeExpire(&window->min, window->sequence, window->length);
+    window_DequeExpire(&window->max, window->sequence, window->length);
+    window_DequePush(&window->min, sample, window->sequence, true);
+    window_DequePush(&window->max, sample, window->sequence, false);
+  }
+
+  window->sequence++;
+}
+
+/*!
+ * @brief Returns a sample of the window
+ * @param[in] window: Pointer to the window
+ * @param[in] age: 0 for the newest sample, 1 for the sample before, ... up to length - 1
+ * @return Value of the sample
+ */
+float window_Get(const WINDOW *window, uint16_t age)
+{
+  if (age >= window->length)
+  {
+    age = window->length - 1;
+  }
+
+  return window->samples[(window->head + window->length - 1 - age) % window->length];
+}
+
+/*!
+ * @brief Returns the sum of all samples in the window
+ */
+float window_Sum(const WINDOW *window)
+{
+  return window->sum;
+}
+
+/*!
+ * @brief Returns the mean of all samples in the window
+ */
+float window_Mean(const WINDOW *window)
+{
+  return window->sum / (float)window->length;
+}
+
+/*!
+ * @brief Returns the (population) variance of all samples in the window
+ */
+float window_Variance(const WINDOW *window)
+{
+  float mean = window->sum / (float)window->length;
+  float variance = (window->sum_squares / (float)window->length) - (mean * mean);
+
+  /* Can get slightly negative by rounding if all samples are equal */
+  if (variance < 0.0f)
+  {
+    variance = 0.0f;
+  }
+
+  return variance;
+}
+
+/*!
+ * @brief Returns the (population) standard deviation of all samples in the window
+ */
+float window_StandardDeviation(const WINDOW *window)
+{
+  return sqrtf(window_Variance(window));
+}
+
+/*!
+ * @brief Returns the minimum of all samples in the window. Only valid if the window was initialized with track_extrema
+ */
+float window_Min(const WINDOW *window)
+{
+  return window->min.value[window->min.first];
+}
+
+/*!
+ * @brief Returns the maximum of all samples in the window. Only valid if the window was initialized with track_extrema
+ */
+float window_Max(const WINDOW *window)
+{
+  return window->max.value[window->max.first];
+}
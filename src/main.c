@@ -156,30 +156,21 @@ void ValidateParameterInExernalFlash(void)
 		shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Checking last valid frame number in log memory (stored in external flash memory): ");
 	}
 
-	System.datalogFrameNumber = flash_GetLastFrameNumber(GPIO_PIN_FLASH_CS1, FLASH_SUBSUBSECTOR_SIZE, DATALOG_MEM, DATALOG_MEM_LENGTH, DATALOG_FRAME_LENGTH);
+	System.datalogFrameNumber = datalog_GetLastFrameNumber(GPIO_PIN_FLASH_CS1);
 	if (pcb_test_is_running == false)
 	{
 		shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "%d\n", System.datalogFrameNumber);
 	}
 
-	/* Check for EPCs in external flash */
-	EPC_last_rfid_record_index = EPC_Memory_GetLastIndex(GPIO_PIN_FLASH_CS2, RFID_RECORD_REGION, RFID_RECORD_REGION_LENGTH, RFID_RECORD_BYTE_LENGTH);
+	/* Select the active database bank, count the EPCs in external flash and build the RAM index which is used to look up rfid records
+	 * without searching the external flash */
+	EPC_Database_Init(GPIO_PIN_FLASH_CS2);
 	if (pcb_test_is_running == false)
 	{
 		rtc_print_debug_timestamp();
 		shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Stored rfid records: %d\n", EPC_last_rfid_record_index);
-	}
-
-	EPC_last_room_record_index = EPC_Memory_GetLastIndex(GPIO_PIN_FLASH_CS2, ROOM_RECORD_REGION, ROOM_RECORD_REGION_LENGTH, ROOM_RECORD_BYTE_LENGTH);
-	if (pcb_test_is_running == false)
-	{
 		rtc_print_debug_timestamp();
 		shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Stored room records: %d\n", EPC_last_room_record_index);
-	}
-
-	EPC_last_mop_record_index = EPC_Memory_GetLastIndex(GPIO_PIN_FLASH_CS2, MOP_RECORD_REGION, MOP_RECORD_REGION_LENGTH, MOP_RECORD_BYTE_LENGTH);
-	if (pcb_test_is_running == false)
-	{
 		rtc_print_debug_timestamp();
 		shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Stored mop records: %d\n", EPC_last_mop_record_index);
 	}
@@ -390,6 +381,9 @@ void main(void)
 		shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "ERROR: boot_write_img not confirmed err %d\n", err);
 	}
 
+	/* Queue the unsent events from the journal in the external flash again, before the threads can add, send or store events */
+	Event_JournalRecover();
+
 	/* Threads takeover the system handling, main (main thread) is destroyed after the end of this function is reached */
 	init_threads();
 
@@ -437,11 +431,6 @@ void main(void)
 		notification_set_priority(NOTIFICATION_PRIORITY_LEVEL_LOWEST);
 	}
 
-	/* Clean event storage region in external flash */
-	rtc_print_debug_timestamp();
-	shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Erasing stored events in flash memory\n");
-	Event_ClearCompleteFlash();
-
 	/* Set flag that boot sequence completed before main thread is terminated */
 	System.boot_complete = true;
 
@@ -17,6 +17,128 @@
 struct gpio_dt_spec chip_select_1 = GPIO_DT_SPEC_GET(DT_ALIAS(cs1), gpios);
 struct gpio_dt_spec chip_select_2 = GPIO_DT_SPEC_GET(DT_ALIAS(cs2), gpios);
 
+/* Known NOR flash parts. Capacities above 16MB need 4-byte addressing to be reachable completely. */
+static const FLASH_PART flash_known_parts[] = {
+    {.manufacturer_id = 0x20, .memory_type = 0xBA, .capacity_id = 0x18, .size = 0x1000000UL, .name = "Micron MT25QL128"},
+    {.manufacturer_id = 0x20, .memory_type = 0xBA, .capacity_id = 0x19, .size = 0x2000000UL, .name = "Micron MT25QL256"},
+    {.manufacturer_id = 0x20, .memory_type = 0xBA, .capacity_id = 0x20, .size = 0x4000000UL, .name = "Micron MT25QL512"},
+    {.manufacturer_id = 0x20, .memory_type = 0xBA, .capacity_id = 0x21, .size = 0x8000000UL, .name = "Micron MT25QL01G"},
+};
+
+/* Command set which is used until the part was identified. These legacy 3-byte commands are supported by every SPI NOR flash. */
+static const FLASH_COMMAND_SET flash_default_command_set = {
+    .part = NULL,
+    .address_bytes = 3,
+    .read_cmd = FLASH_READ_CMD,
+    .read_dummy_bytes = 0,
+    .program_cmd = FLASH_WRITE_CMD,
+    .erase_4kb_cmd = FLASH_SSE_4KB,
+    .erase_32kb_cmd = FLASH_SSE_32KB,
+    .erase_64kb_cmd = FLASH_SE_64KB,
+};
+
+static FLASH_COMMAND_SET flash_command_set_cs1;
+static FLASH_COMMAND_SET flash_command_set_cs2;
+
+/* Both flash parts share one SPI bus. Every transaction (chip select low until chip select high) is done while holding this
+ * mutex. The mutex is recursive and hands the bus over to the waiting thread with the highest priority, so a tag lookup of
+ * the epc thread gets the bus between two page programs of a bulk write.
+ */
+K_MUTEX_DEFINE(flash_bus_mutex);
+
+/* Queued requests which are executed by the flash service thread, high priority requests are always taken first. Latency critical
+ * reads (tag lookups) are not queued, they take the bus mutex directly.
+ */
+K_MSGQ_DEFINE(flash_request_queue_high, sizeof(FLASH_REQUEST), FLASH_REQUEST_QUEUE_SIZE, 4);
+K_MSGQ_DEFINE(flash_request_queue_normal, sizeof(FLASH_REQUEST), FLASH_REQUEST_QUEUE_SIZE, 4);
+K_SEM_DEFINE(flash_request_sem, 0, 2 * FLASH_REQUEST_QUEUE_SIZE);
+
+uint32_t flash_request_queue_overflows = 0UL;
+
+/*!
+ * @brief This function returns the command set of the flash connected to the given chip select pin.
+ * @param cs_pin: GPIO number of the cs pin
+ * @return FLASH_COMMAND_SET*: Pointer to the command set
+ */
+FLASH_COMMAND_SET *flash_GetCommandSet(uint8_t cs_pin)
+{
+  if (cs_pin == GPIO_PIN_FLASH_CS2)
+  {
+    return &flash_command_set_cs2;
+  }
+  return &flash_command_set_cs1;
+}
+
+/*!
+ * @brief This function reads the JEDEC manufacturer and device id of the flash.
+ * @param cs_pin: GPIO number of the cs pin
+ * @param id: Pointer to an array of at least 3 bytes (manufacturer id, memory type, capacity)
+ */
+void flash_ReadJedecId(uint8_t cs_pin, uint8_t *id)
+{
+  flash_read_register(cs_pin, FLASH_JEDEC, id, 3);
+}
+
+/*!
+ * @brief This function identifies the flash by its JEDEC id and selects the fastest read mode and the address width.
+ * @details The SPI bus to the flash uses a single data line, therefore dual and quad modes can not be used. The plain
+ * READ command runs without dummy cycles up to FLASH_READ_CMD_MAX_FREQUENCY. Above this frequency the FAST READ command
+ * with its dummy cycles is selected. Parts larger than 16MB are accessed with the dedicated 4-byte address commands, so the
+ * device does not have to be switched into the 4-byte address mode (which would get lost on a flash reset).
+ * @param cs_pin: GPIO number of the cs pin
+ * @return uint8_t: true if the part is known, otherwise false (the legacy 3-byte command set stays active)
+ */
+uint8_t flash_DetectDevice(uint8_t cs_pin)
+{
+  FLASH_COMMAND_SET *command_set = flash_GetCommandSet(cs_pin);
+  uint8_t id[3] = {0, 0, 0};
+  uint8_t i = 0;
+
+  *command_set = flash_default_command_set;
+
+  flash_ReadJedecId(cs_pin, id);
+
+  for (i = 0; i < ARRAY_SIZE(flash_known_parts); i++)
+  {
+    if ((flash_known_parts[i].manufacturer_id == id[0]) && (flash_known_parts[i].memory_type == id[1]) && (flash_known_parts[i].capacity_id == id[2]))
+    {
+      command_set->part = &flash_known_parts[i];
+      break;
+    }
+  }
+
+  if (command_set->part == NULL)
+  {
+    rtc_print_debug_timestamp();
+    shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Unknown flash at cs pin %d (JEDEC id: 0x%02X 0x%02X 0x%02X), using 3-byte addressing\n", cs_pin, id[0], id[1], id[2]);
+    return false;
+  }
+
+  if (command_set->part->size > FLASH_3BYTE_ADDRESS_LIMIT)
+  {
+    command_set->address_bytes = 4;
+    command_set->read_cmd = FLASH_READ4BYTE;
+    command_set->program_cmd = FLASH_PP4BYTE;
+    command_set->erase_4kb_cmd = FLASH_SSE_4KB_4BYTE;
+    command_set->erase_32kb_cmd = FLASH_SSE_32KB_4BYTE;
+    command_set->erase_64kb_cmd = FLASH_SE_64KB_4BYTE;
+  }
+
+  if (spi_cfg.frequency > FLASH_READ_CMD_MAX_FREQUENCY)
+  {
+    command_set->read_cmd = (command_set->address_bytes == 4) ? FLASH_FAST_READ4BYTE : FLASH_FAST_READ;
+    command_set->read_dummy_bytes = FLASH_FAST_READ_DUMMY_CYCLES / 8;
+  }
+
+  if (Parameter.debug == true || Parameter.flash_verbose == true)
+  {
+    rtc_print_debug_timestamp();
+    shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "Found %s at cs pin %d, %d-byte addressing, read cmd: 0x%02X, dummy bytes: %d\n", command_set->part->name, cs_pin, command_set->address_bytes, command_set->read_cmd, command_set->read_dummy_bytes);
+  }
+
+  return true;
+}
+
 void flash_init(void)
 {
   int16_t ret = 0;
@@ -37,10 +159,17 @@ void flash_init(void)
   if (ret < 0)
     printk("Could not configure cs2 pin!\n\r");
 
+  flash_command_set_cs1 = flash_default_command_set;
+  flash_command_set_cs2 = flash_default_command_set;
+
   /* dummy read*/
   uint8_t data = 0x00;
   flash_read(GPIO_PIN_FLASH_CS1, 0x00, &data, 1);
   flash_read(GPIO_PIN_FLASH_CS2, 0x00, &data, 1);
+
+  /* Identify both flash parts and select their command sets */
+  flash_DetectDevice(GPIO_PIN_FLASH_CS1);
+  flash_DetectDevice(GPIO_PIN_FLASH_CS2);
 }
 
 void flash_cs(uint8_t cs_pin, uint8_t state)
@@ -55,47 +184,66 @@ void flash_cs(uint8_t cs_pin, uint8_t state)
   }
 }
 
-uint8_t flash_access(const struct device *spi, struct spi_config *spi_cfg, uint8_t cmd, uint32_t addr, uint8_t *data, uint32_t len)
+/*!
+ * @brief This function executes one command at the flash. Which header is sent depends on the command:
+ * read commands send the address and the dummy bytes of the command set and receive the data, program commands
+ * send the address followed by the data, erase commands send only the address and all other commands consist of the
+ * op code only.
+ * @note The chip select pin has to be handled by the caller.
+ */
+uint8_t flash_access(const struct device *spi, struct spi_config *spi_cfg, const FLASH_COMMAND_SET *command_set, uint8_t cmd, uint32_t addr, uint8_t *data, uint32_t len)
 {
-  uint8_t access[4] = {0, 0, 0, 0};
+  uint8_t access[1 + 4 + FLASH_MAX_DUMMY_BYTES];
+  uint8_t header_length = 1;
+  uint8_t i = 0;
 
-  struct spi_buf bufs[] = {
-      {
-          .buf = access,
-      },
+  struct spi_buf tx_bufs[] = {
+      {.buf = access,
+       .len = 1},
       {.buf = data,
        .len = len}};
 
   struct spi_buf_set tx = {
-      .buffers = bufs};
+      .buffers = tx_bufs,
+      .count = 1};
 
+  memset(access, DUMMY_BYTE, sizeof(access));
   access[0] = cmd;
 
-  if (cmd == FLASH_WRITE_CMD || cmd == FLASH_READ_CMD)
+  if (cmd == command_set->read_cmd || cmd == command_set->program_cmd || cmd == command_set->erase_4kb_cmd || cmd == command_set->erase_32kb_cmd || cmd == command_set->erase_64kb_cmd)
   {
-    access[1] = (addr >> 16) & 0xFF;
-    access[2] = (addr >> 8) & 0xFF;
-    access[3] = addr & 0xFF;
-
-    bufs[0].len = sizeof(access);
-    tx.count = 2;
+    /* Address MSB first */
+    for (i = 0; i < command_set->address_bytes; i++)
+    {
+      access[header_length++] = (addr >> (8 * (command_set->address_bytes - 1 - i))) & 0xFF;
+    }
 
-    if (cmd == FLASH_READ_CMD)
+    if (cmd == command_set->read_cmd)
     {
+      /* Dummy cycles are clocked out as part of the header */
+      header_length += command_set->read_dummy_bytes;
+      tx_bufs[0].len = header_length;
+
+      /* Clock out command and address only, skip the bytes received meanwhile and receive the full data length in the same transaction */
+      struct spi_buf rx_bufs[] = {
+          {.buf = NULL,
+           .len = header_length},
+          {.buf = data,
+           .len = len}};
+
       struct spi_buf_set rx = {
-          .buffers = bufs,
+          .buffers = rx_bufs,
           .count = 2};
 
       return spi_transceive(spi, spi_cfg, &tx, &rx);
     }
-  }
-  else
-  {
-    tx.count = 1;
 
-    if (addr == 0UL && data == NULL && len == 0)
+    tx_bufs[0].len = header_length;
+
+    if (cmd == command_set->program_cmd)
     {
-      bufs[0].len = 1;
+      /* Page program: command, address and data in one transaction */
+      tx.count = 2;
     }
   }
 
@@ -127,102 +275,117 @@ uint8_t flash_access_register(const struct device *spi, struct spi_config *spi_c
   return spi_transceive(spi, spi_cfg, &tx, &rx);
 }
 
+/* Polls the status register until the program or erase cycle has finished. The bus is only locked for each single status
+ * read, so the other flash part stays accessible while this one is busy with a long erase.
+ */
 void flash_WaitWhileBusy(uint8_t cs_pin)
 {
-  uint8_t rslt = 1;
+  uint8_t rslt = 0;
+
+  flash_read_register(cs_pin, FLASH_RDSR1, &rslt, 1);
 
   while (rslt & FLASH_WIP_BIT_MASK)
   {
+    k_usleep(FLASH_BUSY_POLL_INTERVAL_US);
     flash_read_register(cs_pin, FLASH_RDSR1, &rslt, 1);
   }
 }
 
-void flash_WriteEnable_fast(uint8_t cs_pin)
+/*!
+ * @brief This function locks the SPI bus as soon as the flash is not busy anymore.
+ * @details The busy state is checked once more after the bus was locked, because another thread could have started a
+ * program or erase cycle at the same flash between polling and locking. The caller has to call flash_UnlockBus afterwards.
+ * @param cs_pin: GPIO number of the cs pin
+ */
+void flash_LockBusWhenReady(uint8_t cs_pin)
 {
-  // flash_WaitWhileBusy(cs_pin);
+  uint8_t rslt = 0;
 
-  flash_cs(cs_pin, 0);
-  flash_access(spi_dev, &spi_cfg, FLASH_WREN, 0, NULL, 0);
-  flash_cs(cs_pin, 1);
+  while (1)
+  {
+    flash_WaitWhileBusy(cs_pin);
+
+    k_mutex_lock(&flash_bus_mutex, K_FOREVER);
+
+    flash_read_register(cs_pin, FLASH_RDSR1, &rslt, 1);
+
+    if ((rslt & FLASH_WIP_BIT_MASK) == 0)
+    {
+      return;
+    }
+
+    k_mutex_unlock(&flash_bus_mutex);
+  }
 }
 
-void flash_WriteEnable(uint8_t cs_pin)
+void flash_UnlockBus(void)
 {
-  flash_WaitWhileBusy(cs_pin);
+  k_mutex_unlock(&flash_bus_mutex);
+}
 
+/* Sends the write enable command, the bus has to be locked by the caller */
+static void flash_SendWriteEnable(uint8_t cs_pin)
+{
   flash_cs(cs_pin, 0);
-  flash_access(spi_dev, &spi_cfg, FLASH_WREN, 0, NULL, 0);
+  flash_access(spi_dev, &spi_cfg, flash_GetCommandSet(cs_pin), FLASH_WREN, 0, NULL, 0);
   flash_cs(cs_pin, 1);
 }
 
+void flash_WriteEnable(uint8_t cs_pin)
+{
+  flash_LockBusWhenReady(cs_pin);
+  flash_SendWriteEnable(cs_pin);
+  flash_UnlockBus();
+}
+
 void flash_read_register(uint8_t cs_pin, uint32_t reg, uint8_t *data, uint32_t len)
 {
+  k_mutex_lock(&flash_bus_mutex, K_FOREVER);
+
   flash_cs(cs_pin, 0);
   flash_access_register(spi_dev, &spi_cfg, reg, data, len);
   flash_cs(cs_pin, 1);
+
+  k_mutex_unlock(&flash_bus_mutex);
 }
 
+/* Write enable and the command are sent without releasing the bus in between. Otherwise a command of another thread to the
+ * same flash could consume the write enable latch.
+ */
 uint8_t acces_write_reg(const uint8_t cs_pin, const struct device *spi, struct spi_config *spi_cfg, uint8_t reg, uint32_t addr)
 {
   int16_t res = 0;
 
-  flash_WriteEnable(cs_pin);
-  flash_WaitWhileBusy(cs_pin);
+  flash_LockBusWhenReady(cs_pin);
+  flash_SendWriteEnable(cs_pin);
 
   flash_cs(cs_pin, 0);
-
-  uint8_t access[4];
-  struct spi_buf bufs[] = {
-      {
-          .buf = access,
-      },
-      {.buf = NULL,
-       .len = 0}};
-
-  struct spi_buf_set tx = {
-      .buffers = bufs};
-
-  struct spi_buf_set rx = {
-      .buffers = bufs,
-      .count = 2};
-
-  access[0] = reg;
-  access[1] = (addr >> 16) & 0xFF;
-  access[2] = (addr >> 8) & 0xFF;
-  access[3] = addr & 0xFF;
-
-  tx.count = 1;
-  bufs[0].len = sizeof(access);
-
-  res = spi_transceive(spi, spi_cfg, &tx, &rx);
+  res = flash_access(spi, spi_cfg, flash_GetCommandSet(cs_pin), reg, addr, NULL, 0);
   flash_cs(cs_pin, 1);
 
+  flash_UnlockBus();
+
   return res;
 }
 
 void flash_EraseAll(const uint8_t cs_pin)
 {
-  flash_WriteEnable(cs_pin);
-  flash_WaitWhileBusy(cs_pin);
-
+  /* Bulk erase consists of the op code only (no address bytes), otherwise the command is ignored by the flash */
   acces_write_reg(cs_pin, spi_dev, &spi_cfg, FLASH_BE, 0);
 
-  System.datalogFrameNumber = 0UL;
+  datalog_ResetPosition();
   setaddress_flag = false;
 }
 
 void flash_EraseSector_4kB(const uint8_t cs_pin, const uint32_t addr)
 {
-  flash_WriteEnable(cs_pin);
-  flash_WaitWhileBusy(cs_pin);
-
   if (addr < DATALOG_MEM)
   {
     rtc_print_debug_timestamp();
     shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "####### WARNING: Erased 4kB sector, addr: %d ########################\n", addr);
   }
 
-  acces_write_reg(cs_pin, spi_dev, &spi_cfg, FLASH_SSE_4KB, addr);
+  acces_write_reg(cs_pin, spi_dev, &spi_cfg, flash_GetCommandSet(cs_pin)->erase_4kb_cmd, addr);
 
   if (Parameter.debug == true || Parameter.flash_verbose == true)
   {
@@ -233,16 +396,13 @@ void flash_EraseSector_4kB(const uint8_t cs_pin, const uint32_t addr)
 
 void flash_EraseSector_32kB(const uint8_t cs_pin, const uint32_t addr)
 {
-  flash_WriteEnable(cs_pin);
-  flash_WaitWhileBusy(cs_pin);
-
   if (addr < DATALOG_MEM)
   {
     rtc_print_debug_timestamp();
     shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "####### WARNING: Erased 32kB sector, addr: %d ########################\n", addr);
   }
 
-  acces_write_reg(cs_pin, spi_dev, &spi_cfg, FLASH_SSE_32KB, addr);
+  acces_write_reg(cs_pin, spi_dev, &spi_cfg, flash_GetCommandSet(cs_pin)->erase_32kb_cmd, addr);
 
   if (Parameter.debug == true || Parameter.flash_verbose == true)
   {
@@ -253,16 +413,13 @@ void flash_EraseSector_32kB(const uint8_t cs_pin, const uint32_t addr)
 
 void flash_EraseSector_64kB(const uint8_t cs_pin, const uint32_t addr)
 {
-  flash_WriteEnable(cs_pin);
-  flash_WaitWhileBusy(cs_pin);
-
   if (addr < DATALOG_MEM)
   {
     rtc_print_debug_timestamp();
     shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "####### WARNING: Erased 64kB sector, addr: %d ########################\n", addr);
   }
 
-  acces_write_reg(cs_pin, spi_dev, &spi_cfg, FLASH_SE_64KB, addr);
+  acces_write_reg(cs_pin, spi_dev, &spi_cfg, flash_GetCommandSet(cs_pin)->erase_64kb_cmd, addr);
 
   if (Parameter.debug == true || Parameter.flash_verbose == true)
   {
@@ -417,80 +574,62 @@ void flash_ClearMemAll(uint8_t cs_pin, uint32_t memory, uint32_t length)
   shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_DEFAULT, "\r");
 }
 
+/* Writes any length of data. The data is split into page program commands which never cross a 256 byte page boundary,
+ * otherwise the flash would wrap around and overwrite the beginning of the same page.
+ */
 void flash_write(uint8_t cs_pin, uint32_t addr, uint8_t *data, uint32_t len)
 {
-  uint32_t length = 0; // store original length
+  uint32_t length = 0;
   uint32_t offset = 0;
-  int32_t rest = (int32_t)len;
+  uint32_t rest = len;
+  const FLASH_COMMAND_SET *command_set = flash_GetCommandSet(cs_pin);
 
-  do
+  while (rest > 0)
   {
-    /* Split message in 256 byte tuples. Driver can only handle SPI message length up to 256 bytes */
-    if (rest > SPI_MAX_BLOCK_LENGTH)
-    {
-      length = SPI_MAX_BLOCK_LENGTH;
-    }
-    else
-    {
-      length = rest;
-    }
+    /* Limit the chunk to the remaining space in the current page */
+    length = FLASH_PAGE_SIZE - ((addr + offset) % FLASH_PAGE_SIZE);
 
-    rest -= SPI_MAX_BLOCK_LENGTH;
-
-    if (rest < 0)
+    if (length > rest)
     {
-      rest = 0;
+      length = rest;
     }
 
-    /* Start SPI write procedere */
-    flash_WriteEnable(cs_pin);
-    flash_WaitWhileBusy(cs_pin);
+    /* Start SPI write procedere (waits until the previous page program has finished). The bus is released after each page,
+     * so reads of other threads are not delayed by the complete length of a bulk write.
+     */
+    flash_LockBusWhenReady(cs_pin);
+    flash_SendWriteEnable(cs_pin);
 
     flash_cs(cs_pin, 0);
 
     if (Parameter.debug == true || Parameter.flash_verbose == true)
     {
       rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Write flash addr: 0x%X, data addr: 0x%X, length: 0x%X (%d bytes), offset: 0x%X, rest: 0x%X (%d bytes)\n", (addr + offset), (data + offset), length, length, offset, rest, rest);
+      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, "Write flash addr: 0x%X, data addr: 0x%X, length: 0x%X (%d bytes), offset: 0x%X, rest: 0x%X (%d bytes)\n", (addr + offset), (data + offset), length, length, offset, rest - length, rest - length);
     }
 
-    flash_access(spi_dev, &spi_cfg, FLASH_WRITE_CMD, (addr + (offset * sizeof(uint8_t))), (data + (offset * sizeof(uint8_t))), length);
-
-    // //! # <-
-    // uint8_t read_out = 0;
-    // shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_YELLOW, "%02X ", *(data + (offset * sizeof(uint8_t))));
-    // //! # ->
-
-    // offset += SPI_MAX_BLOCK_LENGTH;
+    flash_access(spi_dev, &spi_cfg, command_set, command_set->program_cmd, (addr + offset), (data + offset), length);
 
     flash_cs(cs_pin, 1);
 
-    // //! # <-
-    // k_usleep(500);
-    // uint8_t read_out = 0;
-    // flash_read(cs_pin, (addr + (offset * sizeof(uint8_t))), &read_out, length);
-    // shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "0x%X: %02X, %02X", (addr + (offset * sizeof(uint8_t))),  *(data + (offset * sizeof(uint8_t))), read_out);
-
-    // if (read_out != *(data + (offset * sizeof(uint8_t))))
-    // {
-    //   shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_RED, " ERROR", read_out);
-    // }
+    flash_UnlockBus();
 
-    // shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "\n");
-    // //! # ->
-    offset += SPI_MAX_BLOCK_LENGTH;
-  } while (rest > 0);
+    offset += length;
+    rest -= length;
+  }
 }
 
 void flash_write_register(uint8_t cs_pin, uint32_t reg, uint8_t *data, uint32_t len)
 {
-  flash_WriteEnable(cs_pin);
-  flash_WaitWhileBusy(cs_pin);
+  flash_LockBusWhenReady(cs_pin);
+  flash_SendWriteEnable(cs_pin);
 
   flash_cs(cs_pin, 0);
   flash_access_register(spi_dev, &spi_cfg, reg, data, len);
   flash_cs(cs_pin, 1);
 
+  flash_UnlockBus();
+
   if (Parameter.debug == true || Parameter.flash_verbose == true)
   {
     rtc_print_debug_timestamp();
@@ -501,92 +640,41 @@ void flash_write_register(uint8_t cs_pin, uint32_t reg, uint8_t *data, uint32_t
 /* This read does not check the busy flag in the device memory. It is optimized for speed, but uncertain in the results */
 void flash_read_fast(uint8_t cs_pin, uint32_t addr, uint8_t *data, uint32_t len)
 {
-  // flash_read(cs_pin, addr, data, len);
+  const FLASH_COMMAND_SET *command_set = flash_GetCommandSet(cs_pin);
 
-  uint32_t length = 0; // store original length
-  uint32_t offset = 0;
-  int32_t rest = len;
-
-  do
+  if (len == 0)
   {
-    /* Split message in 256 byte tuples. Driver can only handle SPI message length up to 256 bytes */
-    if (rest > SPI_MAX_BLOCK_LENGTH)
-    {
-      length = SPI_MAX_BLOCK_LENGTH;
-    }
-    else
-    {
-      length = rest;
-    }
-
-    rest -= SPI_MAX_BLOCK_LENGTH;
-
-    if (rest < 0)
-    {
-      rest = 0;
-    }
-
-    flash_WriteEnable_fast(cs_pin);
-    // flash_WaitWhileBusy(cs_pin);
-
-    flash_cs(cs_pin, 0);
+    return;
+  }
 
-    if (Parameter.debug == true || Parameter.flash_verbose == true)
-    {
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_GREEN, "Read flash addr: 0x%02X, length: %d bytes, rest: %d bytes\n", (addr + offset), length, rest);
-    }
+  if (Parameter.debug == true || Parameter.flash_verbose == true)
+  {
+    rtc_print_debug_timestamp();
+    shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_GREEN, "Read flash addr: 0x%02X, length: %d bytes\n", addr, len);
+  }
 
-    flash_access(spi_dev, &spi_cfg, FLASH_READ_CMD, (addr + (offset * sizeof(uint8_t))), (data + (offset * sizeof(uint8_t))), length);
-    offset += SPI_MAX_BLOCK_LENGTH;
+  k_mutex_lock(&flash_bus_mutex, K_FOREVER);
 
-    flash_cs(cs_pin, 1);
+  flash_cs(cs_pin, 0);
+  flash_access(spi_dev, &spi_cfg, command_set, command_set->read_cmd, addr, data, len);
+  flash_cs(cs_pin, 1);
 
-  } while (rest > 0);
+  k_mutex_unlock(&flash_bus_mutex);
 }
 
+/* Reads any length of data with a single read command. The flash increments the address internally, so no
+ * splitting is needed. A read does not need a write enable, it only has to wait for a pending program or erase cycle.
+ */
 void flash_read(uint8_t cs_pin, uint32_t addr, uint8_t *data, uint32_t len)
 {
-  uint32_t length = 0; // store original length
-  uint32_t offset = 0;
-  int32_t rest = len;
-
-  do
+  if (len == 0)
   {
-    /* Split message in 256 byte tuples. Driver can only handle SPI message length up to 256 bytes */
-    if (rest > SPI_MAX_BLOCK_LENGTH)
-    {
-      length = SPI_MAX_BLOCK_LENGTH;
-    }
-    else
-    {
-      length = rest;
-    }
-
-    rest -= SPI_MAX_BLOCK_LENGTH;
-
-    if (rest < 0)
-    {
-      rest = 0;
-    }
-
-    flash_WriteEnable(cs_pin);
-    flash_WaitWhileBusy(cs_pin);
-
-    flash_cs(cs_pin, 0);
-
-    if (Parameter.debug == true || Parameter.flash_verbose == true)
-    {
-      rtc_print_debug_timestamp();
-      shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_GREEN, "Read flash addr: 0x%02X, length: %d bytes, rest: %d bytes\n", (addr + offset), length, rest);
-    }
-
-    flash_access(spi_dev, &spi_cfg, FLASH_READ_CMD, (addr + (offset * sizeof(uint8_t))), (data + (offset * sizeof(uint8_t))), length);
-    offset += SPI_MAX_BLOCK_LENGTH;
-
-    flash_cs(cs_pin, 1);
+    return;
+  }
 
-  } while (rest > 0);
+  flash_LockBusWhenReady(cs_pin);
+  flash_read_fast(cs_pin, addr, data, len);
+  flash_UnlockBus();
 }
 
 uint8_t flash_ValidateDataInMemory(uint8_t cs_pin, uint32_t offset, uint32_t addr, uint16_t accumulation_length, uint8_t clear_value)
@@ -598,10 +686,7 @@ uint8_t flash_ValidateDataInMemory(uint8_t cs_pin, uint32_t offset, uint32_t add
   uint32_t sum_clear_val = clear_value * accumulation_length;
 
   /* Get one frame of data */
-  for (i = 0; i < accumulation_length; i++)
-  {
-    flash_read(cs_pin, offset + (addr + i), &frame[i], 1);
-  }
+  flash_read(cs_pin, offset + addr, frame, accumulation_length);
 
   /* Calculate cross sum */
   for (i = 0; i < accumulation_length; i++)
@@ -623,124 +708,204 @@ uint8_t flash_ValidateDataInMemory(uint8_t cs_pin, uint32_t offset, uint32_t add
 void flash_MemoryViewer(uint8_t cs_pin, uint32_t start_address, uint32_t length)
 {
   uint32_t i = 0UL;
-  uint8_t data = 0;
+  uint32_t row_length = 0UL;
+  uint8_t row[16];
 
   if (length > 0)
   {
-    for (i = 0UL; i <= length; i++)
+    for (i = 0UL; i <= length; i += sizeof(row))
     {
-      if ((i % 16) == 0) // Add every 16th line a line break (except at line 0)
+      /* Read one line (16 bytes) with a single flash access */
+      row_length = (length + 1) - i;
+
+      if (row_length > sizeof(row))
       {
-        // shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_YELLOW, "\n0x%X: ", start_address + i);
-        printf("\n0x%X: ", start_address + i);
+        row_length = sizeof(row);
       }
 
-      flash_read(cs_pin, start_address + i, &data, sizeof(data));
-      // shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "0x%02X ", data);
-      printf("0x%02X ", data);
+      flash_read(cs_pin, start_address + i, row, row_length);
+
+      printf("\n0x%X: ", start_address + i);
+
+      for (uint32_t j = 0UL; j < row_length; j++)
+      {
+        printf("0x%02X ", row[j]);
+      }
     }
-    //  shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_BLUE, "\n");
     printf("\n");
   }
 }
 
 uint8_t flash_CommunicationTest(uint8_t cs_pin)
 {
-  uint8_t flash_ReadByteOut = 0;
   uint8_t test_pattern = 0x55;
 
   /* Clear test memory */
   flash_EraseSector_4kB(cs_pin, PARAMETER_MEM);
 
   /* Write test data (checkerboard) */
-  uint16_t i = 0;
-  for (i = 0; i <= FLASH_CHECKERBOARD_SIZE; i++)
-  {
-    flash_write(cs_pin, PARAMETER_MEM + i, &test_pattern, sizeof(test_pattern));
-  }
+  uint8_t pattern[FLASH_CHECKERBOARD_SIZE];
+  uint8_t readout[FLASH_CHECKERBOARD_SIZE];
+
+  memset(pattern, test_pattern, sizeof(pattern));
+  memset(readout, 0, sizeof(readout));
+
+  flash_write(cs_pin, PARAMETER_MEM, pattern, sizeof(pattern));
 
   /* Verify checkerboard test data */
-  for (i = 0; i <= FLASH_CHECKERBOARD_SIZE; i++)
+  flash_read(cs_pin, PARAMETER_MEM, readout, sizeof(readout));
+
+  if (memcmp(pattern, readout, sizeof(pattern)) != 0)
   {
-    flash_read(cs_pin, PARAMETER_MEM, &flash_ReadByteOut, sizeof(flash_ReadByteOut));
-    if (flash_ReadByteOut != 0x55)
-    {
-      flash_ReadByteOut = 0;
-      return false;
-    }
-    flash_ReadByteOut = 0;
+    return false;
   }
   return true;
 }
 
-uint32_t flash_GetLastFrameNumber(const uint8_t cs_pin, const uint32_t sub_sector_size, const uint32_t start_address, const uint32_t memory_length, const uint32_t frame_length)
+/*!
+ * @brief This function adds a request to the queue of the flash service thread and returns immediately.
+ * @details The request is copied into the queue, but the data buffer is not. It has to stay valid until the request was
+ * completed, which is reported by the callback and/or the semaphore of the request.
+ * @param request: Pointer to the request
+ * @param priority: FLASH_PRIORITY_HIGH requests are executed before all pending FLASH_PRIORITY_NORMAL requests
+ * @return int: 0 on success, -ENOMEM if the queue is full
+ */
+int flash_SubmitRequest(const FLASH_REQUEST *request, FLASH_REQUEST_PRIORITY priority)
 {
-  uint32_t FrameNumber = 0UL;
-  uint32_t frames_per_sector = 0UL;
-  uint32_t addr = 0UL;
-  uint32_t data = 0UL;
-  uint32_t i = 0UL;
-  uint32_t rslt = 0;
+  struct k_msgq *queue = (priority == FLASH_PRIORITY_HIGH) ? &flash_request_queue_high : &flash_request_queue_normal;
+
+  if (k_msgq_put(queue, request, K_NO_WAIT) != 0)
+  {
+    flash_request_queue_overflows++;
+    return -ENOMEM;
+  }
+
+  k_sem_give(&flash_request_sem);
+
+  return 0;
+}
+
+/*!
+ * @brief This function adds a request to the queue of the flash service thread and waits until it was executed.
+ * @param request: Pointer to the request, a callback of the request is called as well
+ * @param priority: Priority of the request
+ * @return int: Result of the request or -ENOMEM if the queue is full
+ */
+int flash_SubmitRequestAndWait(FLASH_REQUEST *request, FLASH_REQUEST_PRIORITY priority)
+{
+  struct k_sem done;
+  int result = 0;
+  int err = 0;
 
-  /* Disable data logging while SPI hardware is used for read out flash memory */
-  datalog_EnableFlag = false;
+  k_sem_init(&done, 0, 1);
 
-  /* Caclulate how much frames fits into one sector */
-  frames_per_sector = sub_sector_size / frame_length;
+  request->done = &done;
+  request->result = &result;
 
-  /* Fast step throuh sector to accelerate finding last frame number */
-  for (i = 0UL; i < memory_length; i += sub_sector_size)
+  err = flash_SubmitRequest(request, priority);
+  if (err != 0)
   {
-    addr = start_address + i;
+    return err;
+  }
 
-    flash_read(cs_pin, addr, &data, sizeof(data));
+  k_sem_take(&done, K_FOREVER);
 
-    if (addr >= 0xFFFFFF)
-    {
-      data += 131072;
-    }
+  return result;
+}
 
-    if (i > 0)
-    {
-      rslt = (i / sub_sector_size) * frames_per_sector;
+/*!
+ * @brief This function blocks until all requests which were queued before have been executed (high priority requests are
+ * always taken before the normal priority sync request).
+ * @details Used before the memory gets erased or read out completely, so no queued write ends up in the memory afterwards.
+ */
+void flash_WaitForPendingRequests(void)
+{
+  FLASH_REQUEST request = {.type = FLASH_REQUEST_SYNC};
 
-      if (data == rslt)
-      {
-        FrameNumber += frames_per_sector;
-      }
-      else
-      {
-        addr -= sub_sector_size;
-        break;
-      }
-    }
+  while (flash_SubmitRequestAndWait(&request, FLASH_PRIORITY_NORMAL) == -ENOMEM)
+  {
+    k_msleep(1);
   }
+}
+
+/*!
+ * @brief This function returns the number of requests which wait for the flash service thread
+ * @param priority: Queue of the requests
+ * @return uint32_t: Number of queued requests
+ */
+uint32_t flash_PendingRequests(FLASH_REQUEST_PRIORITY priority)
+{
+  return k_msgq_num_used_get((priority == FLASH_PRIORITY_HIGH) ? &flash_request_queue_high : &flash_request_queue_normal);
+}
 
-  /* Within sector search for the latest frame number which has a valid number (and not the default flash erase state -> 0xFFFFFFFF)*/
-  for (i = 0UL; i < sub_sector_size; i++)
+static int flash_ExecuteRequest(const FLASH_REQUEST *request)
+{
+  switch (request->type)
   {
-    flash_read(cs_pin, (addr + (i * frame_length)), &data, sizeof(data));
+  case FLASH_REQUEST_READ:
+    flash_read(request->cs_pin, request->addr, request->data, request->len);
+    break;
 
-    if (data == FrameNumber)
-    {
-      FrameNumber++;
-    }
-    else
+  case FLASH_REQUEST_WRITE:
+    flash_write(request->cs_pin, request->addr, request->data, request->len);
+    break;
+
+  case FLASH_REQUEST_ERASE_4KB:
+    flash_EraseSector_4kB(request->cs_pin, request->addr);
+    break;
+
+  case FLASH_REQUEST_ERASE_32KB:
+    flash_EraseSector_32kB(request->cs_pin, request->addr);
+    break;
+
+  case FLASH_REQUEST_ERASE_64KB:
+    flash_EraseSector_64kB(request->cs_pin, request->addr);
+    break;
+
+  case FLASH_REQUEST_SYNC:
+    break;
+
+  default:
+    return -EINVAL;
+  }
+
+  return 0;
+}
+
+/*!
+ * @brief This function waits for the next request and executes it. It is called in the loop of the flash service thread.
+ * @details High priority requests are always taken first. An erase only sends the erase command, the busy time of the flash
+ * is spent in the next access to the same part, so the service thread is not blocked by a long erase cycle.
+ */
+void flash_ProcessRequests(void)
+{
+  FLASH_REQUEST request;
+  int result = 0;
+
+  k_sem_take(&flash_request_sem, K_FOREVER);
+
+  if (k_msgq_get(&flash_request_queue_high, &request, K_NO_WAIT) != 0)
+  {
+    if (k_msgq_get(&flash_request_queue_normal, &request, K_NO_WAIT) != 0)
     {
-      //   shell_print(shell_backend_uart_get_ptr(), "Address: %d, Frame: %d, data: %d", (uint32_t)addr, FrameNumber, data);
-      break;
+      return;
     }
   }
 
-  /* Enable data logging again if it is activated */
-  if (Parameter.datalogEnable == true && datalog_MemoryFull == false)
+  result = flash_ExecuteRequest(&request);
+
+  if (request.callback != NULL)
   {
-    datalog_EnableFlag = true;
+    request.callback(&request, result);
   }
-  else
+
+  if (request.result != NULL)
   {
-    datalog_EnableFlag = false;
+    *request.result = result;
   }
 
-  return FrameNumber;
+  if (request.done != NULL)
+  {
+    k_sem_give(request.done);
+  }
 }
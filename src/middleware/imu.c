@@ -29,6 +29,18 @@ volatile uint8_t motion_detected_old = false;
 volatile uint32_t motion_reset_counter = 0;
 uint8_t mag_data[8] = {0};
 
+/* Fifo acquisition. The watermark interrupt shares INT2 with the any motion interrupt, the imu thread reads the interrupt
+ * status to tell them apart. */
+K_SEM_DEFINE(imu_fifo_sem, 0, 1);
+K_MSGQ_DEFINE(imu_sample_queue, sizeof(IMU_SAMPLE), IMU_SAMPLE_QUEUE_SIZE, 4);
+volatile uint8_t imu_int2_triggered = false;
+uint32_t imu_fifo_skipped_frames = 0;
+uint32_t imu_sample_queue_overflows = 0;
+struct bmi160_fifo_frame imu_fifo_frame;
+uint8_t imu_fifo_buffer[IMU_FIFO_BUFFER_SIZE + BMI160_FIFO_BYTES_OVERREAD];
+IMU_SAMPLE imu_fifo_samples[IMU_FIFO_MAX_FRAMES];
+IMU_SAMPLE imu_last_sample;
+
 
 struct i2c_dt_spec imu_i2c = I2C_DT_SPEC_GET(DT_NODELABEL(bmx160));
 struct gpio_dt_spec imu_int1 = GPIO_DT_SPEC_GET(DT_ALIAS(imuint1), gpios);
@@ -289,6 +301,33 @@ void imu_init(void)
     bmi160.aux_cfg.aux_odr = BMI160_AUX_ODR_50HZ;
     rslt += bmi160_set_aux_auto_mode(&bmm150_data_start, &bmi160);
 
+    /*** Fifo in header mode with accel, gyro, aux and sensor time. Watermark interrupt on INT2 ***/
+
+    imu_fifo_frame.data = imu_fifo_buffer;
+    imu_fifo_frame.length = sizeof(imu_fifo_buffer);
+    bmi160.fifo = &imu_fifo_frame;
+
+    rslt = bmi160_set_fifo_config(BMI160_FIFO_GYRO | BMI160_FIFO_ACCEL | BMI160_FIFO_AUX | BMI160_FIFO_HEADER | BMI160_FIFO_TIME, BMI160_ENABLE, &bmi160);
+    rslt += bmi160_set_fifo_wm((uint8_t)(IMU_FIFO_WATERMARK / 4), &bmi160); // unit of the register is 4 byte
+
+    int_config.int_channel = BMI160_INT_CHANNEL_2;
+    int_config.int_type = BMI160_ACC_GYRO_FIFO_WATERMARK_INT;
+    int_config.fifo_WTM_int_en = BMI160_ENABLE;
+    rslt += bmi160_set_int_config(&int_config, &bmi160);
+
+    rslt += bmi160_set_fifo_flush(&bmi160);
+    memset(&imu_last_sample, 0, sizeof(imu_last_sample));
+    k_msgq_purge(&imu_sample_queue);
+
+    if (rslt != BMI160_OK)
+    {
+      if (Parameter.debug)
+      {
+        rtc_print_debug_timestamp();
+        shell_error(shell_backend_uart_get_ptr(), "Unable to config IMU fifo");
+      }
+    }
+
     imu_IsInitialized = true;
   }
   else
@@ -457,47 +496,242 @@ float gyro_lsb_to_dps(int16_t val)
   return (val * dps_range / half_scale);
 }
 
+/*!
+ *  @brief This function parses the frames of one fifo burst read into imu_fifo_samples. Frames without accel or gyro data
+ *  take the values of the previous frame. The sensor time frame at the end of the burst gives the time of the last frame,
+ *  the earlier frames are timestamped backwards with the sample period. Skipped frames (fifo overflow) are counted.
+ *  @param length: Number of bytes in imu_fifo_buffer
+ *  @return uint16_t: Number of samples
+ */
+static uint16_t imu_ParseFifo(uint16_t length)
+{
+  uint16_t index = 0;
+  uint16_t samples = 0;
+  uint16_t frame_length = 0;
+  uint32_t positions = 0; // Sample slots incl. skipped frames, used to timestamp the samples
+  uint32_t slot[IMU_FIFO_MAX_FRAMES];
+  uint32_t sensortime = 0;
+  uint8_t sensortime_valid = false;
+  uint8_t header = 0;
+  uint8_t parse = true;
+  uint16_t i = 0;
+
+  while ((index < length) && (parse == true))
+  {
+    header = imu_fifo_buffer[index] & BMI160_FIFO_TAG_INTR_MASK;
+
+    switch (header)
+    {
+    case BMI160_FIFO_HEAD_A:
+    case BMI160_FIFO_HEAD_G:
+    case BMI160_FIFO_HEAD_G_A:
+    case BMI160_FIFO_HEAD_M:
+    case BMI160_FIFO_HEAD_M_A:
+    case BMI160_FIFO_HEAD_M_G:
+    case BMI160_FIFO_HEAD_M_G_A:
+      frame_length = ((header & BMI160_FIFO_HEAD_M) == BMI160_FIFO_HEAD_M) ? BMI160_FIFO_M_LENGTH : 0;
+      frame_length += ((header & BMI160_FIFO_HEAD_G) == BMI160_FIFO_HEAD_G) ? BMI160_FIFO_G_LENGTH : 0;
+      frame_length += ((header & BMI160_FIFO_HEAD_A) == BMI160_FIFO_HEAD_A) ? BMI160_FIFO_A_LENGTH : 0;
+
+      /* A partially read frame is delivered again with the next read */
+      if (((index + 1 + frame_length) > length) || (samples >= IMU_FIFO_MAX_FRAMES))
+      {
+        parse = false;
+        break;
+      }
+      index++;
+
+      if ((header & BMI160_FIFO_HEAD_M) == BMI160_FIFO_HEAD_M)
+      {
+        memcpy(mag_data, &imu_fifo_buffer[index], BMI160_FIFO_M_LENGTH);
+        if (bmm150_aux_mag_data(mag_data, &bmm150) == BMM150_OK)
+        {
+          imu_last_sample.mag = bmm150.data;
+        }
+        index += BMI160_FIFO_M_LENGTH;
+      }
+
+      if ((header & BMI160_FIFO_HEAD_G) == BMI160_FIFO_HEAD_G)
+      {
+        imu_last_sample.gyro.x = (int16_t)((imu_fifo_buffer[index + 1] << 8) | imu_fifo_buffer[index]);
+        imu_last_sample.gyro.y = (int16_t)((imu_fifo_buffer[index + 3] << 8) | imu_fifo_buffer[index + 2]);
+        imu_last_sample.gyro.z = (int16_t)((imu_fifo_buffer[index + 5] << 8) | imu_fifo_buffer[index + 4]);
+        index += BMI160_FIFO_G_LENGTH;
+      }
+
+      if ((header & BMI160_FIFO_HEAD_A) == BMI160_FIFO_HEAD_A)
+      {
+        imu_last_sample.accel.x = (int16_t)((imu_fifo_buffer[index + 1] << 8) | imu_fifo_buffer[index]);
+        imu_last_sample.accel.y = (int16_t)((imu_fifo_buffer[index + 3] << 8) | imu_fifo_buffer[index + 2]);
+        imu_last_sample.accel.z = (int16_t)((imu_fifo_buffer[index + 5] << 8) | imu_fifo_buffer[index + 4]);
+        index += BMI160_FIFO_A_LENGTH;
+      }
+
+      imu_fifo_samples[samples] = imu_last_sample;
+      slot[samples] = positions;
+      samples++;
+      positions++;
+      break;
+
+    case BMI160_FIFO_HEAD_SKIP_FRAME:
+      if ((index + 2) > length)
+      {
+        parse = false;
+        break;
+      }
+      imu_fifo_skipped_frames += imu_fifo_buffer[index + 1];
+      positions += imu_fifo_buffer[index + 1];
+      index += 2;
+      break;
+
+    case BMI160_FIFO_HEAD_INPUT_CONFIG:
+      if ((index + 2) > length)
+      {
+        parse = false;
+        break;
+      }
+      index += 2;
+      break;
+
+    case BMI160_FIFO_HEAD_SENSOR_TIME:
+      if ((index + 4) <= length)
+      {
+        sensortime = ((uint32_t)imu_fifo_buffer[index + 3] << 16) | ((uint32_t)imu_fifo_buffer[index + 2] << 8) | imu_fifo_buffer[index + 1];
+        sensortime_valid = true;
+      }
+      parse = false;
+      break;
+
+    default: // BMI160_FIFO_HEAD_OVER_READ or invalid data, the fifo is empty
+      parse = false;
+      break;
+    }
+  }
+
+  if (sensortime_valid == false)
+  {
+    /* No sensor time frame in this read (buffer full), continue the time base of the previous read */
+    sensortime = imu_last_sample.sensortime + (positions * IMU_SAMPLE_PERIOD_TICKS);
+  }
+
+  for (i = 0; i < samples; i++)
+  {
+    imu_fifo_samples[i].sensortime = (sensortime - ((positions - 1 - slot[i]) * IMU_SAMPLE_PERIOD_TICKS)) & IMU_SENSORTIME_MASK;
+    imu_fifo_samples[i].accel.sensortime = imu_fifo_samples[i].sensortime;
+    imu_fifo_samples[i].gyro.sensortime = imu_fifo_samples[i].sensortime;
+  }
+
+  if (samples > 0)
+  {
+    imu_last_sample.sensortime = imu_fifo_samples[samples - 1].sensortime;
+  }
+
+  return samples;
+}
+
+/*!
+ *  @brief This function is called by the imu thread after the watermark interrupt (or the timeout). It checks the interrupt
+ *  status for any motion, reads the fifo in bursts and puts the timestamped samples into imu_sample_queue.
+ */
 void imu_fetch_data(void)
 {
   int8_t rslt = 0;
+  union bmi160_int_status int_status;
+  uint16_t samples = 0;
+  uint16_t i = 0;
+  uint8_t read = 0;
 
   if (imu_IsInitialized)
   {
-    /* To read only Accel data */
-    rslt = bmi160_get_sensor_data((BMI160_ACCEL_SEL | BMI160_GYRO_SEL | BMI160_TIME_SEL), &accel, &gyro, &bmi160);
-    if (rslt != 0)
+    /* INT2 is shared by the any motion and the fifo watermark interrupt */
+    int_status.data[0] = 0;
+    int_status.data[1] = 0;
+    rslt = bmi160_get_int_status(BMI160_INT_STATUS_0 | BMI160_INT_STATUS_1, &int_status, &bmi160);
+
+    if (rslt == BMI160_OK)
     {
-      if (Parameter.debug)
+      /* The any motion interrupt is not latched and may be over already, an edge without watermark was a motion */
+      if ((int_status.bit.anym == 1) || ((imu_int2_triggered == true) && (int_status.bit.fwm == 0)))
       {
-        rtc_print_debug_timestamp();
-        shell_error(shell_backend_uart_get_ptr(), "Could not fetch acceleromter and gyro data");
+        motion_detected = true;
+        motion_reset_counter = 0;
       }
     }
+    imu_int2_triggered = false;
 
-    /* Reading data from BMI160 data registers */
-    rslt = bmi160_read_aux_data_auto_mode(mag_data, &bmi160);
-    if (rslt != 0)
+    /* Read the fifo in bursts until it is empty, two bursts cover the whole sensor fifo */
+    for (read = 0; read < (1024 / IMU_FIFO_BUFFER_SIZE); read++)
     {
-      if (Parameter.debug)
+      imu_fifo_frame.data = imu_fifo_buffer;
+      imu_fifo_frame.length = sizeof(imu_fifo_buffer);
+
+      rslt = bmi160_get_fifo_data(&bmi160);
+      if (rslt != BMI160_OK)
       {
-        rtc_print_debug_timestamp();
-        shell_error(shell_backend_uart_get_ptr(), "Could not set magnetometer auto mode");
+        if (Parameter.debug)
+        {
+          rtc_print_debug_timestamp();
+          shell_error(shell_backend_uart_get_ptr(), "Could not read IMU fifo");
+        }
+        break;
       }
-    }
 
-    /* Compensating the raw mag data available from the BMM150 API */
-    rslt = bmm150_aux_mag_data(mag_data, &bmm150);
-    if (rslt != 0)
-    {
-      if (Parameter.debug)
+      samples = imu_ParseFifo(imu_fifo_frame.length);
+
+      for (i = 0; i < samples; i++)
       {
-        rtc_print_debug_timestamp();
-        shell_error(shell_backend_uart_get_ptr(), "Could not read magnetometer data");
+        if (k_msgq_put(&imu_sample_queue, &imu_fifo_samples[i], K_NO_WAIT) != 0)
+        {
+          imu_sample_queue_overflows++;
+        }
+      }
+
+      if (imu_fifo_frame.length < IMU_FIFO_BUFFER_SIZE)
+      {
+        break;
       }
     }
   }
 }
 
+/*!
+ *  @brief This function takes the next sample for the algorithm from imu_sample_queue and stores it unchanged in accel, gyro
+ *  and bmm150.data. The algorithm is tuned for single samples every Parameter.imu_interval (thresholds, filters and timers
+ *  counted in calls), so the first sample of each interval is used like the former polled one and the other 100Hz samples
+ *  of the interval are dropped.
+ *  @return bool: true if a sample for the next interval was available, false if more samples are needed
+ */
+bool imu_get_next_interval(void)
+{
+  static bool interval_started = false;
+  static uint32_t interval_start = 0;
+  IMU_SAMPLE sample;
+
+  while (k_msgq_get(&imu_sample_queue, &sample, K_NO_WAIT) == 0)
+  {
+    if ((interval_started == false) || (((sample.sensortime - interval_start) & IMU_SENSORTIME_MASK) >= IMU_MS_TO_SENSORTIME(Parameter.imu_interval)))
+    {
+      accel.x = sample.accel.x;
+      accel.y = sample.accel.y;
+      accel.z = sample.accel.z;
+      gyro.x = sample.gyro.x;
+      gyro.y = sample.gyro.y;
+      gyro.z = sample.gyro.z;
+      bmm150.data.x = sample.mag.x;
+      bmm150.data.y = sample.mag.y;
+      bmm150.data.z = sample.mag.z;
+      accel.sensortime = sample.sensortime;
+      gyro.sensortime = sample.sensortime;
+
+      interval_started = true;
+      interval_start = sample.sensortime;
+      return true;
+    }
+  }
+
+  return false;
+}
+
 void trace_imu(void)
 {
   if (imu_IsInitialized)
@@ -732,6 +966,10 @@ void imu_int1_cb(const struct device *dev, struct gpio_callback *cb, uint32_t pi
  */
 void imu_int2_cb(const struct device *dev, struct gpio_callback *cb, uint32_t pins)
 {
-  motion_detected = true;
-  motion_reset_counter = 0;
+  /* Only the active edge, the falling edge after the fifo was read is no motion. The imu thread reads the interrupt status */
+  if (gpio_pin_get_dt(&imu_int2) > 0)
+  {
+    imu_int2_triggered = true;
+    k_sem_give(&imu_fifo_sem);
+  }
 }
@@ -17,10 +17,405 @@ uint8_t RFID_ScanEnable = false;
 uint8_t RFID_autoscan_enabled = false;
 uint8_t RFID_IsOn = false;
 uint8_t RFID_TriggeredRead = false;
+uint32_t rfid_request_timeouts = 0;
+uint32_t rfid_unsolicited_responses = 0;
+uint32_t rfid_parser_overlong_lines = 0;
+
+/* Commands which wait for a response of the module, paired in the order they were sent */
+static RFID_REQUEST rfid_requests[RFID_REQUEST_TABLE_SIZE];
+static uint32_t rfid_request_sequence = 0;
+K_MUTEX_DEFINE(rfid_request_mutex);
+
+static RFID_PARSER rfid_parser;
+
+static void rfid_ExpireRequests(int64_t now);
+static const char *rfid_GetOutputPowerCommand(int8_t tx_dbm);
+static const char *rfid_GetFrequencyCommand(uint8_t freq);
 
 struct gpio_dt_spec booster_enable_pin = GPIO_DT_SPEC_GET(DT_ALIAS(boosterenable), gpios);
 struct gpio_dt_spec rfid_trigger_pin = GPIO_DT_SPEC_GET(DT_ALIAS(rfidtrigger), gpios);
 
+/*!
+ *  @brief Sends a terminated command string to the RFID module without waiting for the transmission
+ *  @param command: Command including the leading <LF> and the trailing <CR>
+ *  @return int: 0 on success, negative error code of uart1_Transmit otherwise
+ */
+int rfid_SendCommand(const char *command)
+{
+  return uart1_Transmit((const uint8_t *)command, strlen(command));
+}
+
+/*!
+ *  @brief Sends a command and pairs it with the response of the module. The request is kept in the request table until a response
+ *  line starting with the expected character arrives or the timeout expires. Responses are paired in the order the commands were
+ *  sent.
+ *  @param command: Command including the leading <LF> and the trailing <CR>
+ *  @param response_command: First character of the expected response line, e.g. 'N'
+ *  @param timeout_ms: Time the module has to answer
+ *  @param wait: true blocks until the response arrived, false returns after sending (the response is consumed without a result)
+ *  @param value: Pointer to the hex value of the response, can be NULL
+ *  @param response: Pointer to a buffer for the terminated response line, can be NULL
+ *  @param response_size: Size of the response buffer
+ *  @return int: 0 on success, -ETIMEDOUT if the module did not answer, -ENOMEM if the request table or the tx queue is full
+ */
+static int rfid_SubmitRequest(const char *command, char response_command, uint32_t timeout_ms, bool wait, int32_t *value, char *response, uint8_t response_size)
+{
+  struct k_sem done;
+  RFID_REQUEST *request = NULL;
+  int result = 0;
+  uint8_t i = 0;
+
+  k_sem_init(&done, 0, 1);
+
+  k_mutex_lock(&rfid_request_mutex, K_FOREVER);
+
+  rfid_ExpireRequests(k_uptime_get());
+
+  for (i = 0; i < RFID_REQUEST_TABLE_SIZE; i++)
+  {
+    if (rfid_requests[i].pending == false)
+    {
+      request = &rfid_requests[i];
+      break;
+    }
+  }
+
+  if (request == NULL)
+  {
+    k_mutex_unlock(&rfid_request_mutex);
+    return -ENOMEM;
+  }
+
+  request->pending = true;
+  request->sequence = rfid_request_sequence++;
+  request->response_command = response_command;
+  request->deadline = k_uptime_get() + timeout_ms;
+  request->done = (wait == true) ? &done : NULL;
+  request->value = value;
+  request->response = response;
+  request->response_size = response_size;
+  request->result = &result;
+
+  if (rfid_SendCommand(command) != 0)
+  {
+    request->pending = false;
+    k_mutex_unlock(&rfid_request_mutex);
+    return -ENOMEM;
+  }
+
+  k_mutex_unlock(&rfid_request_mutex);
+
+  if (wait == false)
+  {
+    return 0;
+  }
+
+  if (k_sem_take(&done, K_MSEC(timeout_ms)) != 0)
+  {
+    /* The response can still arrive between the timeout and the lock, in this case the request is completed already */
+    k_mutex_lock(&rfid_request_mutex, K_FOREVER);
+    if ((request->pending == true) && (request->done == &done))
+    {
+      request->pending = false;
+      result = -ETIMEDOUT;
+      rfid_request_timeouts++;
+    }
+    k_mutex_unlock(&rfid_request_mutex);
+  }
+
+  return result;
+}
+
+/*!
+ *  @brief Sends a command and pairs it with the response of the module, see rfid_SubmitRequest
+ *  @return int: 0 on success, -ETIMEDOUT if the module did not answer, -ENOMEM if the request table or the tx queue is full
+ */
+int rfid_Request(const char *command, char response_command, uint32_t timeout_ms, bool wait, int32_t *value)
+{
+  return rfid_SubmitRequest(command, response_command, timeout_ms, wait, value, NULL, 0);
+}
+
+/*!
+ *  @brief Sends a command and waits for the response line of the module
+ *  @param command: Command including the leading <LF> and the trailing <CR>
+ *  @param response_command: First character of the expected response line
+ *  @param timeout_ms: Time the module has to answer
+ *  @param response: Pointer to a buffer for the terminated response line
+ *  @param response_size: Size of the response buffer
+ *  @return int: 0 on success, -ETIMEDOUT if the module did not answer, -ENOMEM if the request table or the tx queue is full
+ */
+int rfid_RequestText(const char *command, char response_command, uint32_t timeout_ms, char *response, uint8_t response_size)
+{
+  return rfid_SubmitRequest(command, response_command, timeout_ms, true, NULL, response, response_size);
+}
+
+/*!
+ *  @brief Drops requests whose response did not arrive in time. Waiting callers run into their own timeout. Call with the request
+ *  mutex locked.
+ *  @param now: Current uptime in ms
+ */
+static void rfid_ExpireRequests(int64_t now)
+{
+  uint8_t i = 0;
+
+  for (i = 0; i < RFID_REQUEST_TABLE_SIZE; i++)
+  {
+    if ((rfid_requests[i].pending == true) && (rfid_requests[i].done == NULL) && (rfid_requests[i].deadline < now))
+    {
+      rfid_requests[i].pending = false;
+      rfid_request_timeouts++;
+    }
+  }
+}
+
+/*!
+ *  @brief Pairs a response with the oldest pending request which expects it
+ *  @param response: Pointer to the parsed response
+ */
+static void rfid_CompleteRequest(const RFID_RESPONSE *response)
+{
+  RFID_REQUEST *request = NULL;
+  uint8_t i = 0;
+
+  k_mutex_lock(&rfid_request_mutex, K_FOREVER);
+
+  rfid_ExpireRequests(k_uptime_get());
+
+  for (i = 0; i < RFID_REQUEST_TABLE_SIZE; i++)
+  {
+    if ((rfid_requests[i].pending == true) && (rfid_requests[i].response_command == response->command))
+    {
+      if ((request == NULL) || ((int32_t)(rfid_requests[i].sequence - request->sequence) < 0))
+      {
+        request = &rfid_requests[i];
+      }
+    }
+  }
+
+  if (request != NULL)
+  {
+    request->pending = false;
+
+    if (request->done != NULL)
+    {
+      if (request->value != NULL)
+      {
+        *request->value = response->value;
+      }
+      if ((request->response != NULL) && (request->response_size > 0))
+      {
+        snprintf(request->response, request->response_size, "%c%.*s", response->command, response->payload_length, response->payload);
+      }
+      *request->result = 0;
+      k_sem_give(request->done);
+    }
+  }
+  else
+  {
+    rfid_unsolicited_responses++;
+  }
+
+  k_mutex_unlock(&rfid_request_mutex);
+}
+
+/*!
+ *  @brief Converts hex digits to a number
+ *  @param string: Pointer to the hex digits, no termination needed
+ *  @param length: Number of digits, at most 8
+ *  @return int32_t: The value or -1 if there are no digits or a character is no hex digit
+ */
+static int32_t rfid_ParseHex(const char *string, uint8_t length)
+{
+  int32_t value = 0;
+  int8_t digit = 0;
+  uint8_t i = 0;
+
+  if ((length == 0) || (length > 8))
+  {
+    return -1;
+  }
+
+  for (i = 0; i < length; i++)
+  {
+    digit = EPC_HexDigitValue(string[i]);
+    if (digit < 0)
+    {
+      return -1;
+    }
+    value = (value << 4) | digit;
+  }
+
+  return value;
+}
+
+/*!
+ *  @brief Classifies a complete response line and hands it over to the epc ring buffer or to the request table. The response only
+ *  points into the parser line buffer, nothing is copied.
+ */
+static void rfid_DispatchLine(void)
+{
+  RFID_RESPONSE response;
+  const char *separator = NULL;
+  uint8_t field_length = 0;
+
+  memset(&response, 0, sizeof(response));
+  response.command = rfid_parser.line[0];
+  response.payload = &rfid_parser.line[1];
+  response.payload_length = rfid_parser.length - 1;
+  response.rssi = RFID_RSSI_NONE;
+  response.value = -1;
+
+  if (Parameter.rfid_verbose == true)
+  {
+    shell_fprintf(shell_backend_uart_get_ptr(), SHELL_VT100_COLOR_YELLOW, "%.*s\n", rfid_parser.length, rfid_parser.line);
+  }
+
+  /* Fields are separated by a comma, the first one holds the epc (tag responses) or the value */
+  separator = memchr(response.payload, ',', response.payload_length);
+  field_length = (separator != NULL) ? (separator - response.payload) : response.payload_length;
+
+  switch (response.command)
+  {
+  case 'U': // Multi tag read: one line per tag, a line without epc ends the inventory round
+  case 'Q': // Single tag read
+    if (field_length > (EPC_CUT_OFF_START + EPC_CUT_OFF_END))
+    {
+      response.type = RFID_RESPONSE_TAG;
+
+      /* Incomming EPC data has to be trimmed. The rule: cut of the first 4 digits (incoming "PC"), cut of the last 4 digits (CRC) and
+       * take the middle content as the EPC. An optional second field holds the RSSI. */
+      response.epc = &response.payload[EPC_CUT_OFF_START];
+      response.epc_length = field_length - (EPC_CUT_OFF_START + EPC_CUT_OFF_END);
+
+      if (separator != NULL)
+      {
+        response.rssi = rfid_ParseHex(separator + 1, response.payload_length - field_length - 1);
+      }
+    }
+    else
+    {
+      response.type = RFID_RESPONSE_TAG_END;
+    }
+    break;
+
+  case 'X': // No tag in range
+    response.type = RFID_RESPONSE_TAG_END;
+    break;
+
+  case 'N': // Reader settings (N0 output power, N1 set output power, N4 frequency, N5 set frequency)
+    response.type = RFID_RESPONSE_VALUE;
+    response.value = rfid_ParseHex(response.payload, field_length);
+    break;
+
+  case 'V': // Firmware version
+    response.type = RFID_RESPONSE_VERSION;
+    break;
+
+  default:
+    response.type = RFID_RESPONSE_OTHER;
+    break;
+  }
+
+  if (System.RFID_Sniff == true)
+  {
+    /* Echo received data at UART1 to console (UART0) */
+    if (suppress_rfid_command_charcaters == true)
+    {
+      if (response.type == RFID_RESPONSE_TAG)
+      {
+        rfid_ok = true;
+        printk("%.*s\n", response.payload_length, response.payload);
+      }
+    }
+    else
+    {
+      printk("%.*s\n", rfid_parser.length, rfid_parser.line);
+    }
+  }
+
+  if (response.type == RFID_RESPONSE_TAG)
+  {
+    epc_store_tag(response.epc, response.epc_length, response.rssi);
+  }
+  else if (response.type != RFID_RESPONSE_TAG_END)
+  {
+    rfid_CompleteRequest(&response);
+  }
+}
+
+/*!
+ *  @brief Feeds received bytes into the response parser. Lines of the reader start with <LF> and end with <CR> (which is followed by
+ *  the <LF> of the next line), the first character is the command the line belongs to.
+ *  @param data: Pointer to the received bytes
+ *  @param length: Number of bytes
+ */
+void rfid_ParseResponse(const uint8_t *data, uint16_t length)
+{
+  uint16_t i = 0;
+  char c = 0;
+
+  for (i = 0; i < length; i++)
+  {
+    c = data[i];
+
+    switch (rfid_parser.state)
+    {
+    case RFID_PARSER_WAIT_LINE:
+      if (c == '\n')
+      {
+        rfid_parser.length = 0;
+        rfid_parser.state = RFID_PARSER_LINE;
+      }
+      break;
+
+    case RFID_PARSER_LINE:
+      if ((c == '\r') || (c == '\n'))
+      {
+        if (rfid_parser.length > 0)
+        {
+          rfid_DispatchLine();
+        }
+
+        rfid_parser.length = 0;
+        rfid_parser.state = (c == '\n') ? RFID_PARSER_LINE : RFID_PARSER_WAIT_LINE;
+      }
+      else if (rfid_parser.length < RFID_LINE_BUFFER_SIZE)
+      {
+        rfid_parser.line[rfid_parser.length++] = c;
+      }
+      else
+      {
+        /* Line too long, no valid response. Skip it until the next line starts */
+        rfid_parser_overlong_lines++;
+        rfid_parser.state = RFID_PARSER_WAIT_LINE;
+      }
+      break;
+
+    default:
+      rfid_parser.state = RFID_PARSER_WAIT_LINE;
+      break;
+    }
+  }
+}
+
+/*!
+ *  @brief Takes all received bytes out of the uart rx ring and parses them. Runs in the rfid rx thread, the only consumer of the
+ *  ring.
+ */
+void rfid_ProcessReceivedData(void)
+{
+  uint8_t rx_chunk[RFID_RX_CHUNK_SIZE];
+  uint16_t rx_length = 0;
+
+  while ((rx_length = uart1_RxRingRead(rx_chunk, sizeof(rx_chunk))) > 0)
+  {
+    rfid_ParseResponse(rx_chunk, rx_length);
+  }
+
+  /* Hand all tags of this chunk over to the epc thread at once */
+  epc_signal_new_tags();
+}
+
 /*!
  *  @brief This is the function description
  */
@@ -87,15 +482,31 @@ void rfid_power_on(void)
 }
 
 /*!
- *  @brief This is the function description
+ *  @brief Sets frequency band and output power of the RFID module. Each setting waits for the acknowledge of the module instead of
+ *  a fixed delay; a setting which is not acknowledged (e.g. module still starting up) is sent again.
  */
 void config_RFID(void)
 {
-  k_msleep(300);
-  RFID_setFrequency(Parameter.rfid_frequency);
-  k_msleep(200);
-  RFID_setOutputPower(Parameter.rfid_output_power);
-  k_msleep(200);
+  uint8_t retry = 0;
+  const char *command = NULL;
+
+  command = rfid_GetFrequencyCommand(Parameter.rfid_frequency);
+  for (retry = 0; (command != NULL) && (retry < RFID_CONFIG_RETRIES); retry++)
+  {
+    if (rfid_Request(command, 'N', RFID_CONFIG_TIMEOUT_MS, true, NULL) == 0)
+    {
+      break;
+    }
+  }
+
+  command = rfid_GetOutputPowerCommand(Parameter.rfid_output_power);
+  for (retry = 0; (command != NULL) && (retry < RFID_CONFIG_RETRIES); retry++)
+  {
+    if (rfid_Request(command, 'N', RFID_CONFIG_TIMEOUT_MS, true, NULL) == 0)
+    {
+      break;
+    }
+  }
 }
 
 /*!
@@ -119,15 +530,7 @@ void RFID_TurnOn(void)
  */
 void RFID_TriggerSingleScan(void)
 {
-    int16_t err = 0;
-  uint16_t i = 0;
-
-  uint8_t tx_buf[] = {"\nQ\r"};
-
-  for (i = 0; i < sizeof(tx_buf); i++)
-  {
-    uart_poll_out(uart1, tx_buf[i]);
-  }
+  rfid_SendCommand("\nQ\r");
   RFID_TriggeredRead = true;
 }
 
@@ -136,15 +539,7 @@ void RFID_TriggerSingleScan(void)
  */
 void rfid_trigger_multi_read(void)
 {
-  int16_t err = 0;
-  uint16_t i = 0;
-
-  uint8_t tx_buf[] = {"\nU\r"};
-
-  for (i = 0; i < sizeof(tx_buf); i++)
-  {
-    uart_poll_out(uart1, tx_buf[i]);
-  }
+  rfid_SendCommand("\nU\r");
   RFID_TriggeredRead = true;
 }
 
@@ -153,7 +548,7 @@ void rfid_trigger_multi_read(void)
  */
 uint8_t RFID_getFWVersion(void)
 {
-  uart_fifo_fill(uart1, "\nV\r", sizeof("V\r"));
+  rfid_Request("\nV\r", 'V', RFID_RESPONSE_TIMEOUT_MS, false, NULL);
   return 0;
 }
 /*!
@@ -161,365 +556,171 @@ uint8_t RFID_getFWVersion(void)
  */
 uint8_t RFID_getID(void)
 {
-  uart_fifo_fill(uart1, "\nS\r", sizeof("S\r"));
+  rfid_Request("\nS\r", 'S', RFID_RESPONSE_TIMEOUT_MS, false, NULL);
   return 0;
 }
 /*!
- *  @brief This is the function description
+ *  @brief Returns the command which sets the output power
+ *  @param tx_dbm: Output power index 0 (-2 dBm) ... 27 (25 dBm)
+ *  @return const char*: The command or NULL if the index is not valid
  */
-void RFID_setOutputPower(int8_t tx_dbm)
+static const char *rfid_GetOutputPowerCommand(int8_t tx_dbm)
 {
   switch (tx_dbm)
   {
   case 0:
-    uart_fifo_fill(uart1, RFID_TX_POWER_N2_DBM, sizeof(RFID_TX_POWER_N2_DBM));
-    break;
+    return RFID_TX_POWER_N2_DBM;
   case 1:
-    uart_fifo_fill(uart1, RFID_TX_POWER_N1_DBM, sizeof(RFID_TX_POWER_N1_DBM));
-    break;
+    return RFID_TX_POWER_N1_DBM;
   case 2:
-    uart_fifo_fill(uart1, RFID_TX_POWER_0_DBM, sizeof(RFID_TX_POWER_0_DBM));
-    break;
+    return RFID_TX_POWER_0_DBM;
   case 3:
-    uart_fifo_fill(uart1, RFID_TX_POWER_1_DBM, sizeof(RFID_TX_POWER_1_DBM));
-    break;
+    return RFID_TX_POWER_1_DBM;
   case 4:
-    uart_fifo_fill(uart1, RFID_TX_POWER_2_DBM, sizeof(RFID_TX_POWER_2_DBM));
-    break;
+    return RFID_TX_POWER_2_DBM;
   case 5:
-    uart_fifo_fill(uart1, RFID_TX_POWER_3_DBM, sizeof(RFID_TX_POWER_3_DBM));
-    break;
+    return RFID_TX_POWER_3_DBM;
   case 6:
-    uart_fifo_fill(uart1, RFID_TX_POWER_4_DBM, sizeof(RFID_TX_POWER_4_DBM));
-    break;
+    return RFID_TX_POWER_4_DBM;
   case 7:
-    uart_fifo_fill(uart1, RFID_TX_POWER_5_DBM, sizeof(RFID_TX_POWER_5_DBM));
-    break;
+    return RFID_TX_POWER_5_DBM;
   case 8:
-    uart_fifo_fill(uart1, RFID_TX_POWER_6_DBM, sizeof(RFID_TX_POWER_6_DBM));
-    break;
+    return RFID_TX_POWER_6_DBM;
   case 9:
-    uart_fifo_fill(uart1, RFID_TX_POWER_7_DBM, sizeof(RFID_TX_POWER_7_DBM));
-    break;
+    return RFID_TX_POWER_7_DBM;
   case 10:
-    uart_fifo_fill(uart1, RFID_TX_POWER_8_DBM, sizeof(RFID_TX_POWER_8_DBM));
-    break;
+    return RFID_TX_POWER_8_DBM;
   case 11:
-    uart_fifo_fill(uart1, RFID_TX_POWER_9_DBM, sizeof(RFID_TX_POWER_9_DBM));
-    break;
+    return RFID_TX_POWER_9_DBM;
   case 12:
-    uart_fifo_fill(uart1, RFID_TX_POWER_10_DBM, sizeof(RFID_TX_POWER_10_DBM));
-    break;
+    return RFID_TX_POWER_10_DBM;
   case 13:
-    uart_fifo_fill(uart1, RFID_TX_POWER_11_DBM, sizeof(RFID_TX_POWER_11_DBM));
-    break;
+    return RFID_TX_POWER_11_DBM;
   case 14:
-    uart_fifo_fill(uart1, RFID_TX_POWER_12_DBM, sizeof(RFID_TX_POWER_12_DBM));
-    break;
+    return RFID_TX_POWER_12_DBM;
   case 15:
-    uart_fifo_fill(uart1, RFID_TX_POWER_13_DBM, sizeof(RFID_TX_POWER_13_DBM));
-    break;
+    return RFID_TX_POWER_13_DBM;
   case 16:
-    uart_fifo_fill(uart1, RFID_TX_POWER_14_DBM, sizeof(RFID_TX_POWER_14_DBM));
-    break;
+    return RFID_TX_POWER_14_DBM;
   case 17:
-    uart_fifo_fill(uart1, RFID_TX_POWER_15_DBM, sizeof(RFID_TX_POWER_15_DBM));
-    break;
+    return RFID_TX_POWER_15_DBM;
   case 18:
-    uart_fifo_fill(uart1, RFID_TX_POWER_16_DBM, sizeof(RFID_TX_POWER_16_DBM));
-    break;
+    return RFID_TX_POWER_16_DBM;
   case 19:
-    uart_fifo_fill(uart1, RFID_TX_POWER_17_DBM, sizeof(RFID_TX_POWER_17_DBM));
-    break;
+    return RFID_TX_POWER_17_DBM;
   case 20:
-    uart_fifo_fill(uart1, RFID_TX_POWER_18_DBM, sizeof(RFID_TX_POWER_18_DBM));
-    break;
+    return RFID_TX_POWER_18_DBM;
   case 21:
-    uart_fifo_fill(uart1, RFID_TX_POWER_19_DBM, sizeof(RFID_TX_POWER_19_DBM));
-    break;
+    return RFID_TX_POWER_19_DBM;
   case 22:
-    uart_fifo_fill(uart1, RFID_TX_POWER_20_DBM, sizeof(RFID_TX_POWER_20_DBM));
-    break;
+    return RFID_TX_POWER_20_DBM;
   case 23:
-    uart_fifo_fill(uart1, RFID_TX_POWER_21_DBM, sizeof(RFID_TX_POWER_21_DBM));
-    break;
+    return RFID_TX_POWER_21_DBM;
   case 24:
-    uart_fifo_fill(uart1, RFID_TX_POWER_22_DBM, sizeof(RFID_TX_POWER_22_DBM));
-    break;
+    return RFID_TX_POWER_22_DBM;
   case 25:
-    uart_fifo_fill(uart1, RFID_TX_POWER_23_DBM, sizeof(RFID_TX_POWER_23_DBM));
-    break;
+    return RFID_TX_POWER_23_DBM;
   case 26:
-    uart_fifo_fill(uart1, RFID_TX_POWER_24_DBM, sizeof(RFID_TX_POWER_24_DBM));
-    break;
+    return RFID_TX_POWER_24_DBM;
   case 27:
-    uart_fifo_fill(uart1, RFID_TX_POWER_25_DBM, sizeof(RFID_TX_POWER_25_DBM));
-    break;
+    return RFID_TX_POWER_25_DBM;
   default:
-    break;
+    return NULL;
   }
 }
 
 /*!
- *  @brief This is the function description
+ *  @brief Sets the output power of the RFID module. Returns without waiting, the acknowledge of the module is consumed by the
+ *  response parser.
+ *  @param tx_dbm: Output power index 0 (-2 dBm) ... 27 (25 dBm)
  */
-int8_t RFID_getOutputPower(void)
+void RFID_setOutputPower(int8_t tx_dbm)
 {
-  volatile int8_t output_power = 0;
-  char command[8];
-
-  System.RFID_TransparentMode = true;
-
-  RFID_IsOn = true;
-
-  uart1_RFIDResponseTransmissionLength = 0;
-
-  /* Build a command with \n and \r signs which is accepted by the RFID reader module */
-  strcpy(command, "\nN0,00\r");
-
-  /* Send command to RFID module and wait for a certain time for the response */
-  memset(uart1_RFIDResponse, '\0', sizeof(uart1_RFIDResponse));
-  uart_fifo_fill(uart1, command, sizeof(command) - 1);
+  const char *command = rfid_GetOutputPowerCommand(tx_dbm);
 
-  /* Record uart input coming from rfid module for 1000 ms */
-  while (!uart1_RFIDResponseFinished)
+  if (command != NULL)
   {
+    rfid_Request(command, 'N', RFID_RESPONSE_TIMEOUT_MS, false, NULL);
   }
+}
 
-  System.RFID_TransparentMode = false;
+/*!
+ *  @brief Reads the output power of the RFID module
+ *  @return int8_t: Output power index 0 (-2 dBm) ... 27 (25 dBm), 0 if the module did not answer
+ */
+int8_t RFID_getOutputPower(void)
+{
+  int32_t output_power = 0;
 
-  /* Decode string into number */
-  if (!strncmp(uart1_RFIDResponse, "N1B", 3))
-  {
-    output_power = 27;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N1A", 3))
-  {
-    output_power = 26;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N19", 3))
-  {
-    output_power = 25;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N18", 3))
-  {
-    output_power = 24;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N17", 3))
-  {
-    output_power = 23;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N16", 3))
-  {
-    output_power = 22;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N15", 3))
-  {
-    output_power = 21;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N14", 3))
-  {
-    output_power = 20;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N13", 3))
-  {
-    output_power = 19;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N12", 3))
-  {
-    output_power = 18;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N11", 3))
-  {
-    output_power = 17;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N10", 3))
-  {
-    output_power = 16;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N0F", 3))
-  {
-    output_power = 15;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N0E", 3))
-  {
-    output_power = 14;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N0D", 3))
-  {
-    output_power = 13;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N0C", 3))
-  {
-    output_power = 12;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N0B", 3))
-  {
-    output_power = 11;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N0A", 3))
-  {
-    output_power = 10;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N09", 3))
-  {
-    output_power = 9;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N08", 3))
-  {
-    output_power = 8;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N07", 3))
-  {
-    output_power = 7;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N06", 3))
-  {
-    output_power = 6;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N05", 3))
-  {
-    output_power = 5;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N04", 3))
-  {
-    output_power = 4;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N03", 3))
-  {
-    output_power = 3;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N02", 3))
-  {
-    output_power = 2;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N01", 3))
-  {
-    output_power = 1;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N00", 3))
+  RFID_IsOn = true;
+
+  if ((rfid_Request("\nN0,00\r", 'N', RFID_RESPONSE_TIMEOUT_MS, true, &output_power) != 0) || (output_power < 0) || (output_power > 27))
   {
     output_power = 0;
   }
-  else
-  {
-  }
-
-  memset(uart1_RFIDResponse, '\0', sizeof(uart1_RFIDResponse));
-  uart1_RFIDResponseTransmissionLength = 0;
-  uart1_RFIDResponseFinished = false;
 
   return output_power;
 }
 
 /*!
- *  @brief This is the function description
+ *  @brief Returns the command which sets the frequency band
+ *  @param freq: Frequency band 1 (US) ... 8 (VN)
+ *  @return const char*: The command or NULL if the band is not valid
  */
-void RFID_setFrequency(uint8_t freq)
+static const char *rfid_GetFrequencyCommand(uint8_t freq)
 {
   switch (freq)
   {
   case 1:
-    uart_fifo_fill(uart1, RFID_FREQ_US, sizeof(RFID_FREQ_US));
-    break;
+    return RFID_FREQ_US;
   case 2:
-    uart_fifo_fill(uart1, RFID_FREQ_TW, sizeof(RFID_FREQ_TW));
-    break;
+    return RFID_FREQ_TW;
   case 3:
-    uart_fifo_fill(uart1, RFID_FREQ_CN, sizeof(RFID_FREQ_CN));
-    break;
+    return RFID_FREQ_CN;
   case 4:
-    uart_fifo_fill(uart1, RFID_FREQ_CN2, sizeof(RFID_FREQ_CN2));
-    break;
+    return RFID_FREQ_CN2;
   case 5:
-    uart_fifo_fill(uart1, RFID_FREQ_EU, sizeof(RFID_FREQ_EU));
-    break;
+    return RFID_FREQ_EU;
   case 6:
-    uart_fifo_fill(uart1, RFID_FREQ_JP, sizeof(RFID_FREQ_JP));
-    break;
+    return RFID_FREQ_JP;
   case 7:
-    uart_fifo_fill(uart1, RFID_FREQ_KR, sizeof(RFID_FREQ_KR));
-    break;
+    return RFID_FREQ_KR;
   case 8:
-    uart_fifo_fill(uart1, RFID_FREQ_VN, sizeof(RFID_FREQ_VN));
-    break;
+    return RFID_FREQ_VN;
   default:
-    break;
+    return NULL;
   }
 }
 
 /*!
- *  @brief This is the function description
+ *  @brief Sets the frequency band of the RFID module. Returns without waiting, the acknowledge of the module is consumed by the
+ *  response parser.
+ *  @param freq: Frequency band 1 (US) ... 8 (VN)
  */
-uint8_t RFID_getFrequency(void)
+void RFID_setFrequency(uint8_t freq)
 {
-  volatile int8_t freq = 0;
-  char command[8];
-
-  System.RFID_TransparentMode = true;
-
-  // if (RFID_IsOn == false) {
-  //   config_RFID();
-  // }
-
-  RFID_IsOn = true;
-
-  uart1_RFIDResponseTransmissionLength = 0;
+  const char *command = rfid_GetFrequencyCommand(freq);
 
-  /* Build a command with \n and \r signs which is accepted by the RFID reader module */
-  strcpy(command, "\nN4,00\r");
-
-  /* Send command to RFID module and wait for a certain time for the response */
-  memset(uart1_RFIDResponse, '\0', sizeof(uart1_RFIDResponse));
-  uart_fifo_fill(uart1, command, sizeof(command) - 1);
-
-  /* Record uart input coming from rfid module for 1000 ms */
-  while (!uart1_RFIDResponseFinished)
+  if (command != NULL)
   {
+    rfid_Request(command, 'N', RFID_RESPONSE_TIMEOUT_MS, false, NULL);
   }
+}
 
-  System.RFID_TransparentMode = false;
+/*!
+ *  @brief Reads the frequency band of the RFID module
+ *  @return uint8_t: Frequency band 1 (US) ... 8 (VN), 0 if the module did not answer
+ */
+uint8_t RFID_getFrequency(void)
+{
+  int32_t freq = 0;
 
-  /* Decode string into number */
-  if (!strncmp(uart1_RFIDResponse, "N01", 3))
-  {
-    freq = 1;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N02", 3))
-  {
-    freq = 2;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N03", 3))
-  {
-    freq = 3;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N04", 3))
-  {
-    freq = 4;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N05", 3))
-  {
-    freq = 5;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N06", 3))
-  {
-    freq = 6;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N07", 3))
-  {
-    freq = 7;
-  }
-  else if (!strncmp(uart1_RFIDResponse, "N08", 3))
-  {
-    freq = 8;
-  }
-  else
+  RFID_IsOn = true;
+
+  if ((rfid_Request("\nN4,00\r", 'N', RFID_RESPONSE_TIMEOUT_MS, true, &freq) != 0) || (freq < 1) || (freq > 8))
   {
+    freq = 0;
   }
 
-  memset(uart1_RFIDResponse, '\0', sizeof(uart1_RFIDResponse));
-  uart1_RFIDResponseTransmissionLength = 0;
-  uart1_RFIDResponseFinished = false;
-
   return freq;
 }
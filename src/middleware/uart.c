@@ -12,144 +12,201 @@
  * @{*/
 #include "uart.h"
 
-struct uart_data_t
+struct uart1_tx_message
 {
-  void *fifo_reserved;
-  uint8_t data[UART1_BUFFERSIZE];
+  uint8_t data[UART1_TX_MESSAGE_SIZE];
   uint16_t len;
 };
 
-volatile char uart1_InputBuffer[UART1_BUFFERSIZE];
-volatile char uart1_RFIDResponse[UART1_BUFFERSIZE];
+/* Two rx buffers, while the UARTE fills one by DMA the driver requests the next one (double buffering) */
+static uint8_t uart1_rx_dma_buffer[2][UART1_RX_DMA_BUFFER_SIZE];
+static uint8_t uart1_rx_dma_buffer_next = 0;
 
-static char uart_buf[32];
-static K_FIFO_DEFINE(fifo_uart_tx_data);
+/* Commands wait in the queue until the previous transmission is done. uart_tx needs the buffer until UART_TX_DONE */
+K_MSGQ_DEFINE(uart1_tx_queue, sizeof(struct uart1_tx_message), UART1_TX_QUEUE_SIZE, 4);
+static struct uart1_tx_message uart1_tx_active;
+static atomic_t uart1_tx_busy = ATOMIC_INIT(0);
 
-void print_uart(char *buf);
+volatile uint32_t uart1_rx_errors = 0;
 
+/* Given for every received chunk, the RFID response parser waits on it */
+K_SEM_DEFINE(uart1_rx_sem, 0, 1);
+
+/* Single producer (uart1_cb), single consumer (rfid_thread) byte ring. The ISR is the only writer of the head index and the
+ * thread the only writer of the tail index, so no lock is needed. The indices run freely and are masked on access, the store of an
+ * index is a release which publishes the data written before, the load of the other index is an acquire. */
+static uint8_t uart1_rx_ring[UART1_RX_RING_SIZE];
+static uint32_t uart1_rx_ring_head = 0;
+static uint32_t uart1_rx_ring_tail = 0;
+volatile uint32_t uart1_rx_ring_overflows = 0;
 volatile uint8_t uart1_TransmissionReady = false;
-volatile uint16_t uart1_TransmissionLength = 0;
-volatile uint16_t uart1_RFIDResponseTransmissionLength = 0;
-volatile uint8_t uart1_RFIDResponseFinished = false;
-volatile uint8_t EPC_string_start = false;
-volatile uint8_t EPC_string_end = false;
 
 struct device *uart1 = DEVICE_DT_GET(DT_NODELABEL(uart1));
 
-#define MSG_SIZE 64
-
-/* receive buffer used in UART ISR callback */
-static char rx_buf[MSG_SIZE];
-
 /*!
- *  @brief This is the function description
+ *  @brief Appends received bytes to the rx ring. Called from the uart ISR only (producer side).
+ *  @param data: Pointer to the received bytes
+ *  @param length: Number of bytes
  */
-void uart1_cb(const struct device *rfid_module, struct uart_event *evt, void *user_data)
+static void uart1_RxRingWrite(const uint8_t *data, uint16_t length)
 {
+  uint32_t head = __atomic_load_n(&uart1_rx_ring_head, __ATOMIC_RELAXED);
+  uint32_t tail = __atomic_load_n(&uart1_rx_ring_tail, __ATOMIC_ACQUIRE);
+  uint16_t i = 0;
 
-  if (!uart_irq_update(rfid_module))
+  for (i = 0; i < length; i++)
   {
-    return;
+    if ((head - tail) >= UART1_RX_RING_SIZE)
+    {
+      /* Ring is full, the consumer is too slow. Drop the rest, the parser resynchronizes at the next <LF> */
+      uart1_rx_ring_overflows += (length - i);
+      break;
+    }
+
+    uart1_rx_ring[head & UART1_RX_RING_MASK] = data[i];
+    head++;
   }
 
-  if (!uart_irq_rx_ready(rfid_module))
+  __atomic_store_n(&uart1_rx_ring_head, head, __ATOMIC_RELEASE);
+}
+
+/*!
+ *  @brief Copies received bytes out of the rx ring (consumer side, must be called from one thread only)
+ *  @param data: Pointer to the destination buffer
+ *  @param length: Size of the destination buffer
+ *  @return uint16_t: Number of bytes copied
+ */
+uint16_t uart1_RxRingRead(uint8_t *data, uint16_t length)
+{
+  uint32_t tail = __atomic_load_n(&uart1_rx_ring_tail, __ATOMIC_RELAXED);
+  uint32_t head = __atomic_load_n(&uart1_rx_ring_head, __ATOMIC_ACQUIRE);
+  uint16_t count = 0;
+
+  while ((tail != head) && (count < length))
   {
-    return;
+    data[count++] = uart1_rx_ring[tail & UART1_RX_RING_MASK];
+    tail++;
   }
 
-  volatile int16_t data_length = 0;
-  /* ----------- RX handling --------------------------------------------------------- */
+  __atomic_store_n(&uart1_rx_ring_tail, tail, __ATOMIC_RELEASE);
+
+  return count;
+}
+
+/*!
+ *  @brief Returns the number of bytes waiting in the rx ring
+ */
+uint16_t uart1_RxRingAvailable(void)
+{
+  uint32_t head = __atomic_load_n(&uart1_rx_ring_head, __ATOMIC_ACQUIRE);
+  uint32_t tail = __atomic_load_n(&uart1_rx_ring_tail, __ATOMIC_RELAXED);
 
-  /* Received data */
-  data_length = uart_fifo_read(rfid_module, uart_buf, sizeof(uart_buf));
+  return (uint16_t)(head - tail);
+}
 
-  /* Append incoming byte-wise charackters to a full string to process it outside this ISR */
-  if (uart1_TransmissionLength < UART1_BUFFERSIZE)
+/*!
+ *  @brief Discards all bytes waiting in the rx ring (consumer side)
+ */
+void uart1_RxRingFlush(void)
+{
+  __atomic_store_n(&uart1_rx_ring_tail, __atomic_load_n(&uart1_rx_ring_head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+}
+
+/*!
+ *  @brief Starts the transmission of the next queued command if the UARTE is idle. Called from thread and ISR context.
+ */
+static void uart1_StartNextTransmission(void)
+{
+  if (atomic_cas(&uart1_tx_busy, 0, 1) == false)
   {
-    uart1_InputBuffer[uart1_TransmissionLength++] = uart_buf[0];
+    return; // A transmission is running, UART_TX_DONE starts the next one
   }
 
-  /* Fill input buffer, extract EPC tags from raw input buffer data */
-  if (System.RFID_TransparentMode == true && System.RFID_Sniff == false)
+  if (k_msgq_get(&uart1_tx_queue, &uart1_tx_active, K_NO_WAIT) != 0)
   {
-    if (uart_buf[0] != '\n' && uart_buf[0] != '\r')
-    {
-      uart1_RFIDResponse[uart1_RFIDResponseTransmissionLength++] = uart_buf[0]; // Append character to a full string
-    }
-
-    if (uart_buf[0] == '\r')
-    {
-      /* Print out raw data coming from rfid module */
-      uart1_RFIDResponseFinished = true;
-    }
+    atomic_clear(&uart1_tx_busy);
+    return;
   }
-  else if (System.RFID_TransparentMode == false && System.RFID_Sniff == true)
+
+  if (uart_tx(uart1, uart1_tx_active.data, uart1_tx_active.len, SYS_FOREVER_US) != 0)
   {
-    /* Echo received data at UART1 to console (UART0) */
-    if (suppress_rfid_command_charcaters == true)
-    {
-      if ((uart_buf[0] != 'U') && (uart_buf[0] != 'x')) // supress charackter 'U' and 'X' and 'CR'
-      {
-        if ((EPC_string_start == false) && (uart_buf[0] != 0x0D) && (uart_buf[0] != 0x0A))
-        {
-          EPC_string_start = true;
-          rfid_ok = true;
-        }
-
-        if ((EPC_string_start == true) && (uart_buf[0] == 0x0D))
-        {
-          EPC_string_start = false;
-          printk("\n");
-        }
-
-        if (EPC_string_start == true)
-        {
-          printk("%s", &uart_buf[0]);
-        }
-      }
-    }
-    else
-    {
-      printk("%s", &uart_buf[0]);
-    }
+    atomic_clear(&uart1_tx_busy);
   }
+}
 
-  /* ----------- TX handling --------------------------------------------------------- */
+/*!
+ *  @brief Queues a command for the RFID module and returns immediately. The data is copied, the caller's buffer can be reused.
+ *  @param data: Pointer to the data to send
+ *  @param length: Number of bytes, at most UART1_TX_MESSAGE_SIZE
+ *  @return int: 0 on success, -EINVAL if the data is too long, -ENOMEM if the tx queue is full
+ */
+int uart1_Transmit(const uint8_t *data, uint16_t length)
+{
+  struct uart1_tx_message message;
 
-  /* Data to send */
-  if (uart_irq_tx_ready(rfid_module))
+  if (length > UART1_TX_MESSAGE_SIZE)
   {
-    struct uart_data_t *buf = k_fifo_get(&fifo_uart_tx_data, K_NO_WAIT);
-    uint16_t written = 0;
+    return -EINVAL;
+  }
 
-    /* Nothing in the FIFO, nothing to send */
-    if (!buf)
-    {
-      uart_irq_tx_disable(rfid_module);
-      return;
-    }
+  memcpy(message.data, data, length);
+  message.len = length;
 
-    while (buf->len > written)
-    {
-      written += uart_fifo_fill(rfid_module, &buf->data[written], buf->len - written);
-    }
+  if (k_msgq_put(&uart1_tx_queue, &message, K_NO_WAIT) != 0)
+  {
+    return -ENOMEM;
+  }
 
-    while (!uart_irq_tx_complete(rfid_module))
-    {
-      /* Wait for the last byte to get shifted out of the module */
-    }
+  uart1_StartNextTransmission();
 
-    if (k_fifo_is_empty(&fifo_uart_tx_data))
-    {
-      uart_irq_tx_disable(rfid_module);
-    }
+  return 0;
+}
+
+/*!
+ *  @brief UART1 (RFID module) async event callback. Received DMA chunks are put into the rx ring, queued commands are sent one
+ *  after the other.
+ */
+void uart1_cb(const struct device *rfid_module, struct uart_event *evt, void *user_data)
+{
+  ARG_UNUSED(user_data);
 
-    free(buf);
+  switch (evt->type)
+  {
+  case UART_RX_RDY:
+    /* Bytes are reported when the buffer is full or the line was idle for UART1_RX_TIMEOUT_US */
+    /* The response parser consumes the bytes outside this callback */
+    uart1_RxRingWrite(&evt->data.rx.buf[evt->data.rx.offset], evt->data.rx.len);
+    k_sem_give(&uart1_rx_sem);
+    break;
+
+  case UART_RX_BUF_REQUEST:
+    uart_rx_buf_rsp(rfid_module, uart1_rx_dma_buffer[uart1_rx_dma_buffer_next], UART1_RX_DMA_BUFFER_SIZE);
+    uart1_rx_dma_buffer_next ^= 1;
+    break;
+
+  case UART_RX_STOPPED:
+    uart1_rx_errors++;
+    break;
+
+  case UART_RX_DISABLED:
+    /* Reception stops after an error or if no buffer was available, restart it */
+    uart1_rx_dma_buffer_next = 1;
+    uart_rx_enable(rfid_module, uart1_rx_dma_buffer[0], UART1_RX_DMA_BUFFER_SIZE, UART1_RX_TIMEOUT_US);
+    break;
+
+  case UART_TX_DONE:
+  case UART_TX_ABORTED:
+    atomic_clear(&uart1_tx_busy);
+    uart1_StartNextTransmission();
+    break;
+
+  default:
+    break;
   }
 }
 
 /*!
- *  @brief This is the function description
+ *  @brief Installs the async callback and starts the DMA reception of UART1 (RFID module)
  */
 void uart1_init(void)
 {
@@ -161,12 +218,17 @@ void uart1_init(void)
     return;
   }
 
-  ret = uart_irq_callback_user_data_set(uart1, uart1_cb, NULL);
+  ret = uart_callback_set(uart1, uart1_cb, NULL);
   if (ret)
   {
     printk("UART1 cant install uart1 callback\n\r");
     return;
   }
 
-  uart_irq_rx_enable(uart1);
-}
\ No newline at end of file
+  uart1_rx_dma_buffer_next = 1;
+  ret = uart_rx_enable(uart1, uart1_rx_dma_buffer[0], UART1_RX_DMA_BUFFER_SIZE, UART1_RX_TIMEOUT_US);
+  if (ret)
+  {
+    printk("UART1 cant enable reception\n\r");
+  }
+}
@@ -0,0 +1,309 @@
+/**
+ * @file test_datalog_codec.c
+ * @author Thomas Keilbach | keiltronic GmbH
+ * @date 17 Oct 2026
+ * @brief Host test of the compact data log frames (datalog_codec.h), every encoded sector has to decode to the original frames
+ * @version 2.0.0
+ */
+
+#include <stdio.h>
+#include "datalog_codec.h"
+
+#define SECTOR_LENGTH 4096     // Byte, one sector of the data log without its header
+#define SEQUENCE_FRAMES 200    // Frames of the keyframe and delta sequence
+#define FIRST_FRAME_NUMBER 4711UL
+
+static int failures = 0;
+static uint32_t random_state = 0x12345678UL;
+
+static void check(int condition, const char *name, const char *detail)
+{
+  printf("%-32s %-40s %s\n", name, detail, condition ? "ok" : "FAILED");
+
+  if (!condition)
+  {
+    failures++;
+  }
+}
+
+/* xorshift32, the same sequence on every run */
+static uint32_t test_Random(void)
+{
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state;
+}
+
+static void test_Epc(EPC_BINARY *epc, uint8_t length, uint32_t seed)
+{
+  uint8_t i = 0;
+
+  EPC_Clear(epc);
+  for (i = EPC_BINARY_LENGTH - length; i < EPC_BINARY_LENGTH; i++)
+  {
+    epc->bytes[i] = (uint8_t)(seed + i) | 0x01;
+  }
+}
+
+/**
+ * @brief Encodes the frames into one sector, decodes the sector again and compares all frames byte by byte
+ * @details The frame numbers of the expected frames are set from the first frame number, like the decoder numbers them
+ * @param frames: Frames to encode, frames with an rfid need rfid_reserved 0 (it is not stored)
+ * @param count: Number of frames
+ * @param max_length: Longest encoded frame of the sector
+ * @return int: 1 if all frames decoded to the original ones
+ */
+static int test_RoundTrip(LOGFRAME *frames, uint16_t count, uint16_t *max_length)
+{
+  static uint8_t sector[SECTOR_LENGTH];
+  DATALOG_CODEC codec;
+  LOGFRAME decoded;
+  uint16_t position = 0;
+  uint16_t length = 0;
+  int16_t consumed = 0;
+  uint16_t i = 0;
+
+  memset(sector, DATALOG_RECORD_ERASED, sizeof(sector));
+  *max_length = 0;
+
+  datalog_ResetCodec(&codec, FIRST_FRAME_NUMBER);
+  for (i = 0; i < count; i++)
+  {
+    frames[i].FrameNumber = FIRST_FRAME_NUMBER + i;
+
+    if ((position + DATALOG_RECORD_MAX_LENGTH) > SECTOR_LENGTH)
+    {
+      printf("  sector full after %d frames\n", i);
+      return 0;
+    }
+
+    length = datalog_EncodeFrame(&codec, &frames[i], &sector[position]);
+    position += length;
+    *max_length = (length > *max_length) ? length : *max_length;
+  }
+
+  datalog_ResetCodec(&codec, FIRST_FRAME_NUMBER);
+  position = 0;
+  for (i = 0; i < count; i++)
+  {
+    consumed = datalog_DecodeFrame(&codec, &sector[position], sizeof(sector) - position, &decoded);
+
+    if (consumed <= 0)
+    {
+      printf("  frame %d not decoded (%d)\n", i, consumed);
+      return 0;
+    }
+
+    if (memcmp(decoded.logging_frame, frames[i].logging_frame, DATALOG_FRAME_LENGTH) != 0)
+    {
+      printf("  frame %d differs\n", i);
+      return 0;
+    }
+
+    position += consumed;
+  }
+
+  /* The erased rest of the sector ends it */
+  return (datalog_DecodeFrame(&codec, &sector[position], sizeof(sector) - position, &decoded) == 0);
+}
+
+/* Keyframe followed by delta frames of a slowly moving mop with a tag now and then */
+static void test_Sequence(void)
+{
+  static LOGFRAME frames[SEQUENCE_FRAMES];
+  EPC_BINARY room;
+  uint16_t max_length = 0;
+  uint16_t i = 0;
+  uint8_t axis = 0;
+  char detail[48];
+
+  test_Epc(&room, 12, 0x30);
+  memset(frames, 0, sizeof(frames));
+
+  frames[0].unixtime = 1792224000UL;
+  frames[0].millisec = 990;
+  frames[0].Battery_voltage = 3950;
+  frames[0].ChargeCycle = 17;
+  frames[0].Input_status = 0x0041;
+
+  for (i = 0; i < SEQUENCE_FRAMES; i++)
+  {
+    if (i > 0)
+    {
+      frames[i] = frames[i - 1];
+      EPC_Clear(&frames[i].rfid_epc);
+      frames[i].rfid_record_type = 0;
+
+      /* 20 ms per sample, over the full second */
+      frames[i].millisec += 20;
+      if (frames[i].millisec >= 1000)
+      {
+        frames[i].millisec -= 1000;
+        frames[i].unixtime++;
+      }
+    }
+
+    for (axis = 0; axis < 9; axis++)
+    {
+      frames[i].raw_sens_value[axis] += (int16_t)((test_Random() % 201) - 100);
+    }
+
+    if ((i % 10) == 0)
+    {
+      frames[i].floor_handle_angle = 45.0f + (float)(test_Random() % 100) / 10.0f;
+      frames[i].frame_handle_angle = (float)(test_Random() % 3600) / 10.0f;
+    }
+    if ((i % 25) == 0)
+    {
+      frames[i].Mopping_speed += 0.05f;
+      frames[i].Coverage_per_Mop += 0.25f;
+      frames[i].Mop_cycles++;
+      frames[i].Total_Steps += 3;
+      frames[i].Mopping_pattern = (frames[i].Mopping_pattern + 1) % 4;
+      frames[i].Motion_state = 1;
+    }
+    if ((i % 30) == 5)
+    {
+      frames[i].rfid_epc = room;
+      frames[i].rfid_record_type = 3;
+    }
+    if (i == 120)
+    {
+      frames[i].Output_status ^= 0x0100;
+      frames[i].Error_status = 0x04;
+      frames[i].Battery_voltage -= 5;
+    }
+  }
+
+  snprintf(detail, sizeof(detail), "%d frames", SEQUENCE_FRAMES);
+  check(test_RoundTrip(frames, SEQUENCE_FRAMES, &max_length), "keyframe and delta frames", detail);
+
+  /* An unchanged frame is only the type and the empty mask */
+  memset(frames, 0, 2 * sizeof(LOGFRAME));
+  frames[0].unixtime = 1792224000UL;
+  frames[1] = frames[0];
+  check(test_RoundTrip(frames, 2, &max_length), "unchanged delta frame", "");
+}
+
+/* More epcs in a sector than the dictionary holds, the later ones are stored in full each time */
+static void test_EpcDictionary(void)
+{
+  static LOGFRAME frames[3 * (DATALOG_EPC_DICTIONARY_SIZE + 8)];
+  uint16_t count = 0;
+  uint16_t max_length = 0;
+  uint8_t round = 0;
+  uint8_t i = 0;
+  char detail[48];
+
+  memset(frames, 0, sizeof(frames));
+
+  /* Each epc three times, in rounds, so the dictionary is full before the epcs repeat */
+  for (round = 0; round < 3; round++)
+  {
+    for (i = 0; i < (DATALOG_EPC_DICTIONARY_SIZE + 8); i++)
+    {
+      frames[count].unixtime = 1792224000UL + count;
+      test_Epc(&frames[count].rfid_epc, 1 + (i % EPC_BINARY_LENGTH), 0x10 * i);
+      frames[count].rfid_record_type = i % 5;
+      count++;
+    }
+  }
+
+  snprintf(detail, sizeof(detail), "%d epcs, dictionary %d", DATALOG_EPC_DICTIONARY_SIZE + 8, DATALOG_EPC_DICTIONARY_SIZE);
+  check(test_RoundTrip(frames, count, &max_length), "epc dictionary overflow", detail);
+}
+
+/* Keyframe with every field changed and no compressible value, it has to fit DATALOG_RECORD_MAX_LENGTH */
+static void test_WorstCase(void)
+{
+  static LOGFRAME frames[2];
+  uint16_t max_length = 0;
+  uint8_t axis = 0;
+  char detail[48];
+
+  memset(frames, 0, sizeof(frames));
+
+  frames[0].unixtime = 0xFFFFFFFFUL;
+  frames[0].millisec = 999;
+  test_Epc(&frames[0].rfid_epc, EPC_BINARY_LENGTH, 0x80);
+  frames[0].rfid_record_type = 0xFF;
+  for (axis = 0; axis < 9; axis++)
+  {
+    frames[0].raw_sens_value[axis] = (axis % 2) ? INT16_MIN : INT16_MAX;
+  }
+  frames[0].floor_handle_angle = -1.0f;
+  frames[0].frame_handle_angle = 359.9f;
+  frames[0].Mopping_speed = 1e30f;
+  frames[0].Coverage_per_Mop = -1e-30f;
+  frames[0].Mop_cycles = UINT16_MAX;
+  frames[0].Mopping_pattern = 0xFF;
+  frames[0].Motion_state = 0xFF;
+  frames[0].Total_Steps = UINT16_MAX;
+  frames[0].Battery_voltage = UINT16_MAX;
+  frames[0].ChargeCycle = UINT16_MAX;
+  frames[0].Input_status = UINT16_MAX;
+  frames[0].Output_status = UINT16_MAX;
+  frames[0].Error_status = 0xFF;
+
+  /* Every value jumps to the other extreme */
+  frames[1].unixtime = 0;
+  frames[1].millisec = 0;
+  test_Epc(&frames[1].rfid_epc, EPC_BINARY_LENGTH, 0x81);
+  frames[1].rfid_record_type = 0x01;
+  for (axis = 0; axis < 9; axis++)
+  {
+    frames[1].raw_sens_value[axis] = (axis % 2) ? INT16_MAX : INT16_MIN;
+  }
+  frames[1].floor_handle_angle = 1.0f;
+  frames[1].frame_handle_angle = -359.9f;
+  frames[1].Mopping_speed = -1e30f;
+  frames[1].Coverage_per_Mop = 1e-30f;
+  frames[1].Mopping_pattern = 0x01;
+  frames[1].Motion_state = 0x02;
+  frames[1].Input_status = 0x5555;
+  frames[1].Output_status = 0xAAAA;
+  frames[1].Error_status = 0x7F;
+
+  check(test_RoundTrip(frames, 2, &max_length), "all fields changed", "");
+
+  snprintf(detail, sizeof(detail), "%d byte (limit %d)", max_length, DATALOG_RECORD_MAX_LENGTH);
+  check(max_length <= DATALOG_RECORD_MAX_LENGTH, "worst case length", detail);
+}
+
+/* Differences at the limits of the zigzag varints, forwards and backwards */
+static void test_ZigZag(void)
+{
+  static LOGFRAME frames[6];
+  uint16_t max_length = 0;
+  uint8_t i = 0;
+
+  memset(frames, 0, sizeof(frames));
+
+  for (i = 0; i < 6; i++)
+  {
+    frames[i].unixtime = (i % 2) ? 0xFFFFFFFFUL : 0;
+    frames[i].millisec = (i % 2) ? 999 : 0;
+    frames[i].raw_sens_value[0] = (i % 2) ? INT16_MIN : INT16_MAX;
+    frames[i].raw_sens_value[8] = (i % 2) ? INT16_MAX : INT16_MIN;
+    frames[i].raw_sens_value[4] = (i == 4) ? -1 : 0;
+    frames[i].Mop_cycles = (i % 2) ? 0 : UINT16_MAX;
+    frames[i].Total_Steps = (i % 2) ? UINT16_MAX : 0;
+    frames[i].Battery_voltage = (i % 2) ? 0 : UINT16_MAX;
+    frames[i].ChargeCycle = (i % 2) ? UINT16_MAX : 1;
+    frames[i].Input_status = (i % 2) ? 0x8000 : 0x0001;
+    frames[i].Output_status = (i % 2) ? 0x0001 : 0x8000;
+  }
+
+  check(test_RoundTrip(frames, 6, &max_length), "zigzag extremes", "");
+}
+
+int main(void)
+{
+  test_Sequence();
+  test_EpcDictionary();
+  test_WorstCase();
+  test_ZigZag();
+
+  return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+/**
+ * @file test_fastmath.c
+ * @author Thomas Keilbach | keiltronic GmbH
+ * @date 17 Oct 2026
+ * @brief Host test of the single precision math functions (fastmath.h) against the double precision libm reference
+ * @version 1.0.0
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "fastmath.h"
+
+#define ATAN2_MAX_ERROR 2e-5  // rad, documented bound of fmath_Atan2
+#define NORM_MAX_ERROR 1e-6   // Relative error of the float norms
+#define ANGLE_STEPS 100000
+
+static int failures = 0;
+
+static void check(int condition, const char *name, double error, double bound)
+{
+  printf("%-24s max error %.3g (bound %.3g) %s\n", name, error, bound, condition ? "ok" : "FAILED");
+
+  if (!condition)
+  {
+    failures++;
+  }
+}
+
+/* Sweeps the full circle at radii from the magnetometer scale up to the accelerometer lsb range */
+static void test_Atan2(void)
+{
+  const float radius[] = {1e-3f, 0.5f, 1.0f, 9.81f, 100.0f, 32768.0f, 1e6f};
+  double max_error = 0.0;
+  double error = 0.0;
+  double angle = 0.0;
+  float x = 0.0f;
+  float y = 0.0f;
+  unsigned int r = 0;
+  unsigned int i = 0;
+
+  for (r = 0; r < sizeof(radius) / sizeof(radius[0]); r++)
+  {
+    for (i = 0; i <= ANGLE_STEPS; i++)
+    {
+      angle = -M_PI + (2.0 * M_PI * i) / ANGLE_STEPS;
+      x = (float)(radius[r] * cos(angle));
+      y = (float)(radius[r] * sin(angle));
+
+      error = fabs((double)fmath_Atan2(y, x) - atan2((double)y, (double)x));
+
+      /* -PI and PI are the same direction */
+      if (error > M_PI)
+      {
+        error = fabs(error - 2.0 * M_PI);
+      }
+
+      if (error > max_error)
+      {
+        max_error = error;
+      }
+    }
+  }
+
+  /* Axes and the origin */
+  check((fmath_Atan2(0.0f, 0.0f) == 0.0f) && (fabs(fmath_Atan2(1.0f, 0.0f) - M_PI_2) < ATAN2_MAX_ERROR) &&
+            (fabs(fmath_Atan2(-1.0f, 0.0f) + M_PI_2) < ATAN2_MAX_ERROR) && (fmath_Atan2(0.0f, 1.0f) == 0.0f) &&
+            (fabs(fmath_Atan2(0.0f, -1.0f) - M_PI) < ATAN2_MAX_ERROR),
+        "fmath_Atan2 axes", 0.0, ATAN2_MAX_ERROR);
+
+  check(max_error <= ATAN2_MAX_ERROR, "fmath_Atan2 sweep", max_error, ATAN2_MAX_ERROR);
+}
+
+static void test_Norm(void)
+{
+  double max_error2 = 0.0;
+  double max_error3 = 0.0;
+  double max_error_vector = 0.0;
+  float vector[3];
+  double reference = 0.0;
+  double error = 0.0;
+  float x = 0.0f;
+  float y = 0.0f;
+  float z = 0.0f;
+  int i = 0;
+  int j = 0;
+
+  /* Raw sensor values and scaled values in m/s^2 and uT */
+  for (i = -32768; i <= 32767; i += 97)
+  {
+    for (j = -32768; j <= 32767; j += 1013)
+    {
+      x = (float)i;
+      y = (float)j * 0.01f;
+      z = (float)(i ^ j) * 0.5f;
+
+      reference = sqrt((double)x * x + (double)y * y);
+      if (reference > 0.0)
+      {
+        error = fabs((double)fmath_Norm2(x, y) - reference) / reference;
+        max_error2 = (error > max_error2) ? error : max_error2;
+      }
+
+      reference = sqrt((double)x * x + (double)y * y + (double)z * z);
+      if (reference > 0.0)
+      {
+        error = fabs((double)fmath_Norm3(x, y, z) - reference) / reference;
+        max_error3 = (error > max_error3) ? error : max_error3;
+
+        vector[0] = x;
+        vector[1] = y;
+        vector[2] = z;
+        error = fabs((double)fmath_Norm(vector, 3) - reference) / reference;
+        max_error_vector = (error > max_error_vector) ? error : max_error_vector;
+      }
+    }
+  }
+
+  check((fmath_Norm2(0.0f, 0.0f) == 0.0f) && (fmath_Norm3(0.0f, 0.0f, 0.0f) == 0.0f), "fmath_Norm zero", 0.0, 0.0);
+  check(max_error2 <= NORM_MAX_ERROR, "fmath_Norm2 sweep", max_error2, NORM_MAX_ERROR);
+  check(max_error3 <= NORM_MAX_ERROR, "fmath_Norm3 sweep", max_error3, NORM_MAX_ERROR);
+  check(max_error_vector <= NORM_MAX_ERROR, "fmath_Norm sweep", max_error_vector, NORM_MAX_ERROR);
+}
+
+/* The FIR low pass filter of the algorithm on sensor like signals, the error is relative to the sum of the absolute products */
+static void test_Dot(void)
+{
+  const float coefficients[8] = {1.0f / 16.0f, 2.0f / 16.0f, 3.0f / 16.0f, 4.0f / 16.0f, 3.0f / 16.0f, 2.0f / 16.0f, 0.0f, 1.0f / 16.0f};
+  float samples[8];
+  double max_error = 0.0;
+  double reference = 0.0;
+  double magnitude = 0.0;
+  double error = 0.0;
+  int i = 0;
+  int k = 0;
+
+  for (i = 0; i < 100000; i++)
+  {
+    reference = 0.0;
+    magnitude = 0.0;
+    for (k = 0; k < 8; k++)
+    {
+      samples[k] = (float)(((i * 7919 + k * 104729) % 65536) - 32768) * 0.01f;
+      reference += (double)samples[k] * coefficients[k];
+      magnitude += fabs((double)samples[k] * coefficients[k]);
+    }
+
+    if (magnitude > 0.0)
+    {
+      error = fabs((double)fmath_Dot(samples, coefficients, 8) - reference) / magnitude;
+      max_error = (error > max_error) ? error : max_error;
+    }
+  }
+
+  check((fmath_Dot(samples, coefficients, 0) == 0.0f) && (fmath_Norm(samples, 0) == 0.0f), "fmath_Dot empty", 0.0, 0.0);
+  check(max_error <= NORM_MAX_ERROR, "fmath_Dot filter", max_error, NORM_MAX_ERROR);
+}
+
+int main(void)
+{
+  test_Atan2();
+  test_Norm();
+  test_Dot();
+
+  return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,557 @@
+/**
+ * @file datalog_receive.c
+ * @author Thomas Keilbach | keiltronic GmbH
+ * @date 17 Oct 2026
+ * @brief Linux receiver of the binary data log export (datalog export, protocol see include/datalog_export.h). The received
+ * sectors are stored in a sector image and decoded into a csv file with one column per field.
+ *
+ * Build:   gcc -O2 -Iinclude -o datalog_receive tools/datalog_receive.c src/flash/datalog_codec.c
+ *
+ * Receive: datalog_receive -d /dev/ttyACM0 [-b 115200] [-s <sector>] [-i log.bin] [-o log.csv]
+ *          Starts the export at the device. A lost or corrupted frame starts the export again with the sector which was not
+ *          received completely. The files are appended, so an interrupted export is continued with -s <next sector> (printed
+ *          when the receiver stops).
+ *
+ * Convert: datalog_receive -r log.bin [-o log.csv]
+ *          Decodes a sector image again.
+ * @version 2.0.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <poll.h>
+#include "datalog_codec.h"
+
+/* See include/datalog_export.h */
+#define EXPORT_SYNC_1 0xA5
+#define EXPORT_SYNC_2 0x5A
+#define EXPORT_HEADER_LENGTH 5
+#define EXPORT_DATA_HEADER_LENGTH 6
+#define EXPORT_MAX_PAYLOAD (EXPORT_DATA_HEADER_LENGTH + 1024)
+#define EXPORT_FRAME_INFO 0x11
+#define EXPORT_FRAME_DATA 0x12
+#define EXPORT_FRAME_SECTOR 0x13
+#define EXPORT_FRAME_END 0x14
+
+#define SECTOR_SIZE 4096      // FLASH_SUBSUBSECTOR_SIZE
+#define RECEIVE_TIMEOUT 5000  // ms without a valid frame until the export is requested again
+
+typedef enum
+{
+  PARSER_SYNC_1 = 0,
+  PARSER_SYNC_2,
+  PARSER_HEADER,
+  PARSER_PAYLOAD
+} PARSER_STATE;
+
+typedef struct
+{
+  PARSER_STATE state;
+  uint8_t frame[EXPORT_HEADER_LENGTH + EXPORT_MAX_PAYLOAD + sizeof(uint32_t)];
+  uint16_t position;
+  uint16_t length; // Bytes of the frame behind the sync bytes
+} PARSER;
+
+static int serial = -1;
+static FILE *image_file = NULL;
+static FILE *csv_file = NULL;
+static uint32_t exported_frames = 0;
+
+static uint32_t get_le32(const uint8_t *data)
+{
+  return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static uint16_t get_le16(const uint8_t *data)
+{
+  return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+/* CRC32 (IEEE), the same as crc32_ieee() of Zephyr */
+static uint32_t crc32_ieee(const uint8_t *data, size_t length)
+{
+  uint32_t crc = 0xFFFFFFFFUL;
+  uint8_t bit = 0;
+
+  while (length--)
+  {
+    crc ^= *data++;
+
+    for (bit = 0; bit < 8; bit++)
+    {
+      crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1)));
+    }
+  }
+
+  return ~crc;
+}
+
+static void csv_PrintHeader(void)
+{
+  fprintf(csv_file, "frame;unixtime_ms;epc;record_type;acc_x;acc_y;acc_z;gyro_x;gyro_y;gyro_z;mag_x;mag_y;mag_z;"
+                    "floor_handle_angle;frame_handle_angle;mopping_speed;coverage_per_mop;mop_cycles;mopping_pattern;motion_state;"
+                    "total_steps;battery_voltage;charge_cycle;input_status;output_status;error_status\n");
+}
+
+static void csv_PrintFrame(const LOGFRAME *frame)
+{
+  uint8_t i = 0;
+
+  fprintf(csv_file, "%u;%llu;", frame->FrameNumber, (unsigned long long)frame->unixtime * 1000ULL + frame->millisec);
+
+  for (i = 0; i < EPC_BINARY_LENGTH; i++)
+  {
+    fprintf(csv_file, "%02X", frame->rfid_epc.bytes[i]);
+  }
+
+  fprintf(csv_file, ";%u;", frame->rfid_record_type);
+
+  for (i = 0; i < 9; i++)
+  {
+    fprintf(csv_file, "%d;", frame->raw_sens_value[i]);
+  }
+
+  fprintf(csv_file, "%.2f;%.2f;%.2f;%.2f;%u;%u;%u;%u;%u;%u;%u;%u;%u\n",
+          frame->floor_handle_angle,
+          frame->frame_handle_angle,
+          frame->Mopping_speed,
+          frame->Coverage_per_Mop,
+          frame->Mop_cycles,
+          frame->Mopping_pattern,
+          frame->Motion_state,
+          frame->Total_Steps,
+          frame->Battery_voltage,
+          frame->ChargeCycle,
+          frame->Input_status,
+          frame->Output_status,
+          frame->Error_status);
+}
+
+/* Decodes all frames of a sector into the csv file, returns false if the sector has no valid header */
+static bool sector_Decode(const uint8_t *sector)
+{
+  DATALOG_SECTOR_HEADER header;
+  DATALOG_CODEC codec;
+  LOGFRAME frame;
+  uint16_t offset = sizeof(DATALOG_SECTOR_HEADER);
+  int16_t consumed = 0;
+
+  memcpy(&header, sector, sizeof(header));
+
+  if ((header.Version != DATALOG_FORMAT_VERSION) || (header.FirstFrameNumber == 0xFFFFFFFFUL))
+  {
+    return false;
+  }
+
+  datalog_ResetCodec(&codec, header.FirstFrameNumber);
+
+  while (offset < SECTOR_SIZE)
+  {
+    consumed = datalog_DecodeFrame(&codec, &sector[offset], SECTOR_SIZE - offset, &frame);
+
+    if (consumed <= 0)
+    {
+      break;
+    }
+
+    csv_PrintFrame(&frame);
+    offset += consumed;
+    exported_frames++;
+  }
+
+  return true;
+}
+
+static int convert_Image(const char *path)
+{
+  uint8_t sector[SECTOR_SIZE];
+  FILE *file = fopen(path, "rb");
+  uint32_t count = 0;
+
+  if (file == NULL)
+  {
+    perror(path);
+    return 1;
+  }
+
+  while (fread(sector, 1, SECTOR_SIZE, file) == SECTOR_SIZE)
+  {
+    if (sector_Decode(sector) == true)
+    {
+      count++;
+    }
+  }
+
+  fclose(file);
+  fprintf(stderr, "%u sectors, %u frames\n", count, exported_frames);
+
+  return 0;
+}
+
+static speed_t serial_Speed(long baudrate)
+{
+  switch (baudrate)
+  {
+  case 9600:
+    return B9600;
+  case 38400:
+    return B38400;
+  case 57600:
+    return B57600;
+  case 230400:
+    return B230400;
+  case 460800:
+    return B460800;
+  case 921600:
+    return B921600;
+  case 1000000:
+    return B1000000;
+  default:
+    return B115200;
+  }
+}
+
+static int serial_Open(const char *path, long baudrate)
+{
+  struct termios tty;
+  int fd = open(path, O_RDWR | O_NOCTTY);
+
+  if (fd < 0)
+  {
+    perror(path);
+    return -1;
+  }
+
+  if (tcgetattr(fd, &tty) != 0)
+  {
+    perror("tcgetattr");
+    close(fd);
+    return -1;
+  }
+
+  cfmakeraw(&tty);
+  cfsetispeed(&tty, serial_Speed(baudrate));
+  cfsetospeed(&tty, serial_Speed(baudrate));
+  tty.c_cflag |= CLOCAL | CREAD;
+  tty.c_cc[VMIN] = 0;
+  tty.c_cc[VTIME] = 0;
+
+  if (tcsetattr(fd, TCSANOW, &tty) != 0)
+  {
+    perror("tcsetattr");
+    close(fd);
+    return -1;
+  }
+
+  tcflush(fd, TCIOFLUSH);
+
+  return fd;
+}
+
+static void export_Request(uint32_t sector)
+{
+  char command[48];
+  int length = snprintf(command, sizeof(command), "\rdatalog export %u\r", sector);
+
+  if (write(serial, command, length) != length)
+  {
+    perror("write");
+  }
+}
+
+/* Returns true when a complete frame with a valid CRC is in the parser */
+static bool parser_Put(PARSER *parser, uint8_t byte, bool *crc_error)
+{
+  uint32_t crc = 0UL;
+
+  switch (parser->state)
+  {
+  case PARSER_SYNC_1:
+    if (byte == EXPORT_SYNC_1)
+    {
+      parser->state = PARSER_SYNC_2;
+    }
+    break;
+
+  case PARSER_SYNC_2:
+    parser->position = 0;
+    parser->state = (byte == EXPORT_SYNC_2) ? PARSER_HEADER : ((byte == EXPORT_SYNC_1) ? PARSER_SYNC_2 : PARSER_SYNC_1);
+    break;
+
+  case PARSER_HEADER:
+    parser->frame[parser->position++] = byte;
+
+    if (parser->position == EXPORT_HEADER_LENGTH)
+    {
+      parser->length = get_le16(&parser->frame[3]);
+
+      if (parser->length > EXPORT_MAX_PAYLOAD)
+      {
+        *crc_error = true;
+        parser->state = PARSER_SYNC_1;
+        break;
+      }
+
+      parser->length += EXPORT_HEADER_LENGTH + sizeof(uint32_t);
+      parser->state = PARSER_PAYLOAD;
+    }
+    break;
+
+  case PARSER_PAYLOAD:
+    parser->frame[parser->position++] = byte;
+
+    if (parser->position == parser->length)
+    {
+      parser->state = PARSER_SYNC_1;
+      crc = crc32_ieee(parser->frame, parser->length - sizeof(uint32_t));
+
+      if (crc == get_le32(&parser->frame[parser->length - sizeof(uint32_t)]))
+      {
+        return true;
+      }
+
+      *crc_error = true;
+    }
+    break;
+  }
+
+  return false;
+}
+
+static int export_Receive(uint32_t sector)
+{
+  PARSER parser = {.state = PARSER_SYNC_1};
+  uint8_t data[4096];
+  uint8_t buffer[SECTOR_SIZE];
+  uint32_t buffer_sector = 0xFFFFFFFFUL;
+  uint32_t end_sector = 0UL;
+  uint32_t resumes = 0;
+  uint16_t expected_sequence = 0;
+  bool wait_for_info = true;
+  bool crc_error = false;
+  bool done = false;
+  struct pollfd poll_fd = {.fd = serial, .events = POLLIN};
+  ssize_t received = 0;
+  ssize_t i = 0;
+  uint8_t *payload = &parser.frame[EXPORT_HEADER_LENGTH];
+
+  export_Request(sector);
+
+  while (done == false)
+  {
+    if (poll(&poll_fd, 1, RECEIVE_TIMEOUT) <= 0)
+    {
+      fprintf(stderr, "\nTimeout, export again from sector %u\n", sector);
+      export_Request(sector);
+      wait_for_info = true;
+      resumes++;
+      continue;
+    }
+
+    received = read(serial, data, sizeof(data));
+
+    for (i = 0; (i < received) && (done == false); i++)
+    {
+      crc_error = false;
+
+      if (parser_Put(&parser, data[i], &crc_error) == false)
+      {
+        if ((crc_error == true) && (wait_for_info == false))
+        {
+          fprintf(stderr, "\nCRC error, export again from sector %u\n", sector);
+          export_Request(sector);
+          wait_for_info = true;
+          resumes++;
+        }
+        continue;
+      }
+
+      /* Frames of the export which was stopped are dropped until the new one starts */
+      if (wait_for_info == true)
+      {
+        if ((parser.frame[0] != EXPORT_FRAME_INFO) || (get_le16(&parser.frame[1]) != 0))
+        {
+          continue;
+        }
+        wait_for_info = false;
+        expected_sequence = 0;
+      }
+
+      if (get_le16(&parser.frame[1]) != expected_sequence)
+      {
+        fprintf(stderr, "\nFrame %u missing, export again from sector %u\n", expected_sequence, sector);
+        export_Request(sector);
+        wait_for_info = true;
+        resumes++;
+        continue;
+      }
+      expected_sequence++;
+
+      switch (parser.frame[0])
+      {
+      case EXPORT_FRAME_INFO:
+        if (payload[0] != DATALOG_FORMAT_VERSION)
+        {
+          fprintf(stderr, "Unsupported format version %u\n", payload[0]);
+          return 1;
+        }
+
+        end_sector = get_le32(&payload[5]);
+        if (get_le32(&payload[1]) > sector)
+        {
+          fprintf(stderr, "Sectors %u to %u were overwritten already\n", sector, get_le32(&payload[1]) - 1);
+        }
+        fprintf(stderr, "Export of sectors %u to %u (frames %u to %u)\n", get_le32(&payload[1]), end_sector, get_le32(&payload[9]), get_le32(&payload[13]));
+        break;
+
+      case EXPORT_FRAME_DATA:
+        /* A frame without the data header or with data beyond the sector is handled like a corrupted frame */
+        if ((get_le16(&parser.frame[3]) < EXPORT_DATA_HEADER_LENGTH) ||
+            (((uint32_t)get_le16(&payload[4]) + get_le16(&parser.frame[3]) - EXPORT_DATA_HEADER_LENGTH) > SECTOR_SIZE))
+        {
+          fprintf(stderr, "\nInvalid data frame, export again from sector %u\n", sector);
+          export_Request(sector);
+          wait_for_info = true;
+          resumes++;
+          break;
+        }
+
+        if (get_le32(&payload[0]) != buffer_sector)
+        {
+          buffer_sector = get_le32(&payload[0]);
+          memset(buffer, 0xFF, sizeof(buffer));
+        }
+
+        memcpy(&buffer[get_le16(&payload[4])], &payload[EXPORT_DATA_HEADER_LENGTH], get_le16(&parser.frame[3]) - EXPORT_DATA_HEADER_LENGTH);
+        break;
+
+      case EXPORT_FRAME_SECTOR:
+        if (get_le32(&payload[0]) == buffer_sector)
+        {
+          fwrite(buffer, 1, SECTOR_SIZE, image_file);
+          sector_Decode(buffer);
+          fflush(image_file);
+          fflush(csv_file);
+        }
+
+        buffer_sector = 0xFFFFFFFFUL;
+        sector = get_le32(&payload[0]) + 1;
+        fprintf(stderr, "\rSector %u of %u, %u frames", sector, end_sector, exported_frames);
+        break;
+
+      case EXPORT_FRAME_END:
+        sector = get_le32(&payload[0]);
+        done = true;
+        break;
+
+      default:
+        break;
+      }
+    }
+  }
+
+  fprintf(stderr, "\n%u frames, %u resumes. Next sector: %u\n", exported_frames, resumes, sector);
+
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  const char *device = NULL;
+  const char *image_path = "datalog.bin";
+  const char *csv_path = NULL;
+  const char *convert_path = NULL;
+  long baudrate = 115200;
+  uint32_t sector = 0;
+  bool csv_exists = false;
+  int option = 0;
+  int result = 0;
+
+  while ((option = getopt(argc, argv, "d:b:s:i:o:r:")) != -1)
+  {
+    switch (option)
+    {
+    case 'd':
+      device = optarg;
+      break;
+    case 'b':
+      baudrate = strtol(optarg, NULL, 10);
+      break;
+    case 's':
+      sector = strtoul(optarg, NULL, 10);
+      break;
+    case 'i':
+      image_path = optarg;
+      break;
+    case 'o':
+      csv_path = optarg;
+      break;
+    case 'r':
+      convert_path = optarg;
+      break;
+    default:
+      fprintf(stderr, "Usage: %s -d <serial device> [-b <baudrate>] [-s <sector>] [-i <image>] [-o <csv>]\n"
+                      "       %s -r <image> [-o <csv>]\n", argv[0], argv[0]);
+      return 1;
+    }
+  }
+
+  if (csv_path != NULL)
+  {
+    csv_exists = (access(csv_path, F_OK) == 0);
+    csv_file = fopen(csv_path, (convert_path != NULL) ? "w" : "a");
+
+    if (csv_file == NULL)
+    {
+      perror(csv_path);
+      return 1;
+    }
+  }
+  else
+  {
+    csv_file = stdout;
+  }
+
+  if ((convert_path != NULL) || (csv_exists == false))
+  {
+    csv_PrintHeader();
+  }
+
+  if (convert_path != NULL)
+  {
+    result = convert_Image(convert_path);
+  }
+  else if (device != NULL)
+  {
+    serial = serial_Open(device, baudrate);
+    image_file = fopen(image_path, "ab");
+
+    if ((serial < 0) || (image_file == NULL))
+    {
+      return 1;
+    }
+
+    result = export_Receive(sector);
+
+    fclose(image_file);
+    close(serial);
+  }
+  else
+  {
+    fprintf(stderr, "No serial device or image given\n");
+    result = 1;
+  }
+
+  if (csv_file != stdout)
+  {
+    fclose(csv_file);
+  }
+
+  return result;
+}
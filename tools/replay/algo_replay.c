@@ -0,0 +1,646 @@
+/**
+ * @file algo_replay.c
+ * @author Thomas Keilbach | keiltronic GmbH
+ * @date 17 Oct 2026
+ * @brief Linux replay of logged frames through the motion algorithm of the firmware (src/logic/algorithms.c). The raw imu
+ * values, the motion flag and the mop tags of each frame are fed into algorithm_execute_process() like on the device, the
+ * decisions of the algorithm (events, notifications, rfid switching) and its outputs are written out.
+ *
+ * Build:  make -C tools/replay
+ *
+ * Replay: algo_replay [-f image|frames|csv] [-o out.csv] [-v] <log>
+ *         <log> is a sector image of datalog_receive (-i), a csv of datalog_receive or of the shell command datalog read, or
+ *         a file of 128 byte LOGFRAMEs (format version 1). The format is detected if -f is not given. The shell csv has the
+ *         acceleration and the rotation rate with two decimals, they are converted back to raw values. Decisions are written
+ *         to stdout as "frame;unixtime_ms;decision", the algorithm outputs of each frame to out.csv and a comparison with the
+ *         logged outputs to stderr. -v also writes the shell output of the algorithm.
+ *
+ * Bench:  algo_replay -b [-n <loops>] <log>
+ *         algo_replay -b [-n <loops>] -g <seconds>
+ *         Runs all frames n times without output and prints the samples per second and the cycles per sample which
+ *         algo_benchmark_Execute() measured (time stamp counter of the host). -g generates a synthetic mopping motion of the
+ *         given length instead of reading a log.
+ * @version 2.0.0
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <unistd.h>
+#include "hal_shim.h"
+
+#define SECTOR_SIZE 4096     // FLASH_SUBSUBSECTOR_SIZE
+#define CSV_FIELDS 26        // Columns of both csv formats
+#define CSV_LINE_LENGTH 512
+
+typedef enum
+{
+  FORMAT_UNKNOWN = 0,
+  FORMAT_IMAGE,
+  FORMAT_FRAMES,
+  FORMAT_CSV
+} FORMAT;
+
+static LOGFRAME *frames = NULL;
+static uint32_t frame_count = 0;
+static uint32_t frame_capacity = 0;
+static bool frames_logged = true; // false for generated frames, which have no logged outputs to compare with
+
+static FILE *output_file = NULL;
+static int64_t last_rfid_read = 0LL;
+
+/* Differences between the replayed and the logged outputs */
+static float max_floor_angle_difference = 0.0f;
+static float max_frame_angle_difference = 0.0f;
+static uint32_t pattern_differences = 0;
+static uint32_t motion_differences = 0;
+
+static bool frames_Add(const LOGFRAME *frame)
+{
+  LOGFRAME *grown = NULL;
+
+  if (frame_count == frame_capacity)
+  {
+    frame_capacity = (frame_capacity == 0) ? 4096 : (2 * frame_capacity);
+    grown = realloc(frames, frame_capacity * sizeof(LOGFRAME));
+
+    if (grown == NULL)
+    {
+      fprintf(stderr, "Out of memory\n");
+      return false;
+    }
+
+    frames = grown;
+  }
+
+  frames[frame_count++] = *frame;
+  return true;
+}
+
+/* Decodes the sectors of a datalog_receive image, sectors without a valid header are skipped */
+static bool frames_LoadImage(FILE *file)
+{
+  uint8_t sector[SECTOR_SIZE];
+  DATALOG_SECTOR_HEADER header;
+  DATALOG_CODEC codec;
+  LOGFRAME frame;
+  uint16_t offset = 0;
+  int16_t consumed = 0;
+
+  while (fread(sector, 1, SECTOR_SIZE, file) == SECTOR_SIZE)
+  {
+    memcpy(&header, sector, sizeof(header));
+
+    if ((header.Version != DATALOG_FORMAT_VERSION) || (header.FirstFrameNumber == 0xFFFFFFFFUL))
+    {
+      continue;
+    }
+
+    datalog_ResetCodec(&codec, header.FirstFrameNumber);
+
+    for (offset = sizeof(DATALOG_SECTOR_HEADER); offset < SECTOR_SIZE; offset += consumed)
+    {
+      consumed = datalog_DecodeFrame(&codec, &sector[offset], SECTOR_SIZE - offset, &frame);
+
+      if ((consumed <= 0) || (frames_Add(&frame) == false))
+      {
+        break;
+      }
+    }
+  }
+
+  return true;
+}
+
+static bool frames_LoadRaw(FILE *file)
+{
+  LOGFRAME frame;
+
+  while (fread(&frame, 1, sizeof(frame), file) == sizeof(frame))
+  {
+    /* Erased frames of the flash */
+    if (frame.FrameNumber == 0xFFFFFFFFUL)
+    {
+      continue;
+    }
+
+    if (frames_Add(&frame) == false)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static int16_t csv_Raw(double value, double lsb_per_unit)
+{
+  double raw = round(value * lsb_per_unit);
+
+  return (int16_t)((raw > INT16_MAX) ? INT16_MAX : ((raw < INT16_MIN) ? INT16_MIN : raw));
+}
+
+/**
+ * @brief Parses one line of the csv of datalog_receive (raw imu values) or of datalog read (imu values in m/s^2 and dps)
+ *
+ * @return true if the line is a frame, false for the header and the other output of the shell
+ */
+static bool csv_ParseLine(char *line, bool raw, LOGFRAME *frame)
+{
+  char *fields[CSV_FIELDS];
+  char *end = NULL;
+  uint8_t count = 0;
+  uint8_t i = 0;
+  long long unixtime_ms = 0LL;
+
+  fields[count++] = line;
+
+  while ((line = strchr(line, ';')) != NULL)
+  {
+    *line++ = '\0';
+
+    if (count == CSV_FIELDS)
+    {
+      break;
+    }
+
+    fields[count++] = line;
+  }
+
+  if (count < CSV_FIELDS)
+  {
+    return false;
+  }
+
+  memset(frame, 0, sizeof(LOGFRAME));
+
+  frame->FrameNumber = strtoul(fields[0], &end, 10);
+
+  if ((end == fields[0]) || (*end != '\0'))
+  {
+    return false;
+  }
+
+  unixtime_ms = strtoll(fields[1], NULL, 10);
+  frame->unixtime = (uint32_t)(unixtime_ms / 1000LL);
+  frame->millisec = (uint16_t)(unixtime_ms % 1000LL);
+
+  if (strcmp(fields[2], "0") != 0)
+  {
+    EPC_FromHexString(fields[2], strlen(fields[2]), &frame->rfid_epc);
+  }
+
+  frame->rfid_record_type = (uint8_t)strtoul(fields[3], NULL, 10);
+
+  for (i = 0; i < 9; i++)
+  {
+    if ((raw == true) || (i >= 6))
+    {
+      frame->raw_sens_value[i] = (int16_t)strtol(fields[4 + i], NULL, 10);
+    }
+    else if (i < 3)
+    {
+      frame->raw_sens_value[i] = csv_Raw(strtod(fields[4 + i], NULL), 32768.0 / (2.0 * GRAVITY_EARTH));
+    }
+    else
+    {
+      frame->raw_sens_value[i] = csv_Raw(strtod(fields[4 + i], NULL), 32768.0 / 2000.0);
+    }
+  }
+
+  frame->floor_handle_angle = strtof(fields[13], NULL);
+  frame->frame_handle_angle = strtof(fields[14], NULL);
+  frame->Mopping_speed = strtof(fields[15], NULL);
+  frame->Coverage_per_Mop = strtof(fields[16], NULL);
+  frame->Mop_cycles = (uint16_t)strtoul(fields[17], NULL, 10);
+  frame->Mopping_pattern = (uint8_t)strtoul(fields[18], NULL, 10);
+  frame->Motion_state = (uint8_t)strtoul(fields[19], NULL, 10);
+  frame->Total_Steps = (uint16_t)strtoul(fields[20], NULL, 10);
+  frame->Battery_voltage = (uint16_t)strtoul(fields[21], NULL, 10);
+  frame->ChargeCycle = (uint16_t)strtoul(fields[22], NULL, 10);
+  frame->Input_status = (uint16_t)strtoul(fields[23], NULL, 10);
+  frame->Output_status = (uint16_t)strtoul(fields[24], NULL, 10);
+  frame->Error_status = (uint8_t)strtoul(fields[25], NULL, 10);
+
+  return true;
+}
+
+static bool frames_LoadCsv(FILE *file)
+{
+  char line[CSV_LINE_LENGTH];
+  LOGFRAME frame;
+  bool raw = false;
+
+  while (fgets(line, sizeof(line), file) != NULL)
+  {
+    line[strcspn(line, "\r\n")] = '\0';
+
+    /* Only the csv of datalog_receive has a header, it has the raw imu values */
+    if (strncmp(line, "frame;unixtime_ms;", 18) == 0)
+    {
+      raw = true;
+      continue;
+    }
+
+    if ((csv_ParseLine(line, raw, &frame) == true) && (frames_Add(&frame) == false))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static FORMAT frames_DetectFormat(const char *path, FILE *file)
+{
+  uint8_t data[SECTOR_SIZE];
+  DATALOG_SECTOR_HEADER header;
+  size_t length = fread(data, 1, sizeof(data), file);
+  size_t i = 0;
+
+  rewind(file);
+
+  if ((strlen(path) > 4) && (strcmp(&path[strlen(path) - 4], ".csv") == 0))
+  {
+    return FORMAT_CSV;
+  }
+
+  memcpy(&header, data, sizeof(header));
+
+  if ((length == SECTOR_SIZE) && (header.Version == DATALOG_FORMAT_VERSION) && (header.FirstFrameNumber != 0xFFFFFFFFUL))
+  {
+    return FORMAT_IMAGE;
+  }
+
+  for (i = 0; i < length; i++)
+  {
+    if ((data[i] != '\r') && (data[i] != '\n') && (data[i] != '\t') && ((data[i] < 0x20) || (data[i] > 0x7E)))
+    {
+      return ((length % sizeof(LOGFRAME)) == 0) ? FORMAT_FRAMES : FORMAT_UNKNOWN;
+    }
+  }
+
+  return FORMAT_CSV;
+}
+
+static bool frames_Load(const char *path, FORMAT format)
+{
+  FILE *file = fopen(path, "rb");
+  bool result = false;
+
+  if (file == NULL)
+  {
+    perror(path);
+    return false;
+  }
+
+  if (format == FORMAT_UNKNOWN)
+  {
+    format = frames_DetectFormat(path, file);
+  }
+
+  switch (format)
+  {
+  case FORMAT_IMAGE:
+    result = frames_LoadImage(file);
+    break;
+  case FORMAT_FRAMES:
+    result = frames_LoadRaw(file);
+    break;
+  case FORMAT_CSV:
+    result = frames_LoadCsv(file);
+    break;
+  default:
+    fprintf(stderr, "%s: unknown format, use -f\n", path);
+    break;
+  }
+
+  fclose(file);
+  return result;
+}
+
+/**
+ * @brief Generates a mopping motion: the handle is held at 50 deg to the floor and is pushed back and forth with 0.8 Hz while
+ * it is turned around its axis (s-shape). The tag of the mop is read every 300 ms.
+ */
+static bool frames_Generate(uint32_t seconds)
+{
+  const EPC_BINARY mop_epc = {{0xE2, 0x80, 0x68, 0x94, 0x00, 0x00, 0x50, 0x00, 0x00, 0x00, 0x00, 0x01}};
+  const double tilt = 50.0 * FMATH_PI / 180.0;
+  uint32_t count = seconds * 1000UL / Parameter.imu_interval;
+  uint32_t i = 0;
+  uint64_t time_ms = 1760000000000ULL;
+  double phase = 0.0;
+  LOGFRAME frame;
+
+  frames_logged = false;
+
+  for (i = 0; i < count; i++)
+  {
+    phase = 2.0 * FMATH_PI * 0.8 * (i * Parameter.imu_interval) / 1000.0;
+
+    memset(&frame, 0, sizeof(frame));
+    frame.FrameNumber = i;
+    frame.unixtime = (uint32_t)(time_ms / 1000ULL);
+    frame.millisec = (uint16_t)(time_ms % 1000ULL);
+    frame.raw_sens_value[0] = csv_Raw(2.0 * sin(phase), 32768.0 / (2.0 * GRAVITY_EARTH));
+    frame.raw_sens_value[1] = csv_Raw(-GRAVITY_EARTH * sin(tilt), 32768.0 / (2.0 * GRAVITY_EARTH));
+    frame.raw_sens_value[2] = csv_Raw(GRAVITY_EARTH * cos(tilt) + 1.5 * sin(phase), 32768.0 / (2.0 * GRAVITY_EARTH));
+    frame.raw_sens_value[3] = csv_Raw(20.0 * sin(phase), 32768.0 / 2000.0);
+    frame.raw_sens_value[4] = csv_Raw(150.0 * cos(phase), 32768.0 / 2000.0);
+    frame.raw_sens_value[5] = csv_Raw(10.0 * cos(2.0 * phase), 32768.0 / 2000.0);
+    frame.raw_sens_value[6] = 0;
+    frame.raw_sens_value[7] = 200;
+    frame.raw_sens_value[8] = 100;
+    frame.Input_status = STATUSFLAG_MD;
+
+    if ((time_ms % 300ULL) < (uint64_t)Parameter.imu_interval)
+    {
+      frame.rfid_epc = mop_epc;
+      frame.rfid_record_type = MOP_TAG;
+    }
+
+    if (frames_Add(&frame) == false)
+    {
+      return false;
+    }
+
+    time_ms += Parameter.imu_interval;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Prepares the firmware state like the boot of the device, with the default parameters and the algorithm unlocked
+ */
+static void replay_Init(void)
+{
+  Parameter_InitRAM();
+  System_InitRAM();
+  shim_Reset();
+  init_algorithms();
+
+  System.boot_complete = true;
+  System.charger_connected = false;
+  algorithm_lock = false;
+  last_rfid_read = 0LL;
+}
+
+/**
+ * @brief Feeds one frame into the algorithm, like the imu thread (samples), the rfid thread (reads) and epc_process_tags()
+ * (mop tags) do it on the device
+ */
+static void replay_Frame(const LOGFRAME *frame)
+{
+  shim_frame_number = frame->FrameNumber;
+  unixtime_ms = (time_t)frame->unixtime * 1000LL + frame->millisec;
+
+  accel.x = frame->raw_sens_value[0];
+  accel.y = frame->raw_sens_value[1];
+  accel.z = frame->raw_sens_value[2];
+  gyro.x = frame->raw_sens_value[3];
+  gyro.y = frame->raw_sens_value[4];
+  gyro.z = frame->raw_sens_value[5];
+  bmm150.data.x = frame->raw_sens_value[6];
+  bmm150.data.y = frame->raw_sens_value[7];
+  bmm150.data.z = frame->raw_sens_value[8];
+
+  motion_detected = ((frame->Input_status & STATUSFLAG_MD) != 0);
+
+  /* The rfid thread triggers a read every rfid interval while the algorithm enabled the scan */
+  if ((RFID_ScanEnable == true) && ((unixtime_ms - last_rfid_read) >= Parameter.rfid_interval))
+  {
+    RFID_TriggeredRead = true;
+    last_rfid_read = unixtime_ms;
+  }
+
+  if ((frame->rfid_record_type == MOP_TAG) && (EPC_IsZero(&frame->rfid_epc) == false))
+  {
+    shim_MopTag(&frame->rfid_epc);
+    RFID_TriggeredRead = true;
+  }
+
+  algo_benchmark_Execute();
+  shim_CheckNotification();
+}
+
+static void replay_PrintOutputs(const LOGFRAME *frame)
+{
+  fprintf(output_file, "%u;%lld;%.2f;%.2f;%.2f;%.2f;%u;%u;%u;%u;%u;%.2f;%.2f;%u;%u;%u\n",
+          frame->FrameNumber,
+          (long long)unixtime_ms,
+          floor_handle_angle[0],
+          frame_handle_angle[0],
+          mopping_speed,
+          mopping_coverage_per_mop,
+          mopcycles,
+          mopping_pattern[0],
+          motion_state[0],
+          Frame_side[0],
+          MoppingFlag[0],
+          frame->floor_handle_angle,
+          frame->frame_handle_angle,
+          frame->Mop_cycles,
+          frame->Mopping_pattern,
+          frame->Motion_state);
+}
+
+/* The data log stores the outputs of the last algorithm run, which is the same frame or the one before */
+static void replay_Compare(const LOGFRAME *frame)
+{
+  max_floor_angle_difference = fmaxf(max_floor_angle_difference, fabsf(floor_handle_angle[0] - frame->floor_handle_angle));
+  max_frame_angle_difference = fmaxf(max_frame_angle_difference, fabsf(frame_handle_angle[0] - frame->frame_handle_angle));
+
+  if (mopping_pattern[0] != frame->Mopping_pattern)
+  {
+    pattern_differences++;
+  }
+
+  if (motion_state[0] != frame->Motion_state)
+  {
+    motion_differences++;
+  }
+}
+
+static void replay_Run(void)
+{
+  uint32_t i = 0;
+  uint8_t type = 0;
+
+  if (output_file != NULL)
+  {
+    fprintf(output_file, "frame;unixtime_ms;floor_handle_angle;frame_handle_angle;mopping_speed;coverage_per_mop;mop_cycles;"
+                         "mopping_pattern;motion_state;frame_side;mopping_flag;logged_floor_handle_angle;logged_frame_handle_angle;"
+                         "logged_mop_cycles;logged_mopping_pattern;logged_motion_state\n");
+  }
+
+  for (i = 0; i < frame_count; i++)
+  {
+    replay_Frame(&frames[i]);
+
+    if (output_file != NULL)
+    {
+      replay_PrintOutputs(&frames[i]);
+    }
+
+    replay_Compare(&frames[i]);
+  }
+
+  fprintf(stderr, "%u frames, %u notifications, events:", frame_count, shim_notification_count);
+
+  for (type = 0; type < SHIM_EVENT_TYPES; type++)
+  {
+    if (shim_event_count[type] > 0)
+    {
+      fprintf(stderr, " 0x%02X: %u", type, shim_event_count[type]);
+    }
+  }
+
+  fprintf(stderr, "\nMop cycles %u, coverage of the last mop %.2f m2\n", mopcycles, mopping_coverage_per_mop);
+
+  if (frames_logged == true)
+  {
+    fprintf(stderr, "Difference to the logged outputs: floor angle %.2f deg, frame angle %.2f deg (max), mopping pattern %u, motion state %u frames\n",
+            max_floor_angle_difference, max_frame_angle_difference, pattern_differences, motion_differences);
+  }
+}
+
+static void bench_Run(uint32_t loops)
+{
+  struct timespec start;
+  struct timespec stop;
+  uint32_t loop = 0;
+  uint32_t i = 0;
+  double seconds = 0.0;
+  double samples = 0.0;
+  ALGO_BENCHMARK benchmark;
+
+  shim_decisions = NULL;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for (loop = 0; loop < loops; loop++)
+  {
+    if (loop > 0)
+    {
+      shim_Reset();
+      algo_reset_variables();
+      last_rfid_read = 0LL;
+    }
+
+    for (i = 0; i < frame_count; i++)
+    {
+      replay_Frame(&frames[i]);
+    }
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+
+  seconds = (double)(stop.tv_sec - start.tv_sec) + (double)(stop.tv_nsec - start.tv_nsec) / 1e9;
+  samples = (double)frame_count * loops;
+
+  fprintf(stdout, "%.0f samples (%u frames x %u loops) in %.3f s\n", samples, frame_count, loops, seconds);
+  fprintf(stdout, "%.0f samples/s, %.1f ns/sample, %.0fx real time at %u ms imu interval\n",
+          samples / seconds, seconds * 1e9 / samples, samples * Parameter.imu_interval / 1000.0 / seconds, Parameter.imu_interval);
+  algo_benchmark_Get(&benchmark);
+  fprintf(stdout, "algorithm_execute_process: %.1f %s/sample (min %llu, max %llu)\n",
+          (double)benchmark.total_cycles / benchmark.calls, shim_cycle_unit,
+          (unsigned long long)benchmark.min_cycles, (unsigned long long)benchmark.max_cycles);
+}
+
+int main(int argc, char **argv)
+{
+  const char *output_path = NULL;
+  FORMAT format = FORMAT_UNKNOWN;
+  bool benchmark = false;
+  uint32_t loops = 1;
+  uint32_t generate_seconds = 0;
+  int option = 0;
+  bool loaded = false;
+
+  while ((option = getopt(argc, argv, "f:o:vbn:g:")) != -1)
+  {
+    switch (option)
+    {
+    case 'f':
+      format = (strcmp(optarg, "image") == 0) ? FORMAT_IMAGE : (strcmp(optarg, "frames") == 0) ? FORMAT_FRAMES : (strcmp(optarg, "csv") == 0) ? FORMAT_CSV : FORMAT_UNKNOWN;
+      break;
+    case 'o':
+      output_path = optarg;
+      break;
+    case 'v':
+      shim_verbose = true;
+      break;
+    case 'b':
+      benchmark = true;
+      break;
+    case 'n':
+      loops = strtoul(optarg, NULL, 10);
+      break;
+    case 'g':
+      generate_seconds = strtoul(optarg, NULL, 10);
+      break;
+    default:
+      fprintf(stderr, "Usage: %s [-f image|frames|csv] [-o <csv>] [-v] <log>\n"
+                      "       %s -b [-n <loops>] <log> | -g <seconds>\n", argv[0], argv[0]);
+      return 1;
+    }
+  }
+
+  replay_Init();
+
+  if (generate_seconds > 0)
+  {
+    loaded = frames_Generate(generate_seconds);
+  }
+  else if (optind < argc)
+  {
+    loaded = frames_Load(argv[optind], format);
+  }
+  else
+  {
+    fprintf(stderr, "No log given\n");
+  }
+
+  if ((loaded == false) || (frame_count == 0) || (loops == 0))
+  {
+    fprintf(stderr, "No frames to replay\n");
+    free(frames);
+    return 1;
+  }
+
+  if (benchmark == true)
+  {
+    bench_Run(loops);
+  }
+  else
+  {
+    if (output_path != NULL)
+    {
+      output_file = fopen(output_path, "w");
+
+      if (output_file == NULL)
+      {
+        perror(output_path);
+        free(frames);
+        return 1;
+      }
+    }
+
+    shim_decisions = stdout;
+    replay_Run();
+
+    if (output_file != NULL)
+    {
+      fclose(output_file);
+    }
+  }
+
+  free(frames);
+  return 0;
+}
@@ -0,0 +1,379 @@
+/**
+ * @file hal_shim.c
+ * @author Thomas Keilbach | keiltronic GmbH
+ * @date 17 Oct 2026
+ * @brief Host implementation of the drivers, events and databases which the motion algorithm (algorithms.c) calls. The events,
+ * notifications and rfid switching of the algorithm are written as decisions instead.
+ * @version 2.0.0
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdarg.h>
+#include <time.h>
+#include "hal_shim.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+FILE *shim_decisions = NULL;
+bool shim_verbose = false;
+uint32_t shim_frame_number = 0UL;
+uint32_t shim_event_count[SHIM_EVENT_TYPES];
+uint32_t shim_notification_count = 0UL;
+
+/* Inputs of the algorithm, set by the replay for each frame (imu.c, rtc.c, rfid.c) */
+struct bmi160_sensor_data accel;
+struct bmi160_sensor_data gyro;
+struct bmm150_dev bmm150;
+volatile uint8_t motion_detected = false;
+time_t unixtime_ms = 0LL;
+uint8_t RFID_autoscan_enabled = false;
+uint8_t RFID_IsOn = false;
+uint8_t RFID_ScanEnable = false;
+uint8_t RFID_TriggeredRead = false;
+
+/* Mop tag of the last reading, the same as the MOP_TAG case of epc_process_tags() (epc_mem.c) sets them */
+EPC_BINARY current_mop_epc_reading;
+MOP_RECORD new_mop_record;
+ADVANCED_MOP_RECORD new_advanced_mop_record;
+ROOM_TO_MOP_MAP current_room_to_mop_mapping;
+uint32_t last_seen_mop_id = 0UL;
+uint8_t mop_installed = false;
+uint32_t epc_session_tag_counter = 0UL;
+
+/* Without the mop database each new mop epc gets the next mop id */
+#define SHIM_MOP_COUNT 256
+static EPC_BINARY shim_mops[SHIM_MOP_COUNT];
+static uint16_t shim_mop_count = 0;
+
+static ADVANCED_MOP_RECORD shim_last_seen_mops[MAX_MOP_PER_SHIFT];
+static uint8_t shim_last_seen_mop_count = 0;
+
+/* Remaining globals of the algorithm */
+NOTIFICATION Notification;
+BUZZER buzzer;
+struct gpio_dt_spec dev_led;
+uint32_t coap_last_transmission_timer = 0UL;
+time_t time_since_last_cloud_transmission = 0LL;
+uint16_t event1statistics_interval_timer = 0;
+uint8_t pcb_test_is_running = false;
+
+static void shim_Decision(const char *format, ...)
+{
+  va_list args;
+
+  if (shim_decisions == NULL)
+  {
+    return;
+  }
+
+  fprintf(shim_decisions, "%u;%lld;", shim_frame_number, (long long)unixtime_ms);
+
+  va_start(args, format);
+  vfprintf(shim_decisions, format, args);
+  va_end(args);
+
+  fputc('\n', shim_decisions);
+}
+
+static void shim_CountEvent(uint8_t type)
+{
+  if (type < SHIM_EVENT_TYPES)
+  {
+    shim_event_count[type]++;
+  }
+}
+
+/**
+ * @brief Clears the state of the shim, the algorithm variables are reset with algo_reset_variables()
+ */
+void shim_Reset(void)
+{
+  memset(&accel, 0, sizeof(accel));
+  memset(&gyro, 0, sizeof(gyro));
+  memset(&bmm150, 0, sizeof(bmm150));
+  memset(&Notification, 0, sizeof(Notification));
+  memset(&current_room_to_mop_mapping, 0, sizeof(current_room_to_mop_mapping));
+  memset(&new_mop_record, 0, sizeof(new_mop_record));
+  memset(&new_advanced_mop_record, 0, sizeof(new_advanced_mop_record));
+  memset(shim_event_count, 0, sizeof(shim_event_count));
+  EPC_Clear(&current_mop_epc_reading);
+
+  motion_detected = false;
+  unixtime_ms = 0LL;
+  RFID_IsOn = false;
+  RFID_ScanEnable = false;
+  RFID_TriggeredRead = false;
+  last_seen_mop_id = 0UL;
+  mop_installed = false;
+  epc_session_tag_counter = 0UL;
+  coap_last_transmission_timer = 0UL;
+  time_since_last_cloud_transmission = 0LL;
+  event1statistics_interval_timer = 0;
+  shim_notification_count = 0UL;
+  shim_mop_count = 0;
+  shim_last_seen_mop_count = 0;
+}
+
+/**
+ * @brief Sets the mop records for a mop tag which was read, like the MOP_TAG case of epc_process_tags()
+ *
+ * @param epc: Epc of the mop tag
+ */
+void shim_MopTag(const EPC_BINARY *epc)
+{
+  uint16_t i = 0;
+
+  for (i = 0; i < shim_mop_count; i++)
+  {
+    if (EPC_Equal(&shim_mops[i], epc) == true)
+    {
+      break;
+    }
+  }
+
+  if ((i == shim_mop_count) && (shim_mop_count < SHIM_MOP_COUNT))
+  {
+    shim_mops[shim_mop_count++] = *epc;
+  }
+
+  memset(&new_mop_record, 0, sizeof(new_mop_record));
+  new_mop_record.mop_id = i + 1;
+  new_mop_record.mop_sides = 2;
+
+  new_advanced_mop_record.mop_color = new_mop_record.mop_color;
+  new_advanced_mop_record.mop_id = new_mop_record.mop_id;
+  new_advanced_mop_record.mop_sides = new_mop_record.mop_sides;
+  new_advanced_mop_record.mop_size = new_mop_record.mop_size;
+  new_advanced_mop_record.mop_typegroup = new_mop_record.mop_typegroup;
+  new_advanced_mop_record.timestamp = unixtime_ms;
+
+  last_seen_mop_id = new_mop_record.mop_id;
+  current_mop_epc_reading = *epc;
+}
+
+/**
+ * @brief Writes a notification which the algorithm requested and clears it, like the notification thread does
+ */
+void shim_CheckNotification(void)
+{
+  if (Notification.next_state != NOTIFICATION_IDLE)
+  {
+    shim_notification_count++;
+    shim_Decision("notification %d", Notification.next_state);
+    Notification.next_state = NOTIFICATION_IDLE;
+  }
+}
+
+/* Events (events.c) */
+void NewEvent0x01(time_t interval_start, time_t interval_end, float pattern_idle, float pattern_moving, float pattern_mopping)
+{
+  (void)interval_start;
+  (void)interval_end;
+  shim_CountEvent(0x01);
+  shim_Decision("event 0x01 idle %.1f%% moving %.1f%% mopping %.1f%%", pattern_idle, pattern_moving, pattern_mopping);
+}
+
+void NewEvent0x02(uint32_t mop_id)
+{
+  shim_CountEvent(0x02);
+  shim_Decision("event 0x02 mop %u", mop_id);
+}
+
+void NewEvent0x17(uint32_t schock_acc)
+{
+  shim_CountEvent(0x17);
+  shim_Decision("event 0x17 hit shock %u", schock_acc);
+}
+
+void NewEvent0x18(uint32_t frame_side)
+{
+  shim_CountEvent(0x18);
+  shim_Decision("event 0x18 frame side %u", frame_side);
+}
+
+void NewEvent0x1B(void)
+{
+  shim_CountEvent(0x1B);
+  shim_Decision("event 0x1B mop change");
+}
+
+void NewEvent0x1C(uint32_t mop_id, float sqm_side_0, float sqm_side_1)
+{
+  shim_CountEvent(0x1C);
+  shim_Decision("event 0x1C mop %u side 0 %.2f m2 side 1 %.2f m2", mop_id, sqm_side_0, sqm_side_1);
+}
+
+/* Mop databases (epc_mem.c) */
+void reset_room_to_mop_mapping(void)
+{
+  EPC_Clear(&current_room_to_mop_mapping.current_mop_epc);
+  current_room_to_mop_mapping.mop_linked_room_id = 0;
+  current_room_to_mop_mapping.current_mop_id = 0;
+  mop_installed = false;
+}
+
+void Mop_AddItemInLastSeenArray(ADVANCED_MOP_RECORD current_mop)
+{
+  if (shim_last_seen_mop_count < MAX_MOP_PER_SHIFT)
+  {
+    shim_last_seen_mops[shim_last_seen_mop_count++] = current_mop;
+  }
+}
+
+uint8_t Mop_CheckIDInLastSeenArray(ADVANCED_MOP_RECORD current_mop)
+{
+  uint8_t i = 0;
+
+  if (current_mop.mop_id != 0)
+  {
+    for (i = 0; i < shim_last_seen_mop_count; i++)
+    {
+      if (shim_last_seen_mops[i].mop_id == current_mop.mop_id)
+      {
+        shim_last_seen_mops[i].timestamp = unixtime_ms;
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+/* Imu (imu.c), with the ranges imu_init() configures (2 g, 2000 dps) */
+float acc_lsb_to_ms2(int16_t val)
+{
+  return (GRAVITY_EARTH * val * 2.0f / 32768.0f);
+}
+
+float gyro_lsb_to_dps(int16_t val)
+{
+  return (val * 2000.0f / 32768.0f);
+}
+
+/* Rfid module (rfid.c) */
+void RFID_TurnOn(void)
+{
+  RFID_IsOn = true;
+  shim_Decision("rfid on");
+}
+
+void RFID_TurnOff(void)
+{
+  RFID_IsOn = false;
+  shim_Decision("rfid off");
+}
+
+void config_RFID(void)
+{
+}
+
+void RFID_setOutputPower(int8_t tx_dbm)
+{
+  shim_Decision("rfid output power %d dBm", tx_dbm);
+}
+
+/* Buzzer and leds */
+void set_buzzer(BUZZER *buzzer)
+{
+  shim_Decision("buzzer %u Hz, %u cycles", buzzer->frequency, buzzer->beep_cycles);
+}
+
+int gpio_pin_set_dt(const struct gpio_dt_spec *spec, int value)
+{
+  (void)spec;
+  (void)value;
+  return 0;
+}
+
+/* Shell and rtc, the output of the algorithm is only written in verbose mode */
+const struct shell *shell_backend_uart_get_ptr(void)
+{
+  return NULL;
+}
+
+void shell_fprintf(const struct shell *sh, int color, const char *fmt, ...)
+{
+  va_list args;
+
+  (void)sh;
+  (void)color;
+
+  if ((shim_verbose == true) && (shim_decisions != NULL))
+  {
+    va_start(args, fmt);
+    vfprintf(shim_decisions, fmt, args);
+    va_end(args);
+  }
+}
+
+void rtc_print_debug_timestamp(void)
+{
+  if ((shim_verbose == true) && (shim_decisions != NULL))
+  {
+    fprintf(shim_decisions, "%u;%lld;", shim_frame_number, (long long)unixtime_ms);
+  }
+}
+
+/* Kernel */
+int32_t k_msleep(int32_t ms)
+{
+  (void)ms;
+  return 0;
+}
+
+int64_t k_uptime_get(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (int64_t)now.tv_sec * 1000LL + now.tv_nsec / 1000000L;
+}
+
+/* The replay runs in one thread, the mutexes have nothing to protect */
+int k_mutex_lock(struct k_mutex *mutex, int timeout)
+{
+  (void)mutex;
+  (void)timeout;
+  return 0;
+}
+
+int k_mutex_unlock(struct k_mutex *mutex)
+{
+  (void)mutex;
+  return 0;
+}
+
+/* Timing, the time stamp counter of the host or nano seconds */
+#if defined(__x86_64__) || defined(__i386__)
+const char *shim_cycle_unit = "tsc cycles";
+
+timing_t timing_counter_get(void)
+{
+  return __rdtsc();
+}
+#else
+const char *shim_cycle_unit = "ns";
+
+timing_t timing_counter_get(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (timing_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+#endif
+
+uint64_t timing_cycles_get(volatile timing_t *const start, volatile timing_t *const end)
+{
+  return *end - *start;
+}
+
+void timing_init(void)
+{
+}
+
+void timing_start(void)
+{
+}
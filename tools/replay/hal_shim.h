@@ -0,0 +1,30 @@
+/**
+ * @file hal_shim.h
+ * @author Thomas Keilbach | keiltronic GmbH
+ * @date 17 Oct 2026
+ * @brief Host implementation of the drivers, events and databases which the motion algorithm (algorithms.c) calls. The events,
+ * notifications and rfid switching of the algorithm are written as decisions instead.
+ * @version 2.0.0
+ */
+
+#ifndef HAL_SHIM_H
+#define HAL_SHIM_H
+
+#include <stdio.h>
+#include "algorithms.h"
+
+#define SHIM_EVENT_TYPES 0x20 // Event types which are counted (0x00 - 0x1F)
+
+/* Decisions are written as "frame;unixtime_ms;decision" lines */
+extern FILE *shim_decisions;         // NULL while benchmarking
+extern bool shim_verbose;            // Also write the shell output of the algorithm
+extern uint32_t shim_frame_number;   // Frame of the sample which is processed
+extern uint32_t shim_event_count[SHIM_EVENT_TYPES];
+extern uint32_t shim_notification_count;
+extern const char *shim_cycle_unit;  // Unit of timing_cycles_get()
+
+extern void shim_Reset(void);
+extern void shim_MopTag(const EPC_BINARY *epc);
+extern void shim_CheckNotification(void);
+
+#endif
@@ -0,0 +1,2 @@
+/* Host stand-in, see zephyr_shim.h */
+#include "zephyr_shim.h"
@@ -0,0 +1,70 @@
+/**
+ * @file zephyr_shim.h
+ * @author Thomas Keilbach | keiltronic GmbH
+ * @date 17 Oct 2026
+ * @brief Host stand-in for the Zephyr, nrf and protobuf-c headers which are reached from algorithms.h. All stub headers in
+ * this directory include this file. It only declares what the firmware headers and the replayed sources use, the functions
+ * are implemented in hal_shim.c.
+ * @version 2.0.0
+ */
+
+#ifndef ZEPHYR_SHIM_H
+#define ZEPHYR_SHIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Types used in the declarations of the firmware headers */
+struct device;
+struct shell;
+struct mqtt_client;
+struct mqtt_evt;
+struct aws_fota_event;
+struct gpio_dt_spec { const struct device *port; int pin; int dt_flags; };
+struct gpio_callback { int unused; };
+struct i2c_msg { int unused; };
+struct uart_event_rx { uint8_t *buf; size_t offset; size_t len; };
+struct uart_event_tx { const uint8_t *buf; size_t len; };
+struct uart_event_rx_buf { uint8_t *buf; };
+struct uart_event { int type; union { struct uart_event_tx tx; struct uart_event_rx rx; struct uart_event_rx_buf rx_buf; } data; };
+struct lte_lc_evt { int type; };
+enum lte_lc_nw_reg_status { LTE_LC_NW_REG_NOT_REGISTERED, LTE_LC_NW_REG_REGISTERED_HOME, LTE_LC_NW_REG_SEARCHING, LTE_LC_NW_REG_REGISTRATION_DENIED, LTE_LC_NW_REG_UNKNOWN, LTE_LC_NW_REG_REGISTERED_ROAMING, LTE_LC_NW_REG_REGISTERED_EMERGENCY, LTE_LC_NW_REG_UICC_FAIL };
+typedef uint64_t timing_t;
+struct k_mutex { int unused; };
+
+/* protobuf-c, for aletheia.pb-c.h */
+typedef int protobuf_c_boolean;
+typedef struct { size_t len; uint8_t *data; } ProtobufCBinaryData;
+typedef struct { const void *descriptor; unsigned n_unknown_fields; void *unknown_fields; } ProtobufCMessage;
+typedef struct ProtobufCBuffer { void (*append)(struct ProtobufCBuffer *buffer, size_t len, const uint8_t *data); } ProtobufCBuffer;
+typedef struct { int unused; } ProtobufCMessageDescriptor;
+typedef struct { int unused; } ProtobufCAllocator;
+#define PROTOBUF_C__BEGIN_DECLS
+#define PROTOBUF_C__END_DECLS
+#define PROTOBUF_C_VERSION_NUMBER 1003000
+#define PROTOBUF_C__FORCE_ENUM_TO_BE_INT_SIZE(x) , x##__FORCE_INT = 0x7fffffff
+
+#define BUILD_ASSERT(...)
+#define K_FOREVER 0
+#define K_MUTEX_DEFINE(name) struct k_mutex name
+#define SHELL_VT100_COLOR_DEFAULT 0
+#define SHELL_VT100_COLOR_RED 1
+#define SHELL_VT100_COLOR_GREEN 2
+#define SHELL_VT100_COLOR_YELLOW 3
+#define SHELL_VT100_COLOR_BLUE 4
+
+/* Kernel, timing and shell calls of the replayed sources */
+extern int32_t k_msleep(int32_t ms);
+extern int64_t k_uptime_get(void);
+extern int k_mutex_lock(struct k_mutex *mutex, int timeout);
+extern int k_mutex_unlock(struct k_mutex *mutex);
+extern void timing_init(void);
+extern void timing_start(void);
+extern timing_t timing_counter_get(void);
+extern uint64_t timing_cycles_get(volatile timing_t *const start, volatile timing_t *const end);
+extern int gpio_pin_set_dt(const struct gpio_dt_spec *spec, int value);
+extern const struct shell *shell_backend_uart_get_ptr(void);
+extern void shell_fprintf(const struct shell *sh, int color, const char *fmt, ...);
+
+#endif